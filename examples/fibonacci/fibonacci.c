@@ -75,6 +75,30 @@ void fibonacci_cf(void *arg)
     }
 }
 
+void fibonacci_wf(void *arg)
+{
+    int n = ((fibonacci_arg_t *)arg)->n;
+    int *p_ret = &((fibonacci_arg_t *)arg)->ret;
+
+    if (n <= 1) {
+        *p_ret = 1;
+    } else {
+        fibonacci_arg_t child1_arg = { n - 1, 0 };
+        fibonacci_arg_t child2_arg = { n - 2, 0 };
+        int rank;
+        ABT_xstream_self_rank(&rank);
+        ABT_pool target_pool = pools[rank];
+        ABT_thread child1;
+        /* Calculate fib(n - 1).  If child1 is not stolen by the time when it
+         * is freed, this ULT executes it as a function call. */
+        ABT_thread_fork(target_pool, fibonacci_wf, &child1_arg, &child1);
+        /* Calculate fib(n - 2).  We do not create another ULT. */
+        fibonacci_wf(&child2_arg);
+        ABT_thread_free(&child1);
+        *p_ret = child1_arg.ret + child2_arg.ret;
+    }
+}
+
 int fibonacci_seq(int n)
 {
     if (n <= 1) {
@@ -123,6 +147,7 @@ int main(int argc, char **argv)
                        "[-s CREATE_TYPE]\n"
                        "CREATE_TYPE = 0 : parent-first (ABT_thread_create)\n"
                        "            = 1 : child-first(ABT_thread_create_to)\n"
+                       "            = 2 : work-first (ABT_thread_fork)\n"
                        "[-p POOL_TYPE]\n"
                        "POOL_TYPE = 0 : FIFO (ABT_POOL_FIFO)\n"
                        "          = 1 : RANDWS (ABT_POOL_RANDWS)\n");
@@ -174,7 +199,9 @@ int main(int argc, char **argv)
     for (i = 0; i < 5; i++) {
         double t1 = ABT_get_wtime();
         fibonacci_arg_t arg = { n, 0 };
-        if (is_child_first) {
+        if (is_child_first == 2) {
+            fibonacci_wf(&arg);
+        } else if (is_child_first) {
             fibonacci_cf(&arg);
         } else {
             fibonacci_pf(&arg);
@@ -8,8 +8,10 @@ abt_sources += \
 	arch/abtd_affinity_parser.c \
 	arch/abtd_env.c \
 	arch/abtd_futex.c \
+	arch/abtd_stack.c \
 	arch/abtd_stream.c \
 	arch/abtd_time.c \
+	arch/abtd_topology.c \
 	arch/abtd_ythread.c
 
 if ABT_USE_FCONTEXT
@@ -447,6 +447,26 @@ ABTU_ret_err int ABTD_affinity_cpuset_apply_default(ABTD_xstream_context *p_ctx,
     return apply_cpuset(p_ctx->native_thread, p_cpuset);
 }
 
+/* Return the NUMA node of CPUs to which an ES of rank is bound by default.  It
+ * returns -1 if the affinity is not set or the CPUs span multiple nodes. */
+int ABTD_affinity_get_default_numa_id(int rank)
+{
+    if (g_affinity.num_cpusets == 0)
+        return -1;
+    ABTD_affinity_cpuset *p_cpuset =
+        &g_affinity.cpusets[rank % g_affinity.num_cpusets];
+    int i, numa_id = -1;
+    for (i = 0; i < (int)p_cpuset->num_cpuids; i++) {
+        ABTD_topology_cpu cpu;
+        int ret = ABTD_topology_cpu_read(p_cpuset->cpuids[i], &cpu);
+        if (ret != ABT_SUCCESS || cpu.numa_id == -1 ||
+            (i != 0 && cpu.numa_id != numa_id))
+            return -1;
+        numa_id = cpu.numa_id;
+    }
+    return numa_id;
+}
+
 void ABTD_affinity_cpuset_destroy(ABTD_affinity_cpuset *p_cpuset)
 {
     if (p_cpuset) {
@@ -19,6 +19,11 @@
 #define ABTD_MEM_MAX_NUM_STACKS 1024
 #define ABTD_MEM_MAX_TOTAL_STACK_SIZE (64 * 1024 * 1024)
 #define ABTD_MEM_MAX_NUM_DESCS 4096
+#define ABTD_MEM_MAX_LOCAL_BUCKETS ABT_MEM_POOL_MIN_LOCAL_BUCKETS
+#define ABTD_MEM_MIN_STACK_CLASS (16 * 1024)
+#define ABTD_MEM_MAX_STACK_CLASS (1024 * 1024)
+#define ABTD_MEM_STACK_RECLAIM_KEEP_SIZE (8 * 1024)
+#define ABTD_STACK_COMMIT_SIZE (16 * 1024)
 
 /* To avoid potential overflow, we intentionally use a smaller value than the
  * real limit. */
@@ -41,6 +46,10 @@ static uint64_t load_env_uint64(const char *env_suffix, uint64_t default_val,
                                 uint64_t min_val, uint64_t max_val);
 static size_t load_env_size(const char *env_suffix, size_t default_val,
                             size_t min_val, size_t max_val);
+#ifdef ABT_CONFIG_USE_MEM_POOL
+static int load_env_stack_classes(const char *env_suffix, size_t *stack_classes,
+                                  int max_num_stack_classes);
+#endif
 
 void ABTD_env_init(ABTI_global *p_global)
 {
@@ -81,6 +90,16 @@ void ABTD_env_init(ABTI_global *p_global)
     }
     /* System page size. */
     p_global->sys_page_size = ABTD_env_get_sys_pagesize();
+    /* Growable stack setting */
+    p_global->stack_growable = ABTD_env_get_stack_growable();
+    /* ABT_STACK_COMMIT_SIZE, ABT_ENV_STACK_COMMIT_SIZE
+     * Size of the top of each growable stack that is accessible from the
+     * beginning.  It is rounded up to the system page size. */
+    p_global->stack_commit_size =
+        ABTU_roundup_size(load_env_size("STACK_COMMIT_SIZE",
+                                        ABTD_STACK_COMMIT_SIZE, 1,
+                                        ABTD_ENV_SIZE_MAX),
+                          p_global->sys_page_size);
     /* Default stack size for ULT */
     p_global->thread_stacksize = ABTD_env_get_thread_stacksize();
     /* Default stack size for scheduler */
@@ -89,6 +108,11 @@ void ABTD_env_init(ABTI_global *p_global)
     p_global->sched_event_freq = ABTD_env_get_sched_event_freq();
     /* Default nanoseconds for scheduler sleep */
     p_global->sched_sleep_nsec = ABTD_env_get_sched_sleep_nsec();
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+    /* ABT_SCHED_PARK, ABT_ENV_SCHED_PARK
+     * Whether idle predefined schedulers park their ESs */
+    p_global->sched_park = load_env_bool("SCHED_PARK", ABT_TRUE);
+#endif
 
     /* ABT_MUTEX_MAX_HANDOVERS, ABT_ENV_MUTEX_MAX_HANDOVERS
      * Default maximum number of mutex handover */
@@ -141,23 +165,83 @@ void ABTD_env_init(ABTI_global *p_global)
         ABTU_min_uint32(ABTD_MEM_MAX_TOTAL_STACK_SIZE /
                             p_global->thread_stacksize,
                         ABTD_MEM_MAX_NUM_STACKS);
-    /* The value must be a multiple of ABT_MEM_POOL_MAX_LOCAL_BUCKETS. */
+    /* The value must be a multiple of ABT_MEM_POOL_MIN_LOCAL_BUCKETS. */
     p_global->mem_max_stacks =
         ABTU_roundup_uint32(load_env_uint32("MEM_MAX_NUM_STACKS",
                                             default_mem_max_stacks,
-                                            ABT_MEM_POOL_MAX_LOCAL_BUCKETS,
+                                            ABT_MEM_POOL_MIN_LOCAL_BUCKETS,
                                             ABTD_ENV_UINT32_MAX),
-                            ABT_MEM_POOL_MAX_LOCAL_BUCKETS);
+                            ABT_MEM_POOL_MIN_LOCAL_BUCKETS);
 
     /* ABT_MEM_MAX_NUM_DESCS, ABT_ENV_MEM_MAX_NUM_DESCS
      * Maximum number of descriptors that each ES can keep during execution */
-    /* The value must be a multiple of ABT_MEM_POOL_MAX_LOCAL_BUCKETS. */
+    /* The value must be a multiple of ABT_MEM_POOL_MIN_LOCAL_BUCKETS. */
     p_global->mem_max_descs =
         ABTU_roundup_uint32(load_env_uint32("MEM_MAX_NUM_DESCS",
                                             ABTD_MEM_MAX_NUM_DESCS,
-                                            ABT_MEM_POOL_MAX_LOCAL_BUCKETS,
+                                            ABT_MEM_POOL_MIN_LOCAL_BUCKETS,
                                             ABTD_ENV_UINT32_MAX),
-                            ABT_MEM_POOL_MAX_LOCAL_BUCKETS);
+                            ABT_MEM_POOL_MIN_LOCAL_BUCKETS);
+
+    /* ABT_MEM_MAX_LOCAL_BUCKETS, ABT_ENV_MEM_MAX_LOCAL_BUCKETS
+     * Maximum number of buckets that each ES can keep per memory pool.  Each ES
+     * keeps ABT_MEM_POOL_MIN_LOCAL_BUCKETS buckets (i.e., MEM_MAX_NUM_STACKS
+     * stacks).  If the user sets a larger value, an ES keeps more if buckets
+     * bounce between the ES and the global pool, so it can cache up to
+     * MEM_MAX_NUM_STACKS * MEM_MAX_LOCAL_BUCKETS / 2 stacks.  By default, an
+     * ES caches at most MEM_MAX_NUM_STACKS stacks. */
+    p_global->mem_max_local_buckets =
+        load_env_uint32("MEM_MAX_LOCAL_BUCKETS", ABTD_MEM_MAX_LOCAL_BUCKETS,
+                        ABT_MEM_POOL_MIN_LOCAL_BUCKETS,
+                        ABT_MEM_POOL_MAX_LOCAL_BUCKETS);
+
+    /* ABT_MEM_STACK_CLASSES, ABT_ENV_MEM_STACK_CLASSES
+     * Comma-separated list of stack sizes (in bytes) whose stacks are kept in
+     * memory pools like stacks of the default size.  A ULT of a non-default
+     * stack size takes a stack of the smallest class that is large enough.
+     * Power-of-two sizes from ABTD_MEM_MIN_STACK_CLASS to
+     * ABTD_MEM_MAX_STACK_CLASS are used by default. */
+    p_global->mem_num_stack_classes =
+        load_env_stack_classes("MEM_STACK_CLASSES",
+                               p_global->mem_stack_classes,
+                               ABTI_MEM_MAX_STACK_CLASSES);
+
+    /* ABT_MEM_STACK_RECLAIM, ABT_ENV_MEM_STACK_RECLAIM
+     * How to release memory of stacks that are returned to the global memory
+     * pool.  "none" keeps the memory, "free" uses MADV_FREE (or MADV_DONTNEED
+     * if MADV_FREE is not available), and "dontneed" uses MADV_DONTNEED. */
+    p_global->mem_stack_reclaim = ABTI_MEM_STACK_RECLAIM_NONE;
+    if (p_global->stack_growable) {
+        /* Shrink growable stacks by default. */
+        p_global->mem_stack_reclaim = ABTI_MEM_STACK_RECLAIM_DONTNEED;
+    }
+    env = get_abt_env("MEM_STACK_RECLAIM");
+    if (env != NULL) {
+        if (strcasecmp(env, "free") == 0) {
+            p_global->mem_stack_reclaim = ABTI_MEM_STACK_RECLAIM_FREE;
+        } else if (strcasecmp(env, "dontneed") == 0) {
+            p_global->mem_stack_reclaim = ABTI_MEM_STACK_RECLAIM_DONTNEED;
+        } else if (strcasecmp(env, "none") == 0) {
+            p_global->mem_stack_reclaim = ABTI_MEM_STACK_RECLAIM_NONE;
+        }
+    }
+
+    /* ABT_MEM_STACK_RECLAIM_KEEP_SIZE, ABT_ENV_MEM_STACK_RECLAIM_KEEP_SIZE
+     * Size of the top of each stack that is not released by
+     * ABT_MEM_STACK_RECLAIM.  It is rounded up to the system page size.
+     * Growable stacks are shrunk to their commit size by default. */
+    p_global->mem_stack_reclaim_keep_size =
+        ABTU_roundup_size(load_env_size("MEM_STACK_RECLAIM_KEEP_SIZE",
+                                        p_global->stack_growable
+                                            ? p_global->stack_commit_size
+                                            : ABTD_MEM_STACK_RECLAIM_KEEP_SIZE,
+                                        0, ABTD_ENV_SIZE_MAX),
+                          p_global->sys_page_size);
+
+    /* ABT_MEM_NUMA_AWARE, ABT_ENV_MEM_NUMA_AWARE
+     * Whether to keep stacks and descriptors in a global pool per NUMA node.
+     * It is effective only if the CPU affinity is set. */
+    p_global->mem_numa_aware = load_env_bool("MEM_NUMA_AWARE", ABT_TRUE);
 
     /* ABT_MEM_LP_ALLOC, ABT_ENV_MEM_LP_ALLOC
      * How to allocate large pages.  The default is to use mmap() for huge
@@ -361,11 +445,26 @@ ABT_bool ABTD_env_get_stack_guard_mprotect(ABT_bool *is_strict)
         mprotect_val = ABT_FALSE;
 #endif
     }
+    if (!mprotect_val && ABTD_env_get_stack_growable()) {
+        /* Growable stacks are built on the mprotect-based stack guard. */
+        strict_val = ABT_FALSE;
+        mprotect_val = ABT_TRUE;
+    }
     if (is_strict)
         *is_strict = strict_val;
     return mprotect_val;
 }
 
+ABT_bool ABTD_env_get_stack_growable(void)
+{
+#ifdef ABTD_STACK_GROWABLE_SUPPORTED
+    /* ABT_STACK_GROWABLE, ABT_ENV_STACK_GROWABLE */
+    return load_env_bool("STACK_GROWABLE", ABT_FALSE);
+#else
+    return ABT_FALSE;
+#endif
+}
+
 /*****************************************************************************/
 /* Internal static functions                                                 */
 /*****************************************************************************/
@@ -525,3 +624,54 @@ static size_t load_env_size(const char *env_suffix, size_t default_val,
         }
     }
 }
+
+#ifdef ABT_CONFIG_USE_MEM_POOL
+static int load_env_stack_classes(const char *env_suffix, size_t *stack_classes,
+                                  int max_num_stack_classes)
+{
+    int num_stack_classes = 0, i;
+    const char *env = get_abt_env(env_suffix);
+    if (!env) {
+        size_t stacksize;
+        for (stacksize = ABTD_MEM_MIN_STACK_CLASS;
+             stacksize <= ABTD_MEM_MAX_STACK_CLASS &&
+             num_stack_classes < max_num_stack_classes;
+             stacksize *= 2) {
+            stack_classes[num_stack_classes++] = stacksize;
+        }
+        return num_stack_classes;
+    } else if (is_false(env, ABT_TRUE)) {
+        /* Stack size classes are disabled. */
+        return 0;
+    }
+    /* Read sizes.  Invalid ones are ignored. */
+    while (num_stack_classes < max_num_stack_classes) {
+        size_t stacksize;
+        int abt_errno = ABTU_atosz(env, &stacksize, NULL);
+        if (abt_errno == ABT_SUCCESS && stacksize >= 512 &&
+            stacksize <= ABTD_ENV_SIZE_MAX) {
+            stacksize =
+                ABTU_roundup_size(stacksize, ABT_CONFIG_STATIC_CACHELINE_SIZE);
+            /* Insert it while keeping the ascending order. */
+            for (i = num_stack_classes; i > 0; i--) {
+                if (stack_classes[i - 1] <= stacksize)
+                    break;
+                stack_classes[i] = stack_classes[i - 1];
+            }
+            if (i > 0 && stack_classes[i - 1] == stacksize) {
+                /* Duplicated.  Undo the shift. */
+                for (; i < num_stack_classes; i++)
+                    stack_classes[i] = stack_classes[i + 1];
+            } else {
+                stack_classes[i] = stacksize;
+                num_stack_classes++;
+            }
+        }
+        env = strchr(env, ',');
+        if (!env)
+            break;
+        env++;
+    }
+    return num_stack_classes;
+}
+#endif
@@ -47,6 +47,15 @@ void ABTD_futex_broadcast(ABTD_futex_multiple *p_futex)
             NULL, 0);
 }
 
+void ABTD_futex_signal(ABTD_futex_multiple *p_futex)
+{
+    /* A waiter that has not slept yet also notices the value change. */
+    int current_val = ABTD_atomic_relaxed_load_int(&p_futex->val);
+    ABTD_atomic_relaxed_store_int(&p_futex->val, current_val + 1);
+    syscall(SYS_futex, &p_futex->val.val, FUTEX_WAKE_PRIVATE, 1, NULL, NULL,
+            0);
+}
+
 void ABTD_futex_suspend(ABTD_futex_single *p_futex)
 {
     /* Wake-up signal is 1. */
@@ -158,10 +167,13 @@ void ABTD_futex_timedwait_and_unlock(ABTD_futex_multiple *p_futex,
              * p_futex carefully. */
             if (p_futex->p_next == (void *)&sync_obj) {
                 p_futex->p_next = (void *)sync_obj.p_next;
+                if (sync_obj.p_next)
+                    sync_obj.p_next->p_prev = NULL;
             } else {
                 ABTI_ASSERT(sync_obj.p_prev);
                 sync_obj.p_prev->p_next = sync_obj.p_next;
-                sync_obj.p_next->p_prev = sync_obj.p_prev;
+                if (sync_obj.p_next)
+                    sync_obj.p_next->p_prev = sync_obj.p_prev;
             }
         }
         ABTD_spinlock_release(p_lock);
@@ -188,6 +200,23 @@ void ABTD_futex_broadcast(ABTD_futex_multiple *p_futex)
     p_futex->p_next = NULL;
 }
 
+void ABTD_futex_signal(ABTD_futex_multiple *p_futex)
+{
+    /* The caller must be holding a lock (p_lock above). */
+    pthread_sync *p_cur = (pthread_sync *)p_futex->p_next;
+    if (p_cur) {
+        /* Remove p_cur from the list before waking it up. */
+        pthread_sync *p_next = p_cur->p_next;
+        if (p_next)
+            p_next->p_prev = NULL;
+        p_futex->p_next = (void *)p_next;
+        pthread_mutex_lock(&p_cur->mutex);
+        ABTD_atomic_relaxed_store_int(&p_cur->val, 1);
+        pthread_cond_broadcast(&p_cur->cond);
+        pthread_mutex_unlock(&p_cur->mutex);
+    }
+}
+
 void ABTD_futex_suspend(ABTD_futex_single *p_futex)
 {
     if (ABTD_atomic_acquire_load_ptr(&p_futex->p_sync_obj) != NULL) {
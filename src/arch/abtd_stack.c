@@ -0,0 +1,237 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include "abti.h"
+
+#ifdef ABTD_STACK_GROWABLE_SUPPORTED
+
+#include <signal.h>
+
+/* Minimum size of a signal stack that runs the SIGSEGV handler.  The handler
+ * might call a handler that has been installed before ABT_init(). */
+#define ABTD_STACK_GROWABLE_SIGALTSTACK_SIZE (64 * 1024)
+
+static ABT_bool g_stack_growable_enabled = ABT_FALSE;
+static size_t g_stack_growable_page_size;
+static size_t g_stack_growable_commit_size;
+static struct sigaction g_stack_growable_prev_action;
+/* Signal stack of the primary ES if it is allocated by this library. */
+static void *gp_stack_growable_primary_sigaltstack = NULL;
+
+static size_t stack_growable_get_sigaltstack_size(void);
+static ABT_bool stack_growable_grow(char *p_addr);
+static void stack_growable_sigsegv_handler(int sig, siginfo_t *p_info,
+                                           void *p_ucontext);
+
+ABTU_ret_err int ABTD_stack_growable_init(ABTI_global *p_global)
+{
+    if (!p_global->stack_growable)
+        return ABT_SUCCESS;
+    g_stack_growable_page_size = p_global->sys_page_size;
+    g_stack_growable_commit_size = p_global->stack_commit_size;
+    g_stack_growable_enabled = ABT_TRUE;
+
+    /* The handler must run on another stack since the stack of the faulting
+     * ULT cannot be used.  Use the signal stack of the calling thread (i.e.,
+     * the primary ES) if it has been set by the user. */
+    stack_t old_ss;
+    int ret = sigaltstack(NULL, &old_ss);
+    if (ret == 0 && (old_ss.ss_flags & SS_DISABLE)) {
+        int abt_errno = ABTD_stack_growable_alloc_sigaltstack(
+            &gp_stack_growable_primary_sigaltstack);
+        if (abt_errno != ABT_SUCCESS) {
+            g_stack_growable_enabled = ABT_FALSE;
+            ABTI_HANDLE_ERROR(abt_errno);
+        }
+        ABTD_stack_growable_set_sigaltstack(
+            gp_stack_growable_primary_sigaltstack);
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_flags = SA_SIGINFO | SA_ONSTACK;
+    sa.sa_sigaction = stack_growable_sigsegv_handler;
+    sigemptyset(&sa.sa_mask);
+    ret = sigaction(SIGSEGV, &sa, &g_stack_growable_prev_action);
+    if (ret != 0) {
+        ABTD_stack_growable_unset_sigaltstack(
+            gp_stack_growable_primary_sigaltstack);
+        ABTD_stack_growable_free_sigaltstack(
+            gp_stack_growable_primary_sigaltstack);
+        gp_stack_growable_primary_sigaltstack = NULL;
+        g_stack_growable_enabled = ABT_FALSE;
+        ABTI_HANDLE_ERROR(ABT_ERR_SYS);
+    }
+    return ABT_SUCCESS;
+}
+
+void ABTD_stack_growable_finalize(ABTI_global *p_global)
+{
+    (void)p_global;
+    if (!g_stack_growable_enabled)
+        return;
+    /* Restore the previous handler unless it has been overwritten. */
+    struct sigaction cur_action;
+    int ret = sigaction(SIGSEGV, NULL, &cur_action);
+    if (ret == 0 && (cur_action.sa_flags & SA_SIGINFO) &&
+        cur_action.sa_sigaction == stack_growable_sigsegv_handler) {
+        ret = sigaction(SIGSEGV, &g_stack_growable_prev_action, NULL);
+        ABTI_ASSERT(ret == 0);
+    }
+    ABTD_stack_growable_unset_sigaltstack(
+        gp_stack_growable_primary_sigaltstack);
+    ABTD_stack_growable_free_sigaltstack(gp_stack_growable_primary_sigaltstack);
+    gp_stack_growable_primary_sigaltstack = NULL;
+    g_stack_growable_enabled = ABT_FALSE;
+}
+
+ABTU_ret_err int ABTD_stack_growable_alloc_sigaltstack(void **pp_sigaltstack)
+{
+    if (!g_stack_growable_enabled) {
+        *pp_sigaltstack = NULL;
+        return ABT_SUCCESS;
+    }
+    return ABTU_malloc(stack_growable_get_sigaltstack_size(), pp_sigaltstack);
+}
+
+void ABTD_stack_growable_free_sigaltstack(void *p_sigaltstack)
+{
+    if (p_sigaltstack)
+        ABTU_free(p_sigaltstack);
+}
+
+void ABTD_stack_growable_set_sigaltstack(void *p_sigaltstack)
+{
+    if (p_sigaltstack) {
+        stack_t ss;
+        ss.ss_sp = p_sigaltstack;
+        ss.ss_size = stack_growable_get_sigaltstack_size();
+        ss.ss_flags = 0;
+        int ret = sigaltstack(&ss, NULL);
+        ABTI_ASSERT(ret == 0);
+    }
+}
+
+void ABTD_stack_growable_unset_sigaltstack(void *p_sigaltstack)
+{
+    if (p_sigaltstack) {
+        stack_t ss;
+        memset(&ss, 0, sizeof(ss));
+        ss.ss_flags = SS_DISABLE;
+        int ret = sigaltstack(&ss, NULL);
+        ABTI_ASSERT(ret == 0);
+    }
+}
+
+/*****************************************************************************/
+/* Internal static functions                                                 */
+/*****************************************************************************/
+
+static size_t stack_growable_get_sigaltstack_size(void)
+{
+    return ABTU_max_size(ABTD_STACK_GROWABLE_SIGALTSTACK_SIZE,
+                         (size_t)SIGSTKSZ);
+}
+
+/* Unprotect the page of p_addr and stack_commit_size bytes below it if p_addr
+ * is in a growable part of the stack of the running ULT.  The lowest page of
+ * that stack is not unprotected since it is a stack guard. */
+static ABT_bool stack_growable_grow(char *p_addr)
+{
+    ABTI_xstream *p_local_xstream =
+        ABTI_local_get_xstream_or_null(ABTI_local_get_local_uninlined());
+    if (!p_local_xstream || !p_local_xstream->p_thread)
+        return ABT_FALSE;
+    /* Only stacks taken from memory pools are growable. */
+    ABTI_thread *p_thread = p_local_xstream->p_thread;
+    if (!(p_thread->type &
+          (ABTI_THREAD_TYPE_MEM_MEMPOOL_DESC_STACK |
+           ABTI_THREAD_TYPE_MEM_MEMPOOL_DESC_MEMPOOL_LAZY_STACK |
+           ABTI_THREAD_TYPE_MEM_MALLOC_DESC_MEMPOOL_LAZY_STACK)))
+        return ABT_FALSE;
+    ABTI_ythread *p_ythread = ABTI_thread_get_ythread(p_thread);
+    char *p_stacktop =
+        (char *)ABTD_ythread_context_get_stacktop(&p_ythread->ctx);
+    if (!p_stacktop)
+        return ABT_FALSE;
+    const size_t page_size = g_stack_growable_page_size;
+    char *p_stack =
+        p_stacktop - ABTD_ythread_context_get_stacksize(&p_ythread->ctx);
+    char *p_limit = ((char *)ABTU_roundup_ptr(p_stack, page_size)) + page_size;
+    if (p_addr < p_limit || p_stacktop <= p_addr)
+        return ABT_FALSE;
+
+    char *p_fault_page = (char *)(((uintptr_t)p_addr) & ~(page_size - 1));
+    char *p_start = p_limit;
+    if ((size_t)(p_fault_page - p_limit) > g_stack_growable_commit_size)
+        p_start = p_fault_page - g_stack_growable_commit_size;
+    /* Unprotect pages up to the stack top so that the accessible part of the
+     * stack stays contiguous. */
+    char *p_end = (char *)(((uintptr_t)p_stacktop) & ~(page_size - 1));
+    if (p_end <= p_fault_page)
+        p_end = p_fault_page + page_size;
+    return ABTU_mprotect(p_start, p_end - p_start, ABT_FALSE) == ABT_SUCCESS
+               ? ABT_TRUE
+               : ABT_FALSE;
+}
+
+/* This function must be async-signal-safe. */
+static void stack_growable_sigsegv_handler(int sig, siginfo_t *p_info,
+                                           void *p_ucontext)
+{
+    if (p_info->si_code == SEGV_ACCERR &&
+        stack_growable_grow((char *)p_info->si_addr)) {
+        /* The faulting instruction will be executed again. */
+        return;
+    }
+    /* This signal is not caused by a growable stack.  Forward it. */
+    const struct sigaction *p_prev = &g_stack_growable_prev_action;
+    if (p_prev->sa_flags & SA_SIGINFO) {
+        p_prev->sa_sigaction(sig, p_info, p_ucontext);
+    } else if (p_prev->sa_handler != SIG_DFL && p_prev->sa_handler != SIG_IGN) {
+        p_prev->sa_handler(sig);
+    } else {
+        /* Reset the action so that the faulting instruction raises SIGSEGV
+         * again and terminates the process. */
+        signal(sig, SIG_DFL);
+    }
+}
+
+#else /* !ABTD_STACK_GROWABLE_SUPPORTED */
+
+ABTU_ret_err int ABTD_stack_growable_init(ABTI_global *p_global)
+{
+    /* ABTD_env_get_stack_growable() always returns ABT_FALSE. */
+    ABTI_ASSERT(!p_global->stack_growable);
+    return ABT_SUCCESS;
+}
+
+void ABTD_stack_growable_finalize(ABTI_global *p_global)
+{
+    (void)p_global;
+}
+
+ABTU_ret_err int ABTD_stack_growable_alloc_sigaltstack(void **pp_sigaltstack)
+{
+    *pp_sigaltstack = NULL;
+    return ABT_SUCCESS;
+}
+
+void ABTD_stack_growable_free_sigaltstack(void *p_sigaltstack)
+{
+    (void)p_sigaltstack;
+}
+
+void ABTD_stack_growable_set_sigaltstack(void *p_sigaltstack)
+{
+    (void)p_sigaltstack;
+}
+
+void ABTD_stack_growable_unset_sigaltstack(void *p_sigaltstack)
+{
+    (void)p_sigaltstack;
+}
+
+#endif /* !ABTD_STACK_GROWABLE_SUPPORTED */
@@ -11,6 +11,7 @@ static void *xstream_context_thread_func(void *arg)
     void *(*thread_f)(void *) = p_ctx->thread_f;
     void *p_arg = p_ctx->p_arg;
     ABTI_ASSERT(p_ctx->state == ABTD_XSTREAM_CONTEXT_STATE_RUNNING);
+    ABTD_stack_growable_set_sigaltstack(p_ctx->p_sigaltstack);
     while (1) {
         /* Execute a main execution stream function. */
         thread_f(p_arg);
@@ -42,6 +43,7 @@ static void *xstream_context_thread_func(void *arg)
         if (!restart)
             break;
     }
+    ABTD_stack_growable_unset_sigaltstack(p_ctx->p_sigaltstack);
     return NULL;
 }
 
@@ -56,6 +58,12 @@ ABTU_ret_err int ABTD_xstream_context_create(void *(*f_xstream)(void *),
      * following suppresses a false positive. */
     /* coverity[missing_lock] */
     p_ctx->state = ABTD_XSTREAM_CONTEXT_STATE_RUNNING;
+    int abt_errno =
+        ABTD_stack_growable_alloc_sigaltstack(&p_ctx->p_sigaltstack);
+    if (abt_errno != ABT_SUCCESS) {
+        p_ctx->state = ABTD_XSTREAM_CONTEXT_STATE_UNINIT;
+        ABTI_HANDLE_ERROR(abt_errno);
+    }
     int ret, init_stage = 0;
     ret = pthread_mutex_init(&p_ctx->state_lock, NULL);
     if (ret != 0)
@@ -83,6 +91,7 @@ FAILED:
         ret = pthread_mutex_destroy(&p_ctx->state_lock);
         ABTI_ASSERT(ret == 0);
     }
+    ABTD_stack_growable_free_sigaltstack(p_ctx->p_sigaltstack);
     p_ctx->state = ABTD_XSTREAM_CONTEXT_STATE_UNINIT;
     ABTI_HANDLE_ERROR(ABT_ERR_SYS);
 }
@@ -106,6 +115,7 @@ void ABTD_xstream_context_free(ABTD_xstream_context *p_ctx)
         ABTI_ASSERT(ret == 0);
         ret = pthread_mutex_destroy(&p_ctx->state_lock);
         ABTI_ASSERT(ret == 0);
+        ABTD_stack_growable_free_sigaltstack(p_ctx->p_sigaltstack);
     }
 }
 
@@ -138,6 +148,9 @@ void ABTD_xstream_context_revive(ABTD_xstream_context *p_ctx)
 void ABTD_xstream_context_set_self(ABTD_xstream_context *p_ctx)
 {
     p_ctx->native_thread = pthread_self();
+    /* The signal stack of the calling thread is managed by
+     * ABTD_stack_growable_init(). */
+    p_ctx->p_sigaltstack = NULL;
 }
 
 void ABTD_xstream_context_print(ABTD_xstream_context *p_ctx, FILE *p_os,
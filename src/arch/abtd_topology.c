@@ -0,0 +1,213 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include "abti.h"
+
+/*
+ * The Argobots topology module reads the CPU topology from sysfs on Linux.
+ *  - core_id: the smallest CPU ID in topology/thread_siblings_list, so
+ *    hardware threads on the same physical core share the same core_id.
+ *  - l3_id: the smallest CPU ID in shared_cpu_list of the level-3 cache.
+ *  - numa_id: the NUMA node ID (i.e., N of the "nodeN" entry).
+ * A value that cannot be obtained is set to -1.
+ * The topology of each CPU is read from sysfs only once and cached since it
+ * does not change while the process runs.
+ */
+
+#ifdef __linux__
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#define TOPOLOGY_SYSFS_CPU_PATH "/sys/devices/system/cpu/cpu"
+#define TOPOLOGY_SYSFS_NODE_PATH "/sys/devices/system/node"
+#define TOPOLOGY_MAX_CACHE_INDEX 8
+/* The following values are taken from <linux/mempolicy.h> so that Argobots
+ * does not depend on libnuma. */
+#define TOPOLOGY_MPOL_PREFERRED 1
+#define TOPOLOGY_MPOL_MF_MOVE (1 << 1)
+#define TOPOLOGY_MAX_NUMA_NODES 1024
+/* CPUs whose ID is equal to or larger than this are not cached. */
+#define TOPOLOGY_MAX_CACHED_CPUS 1024
+
+#define TOPOLOGY_CACHE_EMPTY 0
+#define TOPOLOGY_CACHE_VALID 1
+#define TOPOLOGY_CACHE_INVALID 2
+
+/* Cached results of topology_cpu_read().  state is written after cpu with a
+ * release store, so a reader that sees a non-empty state can read cpu without
+ * taking g_topology_cache_lock. */
+typedef struct {
+    ABTD_atomic_int state;
+    ABTD_topology_cpu cpu;
+} topology_cache_entry;
+
+static ABTD_spinlock g_topology_cache_lock = ABTD_SPINLOCK_STATIC_INITIALIZER();
+static topology_cache_entry g_topology_cache[TOPOLOGY_MAX_CACHED_CPUS];
+
+/* Read the first integer in a file.  For a CPU list such as "0-3,8-11", it
+ * returns the smallest CPU ID. */
+static int topology_read_first_int(const char *path)
+{
+    int val;
+    FILE *p_file = fopen(path, "r");
+    if (!p_file)
+        return -1;
+    if (fscanf(p_file, "%d", &val) != 1)
+        val = -1;
+    fclose(p_file);
+    return val;
+}
+
+static int topology_read_l3_id(int cpuid)
+{
+    char path[256];
+    int i;
+    for (i = 0; i < TOPOLOGY_MAX_CACHE_INDEX; i++) {
+        snprintf(path, sizeof(path),
+                 TOPOLOGY_SYSFS_CPU_PATH "%d/cache/index%d/level", cpuid, i);
+        int level = topology_read_first_int(path);
+        if (level == 3) {
+            snprintf(path, sizeof(path),
+                     TOPOLOGY_SYSFS_CPU_PATH "%d/cache/index%d/shared_cpu_list",
+                     cpuid, i);
+            return topology_read_first_int(path);
+        }
+    }
+    return -1;
+}
+
+static int topology_read_numa_id(int cpuid)
+{
+    char path[256];
+    int numa_id = -1;
+    snprintf(path, sizeof(path), TOPOLOGY_SYSFS_CPU_PATH "%d", cpuid);
+    DIR *p_dir = opendir(path);
+    if (!p_dir)
+        return -1;
+    struct dirent *p_entry;
+    while ((p_entry = readdir(p_dir)) != NULL) {
+        int id;
+        if (sscanf(p_entry->d_name, "node%d", &id) == 1) {
+            numa_id = id;
+            break;
+        }
+    }
+    closedir(p_dir);
+    return numa_id;
+}
+
+static ABT_bool topology_cpu_read(int cpuid, ABTD_topology_cpu *p_cpu)
+{
+    char path[256];
+    snprintf(path, sizeof(path),
+             TOPOLOGY_SYSFS_CPU_PATH "%d/topology/thread_siblings_list", cpuid);
+    p_cpu->core_id = topology_read_first_int(path);
+    p_cpu->l3_id = topology_read_l3_id(cpuid);
+    p_cpu->numa_id = topology_read_numa_id(cpuid);
+    return (p_cpu->core_id == -1 && p_cpu->l3_id == -1 && p_cpu->numa_id == -1)
+               ? ABT_FALSE
+               : ABT_TRUE;
+}
+#endif /* __linux__ */
+
+ABTU_ret_err int ABTD_topology_cpu_read(int cpuid, ABTD_topology_cpu *p_cpu)
+{
+#ifdef __linux__
+    if (cpuid < 0 || cpuid >= TOPOLOGY_MAX_CACHED_CPUS) {
+        return topology_cpu_read(cpuid, p_cpu) ? ABT_SUCCESS : ABT_ERR_SYS;
+    }
+    topology_cache_entry *p_entry = &g_topology_cache[cpuid];
+    int state = ABTD_atomic_acquire_load_int(&p_entry->state);
+    if (state == TOPOLOGY_CACHE_EMPTY) {
+        ABTD_spinlock_acquire(&g_topology_cache_lock);
+        state = ABTD_atomic_relaxed_load_int(&p_entry->state);
+        if (state == TOPOLOGY_CACHE_EMPTY) {
+            state = topology_cpu_read(cpuid, &p_entry->cpu)
+                        ? TOPOLOGY_CACHE_VALID
+                        : TOPOLOGY_CACHE_INVALID;
+            ABTD_atomic_release_store_int(&p_entry->state, state);
+        }
+        ABTD_spinlock_release(&g_topology_cache_lock);
+    }
+    if (state != TOPOLOGY_CACHE_VALID)
+        return ABT_ERR_SYS;
+    *p_cpu = p_entry->cpu;
+    return ABT_SUCCESS;
+#else
+    return ABT_ERR_FEATURE_NA;
+#endif
+}
+
+/* Return the topology level shared by two CPUs. */
+ABTD_topology_level ABTD_topology_get_level(const ABTD_topology_cpu *p_cpu1,
+                                            const ABTD_topology_cpu *p_cpu2)
+{
+    if (p_cpu1->core_id != -1 && p_cpu1->core_id == p_cpu2->core_id) {
+        return ABTD_TOPOLOGY_LEVEL_CORE;
+    } else if (p_cpu1->l3_id != -1 && p_cpu1->l3_id == p_cpu2->l3_id) {
+        return ABTD_TOPOLOGY_LEVEL_L3;
+    } else if (p_cpu1->numa_id != -1 && p_cpu1->numa_id == p_cpu2->numa_id) {
+        return ABTD_TOPOLOGY_LEVEL_NUMA;
+    } else {
+        return ABTD_TOPOLOGY_LEVEL_REMOTE;
+    }
+}
+
+/* Return the number of NUMA nodes, which is the largest node ID + 1.  It
+ * returns 1 if the NUMA topology is unknown. */
+int ABTD_topology_get_num_numa_nodes(void)
+{
+    int num_nodes = 1;
+#ifdef __linux__
+    DIR *p_dir = opendir(TOPOLOGY_SYSFS_NODE_PATH);
+    if (!p_dir)
+        return 1;
+    struct dirent *p_entry;
+    while ((p_entry = readdir(p_dir)) != NULL) {
+        int id;
+        if (sscanf(p_entry->d_name, "node%d", &id) == 1 && id >= num_nodes &&
+            id < TOPOLOGY_MAX_NUMA_NODES) {
+            num_nodes = id + 1;
+        }
+    }
+    closedir(p_dir);
+#endif
+    return num_nodes;
+}
+
+/* Ask the OS to place memory pages in [addr, addr + size) on the NUMA node.
+ * Pages that have been touched are moved if possible.  Since the preferred
+ * policy is used, the OS falls back to other nodes when the node runs out of
+ * memory.  This is a hint, so errors are ignored. */
+void ABTD_topology_bind_memory(void *addr, size_t size, int numa_id)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    if (numa_id < 0 || numa_id >= TOPOLOGY_MAX_NUMA_NODES)
+        return;
+    const size_t sys_page_size = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t bits_per_ulong = sizeof(unsigned long) * 8;
+    unsigned long nodemask[TOPOLOGY_MAX_NUMA_NODES / (sizeof(unsigned long) *
+                                                      8)] = { 0 };
+    /* mbind() requires a page-aligned address. */
+    void *aligned_addr = ABTU_roundup_ptr(addr, sys_page_size);
+    size_t offset = ((uintptr_t)aligned_addr) - ((uintptr_t)addr);
+    if (size <= offset)
+        return;
+    size = (size - offset) & ~(sys_page_size - 1);
+    if (size == 0)
+        return;
+    nodemask[numa_id / bits_per_ulong] |= 1UL << (numa_id % bits_per_ulong);
+    /* The kernel reads maxnode - 1 bits. */
+    long ret = syscall(SYS_mbind, aligned_addr, size, TOPOLOGY_MPOL_PREFERRED,
+                       nodemask, (unsigned long)(TOPOLOGY_MAX_NUMA_NODES + 1),
+                       TOPOLOGY_MPOL_MF_MOVE);
+    (void)ret;
+#else
+    ABTI_UNUSED(addr);
+    ABTI_UNUSED(size);
+    ABTI_UNUSED(numa_id);
+#endif
+}
@@ -60,11 +60,11 @@ int ABT_barrier_create(uint32_t num_waiters, ABT_barrier *newbarrier)
 
     abt_errno = ABTU_malloc(sizeof(ABTI_barrier), (void **)&p_newbarrier);
     ABTI_CHECK_ERROR(abt_errno);
-
-    ABTD_spinlock_clear(&p_newbarrier->lock);
-    p_newbarrier->num_waiters = arg_num_waiters;
-    p_newbarrier->counter = 0;
-    ABTI_waitlist_init(&p_newbarrier->waitlist);
+    abt_errno = ABTI_barrier_init(p_newbarrier, arg_num_waiters);
+    if (ABTI_IS_ERROR_CHECK_ENABLED && abt_errno != ABT_SUCCESS) {
+        ABTU_free(p_newbarrier);
+        ABTI_HANDLE_ERROR(abt_errno);
+    }
     /* Return value */
     *newbarrier = ABTI_barrier_get_handle(p_newbarrier);
     return ABT_SUCCESS;
@@ -105,16 +105,17 @@ int ABT_barrier_reinit(ABT_barrier barrier, uint32_t num_waiters)
 
     ABTI_barrier *p_barrier = ABTI_barrier_get_ptr(barrier);
     ABTI_CHECK_NULL_BARRIER_PTR(p_barrier);
-    ABTI_UB_ASSERT(p_barrier->counter == 0);
+    ABTI_UB_ASSERT(ABTI_barrier_is_idle(p_barrier));
     ABTI_CHECK_TRUE(num_waiters != 0, ABT_ERR_INV_ARG);
     size_t arg_num_waiters = num_waiters;
 
-    /* Only when num_waiters is different from p_barrier->num_waiters, we
-     * change p_barrier. */
-    if (arg_num_waiters != p_barrier->num_waiters) {
-        /* We can reuse waiters and waiter_type arrays */
-        p_barrier->num_waiters = arg_num_waiters;
-    }
+    /* Arrivals are counted from scratch with the new number of waiters.
+     * num_phases is not rewound since waiters released by the last phase might
+     * not have checked it yet.  The leaves can be reused. */
+    p_barrier->num_waiters = arg_num_waiters;
+    p_barrier->phase_base =
+        ABTD_atomic_relaxed_load_size(&p_barrier->num_phases);
+    ABTD_atomic_relaxed_store_size(&p_barrier->counter, 0);
     return ABT_SUCCESS;
 }
 
@@ -150,14 +151,9 @@ int ABT_barrier_free(ABT_barrier *barrier)
     ABTI_barrier *p_barrier = ABTI_barrier_get_ptr(h_barrier);
     ABTI_CHECK_NULL_BARRIER_PTR(p_barrier);
 
-    /* The lock needs to be acquired to safely free the barrier structure.
-     * However, we do not have to unlock it because the entire structure is
-     * freed here. */
-    ABTD_spinlock_acquire(&p_barrier->lock);
-
-    /* p_barrier->counter must be checked after taking a lock. */
-    ABTI_UB_ASSERT(p_barrier->counter == 0);
+    ABTI_UB_ASSERT(ABTI_barrier_is_idle(p_barrier));
 
+    ABTI_barrier_fini(p_barrier);
     ABTU_free(p_barrier);
 
     /* Return value */
@@ -212,23 +208,7 @@ int ABT_barrier_wait(ABT_barrier barrier)
     }
 #endif
 
-    ABTD_spinlock_acquire(&p_barrier->lock);
-
-    ABTI_ASSERT(p_barrier->counter < p_barrier->num_waiters);
-    p_barrier->counter++;
-
-    /* If we do not have all the waiters yet */
-    if (p_barrier->counter < p_barrier->num_waiters) {
-        ABTI_waitlist_wait_and_unlock(&p_local, &p_barrier->waitlist,
-                                      &p_barrier->lock,
-                                      ABT_SYNC_EVENT_TYPE_BARRIER,
-                                      (void *)p_barrier);
-    } else {
-        ABTI_waitlist_broadcast(p_local, &p_barrier->waitlist);
-        /* Reset counter */
-        p_barrier->counter = 0;
-        ABTD_spinlock_release(&p_barrier->lock);
-    }
+    ABTI_barrier_wait(&p_local, p_barrier);
     return ABT_SUCCESS;
 }
 
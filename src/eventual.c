@@ -5,6 +5,13 @@
 
 #include "abti.h"
 
+ABTU_ret_err static inline int eventual_alloc(ABTI_local *p_local,
+                                             size_t nbytes,
+                                             ABTI_eventual **pp_eventual);
+static inline void eventual_free(ABTI_global *p_global, ABTI_local *p_local,
+                                 ABTI_eventual *p_eventual);
+static inline void *eventual_get_buffer(ABTI_eventual *p_eventual);
+
 /** @defgroup EVENTUAL Eventual
  * This group is for Eventual.
  */
@@ -52,21 +59,14 @@ int ABT_eventual_create(int nbytes, ABT_eventual *neweventual)
     ABTI_CHECK_TRUE(nbytes >= 0, ABT_ERR_INV_ARG);
     size_t arg_nbytes = nbytes;
 
-    abt_errno = ABTU_malloc(sizeof(ABTI_eventual), (void **)&p_eventual);
+    abt_errno =
+        eventual_alloc(ABTI_local_get_local(), arg_nbytes, &p_eventual);
     ABTI_CHECK_ERROR(abt_errno);
 
     ABTD_spinlock_clear(&p_eventual->lock);
     p_eventual->ready = ABT_FALSE;
     p_eventual->nbytes = arg_nbytes;
-    if (arg_nbytes == 0) {
-        p_eventual->value = NULL;
-    } else {
-        abt_errno = ABTU_malloc(arg_nbytes, &p_eventual->value);
-        if (ABTI_IS_ERROR_CHECK_ENABLED && abt_errno != ABT_SUCCESS) {
-            ABTU_free(p_eventual);
-            ABTI_HANDLE_ERROR(abt_errno);
-        }
-    }
+    p_eventual->value = eventual_get_buffer(p_eventual);
     ABTI_waitlist_init(&p_eventual->waitlist);
 
     *neweventual = ABTI_eventual_get_handle(p_eventual);
@@ -104,6 +104,7 @@ int ABT_eventual_free(ABT_eventual *eventual)
     ABTI_UB_ASSERT(ABTI_initialized());
     ABTI_UB_ASSERT(eventual);
 
+    ABTI_global *p_global = ABTI_global_get_global();
     ABTI_eventual *p_eventual = ABTI_eventual_get_ptr(*eventual);
     ABTI_CHECK_NULL_EVENTUAL_PTR(p_eventual);
 
@@ -113,9 +114,7 @@ int ABT_eventual_free(ABT_eventual *eventual)
     ABTD_spinlock_acquire(&p_eventual->lock);
     ABTI_UB_ASSERT(ABTI_waitlist_is_empty(&p_eventual->waitlist));
 
-    if (p_eventual->value)
-        ABTU_free(p_eventual->value);
-    ABTU_free(p_eventual);
+    eventual_free(p_global, ABTI_local_get_local(), p_eventual);
 
     *eventual = ABT_EVENTUAL_NULL;
     return ABT_SUCCESS;
@@ -133,7 +132,9 @@ int ABT_eventual_free(ABT_eventual *eventual)
  * If \c value is not \c NULL, \c value is set to the memory buffer of
  * \c eventual.  If \c value is not \c NULL but the size of the memory buffer of
  * \c eventual (i.e., \c nbytes passed to \c ABT_eventual_create()) is zero,
- * \c value is set to \c NULL.
+ * \c value is set to \c NULL.  If \c eventual was made ready by
+ * \c ABT_eventual_set_ptr(), \c value is set to the pointer passed to it
+ * instead of the memory buffer of \c eventual.
  *
  * The memory buffer pointed to by \c value is deallocated when \c eventual is
  * freed by \c ABT_eventual_free().  The memory buffer is properly aligned for
@@ -197,9 +198,10 @@ int ABT_eventual_wait(ABT_eventual eventual, void **value)
     } else {
         ABTD_spinlock_release(&p_eventual->lock);
     }
-    /* This value is updated outside the critical section, but it is okay since
-     * the "pointer" to the memory buffer is constant and there is no way to
-     * avoid updating this memory buffer by ABT_eventual_set() etc. */
+    /* This value is read outside the critical section, but it is okay since
+     * the pointer is updated only by ABT_eventual_set_ptr() and
+     * ABT_eventual_reset(), neither of which may be called while this eventual
+     * is ready and has waiters. */
     if (value)
         *value = p_eventual->value;
     return ABT_SUCCESS;
@@ -214,7 +216,9 @@ int ABT_eventual_wait(ABT_eventual eventual, void **value)
  * routine leaves \c value unchanged and sets \c is_ready to \c ABT_FALSE.  If
  * \c eventual is ready, \c is_ready is set to \c ABT_TRUE and, if \c value is
  * not \c NULL, \c value is set to the memory buffer of \c eventual.  This
- * routine returns \c ABT_SUCCESS even if \c eventual is not ready.
+ * routine returns \c ABT_SUCCESS even if \c eventual is not ready.  If
+ * \c eventual was made ready by \c ABT_eventual_set_ptr(), \c value is set
+ * to the pointer passed to it instead of the memory buffer of \c eventual.
  *
  * The memory buffer pointed to by \c value is deallocated when \c eventual is
  * freed by \c ABT_eventual_free().  The memory buffer is properly aligned for
@@ -337,9 +341,76 @@ int ABT_eventual_set(ABT_eventual eventual, void *value, int nbytes)
         if (p_eventual->value)
             memcpy(p_eventual->value, value, arg_nbytes);
         p_eventual->ready = ABT_TRUE;
-        /* Wake up all waiting ULTs */
-        ABTI_waitlist_broadcast(p_local, &p_eventual->waitlist);
+        /* Wake up all waiting ULTs.  The detached ULTs are resumed outside
+         * the critical section. */
+        ABTI_thread *p_waiters =
+            ABTI_waitlist_detach_all(&p_eventual->waitlist);
         ABTD_spinlock_release(&p_eventual->lock);
+        ABTI_ythread_resume_and_push_list(p_local, p_waiters);
+    } else {
+        ABTD_spinlock_release(&p_eventual->lock);
+        /* It has been ready.  Error. */
+        ABTI_HANDLE_ERROR(ABT_ERR_EVENTUAL);
+    }
+
+    return ABT_SUCCESS;
+}
+
+/**
+ * @ingroup EVENTUAL
+ * @brief   Signal an eventual with a pointer.
+ *
+ * \c ABT_eventual_set_ptr() makes the eventual \c eventual ready and resumes
+ * all waiters that are blocked on \c eventual.  Unlike \c ABT_eventual_set(),
+ * this routine does not copy any data; \c ABT_eventual_wait() and
+ * \c ABT_eventual_test() return \c ptr itself as the memory buffer of
+ * \c eventual until \c eventual is reset by \c ABT_eventual_reset().  This
+ * routine can be called regardless of the size of the memory buffer of
+ * \c eventual, so it can also be used for \c eventual that is created with
+ * zero \c nbytes or statically initialized.
+ *
+ * @note
+ * The memory buffer pointed to by \c ptr is owned by the user.
+ * \c ABT_eventual_free() does not deallocate it, so the user must keep it
+ * valid while waiters may access it.
+ *
+ * \DOC_DESC_ATOMICITY_EVENTUAL_READINESS
+ *
+ * @contexts
+ * \DOC_CONTEXT_INIT \DOC_CONTEXT_NOCTXSWITCH
+ *
+ * @errors
+ * \DOC_ERROR_SUCCESS
+ * \DOC_ERROR_INV_EVENTUAL_HANDLE{\c eventual}
+ * \DOC_ERROR_EVENTUAL_READY{\c eventual}
+ *
+ * @undefined
+ * \DOC_UNDEFINED_UNINIT
+ *
+ * @param[in] eventual  eventual handle
+ * @param[in] ptr       pointer to be passed to waiters
+ * @return Error code
+ */
+int ABT_eventual_set_ptr(ABT_eventual eventual, void *ptr)
+{
+    ABTI_UB_ASSERT(ABTI_initialized());
+
+    ABTI_local *p_local = ABTI_local_get_local();
+    ABTI_eventual *p_eventual = ABTI_eventual_get_ptr(eventual);
+    ABTI_CHECK_NULL_EVENTUAL_PTR(p_eventual);
+
+    ABTD_spinlock_acquire(&p_eventual->lock);
+
+    ABT_bool ready = p_eventual->ready;
+    if (ready == ABT_FALSE) {
+        p_eventual->value = ptr;
+        p_eventual->ready = ABT_TRUE;
+        /* Wake up all waiting ULTs.  The detached ULTs are resumed outside
+         * the critical section. */
+        ABTI_thread *p_waiters =
+            ABTI_waitlist_detach_all(&p_eventual->waitlist);
+        ABTD_spinlock_release(&p_eventual->lock);
+        ABTI_ythread_resume_and_push_list(p_local, p_waiters);
     } else {
         ABTD_spinlock_release(&p_eventual->lock);
         /* It has been ready.  Error. */
@@ -384,6 +455,56 @@ int ABT_eventual_reset(ABT_eventual eventual)
     ABTD_spinlock_acquire(&p_eventual->lock);
     ABTI_UB_ASSERT(ABTI_waitlist_is_empty(&p_eventual->waitlist));
     p_eventual->ready = ABT_FALSE;
+    p_eventual->value = eventual_get_buffer(p_eventual);
     ABTD_spinlock_release(&p_eventual->lock);
     return ABT_SUCCESS;
 }
+
+/*****************************************************************************/
+/* Internal static functions                                                 */
+/*****************************************************************************/
+
+/* The memory buffer of an eventual is placed right after ABTI_eventual so that
+ * one allocation serves both.  If they fit in a descriptor, the descriptor
+ * memory pool is used, which recycles memory without calling malloc(). */
+static inline size_t eventual_get_buffer_offset(void)
+{
+    return ABTU_roundup_size(sizeof(ABTI_eventual), ABTU_MAX_ALIGNMENT);
+}
+
+static inline ABT_bool eventual_use_desc(size_t nbytes)
+{
+    return (eventual_get_buffer_offset() + nbytes <= ABTI_MEM_POOL_DESC_SIZE)
+               ? ABT_TRUE
+               : ABT_FALSE;
+}
+
+ABTU_ret_err static inline int eventual_alloc(ABTI_local *p_local,
+                                             size_t nbytes,
+                                             ABTI_eventual **pp_eventual)
+{
+    if (eventual_use_desc(nbytes)) {
+        return ABTI_mem_alloc_desc(p_local, (void **)pp_eventual);
+    } else {
+        return ABTU_malloc(eventual_get_buffer_offset() + nbytes,
+                           (void **)pp_eventual);
+    }
+}
+
+static inline void eventual_free(ABTI_global *p_global, ABTI_local *p_local,
+                                 ABTI_eventual *p_eventual)
+{
+    if (eventual_use_desc(p_eventual->nbytes)) {
+        ABTI_mem_free_desc(p_global, p_local, (void *)p_eventual);
+    } else {
+        ABTU_free(p_eventual);
+    }
+}
+
+static inline void *eventual_get_buffer(ABTI_eventual *p_eventual)
+{
+    /* A statically initialized eventual does not have a memory buffer. */
+    if (p_eventual->nbytes == 0)
+        return NULL;
+    return (void *)(((char *)p_eventual) + eventual_get_buffer_offset());
+}
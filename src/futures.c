@@ -71,7 +71,11 @@ int ABT_future_create(uint32_t num_compartments, void (*cb_func)(void **arg),
     abt_errno = ABTU_malloc(sizeof(ABTI_future), (void **)&p_future);
     ABTI_CHECK_ERROR(abt_errno);
     ABTD_spinlock_clear(&p_future->lock);
+    ABTD_atomic_relaxed_store_size(&p_future->num_claimed, 0);
     ABTD_atomic_relaxed_store_size(&p_future->counter, 0);
+    ABTD_atomic_relaxed_store_int(&p_future->is_ready,
+                                  arg_num_compartments == 0 ? ABT_TRUE
+                                                            : ABT_FALSE);
     p_future->num_compartments = arg_num_compartments;
     if (arg_num_compartments > 0) {
         abt_errno = ABTU_malloc(arg_num_compartments * sizeof(void *),
@@ -187,9 +191,12 @@ int ABT_future_wait(ABT_future future)
     }
 #endif
 
+    /* Quick check without taking a lock. */
+    if (ABTD_atomic_acquire_load_int(&p_future->is_ready))
+        return ABT_SUCCESS;
+
     ABTD_spinlock_acquire(&p_future->lock);
-    if (ABTD_atomic_relaxed_load_size(&p_future->counter) <
-        p_future->num_compartments) {
+    if (!ABTD_atomic_relaxed_load_int(&p_future->is_ready)) {
         ABTI_waitlist_wait_and_unlock(&p_local, &p_future->waitlist,
                                       &p_future->lock,
                                       ABT_SYNC_EVENT_TYPE_FUTURE,
@@ -234,8 +241,8 @@ int ABT_future_test(ABT_future future, ABT_bool *is_ready)
     ABTI_future *p_future = ABTI_future_get_ptr(future);
     ABTI_CHECK_NULL_FUTURE_PTR(p_future);
 
-    size_t counter = ABTD_atomic_acquire_load_size(&p_future->counter);
-    *is_ready = (counter == p_future->num_compartments) ? ABT_TRUE : ABT_FALSE;
+    *is_ready = ABTD_atomic_acquire_load_int(&p_future->is_ready) ? ABT_TRUE
+                                                                  : ABT_FALSE;
     return ABT_SUCCESS;
 }
 
@@ -275,31 +282,35 @@ int ABT_future_set(ABT_future future, void *value)
     ABTI_future *p_future = ABTI_future_get_ptr(future);
     ABTI_CHECK_NULL_FUTURE_PTR(p_future);
 
-    ABTD_spinlock_acquire(&p_future->lock);
-
-    size_t counter = ABTD_atomic_relaxed_load_size(&p_future->counter);
+    /* Claim a compartment.  No lock is needed to set a value. */
+    size_t index = ABTD_atomic_fetch_add_size(&p_future->num_claimed, 1);
     size_t num_compartments = p_future->num_compartments;
 #ifndef ABT_CONFIG_DISABLE_ERROR_CHECK
     /* If num_compartments is 0, this routine always returns ABT_ERR_FUTURE */
-    if (counter >= num_compartments) {
-        ABTD_spinlock_release(&p_future->lock);
+    if (index >= num_compartments) {
+        ABTD_atomic_fetch_sub_size(&p_future->num_claimed, 1);
         ABTI_HANDLE_ERROR(ABT_ERR_FUTURE);
     }
 #endif
-    p_future->array[counter] = value;
-    counter++;
-    /* Call a callback function before setting the counter. */
-    if (counter == num_compartments && p_future->p_callback != NULL) {
-        (*p_future->p_callback)(p_future->array);
-    }
-
-    ABTD_atomic_release_store_size(&p_future->counter, counter);
+    p_future->array[index] = value;
+    /* The setter that sets the last value makes the future ready.  fetch_add
+     * makes all the values visible to that setter. */
+    size_t counter = ABTD_atomic_fetch_add_size(&p_future->counter, 1) + 1;
+    if (counter != num_compartments)
+        return ABT_SUCCESS;
 
-    if (counter == num_compartments) {
-        ABTI_waitlist_broadcast(p_local, &p_future->waitlist);
+    /* Call a callback function before making the future ready. */
+    if (p_future->p_callback != NULL) {
+        (*p_future->p_callback)(p_future->array);
     }
 
+    /* Only the waitlist manipulation needs a lock. */
+    ABTD_spinlock_acquire(&p_future->lock);
+    ABTD_atomic_release_store_int(&p_future->is_ready, ABT_TRUE);
+    ABTI_thread *p_waiters = ABTI_waitlist_detach_all(&p_future->waitlist);
     ABTD_spinlock_release(&p_future->lock);
+    /* The detached waiters are resumed outside the critical section. */
+    ABTI_ythread_resume_and_push_list(p_local, p_waiters);
     return ABT_SUCCESS;
 }
 
@@ -343,7 +354,11 @@ int ABT_future_reset(ABT_future future)
 
     ABTD_spinlock_acquire(&p_future->lock);
     ABTI_UB_ASSERT(ABTI_waitlist_is_empty(&p_future->waitlist));
-    ABTD_atomic_release_store_size(&p_future->counter, 0);
+    ABTD_atomic_relaxed_store_size(&p_future->num_claimed, 0);
+    ABTD_atomic_relaxed_store_size(&p_future->counter, 0);
+    ABTD_atomic_release_store_int(&p_future->is_ready,
+                                  p_future->num_compartments == 0 ? ABT_TRUE
+                                                                  : ABT_FALSE);
     ABTD_spinlock_release(&p_future->lock);
     return ABT_SUCCESS;
 }
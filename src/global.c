@@ -213,6 +213,12 @@ ABTU_ret_err static int init_library(void)
         goto FAILED;
     init_stage = 1;
 
+    /* Set up growable stacks */
+    abt_errno = ABTD_stack_growable_init(p_global);
+    if (abt_errno != ABT_SUCCESS)
+        goto FAILED;
+    init_stage = 2;
+
     /* Initialize IDs */
     ABTI_thread_reset_id();
     ABTI_sched_reset_id();
@@ -227,7 +233,10 @@ ABTU_ret_err static int init_library(void)
                                      0);
 #endif
     /* Initialize a unit-to-thread hash table. */
-    ABTI_unit_init_hash_table(p_global);
+    abt_errno = ABTI_unit_init_hash_table(p_global);
+    if (abt_errno != ABT_SUCCESS)
+        goto FAILED;
+    init_stage = 3;
 
     /* Initialize the ES list */
     p_global->p_xstream_head = NULL;
@@ -240,7 +249,7 @@ ABTU_ret_err static int init_library(void)
     abt_errno = ABTI_xstream_create_primary(p_global, &p_local_xstream);
     if (abt_errno != ABT_SUCCESS)
         goto FAILED;
-    init_stage = 2;
+    init_stage = 4;
 
     /* Init the ES local data */
     ABTI_local_set_xstream(p_local_xstream);
@@ -253,7 +262,7 @@ ABTU_ret_err static int init_library(void)
                                     p_local_xstream, &p_primary_ythread);
     if (abt_errno != ABT_SUCCESS)
         goto FAILED;
-    init_stage = 3;
+    init_stage = 5;
 
     /* Set as if p_local_xstream is currently running the primary ULT. */
     ABTD_atomic_relaxed_store_int(&p_primary_ythread->thread.state,
@@ -272,11 +281,17 @@ ABTU_ret_err static int init_library(void)
     ABTD_atomic_release_store_uint32(&g_ABTI_initialized, 1);
     return ABT_SUCCESS;
 FAILED:
-    if (init_stage >= 2) {
+    if (init_stage >= 4) {
         ABTI_xstream_free(p_global, ABTI_xstream_get_local(p_local_xstream),
                           p_local_xstream, ABT_TRUE);
         ABTI_local_set_xstream(NULL);
     }
+    if (init_stage >= 3) {
+        ABTI_unit_finalize_hash_table(p_global);
+    }
+    if (init_stage >= 2) {
+        ABTD_stack_growable_finalize(p_global);
+    }
     if (init_stage >= 1) {
         ABTI_mem_finalize(p_global);
     }
@@ -345,6 +360,9 @@ ABTU_ret_err static int finailze_library(void)
     /* Free the ES array */
     ABTI_ASSERT(p_global->p_xstream_head == NULL);
 
+    /* Restore the SIGSEGV handler */
+    ABTD_stack_growable_finalize(p_global);
+
     /* Finalize the memory pool */
     ABTI_mem_finalize(p_global);
 
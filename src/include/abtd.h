@@ -8,6 +8,7 @@
 
 #define __USE_GNU 1
 #include <pthread.h>
+#include <sched.h>
 #include "abtd_atomic.h"
 #include "abtd_context.h"
 #include "abtd_spinlock.h"
@@ -28,6 +29,7 @@ typedef struct ABTD_xstream_context {
     ABTD_xstream_context_state state;
     pthread_mutex_t state_lock;
     pthread_cond_t state_cond;
+    void *p_sigaltstack; /* Signal stack for growable stacks (or NULL). */
 } ABTD_xstream_context;
 typedef pthread_mutex_t ABTD_xstream_mutex;
 #ifdef HAVE_PTHREAD_BARRIER_INIT
@@ -57,6 +59,7 @@ size_t ABTD_env_get_sched_stacksize(void);
 uint32_t ABTD_env_get_sched_event_freq(void);
 uint64_t ABTD_env_get_sched_sleep_nsec(void);
 ABT_bool ABTD_env_get_stack_guard_mprotect(ABT_bool *is_strict);
+ABT_bool ABTD_env_get_stack_growable(void);
 
 /* ES Context */
 ABTU_ret_err int ABTD_xstream_context_create(void *(*f_xstream)(void *),
@@ -69,6 +72,19 @@ void ABTD_xstream_context_set_self(ABTD_xstream_context *p_ctx);
 void ABTD_xstream_context_print(ABTD_xstream_context *p_ctx, FILE *p_os,
                                 int indent);
 
+/* Growable stacks.  Stacks in memory pools are protected except for their top
+ * pages, and a SIGSEGV handler unprotects pages on demand. */
+#if defined(HAVE_MPROTECT) && defined(HAVE_SIGALTSTACK) &&                     \
+    defined(ABT_CONFIG_USE_MEM_POOL)
+#define ABTD_STACK_GROWABLE_SUPPORTED 1
+#endif
+ABTU_ret_err int ABTD_stack_growable_init(ABTI_global *p_global);
+void ABTD_stack_growable_finalize(ABTI_global *p_global);
+ABTU_ret_err int ABTD_stack_growable_alloc_sigaltstack(void **pp_sigaltstack);
+void ABTD_stack_growable_free_sigaltstack(void *p_sigaltstack);
+void ABTD_stack_growable_set_sigaltstack(void *p_sigaltstack);
+void ABTD_stack_growable_unset_sigaltstack(void *p_sigaltstack);
+
 /* ES Affinity */
 void ABTD_affinity_init(ABTI_global *p_global, const char *affinity_str);
 void ABTD_affinity_finalize(ABTI_global *p_global);
@@ -79,8 +95,28 @@ ABTU_ret_err int
 ABTD_affinity_cpuset_apply(ABTD_xstream_context *p_ctx,
                            const ABTD_affinity_cpuset *p_cpuset);
 int ABTD_affinity_cpuset_apply_default(ABTD_xstream_context *p_ctx, int rank);
+int ABTD_affinity_get_default_numa_id(int rank);
 void ABTD_affinity_cpuset_destroy(ABTD_affinity_cpuset *p_cpuset);
 
+/* CPU Topology */
+typedef enum {
+    ABTD_TOPOLOGY_LEVEL_CORE = 0,   /* Same physical core */
+    ABTD_TOPOLOGY_LEVEL_L3 = 1,     /* Same L3 cache */
+    ABTD_TOPOLOGY_LEVEL_NUMA = 2,   /* Same NUMA node */
+    ABTD_TOPOLOGY_LEVEL_REMOTE = 3, /* Others */
+} ABTD_topology_level;
+#define ABTD_TOPOLOGY_NUM_LEVELS 4
+typedef struct ABTD_topology_cpu {
+    int core_id;
+    int l3_id;
+    int numa_id;
+} ABTD_topology_cpu;
+ABTU_ret_err int ABTD_topology_cpu_read(int cpuid, ABTD_topology_cpu *p_cpu);
+ABTD_topology_level ABTD_topology_get_level(const ABTD_topology_cpu *p_cpu1,
+                                            const ABTD_topology_cpu *p_cpu2);
+int ABTD_topology_get_num_numa_nodes(void);
+void ABTD_topology_bind_memory(void *addr, size_t size, int numa_id);
+
 /* ES Affinity Parser */
 typedef struct ABTD_affinity_id_list {
     uint32_t num;
@@ -32,6 +32,10 @@ void ABTD_futex_timedwait_and_unlock(ABTD_futex_multiple *p_futex,
  * must be called when a lock (p_lock above) is taken. */
 void ABTD_futex_broadcast(ABTD_futex_multiple *p_futex);
 
+/* This routine wakes up at least one waiter that is waiting on p_futex if any.
+ * This function must be called when a lock (p_lock above) is taken. */
+void ABTD_futex_signal(ABTD_futex_multiple *p_futex);
+
 /* ABTD_futex_single supports a suspend-resume pattern.  ABTD_futex_single
  * allows only a single waiter. */
 typedef struct ABTD_futex_single ABTD_futex_single;
@@ -48,14 +48,31 @@
 #define ABTI_THREAD_REQ_JOIN (1 << 0)
 #define ABTI_THREAD_REQ_CANCEL (1 << 1)
 #define ABTI_THREAD_REQ_MIGRATE (1 << 2)
+/* A forked ULT that has not been taken by either a scheduler or its joiner. */
+#define ABTI_THREAD_REQ_FORK (1 << 3)
+/* A forked ULT that has been executed by its joiner. */
+#define ABTI_THREAD_REQ_FORK_INLINED (1 << 4)
+/* Either the joiner or the pool has released a forked and inlined ULT. */
+#define ABTI_THREAD_REQ_FORK_RELEASED (1 << 5)
+/* A forked ULT that its parent has not pushed to a pool yet. */
+#define ABTI_THREAD_REQ_FORK_DEFERRED (1 << 6)
 
 #define ABTI_THREAD_INIT_ID 0xFFFFFFFFFFFFFFFF
 #define ABTI_TASK_INIT_ID 0xFFFFFFFFFFFFFFFF
 
 #define ABTI_INDENT 4
 
-#define ABTI_UNIT_HASH_TABLE_SIZE_EXP 8 /* N -> 2^N table entries */
-#define ABTI_UNIT_HASH_TABLE_SIZE ((size_t)(1 << ABTI_UNIT_HASH_TABLE_SIZE_EXP))
+/* Number of IDs that an ES takes from a global ID counter at once. */
+#define ABTI_ID_BLOCK_SIZE 4096
+
+/* N -> 2^N initial table entries.  The table grows when the average chain
+ * length exceeds ABTI_UNIT_HASH_TABLE_MAX_LOAD. */
+#define ABTI_UNIT_HASH_TABLE_INIT_SIZE_EXP 8
+#define ABTI_UNIT_HASH_TABLE_MAX_SIZE_EXP 30
+#define ABTI_UNIT_HASH_TABLE_MAX_LOAD 2
+
+/* Max. # of stack size classes that have their own memory pools. */
+#define ABTI_MEM_MAX_STACK_CLASSES 8
 
 #define ABTI_STACK_CHECK_TYPE_NONE 0
 #define ABTI_STACK_CHECK_TYPE_CANARY 1
@@ -87,6 +104,8 @@ enum ABTI_stack_guard {
 #define ABTI_THREAD_TYPE_YIELDABLE ((ABTI_thread_type)(0x1 << 4))
 #define ABTI_THREAD_TYPE_NAMED ((ABTI_thread_type)(0x1 << 5))
 #define ABTI_THREAD_TYPE_MIGRATABLE ((ABTI_thread_type)(0x1 << 6))
+/* Created by ABT_thread_fork().  Its joiner might execute it in place. */
+#define ABTI_THREAD_TYPE_FORK ((ABTI_thread_type)(0x1 << 13))
 
 /* Memory management.  Only one flag must be set. */
 /* Only a thread descriptor is allocated.  It is from a memory pool.
@@ -132,9 +151,11 @@ typedef struct ABTI_global ABTI_global;
 typedef struct ABTI_local ABTI_local;
 typedef struct ABTI_local_func ABTI_local_func;
 typedef struct ABTI_xstream ABTI_xstream;
+typedef struct ABTI_id_block ABTI_id_block;
 typedef enum ABTI_xstream_type ABTI_xstream_type;
 typedef struct ABTI_sched ABTI_sched;
 typedef struct ABTI_sched_config ABTI_sched_config;
+typedef struct ABTI_sched_park_node ABTI_sched_park_node;
 typedef enum ABTI_sched_used ABTI_sched_used;
 typedef void *ABTI_sched_id;       /* Scheduler id */
 typedef uintptr_t ABTI_sched_kind; /* Scheduler kind */
@@ -158,9 +179,11 @@ typedef struct ABTI_mutex_attr ABTI_mutex_attr;
 typedef struct ABTI_mutex ABTI_mutex;
 typedef struct ABTI_cond ABTI_cond;
 typedef struct ABTI_rwlock ABTI_rwlock;
+typedef struct ABTI_rwlock_reader_indicator ABTI_rwlock_reader_indicator;
 typedef struct ABTI_eventual ABTI_eventual;
 typedef struct ABTI_future ABTI_future;
 typedef struct ABTI_barrier ABTI_barrier;
+typedef struct ABTI_barrier_leaf ABTI_barrier_leaf;
 typedef struct ABTI_xstream_barrier ABTI_xstream_barrier;
 typedef struct ABTI_timer ABTI_timer;
 #ifndef ABT_CONFIG_DISABLE_TOOL_INTERFACE
@@ -176,6 +199,7 @@ typedef struct ABTI_thread_id_opaque *ABTI_thread_id;
 /* Unit-to-thread hash table. */
 typedef struct ABTI_atomic_unit_to_thread ABTI_atomic_unit_to_thread;
 typedef struct ABTI_unit_to_thread_entry ABTI_unit_to_thread_entry;
+typedef struct ABTI_unit_to_thread_table ABTI_unit_to_thread_table;
 typedef enum ABTI_stack_guard ABTI_stack_guard;
 
 /* Architecture-Dependent Definitions */
@@ -204,10 +228,15 @@ struct ABTI_mutex {
                               * this variable can be  initialized. */
     ABTD_spinlock lock;      /* lock */
     int nesting_cnt;         /* nesting count (if recursive) */
-    ABTI_thread_id owner_id; /* owner's ID (if recursive) */
 #ifndef ABT_CONFIG_USE_SIMPLE_MUTEX
     ABTD_spinlock waiter_lock; /* lock */
-    ABTI_waitlist waitlist;    /* waiting list */
+#endif
+    ABTI_thread_id owner_id; /* owner's ID (if recursive) */
+#ifndef ABT_CONFIG_USE_SIMPLE_MUTEX
+    ABTI_waitlist waitlist;     /* waiting list */
+    ABTD_atomic_ptr p_handover; /* waiter to which the lock is handed over */
+    uint32_t num_handovers;     /* # of consecutive handovers to waiters on
+                                 * preferred ESs */
 #endif
 };
 
@@ -220,6 +249,13 @@ struct ABTI_unit_to_thread_entry {
     ABTD_spinlock lock; /* Protecting any list update. */
 };
 
+struct ABTI_unit_to_thread_table {
+    int size_exp;                      /* N -> 2^N entries */
+    ABTD_atomic_size num_nodes;        /* # of allocated list elements */
+    ABTI_unit_to_thread_table *p_prev; /* Replaced table. */
+    ABTI_unit_to_thread_entry *entries;
+};
+
 struct ABTI_global {
     int max_xstreams;             /* Largest rank used in Argobots. */
     int num_xstreams;             /* Current # of ESs */
@@ -238,11 +274,13 @@ struct ABTI_global {
     size_t sched_stacksize;    /* Default stack size for sched (in bytes) */
     uint32_t sched_event_freq; /* Default check frequency for sched */
     uint64_t sched_sleep_nsec; /* Default nanoseconds for scheduler sleep */
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+    ABT_bool sched_park; /* Whether idle predefined schedulers park ESs */
+#endif
     ABTI_ythread *p_primary_ythread; /* Primary ULT */
 
-    uint32_t
-        mutex_max_handovers;    /* Default max. # of local handovers (unused) */
-    uint32_t mutex_max_wakeups; /* Default max. # of wakeups (unused) */
+    uint32_t mutex_max_handovers; /* Default max. # of local handovers */
+    uint32_t mutex_max_wakeups;   /* Default max. # of wakeups */
     size_t sys_page_size;       /* System page size (typically, 4KB) */
     size_t huge_page_size;      /* Huge page size */
 #ifdef ABT_CONFIG_USE_MEM_POOL
@@ -250,20 +288,34 @@ struct ABTI_global {
     size_t mem_sp_size;      /* Stack page size */
     uint32_t mem_max_stacks; /* Max. # of stacks kept in each ES */
     uint32_t mem_max_descs;  /* Max. # of descriptors kept in each ES */
+    uint32_t mem_max_local_buckets; /* Max. # of buckets kept in each ES */
     int mem_lp_alloc;        /* How to allocate large pages */
-
-    ABTI_mem_pool_global_pool mem_pool_stack; /* Pool of stack (default size) */
-    ABTI_mem_pool_global_pool mem_pool_desc;  /* Pool of descriptors that can
-                                               * store ABTI_task. */
+    int mem_stack_reclaim;   /* How to release unused stack memory */
+    size_t mem_stack_reclaim_keep_size; /* Top of a stack that is kept */
+    ABT_bool mem_numa_aware; /* Whether to use a global pool per NUMA node */
+
+    int mem_num_numa_nodes; /* # of elements of the following arrays. */
+    /* Pools of stack (default size).  ESs whose NUMA node is unknown use
+     * mem_pool_stacks[0]. */
+    ABTI_mem_pool_global_pool *mem_pool_stacks;
+    /* Pools of descriptors that can store ABTI_task. */
+    ABTI_mem_pool_global_pool *mem_pool_descs;
+    /* Stack sizes of classes in ascending order.  A ULT of a non-default stack
+     * size takes a stack of the smallest class that is large enough. */
+    int mem_num_stack_classes;
+    size_t mem_stack_classes[ABTI_MEM_MAX_STACK_CLASSES];
+    /* Pools of stacks of each class.  The pool of class c on NUMA node n is
+     * mem_pool_stack_classes[c * mem_num_numa_nodes + n]. */
+    ABTI_mem_pool_global_pool *mem_pool_stack_classes;
 #ifndef ABT_CONFIG_DISABLE_EXT_THREAD
     /* They are used for external threads. */
-    ABTD_spinlock mem_pool_stack_lock;
-    ABTI_mem_pool_local_pool mem_pool_stack_ext;
     ABTD_spinlock mem_pool_desc_lock;
     ABTI_mem_pool_local_pool mem_pool_desc_ext;
 #endif
 #endif
     ABTI_stack_guard stack_guard_kind; /* Stack guard type. */
+    ABT_bool stack_growable;  /* Whether stacks in memory pools are growable. */
+    size_t stack_commit_size; /* Initially accessible size of growable stacks */
 
     ABT_bool print_config; /* Whether to print config on ABT_init */
 
@@ -275,10 +327,10 @@ struct ABTI_global {
     ABTD_atomic_uint64 tool_thread_event_mask_tagged;
 #endif
 
-    ABTI_unit_to_thread_entry
-        unit_to_thread_entires[ABTI_UNIT_HASH_TABLE_SIZE]; /* Hash table that
-                                                              maps ABT_unit to
-                                                              ABTI_thread  */
+    /* Hash table that maps ABT_unit to ABTI_thread (ABTI_unit_to_thread_table
+     * *).  Readers access it without taking any lock. */
+    ABTD_atomic_ptr p_unit_to_thread_table;
+    ABTD_spinlock unit_to_thread_resize_lock;
 };
 
 struct ABTI_local; /* Empty. */
@@ -291,6 +343,12 @@ struct ABTI_local_func {
     char padding2[ABT_CONFIG_STATIC_CACHELINE_SIZE];
 };
 
+/* IDs in [next, end) can be used without updating a global ID counter. */
+struct ABTI_id_block {
+    uint64_t next;
+    uint64_t end;
+};
+
 struct ABTI_xstream {
     /* Linked list to manage all execution streams. */
     ABTI_xstream *p_prev;
@@ -313,8 +371,31 @@ struct ABTI_xstream {
 #ifdef ABT_CONFIG_USE_MEM_POOL
     ABTI_mem_pool_local_pool mem_pool_stack;
     ABTI_mem_pool_local_pool mem_pool_desc;
+    /* Pools of stacks of each class.  Each pool is initialized when this ES
+     * takes a stack of that class for the first time (p_global_pool is NULL
+     * until then). */
+    ABTI_mem_pool_local_pool *mem_pool_stack_classes;
+    /* Stack of the default size that this ES lends to a lazy-stack ULT when it
+     * starts.  The ULT gives it back if it terminates without being suspended,
+     * so only ULTs that block keep their own stacks. */
+    void *p_stack_cache;
 #endif
+    /* Blocks of IDs taken from the global ID counters. */
+    ABTI_id_block thread_id_block;
+    ABTI_id_block pool_id_block;
+#ifdef ABT_CONFIG_USE_DEBUG_LOG
+    ABTI_id_block sched_id_block;
+#endif
+};
+
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+struct ABTI_sched_park_node {
+    ABTI_sched *p_sched;
+    ABTI_sched_park_node *p_prev;
+    ABTI_sched_park_node *p_next;
+    ABT_bool has_set_flag; /* Whether it has set has_parked_scheds */
 };
+#endif
 
 struct ABTI_sched {
     ABTI_sched_used used;           /* To know if it is used and how */
@@ -336,6 +417,15 @@ struct ABTI_sched {
     ABT_sched_free_fn free;
     ABT_sched_get_migr_pool_fn get_migr_pool;
 
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+    ABTD_spinlock park_lock; /* Protecting is_parked */
+    ABT_bool is_parked;
+    ABTD_futex_multiple park_futex;
+    /* Nodes linked to the parked scheduler lists of pools.  park_nodes[p] is
+     * used for pools[p].  Allocated when this scheduler parks first. */
+    ABTI_sched_park_node *park_nodes;
+#endif
+
 #ifdef ABT_CONFIG_USE_DEBUG_LOG
     uint64_t id; /* ID */
 #endif
@@ -393,7 +483,20 @@ struct ABTI_pool {
     /* NOTE: int32_t to check if still positive */
     ABTD_atomic_int32 num_scheds;  /* Number of associated schedulers */
     ABTD_atomic_int32 num_blocked; /* Number of blocked ULTs */
-    void *data;                    /* Specific data */
+    /* Number of forked ULTs that have been executed by their joiners but are
+     * still in this pool.  They are not counted as the size of this pool. */
+    ABTD_atomic_int32 num_inlined_forks;
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+    /* Nonzero while schedulers might be parked on this pool.  A push checks it
+     * without a memory barrier, so a scheduler that sets it does not sleep and
+     * does not reset it.  It is reset when the last parked scheduler leaves
+     * after sleeping. */
+    ABTD_atomic_int32 has_parked_scheds;
+    ABTD_atomic_int32 num_parked_scheds; /* Number of parked schedulers */
+    ABTD_spinlock park_lock; /* Protecting the parked scheduler list */
+    ABTI_sched_park_node *p_parked_head;
+#endif
+    void *data; /* Specific data */
     uint64_t id;                   /* ID */
 
     ABTI_pool_required_def required_def;
@@ -439,6 +542,7 @@ struct ABTI_thread {
 struct ABTI_thread_attr {
     void *p_stack;    /* Stack address */
     size_t stacksize; /* Stack size (in bytes) */
+    ABT_bool lazy_stack; /* Allocate a stack when the ULT starts */
 #ifndef ABT_CONFIG_DISABLE_MIGRATION
     ABT_bool migratable;              /* Migratability */
     void (*f_cb)(ABT_thread, void *); /* Callback function */
@@ -454,8 +558,14 @@ struct ABTI_thread_mig_data {
 };
 
 struct ABTI_ythread {
-    ABTI_thread thread;       /* Common thread definition */
-    ABTD_ythread_context ctx; /* Context */
+    ABTI_thread thread;           /* Common thread definition */
+    ABTD_ythread_context ctx;     /* Context */
+    ABTI_thread *p_deferred_fork; /* Forked ULT not pushed to a pool yet */
+#ifdef ABT_CONFIG_USE_MEM_POOL
+    /* Remote queue of the local pool from which the stack is taken.  It is
+     * valid only if the stack is taken from a memory pool. */
+    ABTI_mem_pool_remote_queue *p_stack_remote_queue;
+#endif
 };
 
 struct ABTI_key {
@@ -486,11 +596,23 @@ struct ABTI_cond {
     ABTI_waitlist waitlist;
 };
 
+struct ABTI_rwlock_reader_indicator {
+    /* # of readers that entered via this indicator minus # of readers that
+     * left via it.  It can wrap around if a reader migrates to another ES
+     * while holding the lock, but the sum over all indicators is exact. */
+    ABTU_align_member_var(ABT_CONFIG_STATIC_CACHELINE_SIZE)
+        ABTD_atomic_size num_readers;
+};
+
 struct ABTI_rwlock {
-    ABTI_mutex mutex;
-    ABTI_cond cond;
-    size_t reader_count;
-    int write_flag;
+    ABTD_atomic_int writer_state;  /* ABTI_RWLOCK_WRITER_XXX */
+    ABTD_spinlock lock;            /* Protecting the waitlists */
+    ABTI_waitlist reader_waitlist; /* Readers waiting for a writer */
+    ABTI_waitlist writer_waitlist; /* Writers waiting for another writer */
+    ABTI_waitlist drain_waitlist;  /* A writer waiting for readers to leave */
+    size_t num_reader_indicators;  /* # of reader indicators (power of 2) */
+    ABTI_rwlock_reader_indicator
+        *reader_indicators; /* Reader indicators indexed by ES ranks */
 };
 
 struct ABTI_eventual {
@@ -502,19 +624,40 @@ struct ABTI_eventual {
 };
 
 struct ABTI_future {
-    ABTD_spinlock lock;
-    ABTD_atomic_size counter;
+    ABTD_spinlock lock;           /* Protecting waitlist */
+    ABTD_atomic_size num_claimed; /* # of compartments claimed by setters */
+    ABTD_atomic_size counter;     /* # of compartments that have been set */
+    ABTD_atomic_int is_ready;     /* ABT_TRUE after the callback is called */
     size_t num_compartments;
     void **array;
     void (*p_callback)(void **arg);
     ABTI_waitlist waitlist;
 };
 
+struct ABTI_barrier_leaf {
+    ABTU_align_member_var(ABT_CONFIG_STATIC_CACHELINE_SIZE)
+        ABTD_spinlock lock; /* Protecting waitlist */
+    ABTI_waitlist waitlist;
+};
+
 struct ABTI_barrier {
     size_t num_waiters;
-    volatile size_t counter;
-    ABTD_spinlock lock;
-    ABTI_waitlist waitlist;
+    size_t num_leaves;         /* # of leaves (power of 2) */
+    ABTI_barrier_leaf *leaves; /* Leaves indexed by ES ranks */
+    /* Bitmap of leaves that might have waiters.  The i-th bit of the j-th
+     * element corresponds to the (j * 64 + i)-th leaf. */
+    ABTD_atomic_uint64 *occupied_leaves;
+    /* num_phases when the barrier was (re)initialized. */
+    size_t phase_base;
+    /* # of arrivals since the barrier was (re)initialized.  The n-th arrival
+     * belongs to the (phase_base + n / num_waiters)-th phase. */
+    ABTU_align_member_var(ABT_CONFIG_STATIC_CACHELINE_SIZE)
+        ABTD_atomic_size counter;
+    /* # of phases that have been completed.  It is never reset, so waiters
+     * released before ABT_barrier_reinit() can still see that their phases
+     * have been completed. */
+    ABTU_align_member_var(ABT_CONFIG_STATIC_CACHELINE_SIZE)
+        ABTD_atomic_size num_phases;
 };
 
 struct ABTI_xstream_barrier {
@@ -585,6 +728,10 @@ ABTU_ret_err int ABTI_sched_get_migration_pool(ABTI_sched *, ABTI_pool *,
                                                ABTI_pool **);
 ABT_bool ABTI_sched_has_to_stop(ABTI_sched *p_sched);
 ABT_bool ABTI_sched_has_unit(ABTI_sched *p_sched);
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+void ABTI_sched_park(ABTI_sched *p_sched);
+void ABTI_sched_unpark_pool(ABTI_pool *p_pool, size_t num_units);
+#endif
 void ABTI_sched_print(ABTI_sched *p_sched, FILE *p_os, int indent,
                       ABT_bool print_sub);
 void ABTI_sched_reset_id(void);
@@ -610,10 +757,17 @@ ABTI_pool_get_fifo_wait_def(ABT_pool_access access,
                             ABTI_pool_optional_def *p_optional_def,
                             ABTI_pool_deprecated_def *p_deprecated_def);
 ABTU_ret_err int
+ABTI_pool_get_fifo_lockfree_def(ABT_pool_access access,
+                                ABTI_pool_required_def *p_required_def,
+                                ABTI_pool_optional_def *p_optional_def,
+                                ABTI_pool_deprecated_def *p_deprecated_def);
+ABTU_ret_err int
 ABTI_pool_get_randws_def(ABT_pool_access access,
                          ABTI_pool_required_def *p_required_def,
                          ABTI_pool_optional_def *p_optional_def,
                          ABTI_pool_deprecated_def *p_deprecated_def);
+void ABTI_pool_randws_bind_owner(ABTI_pool *p_pool, ABTI_xstream *p_xstream);
+void ABTI_pool_randws_unbind_owner(ABTI_pool *p_pool, ABTI_xstream *p_xstream);
 void ABTI_pool_print(ABTI_pool *p_pool, FILE *p_os, int indent);
 void ABTI_pool_reset_id(void);
 
@@ -625,7 +779,7 @@ ABTU_ret_err int ABTI_pool_config_read(const ABTI_pool_config *p_config,
 ABT_bool ABTI_pool_user_def_is_new(const ABT_pool_user_def def);
 
 /* Work Unit */
-void ABTI_unit_init_hash_table(ABTI_global *p_global);
+ABTU_ret_err int ABTI_unit_init_hash_table(ABTI_global *p_global);
 void ABTI_unit_finalize_hash_table(ABTI_global *p_global);
 ABTU_ret_err int ABTI_unit_map_thread(ABTI_global *p_global, ABT_unit unit,
                                       ABTI_thread *p_thread);
@@ -650,6 +804,9 @@ void ABTI_thread_handle_request_cancel(ABTI_global *p_global,
 ABTU_ret_err int ABTI_thread_handle_request_migrate(ABTI_global *p_global,
                                                     ABTI_local *p_local,
                                                     ABTI_thread *p_thread);
+ABT_bool ABTI_thread_handle_request_fork(ABTI_global *p_global,
+                                         ABTI_local *p_local,
+                                         ABTI_thread *p_thread);
 void ABTI_thread_print(ABTI_thread *p_thread, FILE *p_os, int indent);
 void ABTI_thread_reset_id(void);
 ABT_unit_id ABTI_thread_get_id(ABTI_thread *p_thread);
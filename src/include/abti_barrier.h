@@ -39,4 +39,140 @@ static inline ABT_barrier ABTI_barrier_get_handle(ABTI_barrier *p_barrier)
 #endif
 }
 
+ABTU_ret_err static inline int ABTI_barrier_init(ABTI_barrier *p_barrier,
+                                                 size_t num_waiters)
+{
+    /* Prepare one leaf per ES so that waiters on different ESs do not contend
+     * for the same lock and the last waiter can release waiters ES by ES.
+     * ESs whose ranks are larger than the number of leaves share leaves. */
+    ABTI_global *p_global = ABTI_global_get_global();
+    size_t num_leaves = 1;
+    while (num_leaves < (size_t)p_global->max_xstreams)
+        num_leaves *= 2;
+    size_t num_bitmap_words = (num_leaves + 63) / 64;
+    /* The bitmap follows the leaves, which keeps it 8-byte aligned. */
+    ABTI_barrier_leaf *leaves;
+    int abt_errno =
+        ABTU_malloc(sizeof(ABTI_barrier_leaf) * num_leaves +
+                        sizeof(ABTD_atomic_uint64) * num_bitmap_words,
+                    (void **)&leaves);
+    ABTI_CHECK_ERROR(abt_errno);
+    ABTD_atomic_uint64 *occupied_leaves =
+        (ABTD_atomic_uint64 *)(&leaves[num_leaves]);
+    size_t i;
+    for (i = 0; i < num_leaves; i++) {
+        ABTD_spinlock_clear(&leaves[i].lock);
+        ABTI_waitlist_init(&leaves[i].waitlist);
+    }
+    for (i = 0; i < num_bitmap_words; i++)
+        ABTD_atomic_relaxed_store_uint64(&occupied_leaves[i], 0);
+    p_barrier->num_waiters = num_waiters;
+    p_barrier->num_leaves = num_leaves;
+    p_barrier->leaves = leaves;
+    p_barrier->occupied_leaves = occupied_leaves;
+    p_barrier->phase_base = 0;
+    ABTD_atomic_relaxed_store_size(&p_barrier->counter, 0);
+    ABTD_atomic_relaxed_store_size(&p_barrier->num_phases, 0);
+    return ABT_SUCCESS;
+}
+
+static inline void ABTI_barrier_fini(ABTI_barrier *p_barrier)
+{
+    ABTU_free(p_barrier->leaves);
+}
+
+/* Return ABT_TRUE if no waiter is in the middle of the current phase. */
+static inline ABT_bool ABTI_barrier_is_idle(ABTI_barrier *p_barrier)
+{
+    size_t counter = ABTD_atomic_acquire_load_size(&p_barrier->counter);
+    size_t num_phases = ABTD_atomic_acquire_load_size(&p_barrier->num_phases);
+    return (counter ==
+            (num_phases - p_barrier->phase_base) * p_barrier->num_waiters)
+               ? ABT_TRUE
+               : ABT_FALSE;
+}
+
+static inline size_t ABTI_barrier_get_leaf_index(ABTI_local *p_local,
+                                                  ABTI_barrier *p_barrier)
+{
+    /* External threads use the first leaf. */
+    size_t rank = 0;
+    ABTI_xstream *p_local_xstream = ABTI_local_get_xstream_or_null(p_local);
+    if (!ABTI_IS_EXT_THREAD_ENABLED || p_local_xstream)
+        rank = (size_t)p_local_xstream->rank;
+    return rank & (p_barrier->num_leaves - 1);
+}
+
+static inline void ABTI_barrier_wait(ABTI_local **pp_local,
+                                     ABTI_barrier *p_barrier)
+{
+    /* Every arrival is counted on the shared counter.  Arrivals on the same
+     * ES are not combined since a waiter cannot know whether more waiters on
+     * its ES will follow, so only waiting and release are per ES. */
+    size_t num_waiters = p_barrier->num_waiters;
+    size_t ticket = ABTD_atomic_fetch_add_size(&p_barrier->counter, 1);
+    size_t phase = p_barrier->phase_base + ticket / num_waiters;
+
+    if (ticket % num_waiters != num_waiters - 1) {
+        /* Not the last waiter of this phase.  Wait on the leaf of this ES
+         * until the phase is completed.  This waiter marks its leaf as
+         * occupied before checking num_phases while the last waiter updates
+         * num_phases before taking the marks, so this waiter either sees the
+         * update or is woken up. */
+        size_t leaf_index = ABTI_barrier_get_leaf_index(*pp_local, p_barrier);
+        ABTI_barrier_leaf *p_leaf = &p_barrier->leaves[leaf_index];
+        ABTD_atomic_uint64 *p_occupied =
+            &p_barrier->occupied_leaves[leaf_index / 64];
+        const uint64_t mask = ((uint64_t)1) << (leaf_index % 64);
+        ABTD_spinlock_acquire(&p_leaf->lock);
+        while (1) {
+            /* The mark might have been taken by the last waiter of another
+             * phase, so set it every time. */
+            ABTD_atomic_fetch_or_uint64(p_occupied, mask);
+            ABTD_atomic_full_barrier();
+            if (ABTD_atomic_acquire_load_size(&p_barrier->num_phases) > phase)
+                break;
+            ABTI_waitlist_wait_and_unlock(pp_local, &p_leaf->waitlist,
+                                          &p_leaf->lock,
+                                          ABT_SYNC_EVENT_TYPE_BARRIER,
+                                          (void *)p_barrier);
+            /* A waiter of a later phase can be woken up when an earlier phase
+             * is completed, so check it again. */
+            if (ABTD_atomic_acquire_load_size(&p_barrier->num_phases) > phase)
+                return;
+            ABTD_spinlock_acquire(&p_leaf->lock);
+        }
+        ABTD_spinlock_release(&p_leaf->lock);
+    } else {
+        /* The last waiter.  All the tickets of this and preceding phases have
+         * been taken, so waiters of preceding phases can be released even if
+         * their last waiters have not incremented num_phases yet. */
+        ABTD_atomic_fetch_add_size(&p_barrier->num_phases, 1);
+        ABTD_atomic_full_barrier();
+        /* Release waiters of the occupied leaves.  A waiter of a later phase
+         * might be woken up here, but it marks its leaf again.  The detached
+         * waiters are resumed outside the critical section. */
+        size_t i, num_bitmap_words = (p_barrier->num_leaves + 63) / 64;
+        for (i = 0; i < num_bitmap_words; i++) {
+            if (ABTD_atomic_relaxed_load_uint64(
+                    &p_barrier->occupied_leaves[i]) == 0)
+                continue;
+            uint64_t occupied =
+                ABTD_atomic_exchange_uint64(&p_barrier->occupied_leaves[i], 0);
+            while (occupied) {
+                size_t bit = 0;
+                while (!(occupied & (((uint64_t)1) << bit)))
+                    bit++;
+                occupied &= ~(((uint64_t)1) << bit);
+                ABTI_barrier_leaf *p_leaf = &p_barrier->leaves[i * 64 + bit];
+                ABTD_spinlock_acquire(&p_leaf->lock);
+                ABTI_thread *p_waiters =
+                    ABTI_waitlist_detach_all(&p_leaf->waitlist);
+                ABTD_spinlock_release(&p_leaf->lock);
+                ABTI_ythread_resume_and_push_list(*pp_local, p_waiters);
+            }
+        }
+    }
+}
+
 #endif /* ABTI_BARRIER_H_INCLUDED */
@@ -81,9 +81,11 @@ ABTI_cond_wait(ABTI_local **pp_local, ABTI_cond *p_cond, ABTI_mutex *p_mutex)
 static inline void ABTI_cond_broadcast(ABTI_local *p_local, ABTI_cond *p_cond)
 {
     ABTD_spinlock_acquire(&p_cond->lock);
-    /* Wake up all waiting ULTs */
-    ABTI_waitlist_broadcast(p_local, &p_cond->waitlist);
+    /* Wake up all waiting ULTs.  The detached ULTs are resumed outside the
+     * critical section. */
+    ABTI_thread *p_waiters = ABTI_waitlist_detach_all(&p_cond->waitlist);
     ABTD_spinlock_release(&p_cond->lock);
+    ABTI_ythread_resume_and_push_list(p_local, p_waiters);
 }
 
 #endif /* ABTI_COND_H_INCLUDED */
@@ -22,12 +22,27 @@ enum {
     ABTI_MEM_LP_THP
 };
 
+enum {
+    ABTI_MEM_STACK_RECLAIM_NONE = 0,
+    ABTI_MEM_STACK_RECLAIM_FREE,
+    ABTI_MEM_STACK_RECLAIM_DONTNEED
+};
+
 ABTU_ret_err int ABTI_mem_init(ABTI_global *p_global);
 ABTU_ret_err int ABTI_mem_init_local(ABTI_global *p_global,
                                      ABTI_xstream *p_local_xstream);
 void ABTI_mem_finalize(ABTI_global *p_global);
-void ABTI_mem_finalize_local(ABTI_xstream *p_local_xstream);
+void ABTI_mem_finalize_local(ABTI_global *p_global,
+                             ABTI_xstream *p_local_xstream);
+void ABTI_mem_trim_local(ABTI_xstream *p_local_xstream);
+void ABTI_mem_print(ABTI_global *p_global, FILE *p_os, int indent);
+void ABTI_mem_print_local(ABTI_xstream *p_xstream, FILE *p_os, int indent);
 int ABTI_mem_check_lp_alloc(ABTI_global *p_global, int lp_alloc);
+#ifdef ABT_CONFIG_USE_MEM_POOL
+ABTU_ret_err int ABTI_mem_init_local_stack_class(ABTI_global *p_global,
+                                                 ABTI_xstream *p_local_xstream,
+                                                 int stack_class);
+#endif
 
 #define ABTI_STACK_CANARY_VALUE ((uint64_t)0xbaadc0debaadc0de)
 
@@ -127,6 +142,52 @@ static inline void ABTI_mem_unregister_stack(const ABTI_global *p_global,
     ABTI_VALGRIND_UNREGISTER_STACK(p_stack);
 }
 
+#ifdef ABT_CONFIG_USE_MEM_POOL
+/* Return the index of the smallest stack size class that can hold stacksize
+ * bytes.  Return -1 if stacksize is larger than any class. */
+static inline int ABTI_mem_get_stack_class(const ABTI_global *p_global,
+                                           size_t stacksize)
+{
+    int i;
+    for (i = 0; i < p_global->mem_num_stack_classes; i++) {
+        if (stacksize <= p_global->mem_stack_classes[i])
+            return i;
+    }
+    return -1;
+}
+
+/* Return the local pool of p_local_xstream that keeps stacks of stacksize.  A
+ * stack of a non-default size must have been taken from a pool of its class. */
+static inline ABTI_mem_pool_local_pool *
+ABTI_mem_get_local_stack_pool(const ABTI_global *p_global,
+                              ABTI_xstream *p_local_xstream, size_t stacksize)
+{
+    if (ABTU_likely(stacksize == p_global->thread_stacksize))
+        return &p_local_xstream->mem_pool_stack;
+    int stack_class = ABTI_mem_get_stack_class(p_global, stacksize);
+    ABTI_ASSERT(stack_class >= 0);
+    return &p_local_xstream->mem_pool_stack_classes[stack_class];
+}
+
+/* Return a stack to the local pool from which it is taken.  If the stack is
+ * freed by another ES or an external thread (p_mem_pool_stack is then that of
+ * the caller or NULL), it is pushed to the remote queue of that local pool,
+ * which the owner ES drains in batches.  This keeps stacks in the cache of the
+ * ES that creates ULTs even if they are freed elsewhere. */
+static inline void
+ABTI_mem_free_stack(ABTI_mem_pool_local_pool *p_mem_pool_stack,
+                    ABTI_mem_pool_remote_queue *p_stack_remote_queue,
+                    void *p_mem)
+{
+    if (p_mem_pool_stack &&
+        ABTU_likely(p_mem_pool_stack->p_remote_queue == p_stack_remote_queue)) {
+        ABTI_mem_pool_free(p_mem_pool_stack, p_mem);
+    } else {
+        ABTI_mem_pool_remote_free(p_stack_remote_queue, p_mem);
+    }
+}
+#endif
+
 ABTU_ret_err static inline int ABTI_mem_alloc_nythread(ABTI_local *p_local,
                                                        ABTI_thread **pp_thread)
 {
@@ -152,6 +213,41 @@ ABTU_ret_err static inline int ABTI_mem_alloc_nythread(ABTI_local *p_local,
     return ABT_SUCCESS;
 }
 
+/* Allocate num descriptors in the same way as ABTI_mem_alloc_nythread().  Their
+ * memory is taken from the local memory pool at once.  If it fails, no
+ * descriptor is allocated. */
+ABTU_ret_err static inline int
+ABTI_mem_alloc_nythread_many(ABTI_local *p_local, size_t num,
+                             ABTI_thread **p_threads)
+{
+    size_t i;
+#ifdef ABT_CONFIG_USE_MEM_POOL
+    ABTI_xstream *p_local_xstream = ABTI_local_get_xstream_or_null(p_local);
+    if (!ABTI_IS_EXT_THREAD_ENABLED || p_local_xstream) {
+        /* It's not called on an external thread.  Use a memory pool. */
+        int abt_errno =
+            ABTI_mem_pool_alloc_many(&p_local_xstream->mem_pool_desc, num,
+                                     (void **)p_threads);
+        ABTI_CHECK_ERROR(abt_errno);
+        for (i = 0; i < num; i++)
+            p_threads[i]->type = ABTI_THREAD_TYPE_MEM_MEMPOOL_DESC;
+        return ABT_SUCCESS;
+    }
+#endif
+    for (i = 0; i < num; i++) {
+        int abt_errno = ABTU_malloc(ABTI_MEM_POOL_DESC_ELEM_SIZE,
+                                    (void **)&p_threads[i]);
+        if (ABTI_IS_ERROR_CHECK_ENABLED && abt_errno != ABT_SUCCESS) {
+            /* Free descriptors that have been already allocated. */
+            while (i-- > 0)
+                ABTU_free(p_threads[i]);
+            return abt_errno;
+        }
+        p_threads[i]->type = ABTI_THREAD_TYPE_MEM_MALLOC_DESC;
+    }
+    return ABT_SUCCESS;
+}
+
 static inline void ABTI_mem_free_nythread_mempool_impl(ABTI_global *p_global,
                                                        ABTI_local *p_local,
                                                        ABTI_thread *p_thread)
@@ -269,16 +365,18 @@ ABTU_ret_err static inline int ABTI_mem_alloc_ythread_malloc_desc_stack_impl(
     return ABT_SUCCESS;
 }
 
-ABTU_ret_err static inline int
-ABTI_mem_alloc_ythread_mempool_desc_stack(ABTI_global *p_global,
-                                          ABTI_local *p_local, size_t stacksize,
-                                          ABTI_ythread **pp_ythread)
+/* Allocate a ULT that uses a stack of the default size.  If lazy_stack is
+ * ABT_TRUE, the stack is allocated when the ULT starts even if lazy stack
+ * allocation is disabled by default. */
+ABTU_ret_err static inline int ABTI_mem_alloc_ythread_mempool_desc_stack(
+    ABTI_global *p_global, ABTI_local *p_local, size_t stacksize,
+    ABT_bool lazy_stack, ABTI_ythread **pp_ythread)
 {
     ABTI_UB_ASSERT(stacksize == p_global->thread_stacksize);
     ABTI_ythread *p_ythread;
 #ifdef ABT_CONFIG_USE_MEM_POOL
 #ifdef ABT_CONFIG_DISABLE_LAZY_STACK_ALLOC
-    const ABT_bool use_lazy_stack = ABT_FALSE;
+    const ABT_bool use_lazy_stack = lazy_stack;
 #else
     const ABT_bool use_lazy_stack = ABT_TRUE;
 #endif
@@ -301,6 +399,8 @@ ABTI_mem_alloc_ythread_mempool_desc_stack(ABTI_global *p_global,
                 &p_stacktop);
             ABTI_CHECK_ERROR(abt_errno);
             p_ythread->thread.type = ABTI_THREAD_TYPE_MEM_MEMPOOL_DESC_STACK;
+            p_ythread->p_stack_remote_queue =
+                p_local_xstream->mem_pool_stack.p_remote_queue;
             ABTI_mem_register_stack(p_global, p_stacktop, stacksize, ABT_FALSE);
         } else {
             /* If an external thread allocates a stack, we use ABTU_malloc. */
@@ -338,7 +438,8 @@ ABTI_mem_alloc_ythread_default(ABTI_global *p_global, ABTI_local *p_local,
 {
     size_t stacksize = p_global->thread_stacksize;
     return ABTI_mem_alloc_ythread_mempool_desc_stack(p_global, p_local,
-                                                     stacksize, pp_ythread);
+                                                     stacksize, ABT_FALSE,
+                                                     pp_ythread);
 }
 
 ABTU_ret_err static inline int ABTI_mem_alloc_ythread_malloc_desc_stack(
@@ -359,6 +460,48 @@ ABTU_ret_err static inline int ABTI_mem_alloc_ythread_malloc_desc_stack(
     return ABT_SUCCESS;
 }
 
+/* Allocate a ULT with a stack of a non-default size.  The stack is taken from
+ * the pool of the smallest stack size class that can hold it; the ULT uses
+ * only the bottom stacksize bytes of that stack so that the stack guard of the
+ * pool stays right below the stack.  If no class is large enough, it is
+ * allocated by ABTU_malloc(). */
+ABTU_ret_err static inline int
+ABTI_mem_alloc_ythread_sized_desc_stack(ABTI_global *p_global,
+                                        ABTI_local *p_local, size_t stacksize,
+                                        ABTI_ythread **pp_ythread)
+{
+#ifdef ABT_CONFIG_USE_MEM_POOL
+    ABTI_xstream *p_local_xstream = ABTI_local_get_xstream_or_null(p_local);
+    int stack_class = ABTI_mem_get_stack_class(p_global, stacksize);
+    if (stack_class >= 0 && (!ABTI_IS_EXT_THREAD_ENABLED || p_local_xstream)) {
+        int abt_errno;
+        ABTI_mem_pool_local_pool *p_mem_pool_stack =
+            &p_local_xstream->mem_pool_stack_classes[stack_class];
+        if (ABTU_unlikely(!p_mem_pool_stack->p_global_pool)) {
+            abt_errno = ABTI_mem_init_local_stack_class(p_global,
+                                                        p_local_xstream,
+                                                        stack_class);
+            ABTI_CHECK_ERROR(abt_errno);
+        }
+        ABTI_ythread *p_ythread;
+        abt_errno = ABTI_mem_pool_alloc(p_mem_pool_stack, (void **)&p_ythread);
+        ABTI_CHECK_ERROR(abt_errno);
+        void *p_stacktop =
+            (void *)(((char *)p_ythread) -
+                     p_global->mem_stack_classes[stack_class] + stacksize);
+        p_ythread->thread.type = ABTI_THREAD_TYPE_MEM_MEMPOOL_DESC_STACK;
+        p_ythread->p_stack_remote_queue = p_mem_pool_stack->p_remote_queue;
+        ABTI_mem_register_stack(p_global, p_stacktop, stacksize, ABT_FALSE);
+        /* Initialize the context. */
+        ABTD_ythread_context_init(&p_ythread->ctx, p_stacktop, stacksize);
+        *pp_ythread = p_ythread;
+        return ABT_SUCCESS;
+    }
+#endif
+    return ABTI_mem_alloc_ythread_malloc_desc_stack(p_global, stacksize,
+                                                    pp_ythread);
+}
+
 ABTU_ret_err static inline int
 ABTI_mem_alloc_ythread_mempool_desc(ABTI_global *p_global, ABTI_local *p_local,
                                     size_t stacksize, void *p_stacktop,
@@ -394,18 +537,16 @@ static inline void ABTI_mem_free_thread(ABTI_global *p_global,
                                       &p_ythread->ctx),
                                   ABT_FALSE);
 
-        ABTI_xstream *p_local_xstream = ABTI_local_get_xstream_or_null(p_local);
         /* Came from a memory pool. */
-#ifndef ABT_CONFIG_DISABLE_EXT_THREAD
-        if (p_local_xstream == NULL) {
-            /* Return a stack to the global pool. */
-            ABTD_spinlock_acquire(&p_global->mem_pool_stack_lock);
-            ABTI_mem_pool_free(&p_global->mem_pool_stack_ext, p_ythread);
-            ABTD_spinlock_release(&p_global->mem_pool_stack_lock);
-            return;
+        ABTI_xstream *p_local_xstream = ABTI_local_get_xstream_or_null(p_local);
+        ABTI_mem_pool_local_pool *p_mem_pool_stack = NULL;
+        if (!ABTI_IS_EXT_THREAD_ENABLED || p_local_xstream) {
+            p_mem_pool_stack = ABTI_mem_get_local_stack_pool(
+                p_global, p_local_xstream,
+                ABTD_ythread_context_get_stacksize(&p_ythread->ctx));
         }
-#endif
-        ABTI_mem_pool_free(&p_local_xstream->mem_pool_stack, p_ythread);
+        ABTI_mem_free_stack(p_mem_pool_stack, p_ythread->p_stack_remote_queue,
+                            p_ythread);
     } else
 #endif
         if (p_thread->type &
@@ -434,7 +575,11 @@ static inline void ABTI_mem_free_thread(ABTI_global *p_global,
         void *p_stacktop = ABTD_ythread_context_get_stacktop(&p_ythread->ctx);
         size_t stacksize = ABTD_ythread_context_get_stacksize(&p_ythread->ctx);
         ABTI_mem_unregister_stack(p_global, p_stacktop, stacksize, ABT_TRUE);
-        void *p_stack = (void *)(((char *)p_stacktop) - stacksize);
+        /* The allocated stack size is rounded up to the cacheline size. */
+        void *p_stack =
+            (void *)(((char *)p_stacktop) -
+                     ABTU_roundup_size(stacksize,
+                                       ABT_CONFIG_STATIC_CACHELINE_SIZE));
         ABTU_free(p_stack);
     } else if (p_thread->type &
                ABTI_THREAD_TYPE_MEM_MALLOC_DESC_MEMPOOL_LAZY_STACK) {
@@ -457,6 +602,74 @@ static inline void ABTI_mem_free_thread(ABTI_global *p_global,
     }
 }
 
+/* Allocate num ULTs in the same way as
+ * ABTI_mem_alloc_ythread_mempool_desc_stack().  Their memory is taken from the
+ * local memory pool at once.  If it fails, no ULT is allocated. */
+ABTU_ret_err static inline int ABTI_mem_alloc_ythread_mempool_desc_stack_many(
+    ABTI_global *p_global, ABTI_local *p_local, size_t stacksize,
+    ABT_bool lazy_stack, size_t num, ABTI_ythread **p_ythreads)
+{
+    ABTI_UB_ASSERT(stacksize == p_global->thread_stacksize);
+    size_t i;
+#ifdef ABT_CONFIG_USE_MEM_POOL
+    ABTI_xstream *p_local_xstream = ABTI_local_get_xstream_or_null(p_local);
+    if (!ABTI_IS_EXT_THREAD_ENABLED || p_local_xstream) {
+#ifdef ABT_CONFIG_DISABLE_LAZY_STACK_ALLOC
+        const ABT_bool use_lazy_stack = lazy_stack;
+#else
+        const ABT_bool use_lazy_stack = ABT_TRUE;
+#endif
+        if (use_lazy_stack) {
+            /* Only allocate descriptors here. */
+            int abt_errno =
+                ABTI_mem_pool_alloc_many(&p_local_xstream->mem_pool_desc, num,
+                                         (void **)p_ythreads);
+            ABTI_CHECK_ERROR(abt_errno);
+            for (i = 0; i < num; i++) {
+                ABTI_ythread *p_ythread = p_ythreads[i];
+                p_ythread->thread.type =
+                    ABTI_THREAD_TYPE_MEM_MEMPOOL_DESC_MEMPOOL_LAZY_STACK;
+                ABTD_ythread_context_init_lazy(&p_ythread->ctx, stacksize);
+            }
+        } else {
+            /* Allocate ULT stacks and descriptors together. */
+            ABTI_ASSERT((stacksize & (ABT_CONFIG_STATIC_CACHELINE_SIZE - 1)) ==
+                        0);
+            int abt_errno =
+                ABTI_mem_pool_alloc_many(&p_local_xstream->mem_pool_stack, num,
+                                         (void **)p_ythreads);
+            ABTI_CHECK_ERROR(abt_errno);
+            for (i = 0; i < num; i++) {
+                ABTI_ythread *p_ythread = p_ythreads[i];
+                void *p_stacktop = (void *)p_ythread;
+                p_ythread->thread.type = ABTI_THREAD_TYPE_MEM_MEMPOOL_DESC_STACK;
+                p_ythread->p_stack_remote_queue =
+                    p_local_xstream->mem_pool_stack.p_remote_queue;
+                ABTI_mem_register_stack(p_global, p_stacktop, stacksize,
+                                        ABT_FALSE);
+                ABTD_ythread_context_init(&p_ythread->ctx, p_stacktop,
+                                          stacksize);
+            }
+        }
+        return ABT_SUCCESS;
+    }
+#endif
+    /* Allocate ULTs one by one. */
+    for (i = 0; i < num; i++) {
+        int abt_errno =
+            ABTI_mem_alloc_ythread_mempool_desc_stack(p_global, p_local,
+                                                      stacksize, lazy_stack,
+                                                      &p_ythreads[i]);
+        if (ABTI_IS_ERROR_CHECK_ENABLED && abt_errno != ABT_SUCCESS) {
+            /* Free ULTs that have been already allocated. */
+            while (i-- > 0)
+                ABTI_mem_free_thread(p_global, p_local, &p_ythreads[i]->thread);
+            return abt_errno;
+        }
+    }
+    return ABT_SUCCESS;
+}
+
 ABTU_ret_err static inline int
 ABTI_mem_alloc_ythread_mempool_stack(ABTI_xstream *p_local_xstream,
                                      ABTI_ythread *p_ythread)
@@ -465,11 +678,19 @@ ABTI_mem_alloc_ythread_mempool_stack(ABTI_xstream *p_local_xstream,
     ABTI_UB_ASSERT(p_ythread->thread.type &
                    (ABTI_THREAD_TYPE_MEM_MEMPOOL_DESC_MEMPOOL_LAZY_STACK |
                     ABTI_THREAD_TYPE_MEM_MALLOC_DESC_MEMPOOL_LAZY_STACK));
-    void *p_stacktop;
-    int abt_errno =
-        ABTI_mem_pool_alloc(&p_local_xstream->mem_pool_stack, &p_stacktop);
-    ABTI_CHECK_ERROR(abt_errno);
+    void *p_stacktop = p_local_xstream->p_stack_cache;
+    if (p_stacktop) {
+        /* Borrow the stack of this ES. */
+        p_local_xstream->p_stack_cache = NULL;
+    } else {
+        /* The stack of this ES is held by a suspended ULT. */
+        int abt_errno =
+            ABTI_mem_pool_alloc(&p_local_xstream->mem_pool_stack, &p_stacktop);
+        ABTI_CHECK_ERROR(abt_errno);
+    }
     ABTD_ythread_context_lazy_set_stack(&p_ythread->ctx, p_stacktop);
+    p_ythread->p_stack_remote_queue =
+        p_local_xstream->mem_pool_stack.p_remote_queue;
     return ABT_SUCCESS;
 #else
     /* This function should not be called. */
@@ -488,7 +709,15 @@ ABTI_mem_free_ythread_mempool_stack(ABTI_xstream *p_local_xstream,
                     ABTI_THREAD_TYPE_MEM_MALLOC_DESC_MEMPOOL_LAZY_STACK));
     void *p_stacktop = ABTD_ythread_context_get_stacktop(&p_ythread->ctx);
     ABTD_ythread_context_lazy_unset_stack(&p_ythread->ctx);
-    ABTI_mem_pool_free(&p_local_xstream->mem_pool_stack, p_stacktop);
+    if (!p_local_xstream->p_stack_cache &&
+        ABTU_likely(p_ythread->p_stack_remote_queue ==
+                    p_local_xstream->mem_pool_stack.p_remote_queue)) {
+        /* Keep the stack so that the next ULT on this ES can run on it. */
+        p_local_xstream->p_stack_cache = p_stacktop;
+    } else {
+        ABTI_mem_free_stack(&p_local_xstream->mem_pool_stack,
+                            p_ythread->p_stack_remote_queue, p_stacktop);
+    }
 #else
     /* This function should not be called. */
     ABTI_ASSERT(0);
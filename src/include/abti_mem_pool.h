@@ -6,9 +6,14 @@
 #ifndef ABTI_MEM_POOL_H_INCLUDED
 #define ABTI_MEM_POOL_H_INCLUDED
 
-#define ABT_MEM_POOL_MAX_LOCAL_BUCKETS 2
+/* A local pool keeps ABT_MEM_POOL_MIN_LOCAL_BUCKETS buckets by default.  Its
+ * depth can grow up to ABT_MEM_POOL_MAX_LOCAL_BUCKETS at run time. */
+#define ABT_MEM_POOL_MIN_LOCAL_BUCKETS 2
+#define ABT_MEM_POOL_MAX_LOCAL_BUCKETS 16
 #define ABT_MEM_POOL_NUM_RETURN_BUCKETS 1
 #define ABT_MEM_POOL_NUM_TAKE_BUCKETS 1
+/* Max. # of returned buckets reclaimed by each trim of a local pool. */
+#define ABT_MEM_POOL_NUM_RECLAIM_BUCKETS 4
 
 typedef union ABTI_mem_pool_header_bucket_info {
     /* This is used when it is in ABTI_mem_pool_global_pool */
@@ -20,11 +25,15 @@ typedef union ABTI_mem_pool_header_bucket_info {
 typedef struct ABTI_mem_pool_header {
     struct ABTI_mem_pool_header *p_next;
     ABTI_mem_pool_header_bucket_info bucket_info;
+    /* Whether the memory below this header has been probed and released since
+     * this header was freed last time. */
+    ABT_bool is_released;
 } ABTI_mem_pool_header;
 
 typedef struct ABTI_mem_pool_page {
     ABTI_sync_lifo_element lifo_elem;
     struct ABTI_mem_pool_page *p_next_empty_page;
+    struct ABTI_mem_pool_page *p_next_page; /* List of all the pages. */
     void *mem;
     size_t page_size;
     ABTU_MEM_LARGEPAGE_TYPE lp_type;
@@ -39,8 +48,45 @@ typedef struct ABTI_mem_pool_global_pool_mprotect_config {
     size_t page_size;     /* Protection page size. */
     size_t alignment; /* Alignment of protected page.  It should be a multiple
                          of the system page size. */
+    ABT_bool growable; /* Protected pages except for the first one can be
+                          unprotected on demand (i.e., growable stacks). */
 } ABTI_mem_pool_global_pool_mprotect_config;
 
+/*
+ * If reclamation is enabled, headers returned to the global pool are probed by
+ * mincore() to see how deep the memory right below each header has been used,
+ * and resident pages that are more than keep_size bytes below the header are
+ * released by madvise().  It is for stacks, which grow downward from headers.
+ * Returned buckets are first kept in reclaim_bucket_lifo and are reclaimed in
+ * batches by ABTI_mem_pool_trim_local_pool().  A released header is not probed
+ * again until it is freed after use.  Pages released by MADV_FREE still look
+ * resident to mincore() until the OS reclaims them, so the statistics can
+ * count such pages again if the header is used again; MADV_DONTNEED gives
+ * exact statistics.
+ */
+typedef struct ABTI_mem_pool_global_pool_reclaim_config {
+    ABT_bool enabled; /* Release unused memory or not. */
+    ABT_bool lazy;    /* Use MADV_FREE instead of MADV_DONTNEED. */
+    size_t keep_size; /* Size of memory right below a header that is kept. */
+    size_t page_size; /* System page size. */
+} ABTI_mem_pool_global_pool_reclaim_config;
+
+/*
+ * A remote queue receives headers that are freed by threads other than the
+ * owner of a local pool.  Any thread pushes a header by CAS, and only the owner
+ * takes all the headers at once, so there is no ABA problem.  Remote queues
+ * are kept by the global pool even after their local pools are destroyed since
+ * other threads might still push headers to them.  Such queues are reused by
+ * new local pools, which will drain the remaining headers.
+ */
+typedef struct ABTI_mem_pool_remote_queue {
+    ABTD_atomic_ptr p_head; /* ABTI_mem_pool_header * */
+    /* All the remote queues of the global pool. */
+    struct ABTI_mem_pool_remote_queue *p_next;
+    /* Remote queues that are not used by any local pool. */
+    struct ABTI_mem_pool_remote_queue *p_next_unused;
+} ABTI_mem_pool_remote_queue;
+
 /*
  * To efficiently take/return multiple headers per bucket, headers are linked as
  * follows in the global pool (bucket_lifo).
@@ -56,6 +102,11 @@ typedef struct ABTI_mem_pool_global_pool_mprotect_config {
  *   .
  */
 typedef struct ABTI_mem_pool_global_pool {
+    int numa_id; /* NUMA node on which new pages are placed (-1 if unknown). */
+    /* Global pools of different NUMA nodes are connected in a ring.  A global
+     * pool takes buckets from the other pools only when it fails to allocate
+     * a new page. */
+    struct ABTI_mem_pool_global_pool *p_next_node_pool;
     size_t header_size;    /* Size of header.  This size includes a protected
                             * page. */
     size_t page_size;      /* Size of page (mem of ABTI_mem_pool_page) */
@@ -64,24 +115,48 @@ typedef struct ABTI_mem_pool_global_pool {
                             * of the memory segment; i.e., the pool returns
                             * p_header_memory_top + offset. */
     size_t num_headers_per_bucket; /* Number of headers per bucket. */
+    size_t max_local_buckets; /* Upper bound of the depth of local pools. */
     uint32_t
         num_lp_type_requests; /* Number of requests for large page allocation.
                                */
     ABTU_MEM_LARGEPAGE_TYPE
     lp_type_requests[4]; /* Requests for large page allocation */
     ABTI_mem_pool_global_pool_mprotect_config mprotect_config;
+    ABTI_mem_pool_global_pool_reclaim_config reclaim_config;
     ABTU_align_member_var(ABT_CONFIG_STATIC_CACHELINE_SIZE)
         ABTI_sync_lifo bucket_lifo; /* LIFO of available buckets. */
+    ABTU_align_member_var(ABT_CONFIG_STATIC_CACHELINE_SIZE)
+        /* LIFO of available buckets that have not been reclaimed yet.  It is
+         * used only if reclaim_config.enabled is true. */
+        ABTI_sync_lifo reclaim_bucket_lifo;
     ABTU_align_member_var(ABT_CONFIG_STATIC_CACHELINE_SIZE)
         ABTI_sync_lifo mem_page_lifo; /* LIFO of non-empty pages. */
     ABTU_align_member_var(ABT_CONFIG_STATIC_CACHELINE_SIZE)
         ABTD_atomic_ptr p_mem_page_empty; /* List of empty pages. */
+    ABTD_atomic_ptr p_mem_pages; /* List of all the pages (push-only). */
     ABTU_align_member_var(ABT_CONFIG_STATIC_CACHELINE_SIZE)
         /* List of the remaining headers that are not enough to create one
          * complete bucket. This is protected by a spinlock. The number of
          * headers is stored in partial_bucket.bucket_info.num_headers. */
         ABTD_spinlock partial_bucket_lock;
     ABTI_mem_pool_header *partial_bucket;
+    /* Remote queues.  They are protected by remote_queues_lock. */
+    ABTD_spinlock remote_queues_lock;
+    ABTI_mem_pool_remote_queue *p_remote_queues;
+    ABTI_mem_pool_remote_queue *p_unused_remote_queues;
+    /* Statistics.  They are updated per bucket or per page. */
+    ABTU_align_member_var(ABT_CONFIG_STATIC_CACHELINE_SIZE)
+        ABTD_atomic_uint64 num_pages; /* # of allocated pages */
+    ABTD_atomic_uint64 num_taken_buckets;    /* # of taken buckets */
+    ABTD_atomic_uint64 num_returned_buckets; /* # of returned buckets */
+    ABTD_atomic_uint64 num_migrated_buckets; /* # of buckets taken from
+                                                the other NUMA nodes */
+    ABTD_atomic_uint64 num_probed_headers;    /* # of probed headers */
+    ABTD_atomic_uint64 max_used_size;         /* Max. used size below a
+                                                 header (high-water mark) */
+    ABTD_atomic_uint64 num_reclaimed_headers; /* # of headers whose memory
+                                                 has been released */
+    ABTD_atomic_uint64 reclaimed_size;        /* Released resident memory */
 } ABTI_mem_pool_global_pool;
 
 /*
@@ -97,28 +172,60 @@ typedef struct ABTI_mem_pool_global_pool {
  * buckets[bucket_index]:
  *  = header (p_next)> header (p_next)> header ...
  *                              (buckets[bucket_index]->bucket_info.num_headers)
+ *
+ * bucket_index is always smaller than max_buckets, which is adjusted by
+ * ABTI_mem_pool_trim_local_pool().  It is called every time the scheduler
+ * checks events and does the actual work once per ABT_MEM_POOL_TRIM_INTERVAL
+ * calls.  If the local pool has taken or returned buckets since the last trim,
+ * max_buckets is doubled so that the next burst of allocations and
+ * deallocations is absorbed locally.  Otherwise, half of the buckets that
+ * have not been used since the last trim (i.e., those below the low-water mark
+ * of bucket_index) are returned to the global pool and max_buckets is halved,
+ * but not below the high-water mark of bucket_index.
  */
+#define ABT_MEM_POOL_TRIM_INTERVAL 64
+
 typedef struct ABTI_mem_pool_local_pool {
     ABTI_mem_pool_global_pool *p_global_pool;
+    ABTI_mem_pool_remote_queue *p_remote_queue; /* Headers freed remotely */
     size_t num_headers_per_bucket; /* Cached value to reduce dereference. It
                                       must be equal to
                                       p_global_pool->num_headers_per_bucket. */
     size_t bucket_index;
+    size_t max_buckets;      /* Current depth of this local pool. */
+    size_t bucket_index_lwm; /* Min. bucket_index since the last trim. */
+    size_t bucket_index_hwm; /* Max. bucket_index since the last trim. */
+    uint32_t trim_tick;      /* Counter for ABT_MEM_POOL_TRIM_INTERVAL. */
+    /* Statistics.  Only the owner updates them. */
+    uint64_t num_global_takes;   /* # of buckets taken from the global pool */
+    uint64_t num_global_returns; /* # of buckets returned to the global pool */
+    uint64_t num_global_ops_at_trim; /* takes + returns at the last trim */
+    uint64_t num_grows;              /* # of times max_buckets is doubled */
+    uint64_t num_trimmed_buckets;    /* # of buckets returned by trimming */
+    uint64_t num_remote_frees; /* # of headers taken from p_remote_queue */
     ABTI_mem_pool_header *buckets[ABT_MEM_POOL_MAX_LOCAL_BUCKETS];
 } ABTI_mem_pool_local_pool;
 
 void ABTI_mem_pool_init_global_pool(
-    ABTI_mem_pool_global_pool *p_global_pool, size_t num_headers_per_bucket,
-    size_t header_size, size_t header_offset, size_t page_size,
+    ABTI_mem_pool_global_pool *p_global_pool, int numa_id,
+    size_t num_headers_per_bucket, size_t max_local_buckets, size_t header_size,
+    size_t header_offset, size_t page_size,
     const ABTU_MEM_LARGEPAGE_TYPE *lp_type_requests,
     uint32_t num_lp_type_requests, size_t alignment_hint,
-    ABTI_mem_pool_global_pool_mprotect_config *p_mprotect_config);
+    ABTI_mem_pool_global_pool_mprotect_config *p_mprotect_config,
+    ABTI_mem_pool_global_pool_reclaim_config *p_reclaim_config);
 void ABTI_mem_pool_destroy_global_pool(
     ABTI_mem_pool_global_pool *p_global_pool);
+void ABTI_mem_pool_print_global_pool(ABTI_mem_pool_global_pool *p_global_pool,
+                                     FILE *p_os, int indent);
 ABTU_ret_err int
 ABTI_mem_pool_init_local_pool(ABTI_mem_pool_local_pool *p_local_pool,
                               ABTI_mem_pool_global_pool *p_global_pool);
 void ABTI_mem_pool_destroy_local_pool(ABTI_mem_pool_local_pool *p_local_pool);
+void ABTI_mem_pool_trim_local_pool(ABTI_mem_pool_local_pool *p_local_pool);
+void ABTI_mem_pool_drain_remote_queue(ABTI_mem_pool_local_pool *p_local_pool);
+void ABTI_mem_pool_print_local_pool(ABTI_mem_pool_local_pool *p_local_pool,
+                                    FILE *p_os, int indent);
 int ABTI_mem_pool_take_bucket(ABTI_mem_pool_global_pool *p_global_pool,
                               ABTI_mem_pool_header **p_bucket);
 void ABTI_mem_pool_return_bucket(ABTI_mem_pool_global_pool *p_global_pool,
@@ -136,8 +243,14 @@ ABTI_mem_pool_alloc(ABTI_mem_pool_local_pool *p_local_pool, void **p_mem)
     if (num_headers_in_cur_bucket == 1) {
         /*cur_bucket will be empty after allocation. */
         if (bucket_index == 0) {
-            /* cur_bucket is the last header in this pool.
-             * Let's get some buckets from the global pool. */
+            /* cur_bucket is the last header in this pool.  Let's first take
+             * headers that have been freed remotely. */
+            if (ABTD_atomic_relaxed_load_ptr(
+                    &p_local_pool->p_remote_queue->p_head)) {
+                ABTI_mem_pool_drain_remote_queue(p_local_pool);
+                return ABTI_mem_pool_alloc(p_local_pool, p_mem);
+            }
+            /* Let's get some buckets from the global pool. */
             size_t i;
             for (i = 0; i < ABT_MEM_POOL_NUM_TAKE_BUCKETS; i++) {
                 int abt_errno =
@@ -155,9 +268,16 @@ ABTI_mem_pool_alloc(ABTI_mem_pool_local_pool *p_local_pool, void **p_mem)
                     return abt_errno;
                 }
             }
-            p_local_pool->bucket_index = ABT_MEM_POOL_NUM_TAKE_BUCKETS - 1;
+            p_local_pool->num_global_takes += ABT_MEM_POOL_NUM_TAKE_BUCKETS;
+            bucket_index = ABT_MEM_POOL_NUM_TAKE_BUCKETS - 1;
+            if (bucket_index > p_local_pool->bucket_index_hwm)
+                p_local_pool->bucket_index_hwm = bucket_index;
+            p_local_pool->bucket_index = bucket_index;
         } else {
-            p_local_pool->bucket_index = bucket_index - 1;
+            bucket_index--;
+            if (bucket_index < p_local_pool->bucket_index_lwm)
+                p_local_pool->bucket_index_lwm = bucket_index;
+            p_local_pool->bucket_index = bucket_index;
         }
         /* Now buckets[bucket_index] is full of headers. */
     } else {
@@ -178,24 +298,26 @@ static inline void ABTI_mem_pool_free(ABTI_mem_pool_local_pool *p_local_pool,
     size_t bucket_index = p_local_pool->bucket_index;
     ABTI_mem_pool_header *p_freed_header = (ABTI_mem_pool_header *)mem;
     ABTI_mem_pool_header *cur_bucket = p_local_pool->buckets[bucket_index];
+    p_freed_header->is_released = ABT_FALSE;
     if (cur_bucket->bucket_info.num_headers ==
         p_local_pool->num_headers_per_bucket) {
         /* cur_bucket is full. */
-        if (++bucket_index == ABT_MEM_POOL_MAX_LOCAL_BUCKETS) {
+        if (++bucket_index == p_local_pool->max_buckets) {
             size_t i;
             /* All buckets are full, so let's return some old buckets. */
             for (i = 0; i < ABT_MEM_POOL_NUM_RETURN_BUCKETS; i++) {
                 ABTI_mem_pool_return_bucket(p_local_pool->p_global_pool,
                                             p_local_pool->buckets[i]);
             }
-            for (i = ABT_MEM_POOL_NUM_RETURN_BUCKETS;
-                 i < ABT_MEM_POOL_MAX_LOCAL_BUCKETS; i++) {
+            for (i = ABT_MEM_POOL_NUM_RETURN_BUCKETS; i < bucket_index; i++) {
                 p_local_pool->buckets[i - ABT_MEM_POOL_NUM_RETURN_BUCKETS] =
                     p_local_pool->buckets[i];
             }
-            bucket_index = ABT_MEM_POOL_MAX_LOCAL_BUCKETS -
-                           ABT_MEM_POOL_NUM_RETURN_BUCKETS;
+            bucket_index -= ABT_MEM_POOL_NUM_RETURN_BUCKETS;
+            p_local_pool->num_global_returns += ABT_MEM_POOL_NUM_RETURN_BUCKETS;
         }
+        if (bucket_index > p_local_pool->bucket_index_hwm)
+            p_local_pool->bucket_index_hwm = bucket_index;
         p_local_pool->bucket_index = bucket_index;
         p_freed_header->p_next = NULL;
         p_freed_header->bucket_info.num_headers = 1;
@@ -208,4 +330,57 @@ static inline void ABTI_mem_pool_free(ABTI_mem_pool_local_pool *p_local_pool,
     /* At least one header is available in the current bucket. */
 }
 
+/* Allocate num headers.  Headers are taken from the current bucket at once
+ * while it has more than one header.  If it fails, no header is allocated. */
+ABTU_ret_err static inline int
+ABTI_mem_pool_alloc_many(ABTI_mem_pool_local_pool *p_local_pool, size_t num,
+                         void **p_mems)
+{
+    size_t i = 0;
+    while (i < num) {
+        size_t bucket_index = p_local_pool->bucket_index;
+        ABTI_mem_pool_header *cur_bucket = p_local_pool->buckets[bucket_index];
+        size_t num_headers_in_cur_bucket = cur_bucket->bucket_info.num_headers;
+        if (num_headers_in_cur_bucket == 1) {
+            /* The last header needs refilling the current bucket. */
+            int abt_errno = ABTI_mem_pool_alloc(p_local_pool, &p_mems[i]);
+            if (ABTI_IS_ERROR_CHECK_ENABLED && abt_errno != ABT_SUCCESS) {
+                /* Return headers that have been already taken. */
+                while (i-- > 0)
+                    ABTI_mem_pool_free(p_local_pool, p_mems[i]);
+                return abt_errno;
+            }
+            i++;
+        } else {
+            /* Take headers while leaving at least one in the bucket. */
+            size_t num_take = num_headers_in_cur_bucket - 1;
+            if (num_take > num - i)
+                num_take = num - i;
+            size_t j;
+            for (j = 0; j < num_take; j++) {
+                p_mems[i++] = (void *)cur_bucket;
+                cur_bucket = cur_bucket->p_next;
+            }
+            cur_bucket->bucket_info.num_headers =
+                num_headers_in_cur_bucket - num_take;
+            p_local_pool->buckets[bucket_index] = cur_bucket;
+        }
+    }
+    return ABT_SUCCESS;
+}
+
+/* Return mem to the local pool that owns p_remote_queue.  Any thread can call
+ * this function. */
+static inline void
+ABTI_mem_pool_remote_free(ABTI_mem_pool_remote_queue *p_remote_queue, void *mem)
+{
+    ABTI_mem_pool_header *p_freed_header = (ABTI_mem_pool_header *)mem;
+    void *p_cur_head;
+    do {
+        p_cur_head = ABTD_atomic_relaxed_load_ptr(&p_remote_queue->p_head);
+        p_freed_header->p_next = (ABTI_mem_pool_header *)p_cur_head;
+    } while (!ABTD_atomic_bool_cas_weak_ptr(&p_remote_queue->p_head,
+                                            p_cur_head, p_freed_header));
+}
+
 #endif /* ABTI_MEM_POOL_H_INCLUDED */
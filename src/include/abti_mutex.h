@@ -6,6 +6,14 @@
 #ifndef ABTI_MUTEX_H_INCLUDED
 #define ABTI_MUTEX_H_INCLUDED
 
+/* Waiters to which the mutex is preferentially handed over by the unlock
+ * routines that may switch the context (e.g., ABT_mutex_unlock()). */
+#define ABTI_MUTEX_HANDOVER_SAME_XSTREAM 0
+#define ABTI_MUTEX_HANDOVER_DIFF_XSTREAM 1
+/* The number of waiters searched for a preferred waiter on unlock.  Waiters
+ * are searched while holding waiter_lock, so the search must be short. */
+#define ABTI_MUTEX_HANDOVER_SEARCH_DEPTH 16
+
 static inline ABTI_mutex *ABTI_mutex_get_ptr(ABT_mutex mutex)
 {
 #ifndef ABT_CONFIG_DISABLE_ERROR_CHECK
@@ -42,6 +50,8 @@ static inline void ABTI_mutex_init(ABTI_mutex *p_mutex)
 #ifndef ABT_CONFIG_USE_SIMPLE_MUTEX
     ABTD_spinlock_clear(&p_mutex->waiter_lock);
     ABTI_waitlist_init(&p_mutex->waitlist);
+    ABTD_atomic_relaxed_store_ptr(&p_mutex->p_handover, NULL);
+    p_mutex->num_handovers = 0;
 #endif
     p_mutex->attrs = ABTI_MUTEX_ATTR_NONE;
     p_mutex->nesting_cnt = 0;
@@ -73,6 +83,19 @@ static inline void ABTI_mutex_lock_no_recursion(ABTI_local **pp_local,
                                       &p_mutex->waiter_lock,
                                       ABT_SYNC_EVENT_TYPE_MUTEX,
                                       (void *)p_mutex);
+        /* The unlocker might have handed over the lock to this ULT.  Only a
+         * waiting ULT can be p_handover, so a non-yieldable caller never
+         * matches it. */
+        ABTI_xstream *p_local_xstream =
+            ABTI_local_get_xstream_or_null(*pp_local);
+        if ((!ABTI_IS_EXT_THREAD_ENABLED || p_local_xstream) &&
+            ABTD_atomic_acquire_load_ptr(&p_mutex->p_handover) ==
+                (void *)p_local_xstream->p_thread) {
+            /* The lock has been taken by the unlocker on behalf of this
+             * ULT. */
+            ABTD_atomic_relaxed_store_ptr(&p_mutex->p_handover, NULL);
+            break;
+        }
     }
     /* Take a lock. */
 #else
@@ -170,20 +193,113 @@ static inline void ABTI_mutex_spinlock(ABTI_local *p_local, ABTI_mutex *p_mutex)
     }
 }
 
+#ifndef ABT_CONFIG_USE_SIMPLE_MUTEX
+/* Wake up at most max_wakeups waiters.  waiter_lock must be taken. */
+static inline void ABTI_mutex_wake_up_waiters(ABTI_local *p_local,
+                                              ABTI_mutex *p_mutex,
+                                              uint32_t max_wakeups)
+{
+    ABTI_global *p_global = ABTI_global_get_global_or_null();
+    if (p_global) {
+        uint32_t num = p_global->mutex_max_wakeups;
+        ABTI_waitlist_signal_many(p_local, &p_mutex->waitlist,
+                                  num < max_wakeups ? num : max_wakeups);
+    } else {
+        /* A mutex can be used while Argobots is not initialized.  All the
+         * waiters are external threads in this case. */
+        ABTI_waitlist_broadcast(p_local, &p_mutex->waitlist);
+    }
+}
+#endif
+
 static inline void ABTI_mutex_unlock_no_recursion(ABTI_local *p_local,
                                                   ABTI_mutex *p_mutex)
 {
 #ifndef ABT_CONFIG_USE_SIMPLE_MUTEX
     ABTD_spinlock_acquire(&p_mutex->waiter_lock);
+    p_mutex->num_handovers = 0;
     ABTD_spinlock_release(&p_mutex->lock);
     /* Operations of waitlist must be done while taking waiter_lock. */
-    ABTI_waitlist_broadcast(p_local, &p_mutex->waitlist);
+    if (!ABTI_waitlist_is_empty(&p_mutex->waitlist))
+        ABTI_mutex_wake_up_waiters(p_local, p_mutex, UINT32_MAX);
     ABTD_spinlock_release(&p_mutex->waiter_lock);
 #else
     ABTD_spinlock_release(&p_mutex->lock);
 #endif
 }
 
+/* This function may switch the context to a waiter, so it may not be called
+ * while holding a spinlock. */
+static inline void
+ABTI_mutex_unlock_handover_no_recursion(ABTI_local **pp_local,
+                                        ABTI_mutex *p_mutex, int handover_kind)
+{
+#ifndef ABT_CONFIG_USE_SIMPLE_MUTEX
+    ABTD_spinlock_acquire(&p_mutex->waiter_lock);
+    if (ABTI_waitlist_is_empty(&p_mutex->waitlist)) {
+        p_mutex->num_handovers = 0;
+        ABTD_spinlock_release(&p_mutex->lock);
+        ABTD_spinlock_release(&p_mutex->waiter_lock);
+        return;
+    }
+    ABTI_ythread *p_self = NULL;
+    ABTI_xstream *p_local_xstream = ABTI_local_get_xstream_or_null(*pp_local);
+    if (!ABTI_IS_EXT_THREAD_ENABLED || p_local_xstream)
+        p_self = ABTI_thread_get_ythread_or_null(p_local_xstream->p_thread);
+    if (p_self && !(p_self->thread.type & ABTI_THREAD_TYPE_MAIN_SCHED)) {
+        ABTI_global *p_global = ABTI_global_get_global();
+        if (handover_kind == ABTI_MUTEX_HANDOVER_SAME_XSTREAM) {
+            ABTI_ythread *p_target = NULL;
+            if (p_mutex->num_handovers < p_global->mutex_max_handovers) {
+                p_target = ABTI_waitlist_remove_ythread(
+                    &p_mutex->waitlist, p_local_xstream, ABT_TRUE,
+                    ABTI_MUTEX_HANDOVER_SEARCH_DEPTH);
+            }
+            if (p_target) {
+                /* Hand over the lock to p_target without releasing it and
+                 * immediately run p_target on this ES.  Since p_target runs
+                 * right now, a busy-waiting work unit on another ES cannot
+                 * prevent the new owner from making progress. */
+                p_mutex->num_handovers++;
+                ABTD_atomic_relaxed_store_ptr(&p_mutex->p_handover,
+                                              (void *)&p_target->thread);
+                ABTD_spinlock_release(&p_mutex->waiter_lock);
+                ABTI_ythread_resume_yield_to(
+                    &p_local_xstream, p_self, p_target,
+                    ABTI_YTHREAD_RESUME_YIELD_TO_KIND_USER,
+                    ABT_SYNC_EVENT_TYPE_MUTEX, (void *)p_mutex);
+                *pp_local = ABTI_xstream_get_local(p_local_xstream);
+                return;
+            }
+        } else {
+            ABTI_ythread *p_target =
+                ABTI_waitlist_remove_ythread(&p_mutex->waitlist,
+                                             p_local_xstream, ABT_FALSE,
+                                             ABTI_MUTEX_HANDOVER_SEARCH_DEPTH);
+            if (p_target) {
+                /* Wake up p_target first.  The lock is released since
+                 * p_target might not be scheduled soon. */
+                p_mutex->num_handovers = 0;
+                ABTD_spinlock_release(&p_mutex->lock);
+                ABTI_ythread_resume_and_push(*pp_local, p_target);
+                ABTI_mutex_wake_up_waiters(*pp_local, p_mutex,
+                                           p_global->mutex_max_wakeups - 1);
+                ABTD_spinlock_release(&p_mutex->waiter_lock);
+                return;
+            }
+        }
+    }
+    /* Give up the mutex.  Woken waiters compete for the lock again. */
+    p_mutex->num_handovers = 0;
+    ABTD_spinlock_release(&p_mutex->lock);
+    ABTI_mutex_wake_up_waiters(*pp_local, p_mutex, UINT32_MAX);
+    ABTD_spinlock_release(&p_mutex->waiter_lock);
+#else
+    (void)handover_kind;
+    ABTI_mutex_unlock_no_recursion(*pp_local, p_mutex);
+#endif
+}
+
 static inline void ABTI_mutex_unlock(ABTI_local *p_local, ABTI_mutex *p_mutex)
 {
     if (p_mutex->attrs & ABTI_MUTEX_ATTR_RECURSIVE) {
@@ -200,4 +316,24 @@ static inline void ABTI_mutex_unlock(ABTI_local *p_local, ABTI_mutex *p_mutex)
     }
 }
 
+static inline void ABTI_mutex_unlock_handover(ABTI_local **pp_local,
+                                              ABTI_mutex *p_mutex,
+                                              int handover_kind)
+{
+    if (p_mutex->attrs & ABTI_MUTEX_ATTR_RECURSIVE) {
+        /* recursive mutex */
+        if (p_mutex->nesting_cnt == 0) {
+            p_mutex->owner_id = 0;
+            ABTI_mutex_unlock_handover_no_recursion(pp_local, p_mutex,
+                                                    handover_kind);
+        } else {
+            p_mutex->nesting_cnt--;
+        }
+    } else {
+        /* unknown attributes */
+        ABTI_mutex_unlock_handover_no_recursion(pp_local, p_mutex,
+                                                handover_kind);
+    }
+}
+
 #endif /* ABTI_MUTEX_H_INCLUDED */
@@ -50,12 +50,29 @@ static inline void ABTI_pool_dec_num_blocked(ABTI_pool *p_pool)
     ABTD_atomic_fetch_sub_int32(&p_pool->num_blocked, 1);
 }
 
+/* Wake up schedulers that are parked on p_pool after num_units work units are
+ * pushed.  Pools on which no scheduler has ever parked skip the barrier. */
+static inline void ABTI_pool_unpark_scheds(ABTI_pool *p_pool, size_t num_units)
+{
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+    if (ABTU_likely(
+            ABTD_atomic_relaxed_load_int32(&p_pool->has_parked_scheds) == 0))
+        return;
+    /* This barrier pairs with the one in ABTI_sched_park(). */
+    ABTD_atomic_full_barrier();
+    if (ABTD_atomic_relaxed_load_int32(&p_pool->num_parked_scheds) > 0) {
+        ABTI_sched_unpark_pool(p_pool, num_units);
+    }
+#endif
+}
+
 static inline void ABTI_pool_push(ABTI_pool *p_pool, ABT_unit unit,
                                   ABT_pool_context context)
 {
     /* Push unit into pool */
     LOG_DEBUG_POOL_PUSH(p_pool, unit);
     p_pool->required_def.p_push(ABTI_pool_get_handle(p_pool), unit, context);
+    ABTI_pool_unpark_scheds(p_pool, 1);
 }
 
 static inline void ABTI_pool_add_thread(ABTI_thread *p_thread,
@@ -116,6 +133,7 @@ static inline void ABTI_pool_push_many(ABTI_pool *p_pool, const ABT_unit *units,
     p_pool->optional_def.p_push_many(ABTI_pool_get_handle(p_pool), units, num,
                                      context);
     LOG_DEBUG_POOL_PUSH_MANY(p_pool, units, num);
+    ABTI_pool_unpark_scheds(p_pool, num);
 }
 
 /* Increase num_scheds to mark the pool as having another scheduler. If the
@@ -141,7 +159,18 @@ static inline ABT_bool ABTI_pool_is_empty(ABTI_pool *p_pool)
 static inline size_t ABTI_pool_get_size(ABTI_pool *p_pool)
 {
     ABTI_UB_ASSERT(p_pool->optional_def.p_get_size);
-    return p_pool->optional_def.p_get_size(ABTI_pool_get_handle(p_pool));
+    size_t size = p_pool->optional_def.p_get_size(ABTI_pool_get_handle(p_pool));
+    /* A scheduler that pops a forked ULT executed by its joiner and the joiner
+     * update num_inlined_forks in any order, so it can be negative for a
+     * while. */
+    int32_t num_inlined_forks =
+        ABTD_atomic_relaxed_load_int32(&p_pool->num_inlined_forks);
+    if (ABTU_unlikely(num_inlined_forks > 0)) {
+        size = (size > (size_t)num_inlined_forks)
+                   ? (size - (size_t)num_inlined_forks)
+                   : 0;
+    }
+    return size;
 }
 
 static inline size_t ABTI_pool_get_total_size(ABTI_pool *p_pool)
@@ -6,8 +6,19 @@
 #ifndef ABTI_RWLOCK_H_INCLUDED
 #define ABTI_RWLOCK_H_INCLUDED
 
-#include "abti_mutex.h"
-#include "abti_cond.h"
+#include "abti_waitlist.h"
+
+/* States of a writer.  Readers can enter the lock only when no writer holds
+ * it or waits for readers to leave. */
+#define ABTI_RWLOCK_WRITER_NONE 0    /* No writer */
+#define ABTI_RWLOCK_WRITER_PENDING 1 /* A writer is waiting for readers */
+#define ABTI_RWLOCK_WRITER_ACTIVE 2  /* A writer holds the lock */
+
+/* Maximum number of reader indicators of a lock.  Each indicator occupies a
+ * cache line and a writer reads all of them, so a lock takes at most
+ * ABTI_RWLOCK_MAX_READER_INDICATORS * ABT_CONFIG_STATIC_CACHELINE_SIZE bytes
+ * for indicators (1 KB with 64-byte cache lines). */
+#define ABTI_RWLOCK_MAX_READER_INDICATORS 16
 
 /* Inlined functions for RWLock */
 
@@ -41,4 +52,168 @@ static inline ABT_rwlock ABTI_rwlock_get_handle(ABTI_rwlock *p_rwlock)
 #endif
 }
 
+ABTU_ret_err static inline int ABTI_rwlock_init(ABTI_rwlock *p_rwlock)
+{
+    /* Prepare one reader indicator per ES so that readers on different ESs do
+     * not touch the same cache line.  As the barrier sizes its leaves, the
+     * number is based on max_xstreams, so a lock created before ESs are created
+     * has enough indicators for them.  The number of indicators is bounded
+     * since a writer needs to check all of them; ESs whose ranks exceed it
+     * share indicators. */
+    ABTI_global *p_global = ABTI_global_get_global();
+    size_t num_reader_indicators = 1;
+    while (num_reader_indicators < (size_t)p_global->max_xstreams &&
+           num_reader_indicators < ABTI_RWLOCK_MAX_READER_INDICATORS)
+        num_reader_indicators *= 2;
+    ABTI_rwlock_reader_indicator *reader_indicators;
+    int abt_errno =
+        ABTU_malloc(sizeof(ABTI_rwlock_reader_indicator) * num_reader_indicators,
+                    (void **)&reader_indicators);
+    ABTI_CHECK_ERROR(abt_errno);
+    size_t i;
+    for (i = 0; i < num_reader_indicators; i++)
+        ABTD_atomic_relaxed_store_size(&reader_indicators[i].num_readers, 0);
+
+    ABTD_atomic_relaxed_store_int(&p_rwlock->writer_state,
+                                  ABTI_RWLOCK_WRITER_NONE);
+    ABTD_spinlock_clear(&p_rwlock->lock);
+    ABTI_waitlist_init(&p_rwlock->reader_waitlist);
+    ABTI_waitlist_init(&p_rwlock->writer_waitlist);
+    ABTI_waitlist_init(&p_rwlock->drain_waitlist);
+    p_rwlock->num_reader_indicators = num_reader_indicators;
+    p_rwlock->reader_indicators = reader_indicators;
+    return ABT_SUCCESS;
+}
+
+static inline void ABTI_rwlock_fini(ABTI_rwlock *p_rwlock)
+{
+    ABTU_free(p_rwlock->reader_indicators);
+}
+
+static inline ABTD_atomic_size *
+ABTI_rwlock_get_reader_indicator(ABTI_local *p_local, ABTI_rwlock *p_rwlock)
+{
+    /* External threads use the first indicator. */
+    size_t rank = 0;
+    ABTI_xstream *p_local_xstream = ABTI_local_get_xstream_or_null(p_local);
+    if (!ABTI_IS_EXT_THREAD_ENABLED || p_local_xstream)
+        rank = (size_t)p_local_xstream->rank;
+    return &p_rwlock
+                ->reader_indicators[rank &
+                                    (p_rwlock->num_reader_indicators - 1)]
+                .num_readers;
+}
+
+static inline size_t ABTI_rwlock_get_num_readers(ABTI_rwlock *p_rwlock)
+{
+    size_t i, num_readers = 0;
+    for (i = 0; i < p_rwlock->num_reader_indicators; i++) {
+        num_readers += ABTD_atomic_acquire_load_size(
+            &p_rwlock->reader_indicators[i].num_readers);
+    }
+    return num_readers;
+}
+
+static inline void ABTI_rwlock_reader_leave(ABTI_local *p_local,
+                                            ABTI_rwlock *p_rwlock)
+{
+    ABTD_atomic_fetch_sub_size(ABTI_rwlock_get_reader_indicator(p_local,
+                                                                p_rwlock),
+                               1);
+    /* Either this reader sees a pending writer or the writer sees that this
+     * reader has left.  See ABTI_rwlock_wrlock(). */
+    ABTD_atomic_full_barrier();
+    if (ABTD_atomic_relaxed_load_int(&p_rwlock->writer_state) ==
+        ABTI_RWLOCK_WRITER_PENDING) {
+        /* This might be the last reader that the writer is waiting for. */
+        ABTD_spinlock_acquire(&p_rwlock->lock);
+        if (!ABTI_waitlist_is_empty(&p_rwlock->drain_waitlist) &&
+            ABTI_rwlock_get_num_readers(p_rwlock) == 0) {
+            ABTI_waitlist_signal(p_local, &p_rwlock->drain_waitlist);
+        }
+        ABTD_spinlock_release(&p_rwlock->lock);
+    }
+}
+
+static inline void ABTI_rwlock_rdlock(ABTI_local **pp_local,
+                                      ABTI_rwlock *p_rwlock)
+{
+    /* Fast path: increment the reader indicator of this ES. */
+    ABTD_atomic_fetch_add_size(ABTI_rwlock_get_reader_indicator(*pp_local,
+                                                                p_rwlock),
+                               1);
+    ABTD_atomic_full_barrier();
+    if (ABTD_atomic_acquire_load_int(&p_rwlock->writer_state) ==
+        ABTI_RWLOCK_WRITER_NONE)
+        return;
+
+    /* Slow path: a writer holds the lock or is waiting for readers.  Leave
+     * the lock and wait for the writer. */
+    ABTI_rwlock_reader_leave(*pp_local, p_rwlock);
+    ABTD_spinlock_acquire(&p_rwlock->lock);
+    while (ABTD_atomic_relaxed_load_int(&p_rwlock->writer_state) !=
+           ABTI_RWLOCK_WRITER_NONE) {
+        ABTI_waitlist_wait_and_unlock(pp_local, &p_rwlock->reader_waitlist,
+                                      &p_rwlock->lock,
+                                      ABT_SYNC_EVENT_TYPE_RWLOCK,
+                                      (void *)p_rwlock);
+        ABTD_spinlock_acquire(&p_rwlock->lock);
+    }
+    /* No writer can change writer_state while this reader holds the lock. */
+    ABTD_atomic_fetch_add_size(ABTI_rwlock_get_reader_indicator(*pp_local,
+                                                                p_rwlock),
+                               1);
+    ABTD_spinlock_release(&p_rwlock->lock);
+}
+
+static inline void ABTI_rwlock_wrlock(ABTI_local **pp_local,
+                                      ABTI_rwlock *p_rwlock)
+{
+    ABTD_spinlock_acquire(&p_rwlock->lock);
+    while (ABTD_atomic_relaxed_load_int(&p_rwlock->writer_state) !=
+           ABTI_RWLOCK_WRITER_NONE) {
+        ABTI_waitlist_wait_and_unlock(pp_local, &p_rwlock->writer_waitlist,
+                                      &p_rwlock->lock,
+                                      ABT_SYNC_EVENT_TYPE_RWLOCK,
+                                      (void *)p_rwlock);
+        ABTD_spinlock_acquire(&p_rwlock->lock);
+    }
+    /* Stop new readers and wait for the current readers to leave. */
+    ABTD_atomic_relaxed_store_int(&p_rwlock->writer_state,
+                                  ABTI_RWLOCK_WRITER_PENDING);
+    ABTD_atomic_full_barrier();
+    while (ABTI_rwlock_get_num_readers(p_rwlock) != 0) {
+        ABTI_waitlist_wait_and_unlock(pp_local, &p_rwlock->drain_waitlist,
+                                      &p_rwlock->lock,
+                                      ABT_SYNC_EVENT_TYPE_RWLOCK,
+                                      (void *)p_rwlock);
+        ABTD_spinlock_acquire(&p_rwlock->lock);
+    }
+    ABTD_atomic_relaxed_store_int(&p_rwlock->writer_state,
+                                  ABTI_RWLOCK_WRITER_ACTIVE);
+    ABTD_spinlock_release(&p_rwlock->lock);
+}
+
+static inline void ABTI_rwlock_unlock(ABTI_local *p_local,
+                                      ABTI_rwlock *p_rwlock)
+{
+    /* No reader holds the lock while a writer is active, so the caller is the
+     * writer if writer_state is ABTI_RWLOCK_WRITER_ACTIVE. */
+    if (ABTD_atomic_relaxed_load_int(&p_rwlock->writer_state) ==
+        ABTI_RWLOCK_WRITER_ACTIVE) {
+        ABTD_spinlock_acquire(&p_rwlock->lock);
+        ABTD_atomic_release_store_int(&p_rwlock->writer_state,
+                                      ABTI_RWLOCK_WRITER_NONE);
+        /* Wake up all the waiting readers and one waiting writer.  The
+         * detached readers are resumed outside the critical section. */
+        ABTI_thread *p_readers =
+            ABTI_waitlist_detach_all(&p_rwlock->reader_waitlist);
+        ABTI_waitlist_signal(p_local, &p_rwlock->writer_waitlist);
+        ABTD_spinlock_release(&p_rwlock->lock);
+        ABTI_ythread_resume_and_push_list(p_local, p_readers);
+    } else {
+        ABTI_rwlock_reader_leave(p_local, p_rwlock);
+    }
+}
+
 #endif /* ABTI_RWLOCK_H_INCLUDED */
@@ -67,6 +67,49 @@ static inline void ABTI_sched_unset_request(ABTI_sched *p_sched, uint32_t req)
     ABTD_atomic_fetch_and_uint32(&p_sched->request, ~req);
 }
 
+/* Adaptive idle policy of the predefined schedulers.  When a scheduler finds
+ * no work unit, it first spins with exponential backoff, then yields the
+ * underlying Pthread, and finally parks the ES until a work unit is pushed to
+ * one of its pools.  If ABT_SCHED_PARK is disabled or the active wait policy
+ * is used, an idle scheduler just keeps polling its pools.  idle_count is the
+ * number of consecutive unsuccessful scheduling attempts; the caller must
+ * reset it to 0 after running a work unit.  If ABT_CONFIG_USE_SCHED_SLEEP is
+ * set, SCHED_SLEEP() is used instead. */
+#define ABTI_SCHED_IDLE_SPIN_ROUNDS 10 /* 1 + 2 + ... + 512 pauses */
+#define ABTI_SCHED_IDLE_YIELD_ROUNDS 16
+#define ABTI_SCHED_PARK_TIMEOUT_SEC 0.1
+
+static inline void ABTI_sched_idle(ABTI_global *p_global, ABTI_sched *p_sched,
+                                   uint32_t *p_idle_count)
+{
+#if !defined(ABT_CONFIG_USE_SCHED_SLEEP) &&                                    \
+    !defined(ABT_CONFIG_ACTIVE_WAIT_POLICY)
+    if (!p_global->sched_park)
+        return;
+    uint32_t idle_count = (*p_idle_count)++;
+    if (idle_count < ABTI_SCHED_IDLE_SPIN_ROUNDS) {
+        uint32_t i, num_pauses = 1u << idle_count;
+        for (i = 0; i < num_pauses; i++)
+            ABTD_atomic_pause();
+    } else if (idle_count <
+               ABTI_SCHED_IDLE_SPIN_ROUNDS + ABTI_SCHED_IDLE_YIELD_ROUNDS) {
+        sched_yield();
+    } else {
+        /* A scheduler in a pool may not block its parent scheduler. */
+        if (p_sched->used == ABTI_SCHED_MAIN) {
+            ABTI_sched_park(p_sched);
+        } else {
+            sched_yield();
+        }
+        *p_idle_count = ABTI_SCHED_IDLE_SPIN_ROUNDS;
+    }
+#else
+    ABTI_UNUSED(p_global);
+    ABTI_UNUSED(p_sched);
+    ABTI_UNUSED(p_idle_count);
+#endif
+}
+
 #ifdef ABT_CONFIG_USE_SCHED_SLEEP
 #define CNT_DECL(c) int c
 #define CNT_INIT(c, v) c = v
@@ -50,4 +50,26 @@ static inline ABTI_local *ABTI_xstream_get_local(ABTI_xstream *p_xstream)
     return (ABTI_local *)p_xstream;
 }
 
+static inline void ABTI_id_block_init(ABTI_id_block *p_block)
+{
+    p_block->next = 0;
+    p_block->end = 0;
+}
+
+/* Get a new ID.  An ES takes ABTI_ID_BLOCK_SIZE IDs from the global ID counter
+ * p_counter at once and keeps them in p_block, so IDs are unique but not
+ * sequential.  An external thread (p_block == NULL) takes a single ID. */
+static inline uint64_t ABTI_id_block_get_new_id(ABTI_id_block *p_block,
+                                                ABTD_atomic_uint64 *p_counter)
+{
+    if (!p_block)
+        return ABTD_atomic_fetch_add_uint64(p_counter, 1);
+    if (ABTU_unlikely(p_block->next == p_block->end)) {
+        p_block->next =
+            ABTD_atomic_fetch_add_uint64(p_counter, ABTI_ID_BLOCK_SIZE);
+        p_block->end = p_block->next + ABTI_ID_BLOCK_SIZE;
+    }
+    return p_block->next++;
+}
+
 #endif /* ABTI_XSTREAM_H_INCLUDED */
@@ -79,17 +79,37 @@ static inline void ABTI_thread_unset_request(ABTI_thread *p_thread,
 #define ABTI_THREAD_HANDLE_REQUEST_NONE ((int)0x0)
 #define ABTI_THREAD_HANDLE_REQUEST_CANCELLED ((int)0x1)
 #define ABTI_THREAD_HANDLE_REQUEST_MIGRATED ((int)0x2)
+#define ABTI_THREAD_HANDLE_REQUEST_FORK_INLINED ((int)0x4)
 
 static inline int ABTI_thread_handle_request(ABTI_thread *p_thread,
                                              ABT_bool allow_termination)
 {
 #if defined(ABT_CONFIG_DISABLE_CANCELLATION) &&                                \
     defined(ABT_CONFIG_DISABLE_MIGRATION)
+    /* Only a forked ULT can have a request. */
+    if (ABTU_likely(!(p_thread->type & ABTI_THREAD_TYPE_FORK)))
+        return ABTI_THREAD_HANDLE_REQUEST_NONE;
+#endif
+    uint32_t request = ABTD_atomic_acquire_load_uint32(&p_thread->request);
+
+    /* Check fork request.  A forked ULT might have been executed by its
+     * joiner while it was in a pool. */
+    if (ABTU_unlikely(request & (ABTI_THREAD_REQ_FORK |
+                                 ABTI_THREAD_REQ_FORK_INLINED))) {
+        if (ABTI_thread_handle_request_fork(ABTI_global_get_global(),
+                                            ABTI_local_get_local(),
+                                            p_thread)) {
+            return ABTI_THREAD_HANDLE_REQUEST_FORK_INLINED;
+        }
+        request = ABTD_atomic_acquire_load_uint32(&p_thread->request);
+    }
+
+#if defined(ABT_CONFIG_DISABLE_CANCELLATION) &&                                \
+    defined(ABT_CONFIG_DISABLE_MIGRATION)
+    ABTI_UNUSED(allow_termination);
     return ABTI_THREAD_HANDLE_REQUEST_NONE;
 #else
     /* At least either cancellation or migration is enabled. */
-    const uint32_t request =
-        ABTD_atomic_acquire_load_uint32(&p_thread->request);
 
     /* Check cancellation request. */
 #ifndef ABT_CONFIG_DISABLE_CANCELLATION
@@ -45,6 +45,7 @@ static inline void ABTI_thread_attr_init(ABTI_thread_attr *p_attr,
 {
     p_attr->p_stack = p_stack;
     p_attr->stacksize = stacksize;
+    p_attr->lazy_stack = ABT_FALSE;
 #ifndef ABT_CONFIG_DISABLE_MIGRATION
     p_attr->migratable = migratable;
     p_attr->f_cb = NULL;
@@ -243,40 +243,109 @@ static inline void ABTI_waitlist_signal(ABTI_local *p_local,
     }
 }
 
-static inline void ABTI_waitlist_broadcast(ABTI_local *p_local,
-                                           ABTI_waitlist *p_waitlist)
+/* Remove at most num waiters from the head of p_waitlist.  Non-yieldable
+ * waiters are woken up immediately while yieldable ones are returned as a list
+ * linked by p_next, which must be resumed by
+ * ABTI_ythread_resume_and_push_list().  The returned ULTs are kept blocked
+ * until then, so the caller may release the lock that protects p_waitlist
+ * before resuming them. */
+static inline ABTI_thread *ABTI_waitlist_detach_many(ABTI_waitlist *p_waitlist,
+                                                     uint32_t num)
 {
     ABTI_thread *p_thread = p_waitlist->p_head;
-    if (p_thread) {
-        ABT_bool wakeup_nonyieldable = ABT_FALSE;
-        do {
-            ABTI_thread *p_next = p_thread->p_next;
-            p_thread->p_next = NULL;
+    ABTI_thread *p_ythreads_head = NULL, *p_ythreads_tail = NULL;
+    ABT_bool wakeup_nonyieldable = ABT_FALSE;
+    while (p_thread && num > 0) {
+        ABTI_thread *p_next = p_thread->p_next;
+        p_thread->p_next = NULL;
 
-            ABTI_ythread *p_ythread = ABTI_thread_get_ythread_or_null(p_thread);
-            if (p_ythread) {
-                ABTI_ythread_resume_and_push(p_local, p_ythread);
+        if (ABTI_thread_get_ythread_or_null(p_thread)) {
+            if (p_ythreads_tail) {
+                p_ythreads_tail->p_next = p_thread;
             } else {
-                /* When p_thread is an external thread or a tasklet */
-                wakeup_nonyieldable = ABT_TRUE;
-                ABTD_atomic_release_store_int(&p_thread->state,
-                                              ABT_THREAD_STATE_READY);
+                p_ythreads_head = p_thread;
             }
-            /* After updating p_thread->state, p_thread can be updated and
-             * freed. */
-            p_thread = p_next;
-        } while (p_thread);
-        p_waitlist->p_head = NULL;
+            p_ythreads_tail = p_thread;
+        } else {
+            /* When p_thread is an external thread or a tasklet */
+            wakeup_nonyieldable = ABT_TRUE;
+            ABTD_atomic_release_store_int(&p_thread->state,
+                                          ABT_THREAD_STATE_READY);
+        }
+        /* After updating p_thread->state, p_thread can be updated and
+         * freed. */
+        p_thread = p_next;
+        num--;
+    }
+    p_waitlist->p_head = p_thread;
+    if (!p_thread)
         p_waitlist->p_tail = NULL;
 #ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
-        if (wakeup_nonyieldable) {
-            ABTD_futex_broadcast(&p_waitlist->futex);
-        }
+    if (wakeup_nonyieldable) {
+        ABTD_futex_broadcast(&p_waitlist->futex);
+    }
 #else
-        /* Do nothing. */
-        (void)wakeup_nonyieldable;
+    /* Do nothing. */
+    (void)wakeup_nonyieldable;
 #endif
+    return p_ythreads_head;
+}
+
+/* Remove all the waiters from p_waitlist.  See ABTI_waitlist_detach_many(). */
+static inline ABTI_thread *ABTI_waitlist_detach_all(ABTI_waitlist *p_waitlist)
+{
+    return ABTI_waitlist_detach_many(p_waitlist, UINT32_MAX);
+}
+
+static inline void ABTI_waitlist_broadcast(ABTI_local *p_local,
+                                           ABTI_waitlist *p_waitlist)
+{
+    ABTI_ythread_resume_and_push_list(p_local,
+                                      ABTI_waitlist_detach_all(p_waitlist));
+}
+
+/* Wake up at most num waiters from the head of p_waitlist. */
+static inline void ABTI_waitlist_signal_many(ABTI_local *p_local,
+                                             ABTI_waitlist *p_waitlist,
+                                             uint32_t num)
+{
+    ABTI_ythread_resume_and_push_list(p_local,
+                                      ABTI_waitlist_detach_many(p_waitlist,
+                                                                num));
+}
+
+/* Remove a ULT that has last run on p_xstream (or on an ES other than
+ * p_xstream if is_same_xstream is ABT_FALSE) from the first max_depth waiters
+ * of p_waitlist without resuming it.  A main scheduler is never removed.  NULL
+ * is returned if no such ULT is found.  This function does not support waiters
+ * that use p_prev. */
+static inline ABTI_ythread *
+ABTI_waitlist_remove_ythread(ABTI_waitlist *p_waitlist, ABTI_xstream *p_xstream,
+                             ABT_bool is_same_xstream, uint32_t max_depth)
+{
+    ABTI_thread *p_prev = NULL, *p_thread = p_waitlist->p_head;
+    for (; p_thread && max_depth > 0;
+         p_prev = p_thread, p_thread = p_thread->p_next, max_depth--) {
+        /* A dummy thread of a non-yieldable waiter is not initialized except
+         * for type and state, so check the type first. */
+        if (!(p_thread->type & ABTI_THREAD_TYPE_YIELDABLE) ||
+            (p_thread->type & ABTI_THREAD_TYPE_MAIN_SCHED))
+            continue;
+        if (((p_thread->p_last_xstream == p_xstream) ? ABT_TRUE : ABT_FALSE) ==
+            is_same_xstream) {
+            /* Remove p_thread. */
+            if (p_prev) {
+                p_prev->p_next = p_thread->p_next;
+            } else {
+                p_waitlist->p_head = p_thread->p_next;
+            }
+            if (p_waitlist->p_tail == p_thread)
+                p_waitlist->p_tail = p_prev;
+            p_thread->p_next = NULL;
+            return ABTI_thread_get_ythread(p_thread);
+        }
     }
+    return NULL;
 }
 
 static inline ABT_bool ABTI_waitlist_is_empty(ABTI_waitlist *p_waitlist)
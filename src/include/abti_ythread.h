@@ -62,6 +62,80 @@ static inline void ABTI_ythread_resume_and_push(ABTI_local *p_local,
     ABTI_pool_dec_num_blocked(p_pool);
 }
 
+/* Push a forked ULT that p_ythread has kept to itself (see ABT_thread_fork()).
+ * This must be called before p_ythread stops running since other ULTs can
+ * neither steal nor inline the forked ULT until it is pushed. */
+static inline void ABTI_ythread_push_deferred_fork(ABTI_ythread *p_ythread)
+{
+    ABTI_thread *p_thread = p_ythread->p_deferred_fork;
+    if (ABTU_unlikely(p_thread)) {
+        p_ythread->p_deferred_fork = NULL;
+        /* Other requests (e.g., cancellation) might have been made. */
+        ABTD_atomic_fetch_and_uint32(&p_thread->request,
+                                     ~ABTI_THREAD_REQ_FORK_DEFERRED);
+        ABTI_pool_push(p_thread->p_pool, p_thread->unit,
+                       ABT_POOL_CONTEXT_OP_THREAD_CREATE);
+    }
+}
+
+#define ABTI_YTHREAD_RESUME_MANY_BUFFER_SIZE 64
+
+/* Resume all the ULTs in a list linked by p_next.  ULTs associated with the
+ * same pool are pushed at once if the pool supports push_many. */
+static inline void ABTI_ythread_resume_and_push_list(ABTI_local *p_local,
+                                                     ABTI_thread *p_head)
+{
+    ABT_unit units[ABTI_YTHREAD_RESUME_MANY_BUFFER_SIZE];
+    ABTI_thread *p_caller = ABTI_local_get_xstream_or_null(p_local)
+                                ? ABTI_local_get_xstream(p_local)->p_thread
+                                : NULL;
+    while (p_head) {
+        /* Take ULTs of the same pool as the head from the list.  They must be
+         * removed from the list before being pushed since p_next of a pushed
+         * ULT can be updated by others. */
+        ABTI_pool *p_pool = p_head->p_pool;
+        ABTI_thread *p_prev = NULL, *p_thread = p_head;
+        size_t num_units = 0;
+        while (p_thread && num_units < ABTI_YTHREAD_RESUME_MANY_BUFFER_SIZE) {
+            ABTI_thread *p_next = p_thread->p_next;
+            if (p_thread->p_pool == p_pool) {
+                ABTI_ythread *p_ythread = ABTI_thread_get_ythread(p_thread);
+                /* The ULT must be in BLOCKED state. */
+                ABTI_ASSERT(ABTD_atomic_acquire_load_int(&p_thread->state) ==
+                            ABT_THREAD_STATE_BLOCKED);
+                ABTI_event_ythread_resume(p_local, p_ythread, p_caller);
+                if (p_prev) {
+                    p_prev->p_next = p_next;
+                } else {
+                    p_head = p_next;
+                }
+                p_thread->p_next = NULL;
+                /* The relaxed version is used since the state is synchronized
+                 * by the following pool operation. */
+                ABTD_atomic_relaxed_store_int(&p_thread->state,
+                                              ABT_THREAD_STATE_READY);
+                units[num_units++] = p_thread->unit;
+            } else {
+                p_prev = p_thread;
+            }
+            p_thread = p_next;
+        }
+        /* p_pool is loaded before the ULTs are pushed to keep num_blocked
+         * consistent.  See ABTI_ythread_resume_and_push(). */
+        if (num_units > 1 && p_pool->optional_def.p_push_many) {
+            ABTI_pool_push_many(p_pool, units, num_units,
+                                ABT_POOL_CONTEXT_OP_THREAD_RESUME);
+        } else {
+            size_t i;
+            for (i = 0; i < num_units; i++) {
+                ABTI_pool_push(p_pool, units[i],
+                               ABT_POOL_CONTEXT_OP_THREAD_RESUME);
+            }
+        }
+        ABTD_atomic_fetch_sub_int32(&p_pool->num_blocked, (int32_t)num_units);
+    }
+}
+
 static inline ABTI_ythread *
 ABTI_ythread_context_get_ythread(ABTD_ythread_context *p_ctx)
 {
@@ -147,6 +221,7 @@ static inline void
 ABTI_ythread_switch_to_child_internal(ABTI_xstream **pp_local_xstream,
                                       ABTI_ythread *p_old, ABTI_ythread *p_new)
 {
+    ABTI_ythread_push_deferred_fork(p_old);
     p_new->thread.p_parent = &p_old->thread;
     ABTI_xstream *p_local_xstream = *pp_local_xstream;
     ABTI_event_thread_run(p_local_xstream, &p_new->thread, &p_old->thread,
@@ -164,6 +239,7 @@ ABTI_ythread_jump_to_sibling_internal(ABTI_xstream *p_local_xstream,
                                       ABTI_ythread *p_old, ABTI_ythread *p_new,
                                       void (*f_cb)(void *), void *cb_arg)
 {
+    ABTI_ythread_push_deferred_fork(p_old);
     p_new->thread.p_parent = p_old->thread.p_parent;
     ABTI_event_thread_run(p_local_xstream, &p_new->thread, &p_old->thread,
                           p_new->thread.p_parent);
@@ -177,6 +253,7 @@ static inline void ABTI_ythread_switch_to_sibling_internal(
     ABTI_xstream **pp_local_xstream, ABTI_ythread *p_old, ABTI_ythread *p_new,
     void (*f_cb)(void *), void *cb_arg)
 {
+    ABTI_ythread_push_deferred_fork(p_old);
     p_new->thread.p_parent = p_old->thread.p_parent;
     ABTI_xstream *p_local_xstream = *pp_local_xstream;
     ABTI_event_thread_run(p_local_xstream, &p_new->thread, &p_old->thread,
@@ -195,6 +272,7 @@ ABTI_ythread_jump_to_parent_internal(ABTI_xstream *p_local_xstream,
                                      ABTI_ythread *p_old, void (*f_cb)(void *),
                                      void *cb_arg)
 {
+    ABTI_ythread_push_deferred_fork(p_old);
     ABTI_ythread *p_new = ABTI_thread_get_ythread(p_old->thread.p_parent);
     p_local_xstream->p_thread = &p_new->thread;
     ABTI_ASSERT(p_new->thread.p_last_xstream == p_local_xstream);
@@ -207,6 +285,7 @@ ABTI_ythread_switch_to_parent_internal(ABTI_xstream **pp_local_xstream,
                                        ABTI_ythread *p_old,
                                        void (*f_cb)(void *), void *cb_arg)
 {
+    ABTI_ythread_push_deferred_fork(p_old);
     ABTI_ythread *p_new = ABTI_thread_get_ythread(p_old->thread.p_parent);
     ABTI_xstream *p_local_xstream = *pp_local_xstream;
     p_local_xstream->p_thread = &p_new->thread;
@@ -530,6 +609,7 @@ ABTI_ythread_exit_to(ABTI_xstream *p_local_xstream, ABTI_ythread *p_self,
 ABTU_noreturn static inline void ABTI_ythread_exit_to_primary(
     ABTI_global *p_global, ABTI_xstream *p_local_xstream, ABTI_ythread *p_self)
 {
+    ABTI_ythread_push_deferred_fork(p_self);
     /* No need to call a callback function. */
     ABTI_ythread *p_primary = p_global->p_primary_ythread;
     p_local_xstream->p_thread = &p_primary->thread;
@@ -696,6 +776,9 @@ static inline void ABTI_ythread_schedule(ABTI_global *p_global,
     } else if (request_op == ABTI_THREAD_HANDLE_REQUEST_MIGRATED) {
         /* If p_thread is migrated, let's push p_thread back to its pool. */
         ABTI_pool_add_thread(p_thread, ABT_POOL_CONTEXT_OP_THREAD_MIGRATE);
+    } else if (request_op == ABTI_THREAD_HANDLE_REQUEST_FORK_INLINED) {
+        /* If p_thread has been executed by its joiner, there's nothing to do.
+         */
     }
 }
 
@@ -327,6 +327,19 @@ void ABTU_free_largepage(void *ptr, size_t size, ABTU_MEM_LARGEPAGE_TYPE type);
  * (PROT_READ | PROT_WRITE) is permitted if if protect == ABT_FALSE. */
 ABTU_ret_err int ABTU_mprotect(void *addr, size_t size, ABT_bool protect);
 
+/* Release physical memory of pages in [addr, addr + size).  addr and size must
+ * be multiples of the system page size.  If lazy is ABT_TRUE, MADV_FREE is
+ * used if available so that the OS reclaims them only under memory pressure.
+ * The contents of the pages are undefined after this call. */
+ABTU_ret_err int ABTU_release_pages(void *addr, size_t size, ABT_bool lazy);
+/* Count resident pages in [addr, addr + size) and return the address of the
+ * lowest resident page (NULL if no page is resident).  addr and size must be
+ * multiples of page_size, which must be the system page size. */
+ABTU_ret_err int ABTU_get_resident_pages(void *addr, size_t size,
+                                         size_t page_size,
+                                         size_t *p_num_pages,
+                                         void **p_lowest_page);
+
 /* String-to-integer functions. */
 ABTU_ret_err int ABTU_atoi(const char *str, int *p_val, ABT_bool *p_overflow);
 ABTU_ret_err int ABTU_atoui32(const char *str, uint32_t *p_val,
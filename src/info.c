@@ -552,6 +552,58 @@ int ABT_info_print_all_xstreams(FILE *fp)
     return ABT_SUCCESS;
 }
 
+/**
+ * @ingroup INFO
+ * @brief   Print the statistics of memory pools.
+ *
+ * \c ABT_info_print_mem_pool() writes the statistics of the global memory pools
+ * of ULT stacks and work-unit descriptors to the output stream \c fp.  If
+ * \c ABT_MEM_NUMA_AWARE is enabled and the CPU affinity is set, Argobots has a
+ * separate global memory pool per NUMA node, and each execution stream uses the
+ * memory pool of the NUMA node to which it is bound.
+ *
+ * The statistics are read without any synchronization, so they might be
+ * inconsistent if work units are being created or freed.
+ *
+ * @note
+ * \DOC_NOTE_INFO_PRINT
+ *
+ * @contexts
+ * \DOC_V1X \DOC_CONTEXT_INIT \DOC_CONTEXT_NOCTXSWITCH\n
+ * \DOC_V20 \DOC_CONTEXT_ANY \DOC_CONTEXT_NOCTXSWITCH
+ *
+ * @errors
+ * \DOC_ERROR_SUCCESS
+ * \DOC_V1X \DOC_ERROR_UNINITIALIZED
+ *
+ * @undefined
+ * \DOC_UNDEFINED_NULL_PTR{\c fp}
+ * \DOC_UNDEFINED_SYS_FILE{\c fp}
+ *
+ * @param[in] fp  output stream
+ * @return Error code
+ */
+int ABT_info_print_mem_pool(FILE *fp)
+{
+    ABTI_UB_ASSERT(fp);
+
+    ABTI_global *p_global;
+#ifndef ABT_CONFIG_ENABLE_VER_20_API
+    /* Argobots 1.x always requires an init check. */
+    ABTI_SETUP_GLOBAL(&p_global);
+#else
+    p_global = ABTI_global_get_global_or_null();
+    if (!p_global) {
+        fprintf(fp, "Argobots is not initialized.\n");
+        fflush(fp);
+        return ABT_SUCCESS;
+    }
+#endif
+    ABTI_mem_print(p_global, fp, 0);
+    fflush(fp);
+    return ABT_SUCCESS;
+}
+
 /**
  * @ingroup INFO
  * @brief   Print the information of an execution stream.
@@ -1192,6 +1244,12 @@ void ABTI_info_print_config(ABTI_global *p_global, FILE *fp)
             p_global->thread_stacksize / 1024);
     fprintf(fp, " - default scheduler stack size: %zu KB\n",
             p_global->sched_stacksize / 1024);
+    if (p_global->stack_growable) {
+        fprintf(fp, " - growable stacks: yes (commit %zu KB)\n",
+                p_global->stack_commit_size / 1024);
+    } else {
+        fprintf(fp, " - growable stacks: no\n");
+    }
     fprintf(fp, " - default scheduler event check frequency: %u\n",
             p_global->sched_event_freq);
     fprintf(fp, " - default scheduler sleep: "
@@ -1203,6 +1261,10 @@ void ABTI_info_print_config(ABTI_global *p_global, FILE *fp)
                 "\n");
     fprintf(fp, " - default scheduler sleep duration : %" PRIu64 " [ns]\n",
             p_global->sched_sleep_nsec);
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+    fprintf(fp, " - park idle schedulers: %s\n",
+            p_global->sched_park == ABT_TRUE ? "yes" : "no");
+#endif
 
     fprintf(fp, " - timer function: "
 #if defined(ABT_CONFIG_USE_CLOCK_GETTIME)
@@ -1221,6 +1283,33 @@ void ABTI_info_print_config(ABTI_global *p_global, FILE *fp)
     fprintf(fp, " - stack page size: %zu KB\n", p_global->mem_sp_size / 1024);
     fprintf(fp, " - max. # of stacks per ES: %u\n", p_global->mem_max_stacks);
     fprintf(fp, " - max. # of descs per ES: %u\n", p_global->mem_max_descs);
+    fprintf(fp, " - max. # of buckets per ES: %u\n",
+            p_global->mem_max_local_buckets);
+    fprintf(fp, " - stack size classes:");
+    if (p_global->mem_num_stack_classes == 0) {
+        fprintf(fp, " none");
+    } else {
+        int i;
+        for (i = 0; i < p_global->mem_num_stack_classes; i++) {
+            fprintf(fp, " %zu", p_global->mem_stack_classes[i]);
+        }
+    }
+    fprintf(fp, "\n");
+    switch (p_global->mem_stack_reclaim) {
+        case ABTI_MEM_STACK_RECLAIM_FREE:
+            fprintf(fp, " - stack reclamation: MADV_FREE (keep %zu KB)\n",
+                    p_global->mem_stack_reclaim_keep_size / 1024);
+            break;
+        case ABTI_MEM_STACK_RECLAIM_DONTNEED:
+            fprintf(fp, " - stack reclamation: MADV_DONTNEED (keep %zu KB)\n",
+                    p_global->mem_stack_reclaim_keep_size / 1024);
+            break;
+        default:
+            fprintf(fp, " - stack reclamation: none\n");
+            break;
+    }
+    fprintf(fp, " - # of NUMA-aware global pools: %d\n",
+            p_global->mem_num_numa_nodes);
     switch (p_global->mem_lp_alloc) {
         case ABTI_MEM_LP_MALLOC:
             fprintf(fp, " - large page allocation: malloc\n");
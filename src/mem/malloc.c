@@ -13,6 +13,70 @@
  * global data.  When ABTI_finalize is called, all memory objects that we have
  * allocated are returned to the higher-level memory allocator. */
 
+static void mem_destroy_global_pools(ABTI_global *p_global)
+{
+    int i;
+    for (i = 0; i < p_global->mem_num_numa_nodes; i++) {
+        ABTI_mem_pool_destroy_global_pool(&p_global->mem_pool_stacks[i]);
+        ABTI_mem_pool_destroy_global_pool(&p_global->mem_pool_descs[i]);
+    }
+    for (i = 0; i < p_global->mem_num_stack_classes *
+                        p_global->mem_num_numa_nodes;
+         i++) {
+        ABTI_mem_pool_destroy_global_pool(
+            &p_global->mem_pool_stack_classes[i]);
+    }
+    ABTU_free(p_global->mem_pool_stacks);
+    ABTU_free(p_global->mem_pool_descs);
+    ABTU_free(p_global->mem_pool_stack_classes);
+}
+
+/* Return the stack that p_local_xstream keeps for lazy-stack ULTs to its pool.
+ */
+static void mem_return_stack_cache(ABTI_xstream *p_local_xstream)
+{
+    if (p_local_xstream->p_stack_cache) {
+        ABTI_mem_pool_free(&p_local_xstream->mem_pool_stack,
+                           p_local_xstream->p_stack_cache);
+        p_local_xstream->p_stack_cache = NULL;
+    }
+}
+
+static size_t mem_get_stack_header_size(size_t stacksize)
+{
+    size_t header_size =
+        ABTU_roundup_size(stacksize + sizeof(ABTI_ythread),
+                          ABT_CONFIG_STATIC_CACHELINE_SIZE);
+    if ((header_size & (2 * ABT_CONFIG_STATIC_CACHELINE_SIZE - 1)) == 0) {
+        /* Avoid a multiple of 2 * cacheline size to avoid cache bank conflict.
+         */
+        header_size += ABT_CONFIG_STATIC_CACHELINE_SIZE;
+    }
+    return header_size;
+}
+
+/* Set the size of the protected part of each stack.  A growable stack is
+ * protected except for its top stack_commit_size bytes; the protected part
+ * starts at the first page boundary of the stack. */
+static void
+mem_set_stack_mprotect_size(const ABTI_global *p_global, size_t stacksize,
+                            ABTI_mem_pool_global_pool_mprotect_config *p_config)
+{
+    if (!p_config->enabled)
+        return;
+    const size_t page_size = p_global->sys_page_size;
+    if (p_global->stack_growable &&
+        stacksize >= p_global->stack_commit_size + page_size * 2) {
+        p_config->page_size =
+            (stacksize - p_global->stack_commit_size - page_size) / page_size *
+            page_size;
+        p_config->growable = ABT_TRUE;
+    } else {
+        p_config->page_size = page_size;
+        p_config->growable = ABT_FALSE;
+    }
+}
+
 ABTU_ret_err int ABTI_mem_init(ABTI_global *p_global)
 {
     int num_requested_types = 0;
@@ -47,9 +111,7 @@ ABTU_ret_err int ABTI_mem_init(ABTI_global *p_global)
     size_t thread_stacksize = p_global->thread_stacksize;
     ABTI_ASSERT((thread_stacksize & (ABT_CONFIG_STATIC_CACHELINE_SIZE - 1)) ==
                 0);
-    size_t stacksize =
-        ABTU_roundup_size(thread_stacksize + sizeof(ABTI_ythread),
-                          ABT_CONFIG_STATIC_CACHELINE_SIZE);
+    size_t stacksize = mem_get_stack_header_size(thread_stacksize);
     ABTI_mem_pool_global_pool_mprotect_config mprotect_config;
     if (p_global->stack_guard_kind == ABTI_STACK_GUARD_MPROTECT ||
         p_global->stack_guard_kind == ABTI_STACK_GUARD_MPROTECT_STRICT) {
@@ -61,48 +123,124 @@ ABTU_ret_err int ABTI_mem_init(ABTI_global *p_global)
         mprotect_config.offset = 0;
         mprotect_config.page_size = p_global->sys_page_size;
         mprotect_config.alignment = p_global->sys_page_size;
+        mprotect_config.growable = ABT_FALSE;
     } else {
         mprotect_config.enabled = ABT_FALSE;
+        mprotect_config.growable = ABT_FALSE;
+    }
+    ABTI_mem_pool_global_pool_reclaim_config reclaim_config;
+    if (p_global->mem_stack_reclaim != ABTI_MEM_STACK_RECLAIM_NONE) {
+        reclaim_config.enabled = ABT_TRUE;
+        reclaim_config.lazy =
+            (p_global->mem_stack_reclaim == ABTI_MEM_STACK_RECLAIM_FREE)
+                ? ABT_TRUE
+                : ABT_FALSE;
+        reclaim_config.keep_size = p_global->mem_stack_reclaim_keep_size;
+        reclaim_config.page_size = p_global->sys_page_size;
+    } else {
+        reclaim_config.enabled = ABT_FALSE;
     }
-    if ((stacksize & (2 * ABT_CONFIG_STATIC_CACHELINE_SIZE - 1)) == 0) {
-        /* Avoid a multiple of 2 * cacheline size to avoid cache bank conflict.
-         */
-        stacksize += ABT_CONFIG_STATIC_CACHELINE_SIZE;
-    }
-    ABTI_mem_pool_init_global_pool(&p_global->mem_pool_stack,
-                                   p_global->mem_max_stacks /
-                                       ABT_MEM_POOL_MAX_LOCAL_BUCKETS,
-                                   stacksize, thread_stacksize,
-                                   p_global->mem_sp_size, requested_types,
-                                   num_requested_types, p_global->mem_page_size,
-                                   &mprotect_config);
     /* The last four bytes will be used to store a mempool flag */
     ABTI_STATIC_ASSERT((ABTI_MEM_POOL_DESC_ELEM_SIZE &
                         (ABT_CONFIG_STATIC_CACHELINE_SIZE - 1)) == 0);
-    ABTI_mem_pool_init_global_pool(&p_global->mem_pool_desc,
-                                   p_global->mem_max_descs /
-                                       ABT_MEM_POOL_MAX_LOCAL_BUCKETS,
-                                   ABTI_MEM_POOL_DESC_ELEM_SIZE, 0,
-                                   p_global->mem_page_size, requested_types,
-                                   num_requested_types, p_global->mem_page_size,
-                                   NULL);
-#ifndef ABT_CONFIG_DISABLE_EXT_THREAD
-    int abt_errno;
-    ABTD_spinlock_clear(&p_global->mem_pool_stack_lock);
-    abt_errno = ABTI_mem_pool_init_local_pool(&p_global->mem_pool_stack_ext,
-                                              &p_global->mem_pool_stack);
+
+    /* Create global pools for each NUMA node. */
+    int abt_errno, i, num_nodes = 1;
+    if (p_global->mem_numa_aware && p_global->set_affinity)
+        num_nodes = ABTD_topology_get_num_numa_nodes();
+    abt_errno = ABTU_memalign(ABT_CONFIG_STATIC_CACHELINE_SIZE,
+                              sizeof(ABTI_mem_pool_global_pool) * num_nodes,
+                              (void **)&p_global->mem_pool_stacks);
+    ABTI_CHECK_ERROR(abt_errno);
+    abt_errno = ABTU_memalign(ABT_CONFIG_STATIC_CACHELINE_SIZE,
+                              sizeof(ABTI_mem_pool_global_pool) * num_nodes,
+                              (void **)&p_global->mem_pool_descs);
     if (abt_errno != ABT_SUCCESS) {
-        ABTI_mem_pool_destroy_global_pool(&p_global->mem_pool_stack);
-        ABTI_mem_pool_destroy_global_pool(&p_global->mem_pool_desc);
+        ABTU_free(p_global->mem_pool_stacks);
         ABTI_HANDLE_ERROR(abt_errno);
     }
+    const int num_stack_classes = p_global->mem_num_stack_classes;
+    p_global->mem_pool_stack_classes = NULL;
+    if (num_stack_classes > 0) {
+        abt_errno =
+            ABTU_memalign(ABT_CONFIG_STATIC_CACHELINE_SIZE,
+                          sizeof(ABTI_mem_pool_global_pool) *
+                              num_stack_classes * num_nodes,
+                          (void **)&p_global->mem_pool_stack_classes);
+        if (abt_errno != ABT_SUCCESS) {
+            ABTU_free(p_global->mem_pool_stacks);
+            ABTU_free(p_global->mem_pool_descs);
+            ABTI_HANDLE_ERROR(abt_errno);
+        }
+    }
+    p_global->mem_num_numa_nodes = num_nodes;
+    mem_set_stack_mprotect_size(p_global, thread_stacksize, &mprotect_config);
+    for (i = 0; i < num_nodes; i++) {
+        /* If there is only one node, pages do not need to be bound. */
+        int numa_id = num_nodes == 1 ? -1 : i;
+        ABTI_mem_pool_init_global_pool(&p_global->mem_pool_stacks[i], numa_id,
+                                       p_global->mem_max_stacks /
+                                           ABT_MEM_POOL_MIN_LOCAL_BUCKETS,
+                                       p_global->mem_max_local_buckets,
+                                       stacksize, thread_stacksize,
+                                       p_global->mem_sp_size, requested_types,
+                                       num_requested_types,
+                                       p_global->mem_page_size,
+                                       &mprotect_config, &reclaim_config);
+        ABTI_mem_pool_init_global_pool(&p_global->mem_pool_descs[i], numa_id,
+                                       p_global->mem_max_descs /
+                                           ABT_MEM_POOL_MIN_LOCAL_BUCKETS,
+                                       p_global->mem_max_local_buckets,
+                                       ABTI_MEM_POOL_DESC_ELEM_SIZE, 0,
+                                       p_global->mem_page_size, requested_types,
+                                       num_requested_types,
+                                       p_global->mem_page_size, NULL, NULL);
+        /* Connect global pools in a ring. */
+        p_global->mem_pool_stacks[i].p_next_node_pool =
+            &p_global->mem_pool_stacks[(i + 1) % num_nodes];
+        p_global->mem_pool_descs[i].p_next_node_pool =
+            &p_global->mem_pool_descs[(i + 1) % num_nodes];
+    }
+    int c;
+    for (c = 0; c < num_stack_classes; c++) {
+        /* Keep as many bytes of stacks as the default stack pool does. */
+        const size_t class_stacksize = p_global->mem_stack_classes[c];
+        const size_t header_size = mem_get_stack_header_size(class_stacksize);
+        size_t max_stacks = p_global->mem_max_stacks * thread_stacksize /
+                            class_stacksize;
+        max_stacks = ABTU_max_size(ABTU_min_size(max_stacks,
+                                                 p_global->mem_max_stacks),
+                                   ABT_MEM_POOL_MIN_LOCAL_BUCKETS);
+        /* A page must be able to hold some stacks. */
+        const size_t page_size =
+            ABTU_roundup_size(header_size * 4, p_global->mem_sp_size);
+        ABTI_mem_pool_global_pool *p_class_pools =
+            &p_global->mem_pool_stack_classes[c * num_nodes];
+        mem_set_stack_mprotect_size(p_global, class_stacksize,
+                                    &mprotect_config);
+        for (i = 0; i < num_nodes; i++) {
+            int numa_id = num_nodes == 1 ? -1 : i;
+            ABTI_mem_pool_init_global_pool(&p_class_pools[i], numa_id,
+                                           max_stacks /
+                                               ABT_MEM_POOL_MIN_LOCAL_BUCKETS,
+                                           p_global->mem_max_local_buckets,
+                                           header_size, class_stacksize,
+                                           page_size, requested_types,
+                                           num_requested_types,
+                                           p_global->mem_page_size,
+                                           &mprotect_config, &reclaim_config);
+            p_class_pools[i].p_next_node_pool =
+                &p_class_pools[(i + 1) % num_nodes];
+        }
+    }
+#ifndef ABT_CONFIG_DISABLE_EXT_THREAD
+    /* External threads use the global pool of the first node.  They do not
+     * need a stack pool since they return stacks to the owner ESs. */
     ABTD_spinlock_clear(&p_global->mem_pool_desc_lock);
     abt_errno = ABTI_mem_pool_init_local_pool(&p_global->mem_pool_desc_ext,
-                                              &p_global->mem_pool_desc);
+                                              &p_global->mem_pool_descs[0]);
     if (abt_errno != ABT_SUCCESS) {
-        ABTI_mem_pool_destroy_local_pool(&p_global->mem_pool_stack_ext);
-        ABTI_mem_pool_destroy_global_pool(&p_global->mem_pool_stack);
-        ABTI_mem_pool_destroy_global_pool(&p_global->mem_pool_desc);
+        mem_destroy_global_pools(p_global);
         ABTI_HANDLE_ERROR(abt_errno);
     }
 #endif
@@ -112,33 +250,146 @@ ABTU_ret_err int ABTI_mem_init(ABTI_global *p_global)
 ABTU_ret_err int ABTI_mem_init_local(ABTI_global *p_global,
                                      ABTI_xstream *p_local_xstream)
 {
-    int abt_errno;
+    int abt_errno, node = 0;
+    if (p_global->mem_num_numa_nodes > 1) {
+        /* Use the global pools of the NUMA node to which this ES is bound.
+         * This ES keeps using them even if its affinity is changed later. */
+        int numa_id = ABTD_affinity_get_default_numa_id(p_local_xstream->rank);
+        if (0 <= numa_id && numa_id < p_global->mem_num_numa_nodes)
+            node = numa_id;
+    }
     abt_errno = ABTI_mem_pool_init_local_pool(&p_local_xstream->mem_pool_stack,
-                                              &p_global->mem_pool_stack);
+                                              &p_global->mem_pool_stacks[node]);
     ABTI_CHECK_ERROR(abt_errno);
     abt_errno = ABTI_mem_pool_init_local_pool(&p_local_xstream->mem_pool_desc,
-                                              &p_global->mem_pool_desc);
+                                              &p_global->mem_pool_descs[node]);
     if (abt_errno != ABT_SUCCESS) {
         ABTI_mem_pool_destroy_local_pool(&p_local_xstream->mem_pool_stack);
         ABTI_HANDLE_ERROR(abt_errno);
     }
+    p_local_xstream->p_stack_cache = NULL;
+    /* Pools of stack size classes are initialized on demand. */
+    p_local_xstream->mem_pool_stack_classes = NULL;
+    if (p_global->mem_num_stack_classes > 0) {
+        abt_errno = ABTU_calloc(p_global->mem_num_stack_classes,
+                                sizeof(ABTI_mem_pool_local_pool),
+                                (void **)&p_local_xstream
+                                    ->mem_pool_stack_classes);
+        if (abt_errno != ABT_SUCCESS) {
+            ABTI_mem_pool_destroy_local_pool(&p_local_xstream->mem_pool_stack);
+            ABTI_mem_pool_destroy_local_pool(&p_local_xstream->mem_pool_desc);
+            ABTI_HANDLE_ERROR(abt_errno);
+        }
+    }
     return ABT_SUCCESS;
 }
 
+ABTU_ret_err int ABTI_mem_init_local_stack_class(ABTI_global *p_global,
+                                                 ABTI_xstream *p_local_xstream,
+                                                 int stack_class)
+{
+    /* Use the NUMA node of the default stack pool. */
+    int node = (int)(p_local_xstream->mem_pool_stack.p_global_pool -
+                     p_global->mem_pool_stacks);
+    ABTI_mem_pool_global_pool *p_global_pool =
+        &p_global->mem_pool_stack_classes[stack_class *
+                                              p_global->mem_num_numa_nodes +
+                                          node];
+    int abt_errno = ABTI_mem_pool_init_local_pool(
+        &p_local_xstream->mem_pool_stack_classes[stack_class], p_global_pool);
+    ABTI_CHECK_ERROR(abt_errno);
+    return ABT_SUCCESS;
+}
+
+void ABTI_mem_trim_local(ABTI_xstream *p_local_xstream)
+{
+    ABTI_global *p_global = ABTI_global_get_global();
+    int i;
+    mem_return_stack_cache(p_local_xstream);
+    /* Take stacks that other threads have freed. */
+    ABTI_mem_pool_drain_remote_queue(&p_local_xstream->mem_pool_stack);
+    ABTI_mem_pool_trim_local_pool(&p_local_xstream->mem_pool_stack);
+    ABTI_mem_pool_trim_local_pool(&p_local_xstream->mem_pool_desc);
+    for (i = 0; i < p_global->mem_num_stack_classes; i++) {
+        ABTI_mem_pool_local_pool *p_local_pool =
+            &p_local_xstream->mem_pool_stack_classes[i];
+        if (p_local_pool->p_global_pool) {
+            ABTI_mem_pool_drain_remote_queue(p_local_pool);
+            ABTI_mem_pool_trim_local_pool(p_local_pool);
+        }
+    }
+}
+
 void ABTI_mem_finalize(ABTI_global *p_global)
 {
 #ifndef ABT_CONFIG_DISABLE_EXT_THREAD
-    ABTI_mem_pool_destroy_local_pool(&p_global->mem_pool_stack_ext);
     ABTI_mem_pool_destroy_local_pool(&p_global->mem_pool_desc_ext);
 #endif
-    ABTI_mem_pool_destroy_global_pool(&p_global->mem_pool_stack);
-    ABTI_mem_pool_destroy_global_pool(&p_global->mem_pool_desc);
+    mem_destroy_global_pools(p_global);
 }
 
-void ABTI_mem_finalize_local(ABTI_xstream *p_local_xstream)
+void ABTI_mem_finalize_local(ABTI_global *p_global,
+                             ABTI_xstream *p_local_xstream)
 {
+    int i;
+    mem_return_stack_cache(p_local_xstream);
     ABTI_mem_pool_destroy_local_pool(&p_local_xstream->mem_pool_stack);
     ABTI_mem_pool_destroy_local_pool(&p_local_xstream->mem_pool_desc);
+    for (i = 0; i < p_global->mem_num_stack_classes; i++) {
+        ABTI_mem_pool_local_pool *p_local_pool =
+            &p_local_xstream->mem_pool_stack_classes[i];
+        if (p_local_pool->p_global_pool)
+            ABTI_mem_pool_destroy_local_pool(p_local_pool);
+    }
+    ABTU_free(p_local_xstream->mem_pool_stack_classes);
+}
+
+void ABTI_mem_print(ABTI_global *p_global, FILE *p_os, int indent)
+{
+    int i, c;
+    fprintf(p_os, "%*s# of NUMA nodes: %d\n", indent, "",
+            p_global->mem_num_numa_nodes);
+    for (i = 0; i < p_global->mem_num_numa_nodes; i++) {
+        fprintf(p_os, "%*s== STACK POOL [%d] ==\n", indent, "", i);
+        ABTI_mem_pool_print_global_pool(&p_global->mem_pool_stacks[i], p_os,
+                                        indent);
+        fprintf(p_os, "%*s== DESC POOL [%d] ==\n", indent, "", i);
+        ABTI_mem_pool_print_global_pool(&p_global->mem_pool_descs[i], p_os,
+                                        indent);
+    }
+    for (c = 0; c < p_global->mem_num_stack_classes; c++) {
+        for (i = 0; i < p_global->mem_num_numa_nodes; i++) {
+            fprintf(p_os, "%*s== STACK POOL (%zu bytes) [%d] ==\n", indent, "",
+                    p_global->mem_stack_classes[c], i);
+            ABTI_mem_pool_print_global_pool(
+                &p_global->mem_pool_stack_classes[c * p_global
+                                                          ->mem_num_numa_nodes +
+                                                  i],
+                p_os, indent);
+        }
+    }
+}
+
+void ABTI_mem_print_local(ABTI_xstream *p_xstream, FILE *p_os, int indent)
+{
+    fprintf(p_os, "%*smem_pool_stack:\n", indent, "");
+    ABTI_mem_pool_print_local_pool(&p_xstream->mem_pool_stack, p_os,
+                                   indent + ABTI_INDENT);
+    fprintf(p_os, "%*smem_pool_desc:\n", indent, "");
+    ABTI_mem_pool_print_local_pool(&p_xstream->mem_pool_desc, p_os,
+                                   indent + ABTI_INDENT);
+    ABTI_global *p_global = ABTI_global_get_global();
+    int i;
+    for (i = 0; i < p_global->mem_num_stack_classes; i++) {
+        ABTI_mem_pool_local_pool *p_local_pool =
+            &p_xstream->mem_pool_stack_classes[i];
+        if (p_local_pool->p_global_pool) {
+            fprintf(p_os, "%*smem_pool_stack (%zu bytes):\n", indent, "",
+                    p_global->mem_stack_classes[i]);
+            ABTI_mem_pool_print_local_pool(p_local_pool, p_os,
+                                           indent + ABTI_INDENT);
+        }
+    }
 }
 
 int ABTI_mem_check_lp_alloc(ABTI_global *p_global, int lp_alloc)
@@ -207,7 +458,21 @@ void ABTI_mem_finalize(ABTI_global *p_global)
 {
 }
 
-void ABTI_mem_finalize_local(ABTI_xstream *p_local_xstream)
+void ABTI_mem_finalize_local(ABTI_global *p_global,
+                             ABTI_xstream *p_local_xstream)
+{
+}
+
+void ABTI_mem_trim_local(ABTI_xstream *p_local_xstream)
+{
+}
+
+void ABTI_mem_print(ABTI_global *p_global, FILE *p_os, int indent)
+{
+    fprintf(p_os, "%*sThe memory pool is disabled.\n", indent, "");
+}
+
+void ABTI_mem_print_local(ABTI_xstream *p_xstream, FILE *p_os, int indent)
 {
 }
 
@@ -35,12 +35,183 @@ static ABTU_ret_err int protect_memory(void *addr, size_t size,
     return ABTU_mprotect(mprotect_addr, size, protect);
 }
 
+/* Probe and release memory below headers that are being returned to the
+ * global pool.  See ABTI_mem_pool_global_pool_reclaim_config. */
+static void mem_pool_reclaim_headers(ABTI_mem_pool_global_pool *p_global_pool,
+                                     ABTI_mem_pool_header *p_header,
+                                     size_t num_headers)
+{
+    const size_t page_size = p_global_pool->reclaim_config.page_size;
+    const size_t keep_size = p_global_pool->reclaim_config.keep_size;
+    const ABT_bool lazy = p_global_pool->reclaim_config.lazy;
+    const size_t header_offset = p_global_pool->header_offset;
+    size_t guard_size = 0;
+    if (p_global_pool->mprotect_config.enabled) {
+        /* Do not touch a protected page. */
+        if (p_global_pool->mprotect_config.growable) {
+            /* Only the first page is kept protected.  The other pages might
+             * have been unprotected for stack growth, so they are protected
+             * again after being released. */
+            guard_size = p_global_pool->mprotect_config.offset +
+                         p_global_pool->mprotect_config.alignment;
+        } else {
+            guard_size = p_global_pool->mprotect_config.offset +
+                         p_global_pool->mprotect_config.page_size;
+        }
+    }
+    uint64_t num_probed_headers = 0, max_used_size = 0;
+    uint64_t num_reclaimed_headers = 0, reclaimed_size = 0;
+    size_t i;
+    for (i = 0; i < num_headers; i++, p_header = p_header->p_next) {
+        /* The memory of this header has not been touched since it was
+         * released, so it does not need to be probed. */
+        if (p_header->is_released)
+            continue;
+        char *p_mem = ((char *)p_header) - header_offset;
+        char *p_start = (char *)ABTU_roundup_ptr(p_mem + guard_size, page_size);
+        char *p_end = (char *)(((uintptr_t)p_header) & ~(page_size - 1));
+        char *p_keep =
+            (char *)(((uintptr_t)(((char *)p_header) - keep_size)) &
+                     ~(page_size - 1));
+        if (p_keep < p_start)
+            p_keep = p_start;
+        if (p_end <= p_start) {
+            p_header->is_released = ABT_TRUE;
+            continue;
+        }
+        size_t num_pages;
+        void *p_lowest_page;
+        int abt_errno;
+        if (p_start < p_keep) {
+            /* Check the part that can be released first. */
+            abt_errno = ABTU_get_resident_pages(p_start, p_keep - p_start,
+                                                page_size, &num_pages,
+                                                &p_lowest_page);
+            if (abt_errno != ABT_SUCCESS)
+                break;
+            if (p_lowest_page) {
+                num_probed_headers++;
+                max_used_size =
+                    ABTU_max_uint64(max_used_size,
+                                    ((char *)p_header) - (char *)p_lowest_page);
+                abt_errno =
+                    ABTU_release_pages(p_lowest_page,
+                                       p_keep - (char *)p_lowest_page, lazy);
+                if (abt_errno == ABT_SUCCESS) {
+                    num_reclaimed_headers++;
+                    reclaimed_size += num_pages * page_size;
+                    p_header->is_released = ABT_TRUE;
+                }
+                if (p_global_pool->mprotect_config.growable) {
+                    /* Shrink the stack.  If it fails, the stack simply stays
+                     * accessible. */
+                    char *p_protect_end =
+                        ((char *)ABTU_roundup_ptr(
+                            p_mem + p_global_pool->mprotect_config.offset,
+                            p_global_pool->mprotect_config.alignment)) +
+                        p_global_pool->mprotect_config.page_size;
+                    if (p_protect_end > p_keep)
+                        p_protect_end = p_keep;
+                    if ((char *)p_lowest_page < p_protect_end) {
+                        abt_errno =
+                            ABTU_mprotect(p_lowest_page,
+                                          p_protect_end - (char *)p_lowest_page,
+                                          ABT_TRUE);
+                        (void)abt_errno;
+                    }
+                }
+                continue;
+            }
+        }
+        /* Only the kept part might be used.  Probe it for statistics. */
+        if (p_keep < p_end) {
+            abt_errno = ABTU_get_resident_pages(p_keep, p_end - p_keep,
+                                                page_size, &num_pages,
+                                                &p_lowest_page);
+            if (abt_errno != ABT_SUCCESS)
+                break;
+            if (p_lowest_page) {
+                max_used_size =
+                    ABTU_max_uint64(max_used_size,
+                                    ((char *)p_header) - (char *)p_lowest_page);
+            }
+        }
+        num_probed_headers++;
+        p_header->is_released = ABT_TRUE;
+    }
+    ABTD_atomic_fetch_add_uint64(&p_global_pool->num_probed_headers,
+                                 num_probed_headers);
+    ABTD_atomic_fetch_add_uint64(&p_global_pool->num_reclaimed_headers,
+                                 num_reclaimed_headers);
+    ABTD_atomic_fetch_add_uint64(&p_global_pool->reclaimed_size,
+                                 reclaimed_size);
+    uint64_t cur_max_used_size;
+    do {
+        cur_max_used_size =
+            ABTD_atomic_relaxed_load_uint64(&p_global_pool->max_used_size);
+        if (cur_max_used_size >= max_used_size)
+            break;
+    } while (!ABTD_atomic_bool_cas_weak_uint64(&p_global_pool->max_used_size,
+                                               cur_max_used_size,
+                                               max_used_size));
+}
+
+/* Push a bucket to the global pool without reclaiming its memory. */
+static inline void
+mem_pool_push_bucket(ABTI_mem_pool_global_pool *p_global_pool,
+                     ABTI_mem_pool_header *bucket)
+{
+    ABTI_sync_lifo_push(&p_global_pool->bucket_lifo,
+                        &bucket->bucket_info.lifo_elem);
+    ABTD_atomic_fetch_add_uint64(&p_global_pool->num_returned_buckets, 1);
+}
+
+/* Pop a bucket from the global pool.  Buckets that have not been reclaimed are
+ * taken first since their memory is likely to be resident. */
+static inline ABTI_sync_lifo_element *
+mem_pool_pop_bucket(ABTI_mem_pool_global_pool *p_global_pool)
+{
+    if (p_global_pool->reclaim_config.enabled) {
+        ABTI_sync_lifo_element *p_popped_bucket_lifo_elem =
+            ABTI_sync_lifo_pop(&p_global_pool->reclaim_bucket_lifo);
+        if (p_popped_bucket_lifo_elem)
+            return p_popped_bucket_lifo_elem;
+    }
+    return ABTI_sync_lifo_pop(&p_global_pool->bucket_lifo);
+}
+
+/* Reclaim at most max_buckets buckets that have been returned to the global
+ * pool. */
+static void mem_pool_reclaim_buckets(ABTI_mem_pool_global_pool *p_global_pool,
+                                     size_t max_buckets)
+{
+    size_t i;
+    for (i = 0; i < max_buckets; i++) {
+        ABTI_sync_lifo_element *p_popped_bucket_lifo_elem =
+            ABTI_sync_lifo_pop(&p_global_pool->reclaim_bucket_lifo);
+        if (!p_popped_bucket_lifo_elem)
+            break;
+        ABTI_mem_pool_header *bucket =
+            mem_pool_lifo_elem_to_header(p_popped_bucket_lifo_elem);
+        mem_pool_reclaim_headers(p_global_pool, bucket,
+                                 p_global_pool->num_headers_per_bucket);
+        ABTI_sync_lifo_push(&p_global_pool->bucket_lifo,
+                            &bucket->bucket_info.lifo_elem);
+    }
+}
+
 static void
 mem_pool_return_partial_bucket(ABTI_mem_pool_global_pool *p_global_pool,
                                ABTI_mem_pool_header *bucket)
 {
     int i;
     const int num_headers_per_bucket = p_global_pool->num_headers_per_bucket;
+    /* Headers in partial_bucket have already been reclaimed, so reclaim only
+     * the new ones outside the lock. */
+    if (p_global_pool->reclaim_config.enabled) {
+        mem_pool_reclaim_headers(p_global_pool, bucket,
+                                 bucket->bucket_info.num_headers);
+    }
     /* Return headers in the last bucket to partial_bucket. */
     ABTD_spinlock_acquire(&p_global_pool->partial_bucket_lock);
     if (!p_global_pool->partial_bucket) {
@@ -78,22 +249,54 @@ mem_pool_return_partial_bucket(ABTI_mem_pool_global_pool *p_global_pool,
                     (num_headers_in_partial_bucket + num_headers_in_bucket);
             }
             partial_bucket_header->p_next = bucket;
-            ABTI_mem_pool_return_bucket(p_global_pool,
-                                        p_global_pool->partial_bucket);
+            mem_pool_push_bucket(p_global_pool, p_global_pool->partial_bucket);
             p_global_pool->partial_bucket = new_partial_bucket;
         }
     }
     ABTD_spinlock_release(&p_global_pool->partial_bucket_lock);
 }
 
+/* Take a bucket from the global pools of the other NUMA nodes.  This is called
+ * only when a new page cannot be allocated. */
+static ABT_bool
+mem_pool_take_remote_bucket(ABTI_mem_pool_global_pool *p_global_pool,
+                            ABTI_mem_pool_header **p_bucket)
+{
+    ABTI_mem_pool_global_pool *p_remote_pool = p_global_pool->p_next_node_pool;
+    while (p_remote_pool != p_global_pool) {
+        ABTI_sync_lifo_element *p_popped_bucket_lifo_elem =
+            mem_pool_pop_bucket(p_remote_pool);
+        if (p_popped_bucket_lifo_elem) {
+            ABTI_mem_pool_header *popped_bucket =
+                mem_pool_lifo_elem_to_header(p_popped_bucket_lifo_elem);
+            popped_bucket->bucket_info.num_headers =
+                p_global_pool->num_headers_per_bucket;
+            ABTD_atomic_fetch_add_uint64(&p_global_pool->num_migrated_buckets,
+                                         1);
+            ABTD_atomic_fetch_add_uint64(&p_global_pool->num_taken_buckets, 1);
+            *p_bucket = popped_bucket;
+            return ABT_TRUE;
+        }
+        p_remote_pool = p_remote_pool->p_next_node_pool;
+    }
+    return ABT_FALSE;
+}
+
 void ABTI_mem_pool_init_global_pool(
-    ABTI_mem_pool_global_pool *p_global_pool, size_t num_headers_per_bucket,
-    size_t header_size, size_t header_offset, size_t page_size,
+    ABTI_mem_pool_global_pool *p_global_pool, int numa_id,
+    size_t num_headers_per_bucket, size_t max_local_buckets, size_t header_size,
+    size_t header_offset, size_t page_size,
     const ABTU_MEM_LARGEPAGE_TYPE *lp_type_requests,
     uint32_t num_lp_type_requests, size_t alignment_hint,
-    ABTI_mem_pool_global_pool_mprotect_config *p_mprotect_config)
+    ABTI_mem_pool_global_pool_mprotect_config *p_mprotect_config,
+    ABTI_mem_pool_global_pool_reclaim_config *p_reclaim_config)
 {
+    p_global_pool->numa_id = numa_id;
+    p_global_pool->p_next_node_pool = p_global_pool;
     p_global_pool->num_headers_per_bucket = num_headers_per_bucket;
+    ABTI_ASSERT(ABT_MEM_POOL_MIN_LOCAL_BUCKETS <= max_local_buckets &&
+                max_local_buckets <= ABT_MEM_POOL_MAX_LOCAL_BUCKETS);
+    p_global_pool->max_local_buckets = max_local_buckets;
     ABTI_ASSERT(header_offset + sizeof(ABTI_mem_pool_header) <= header_size);
     p_global_pool->header_size = header_size;
     p_global_pool->header_offset = header_offset;
@@ -103,6 +306,13 @@ void ABTI_mem_pool_init_global_pool(
                sizeof(ABTI_mem_pool_global_pool_mprotect_config));
     } else {
         p_global_pool->mprotect_config.enabled = ABT_FALSE;
+        p_global_pool->mprotect_config.growable = ABT_FALSE;
+    }
+    if (p_reclaim_config) {
+        memcpy(&p_global_pool->reclaim_config, p_reclaim_config,
+               sizeof(ABTI_mem_pool_global_pool_reclaim_config));
+    } else {
+        p_global_pool->reclaim_config.enabled = ABT_FALSE;
     }
 
     /* Note that lp_type_requests is a constant-sized array */
@@ -134,9 +344,22 @@ void ABTI_mem_pool_init_global_pool(
 
     ABTI_sync_lifo_init(&p_global_pool->mem_page_lifo);
     ABTD_atomic_relaxed_store_ptr(&p_global_pool->p_mem_page_empty, NULL);
+    ABTD_atomic_relaxed_store_ptr(&p_global_pool->p_mem_pages, NULL);
     ABTI_sync_lifo_init(&p_global_pool->bucket_lifo);
+    ABTI_sync_lifo_init(&p_global_pool->reclaim_bucket_lifo);
     ABTD_spinlock_clear(&p_global_pool->partial_bucket_lock);
     p_global_pool->partial_bucket = NULL;
+    ABTD_spinlock_clear(&p_global_pool->remote_queues_lock);
+    p_global_pool->p_remote_queues = NULL;
+    p_global_pool->p_unused_remote_queues = NULL;
+    ABTD_atomic_relaxed_store_uint64(&p_global_pool->num_pages, 0);
+    ABTD_atomic_relaxed_store_uint64(&p_global_pool->num_taken_buckets, 0);
+    ABTD_atomic_relaxed_store_uint64(&p_global_pool->num_returned_buckets, 0);
+    ABTD_atomic_relaxed_store_uint64(&p_global_pool->num_migrated_buckets, 0);
+    ABTD_atomic_relaxed_store_uint64(&p_global_pool->num_probed_headers, 0);
+    ABTD_atomic_relaxed_store_uint64(&p_global_pool->max_used_size, 0);
+    ABTD_atomic_relaxed_store_uint64(&p_global_pool->num_reclaimed_headers, 0);
+    ABTD_atomic_relaxed_store_uint64(&p_global_pool->reclaimed_size, 0);
 }
 
 void ABTI_mem_pool_destroy_global_pool(ABTI_mem_pool_global_pool *p_global_pool)
@@ -178,7 +401,15 @@ void ABTI_mem_pool_destroy_global_pool(ABTI_mem_pool_global_pool *p_global_pool)
         ABTU_free_largepage(p_page->mem, p_page->page_size, p_page->lp_type);
         p_page = p_next;
     }
+    /* Headers left in remote queues are also from memory pages. */
+    ABTI_mem_pool_remote_queue *p_remote_queue = p_global_pool->p_remote_queues;
+    while (p_remote_queue) {
+        ABTI_mem_pool_remote_queue *p_next = p_remote_queue->p_next;
+        ABTU_free(p_remote_queue);
+        p_remote_queue = p_next;
+    }
     ABTI_sync_lifo_destroy(&p_global_pool->bucket_lifo);
+    ABTI_sync_lifo_destroy(&p_global_pool->reclaim_bucket_lifo);
     ABTI_sync_lifo_destroy(&p_global_pool->mem_page_lifo);
 }
 
@@ -186,35 +417,162 @@ ABTU_ret_err int
 ABTI_mem_pool_init_local_pool(ABTI_mem_pool_local_pool *p_local_pool,
                               ABTI_mem_pool_global_pool *p_global_pool)
 {
-    p_local_pool->p_global_pool = p_global_pool;
-    p_local_pool->num_headers_per_bucket =
-        p_global_pool->num_headers_per_bucket;
+    /* Reuse a remote queue if any. */
+    ABTI_mem_pool_remote_queue *p_remote_queue;
+    ABTD_spinlock_acquire(&p_global_pool->remote_queues_lock);
+    p_remote_queue = p_global_pool->p_unused_remote_queues;
+    if (p_remote_queue) {
+        p_global_pool->p_unused_remote_queues = p_remote_queue->p_next_unused;
+    } else {
+        int abt_errno = ABTU_memalign(ABT_CONFIG_STATIC_CACHELINE_SIZE,
+                                      sizeof(ABTI_mem_pool_remote_queue),
+                                      (void **)&p_remote_queue);
+        if (abt_errno != ABT_SUCCESS) {
+            ABTD_spinlock_release(&p_global_pool->remote_queues_lock);
+            ABTI_HANDLE_ERROR(abt_errno);
+        }
+        ABTD_atomic_relaxed_store_ptr(&p_remote_queue->p_head, NULL);
+        p_remote_queue->p_next = p_global_pool->p_remote_queues;
+        p_global_pool->p_remote_queues = p_remote_queue;
+    }
+    ABTD_spinlock_release(&p_global_pool->remote_queues_lock);
+
     /* There must be always at least one header in the local pool.
      * Let's take one bucket. */
     int abt_errno =
         ABTI_mem_pool_take_bucket(p_global_pool, &p_local_pool->buckets[0]);
-    ABTI_CHECK_ERROR(abt_errno);
+    if (ABTI_IS_ERROR_CHECK_ENABLED && abt_errno != ABT_SUCCESS) {
+        ABTD_spinlock_acquire(&p_global_pool->remote_queues_lock);
+        p_remote_queue->p_next_unused = p_global_pool->p_unused_remote_queues;
+        p_global_pool->p_unused_remote_queues = p_remote_queue;
+        ABTD_spinlock_release(&p_global_pool->remote_queues_lock);
+        ABTI_HANDLE_ERROR(abt_errno);
+    }
+    /* p_global_pool is set only on success since a local pool of a stack size
+     * class is regarded as initialized if it is not NULL. */
+    p_local_pool->p_global_pool = p_global_pool;
+    p_local_pool->p_remote_queue = p_remote_queue;
+    p_local_pool->num_headers_per_bucket =
+        p_global_pool->num_headers_per_bucket;
     p_local_pool->bucket_index = 0;
+    p_local_pool->max_buckets = ABT_MEM_POOL_MIN_LOCAL_BUCKETS;
+    p_local_pool->bucket_index_lwm = 0;
+    p_local_pool->bucket_index_hwm = 0;
+    p_local_pool->trim_tick = 0;
+    p_local_pool->num_global_takes = 1;
+    p_local_pool->num_global_returns = 0;
+    p_local_pool->num_global_ops_at_trim = 1;
+    p_local_pool->num_grows = 0;
+    p_local_pool->num_trimmed_buckets = 0;
+    p_local_pool->num_remote_frees = 0;
     return ABT_SUCCESS;
 }
 
 void ABTI_mem_pool_destroy_local_pool(ABTI_mem_pool_local_pool *p_local_pool)
 {
+    ABTI_mem_pool_global_pool *p_global_pool = p_local_pool->p_global_pool;
+    /* Take headers that have been freed remotely so far.  Headers that are
+     * freed later will be taken by the next user of this remote queue. */
+    ABTI_mem_pool_drain_remote_queue(p_local_pool);
+    ABTI_mem_pool_remote_queue *p_remote_queue = p_local_pool->p_remote_queue;
+    ABTD_spinlock_acquire(&p_global_pool->remote_queues_lock);
+    p_remote_queue->p_next_unused = p_global_pool->p_unused_remote_queues;
+    p_global_pool->p_unused_remote_queues = p_remote_queue;
+    ABTD_spinlock_release(&p_global_pool->remote_queues_lock);
+
     /* Return the remaining buckets to the global pool. */
     int bucket_index = p_local_pool->bucket_index;
     int i;
     for (i = 0; i < bucket_index; i++) {
-        ABTI_mem_pool_return_bucket(p_local_pool->p_global_pool,
-                                    p_local_pool->buckets[i]);
+        ABTI_mem_pool_return_bucket(p_global_pool, p_local_pool->buckets[i]);
     }
     const size_t num_headers_per_bucket = p_local_pool->num_headers_per_bucket;
     ABTI_mem_pool_header *cur_bucket = p_local_pool->buckets[bucket_index];
     if (cur_bucket->bucket_info.num_headers == num_headers_per_bucket) {
         /* The last bucket is also full. Return the last bucket as well. */
-        ABTI_mem_pool_return_bucket(p_local_pool->p_global_pool,
+        ABTI_mem_pool_return_bucket(p_global_pool,
                                     p_local_pool->buckets[bucket_index]);
     } else {
-        mem_pool_return_partial_bucket(p_local_pool->p_global_pool, cur_bucket);
+        mem_pool_return_partial_bucket(p_global_pool, cur_bucket);
+    }
+}
+
+void ABTI_mem_pool_drain_remote_queue(ABTI_mem_pool_local_pool *p_local_pool)
+{
+    ABTI_mem_pool_remote_queue *p_remote_queue = p_local_pool->p_remote_queue;
+    if (!ABTD_atomic_relaxed_load_ptr(&p_remote_queue->p_head))
+        return;
+    ABTI_mem_pool_header *p_header =
+        (ABTI_mem_pool_header *)ABTD_atomic_exchange_ptr(&p_remote_queue
+                                                              ->p_head,
+                                                          NULL);
+    while (p_header) {
+        ABTI_mem_pool_header *p_next = p_header->p_next;
+        ABTI_mem_pool_free(p_local_pool, p_header);
+        p_local_pool->num_remote_frees++;
+        p_header = p_next;
+    }
+}
+
+void ABTI_mem_pool_trim_local_pool(ABTI_mem_pool_local_pool *p_local_pool)
+{
+    if (++p_local_pool->trim_tick < ABT_MEM_POOL_TRIM_INTERVAL)
+        return;
+    p_local_pool->trim_tick = 0;
+
+    size_t bucket_index = p_local_pool->bucket_index;
+    size_t max_buckets = p_local_pool->max_buckets;
+    const uint64_t num_global_ops =
+        p_local_pool->num_global_takes + p_local_pool->num_global_returns;
+    if (num_global_ops != p_local_pool->num_global_ops_at_trim) {
+        /* This local pool could not absorb allocations and deallocations since
+         * the last trim.  Double the depth. */
+        const size_t max_local_buckets =
+            p_local_pool->p_global_pool->max_local_buckets;
+        if (max_buckets < max_local_buckets) {
+            max_buckets = ABTU_min_size(max_buckets * 2, max_local_buckets);
+            p_local_pool->num_grows++;
+        }
+    } else {
+        /* Full buckets below bucket_index_lwm have not been used since the
+         * last trim.  Return half of them to the global pool, but keep as many
+         * as the default depth. */
+        size_t num_idle_buckets = p_local_pool->bucket_index_lwm;
+        size_t num_trimmed_buckets = 0;
+        if (num_idle_buckets > ABT_MEM_POOL_MIN_LOCAL_BUCKETS - 1) {
+            size_t i;
+            num_trimmed_buckets =
+                (num_idle_buckets - (ABT_MEM_POOL_MIN_LOCAL_BUCKETS - 1) + 1) /
+                2;
+            for (i = 0; i < num_trimmed_buckets; i++) {
+                ABTI_mem_pool_return_bucket(p_local_pool->p_global_pool,
+                                            p_local_pool->buckets[i]);
+            }
+            for (i = num_trimmed_buckets; i <= bucket_index; i++) {
+                p_local_pool->buckets[i - num_trimmed_buckets] =
+                    p_local_pool->buckets[i];
+            }
+            bucket_index -= num_trimmed_buckets;
+            p_local_pool->bucket_index = bucket_index;
+            p_local_pool->num_trimmed_buckets += num_trimmed_buckets;
+            p_local_pool->num_global_returns += num_trimmed_buckets;
+        }
+        /* Halve the depth, but keep the high-water mark of bucket_index. */
+        size_t hwm_buckets =
+            p_local_pool->bucket_index_hwm + 1 - num_trimmed_buckets;
+        max_buckets = ABTU_max_size(max_buckets / 2, hwm_buckets);
+        if (max_buckets < ABT_MEM_POOL_MIN_LOCAL_BUCKETS)
+            max_buckets = ABT_MEM_POOL_MIN_LOCAL_BUCKETS;
+    }
+    p_local_pool->max_buckets = max_buckets;
+    p_local_pool->bucket_index_lwm = bucket_index;
+    p_local_pool->bucket_index_hwm = bucket_index;
+    p_local_pool->num_global_ops_at_trim =
+        p_local_pool->num_global_takes + p_local_pool->num_global_returns;
+    /* Reclaim buckets returned by any local pool outside their return path. */
+    if (p_local_pool->p_global_pool->reclaim_config.enabled) {
+        mem_pool_reclaim_buckets(p_local_pool->p_global_pool,
+                                 ABT_MEM_POOL_NUM_RECLAIM_BUCKETS);
     }
 }
 
@@ -224,13 +582,14 @@ ABTI_mem_pool_take_bucket(ABTI_mem_pool_global_pool *p_global_pool,
 {
     /* Try to get a bucket. */
     ABTI_sync_lifo_element *p_popped_bucket_lifo_elem =
-        ABTI_sync_lifo_pop(&p_global_pool->bucket_lifo);
+        mem_pool_pop_bucket(p_global_pool);
     const int num_headers_per_bucket = p_global_pool->num_headers_per_bucket;
     if (ABTU_likely(p_popped_bucket_lifo_elem)) {
         /* Use this bucket. */
         ABTI_mem_pool_header *popped_bucket =
             mem_pool_lifo_elem_to_header(p_popped_bucket_lifo_elem);
         popped_bucket->bucket_info.num_headers = num_headers_per_bucket;
+        ABTD_atomic_fetch_add_uint64(&p_global_pool->num_taken_buckets, 1);
         *p_bucket = popped_bucket;
         return ABT_SUCCESS;
     } else {
@@ -265,8 +624,19 @@ ABTI_mem_pool_take_bucket(ABTI_mem_pool_global_pool *p_global_pool,
                         p_head->bucket_info.num_headers = num_headers;
                         mem_pool_return_partial_bucket(p_global_pool, p_head);
                     }
+                    /* The memory is under pressure.  Let's use a bucket of
+                     * another NUMA node if any. */
+                    if (mem_pool_take_remote_bucket(p_global_pool, p_bucket))
+                        return ABT_SUCCESS;
                     return abt_errno;
                 }
+                /* Place the page on the NUMA node before it is touched.
+                 * Headers are first touched by ESs on this node, too. */
+                if (p_global_pool->numa_id >= 0) {
+                    ABTD_topology_bind_memory(p_alloc_mem, page_size,
+                                              p_global_pool->numa_id);
+                }
+                ABTD_atomic_fetch_add_uint64(&p_global_pool->num_pages, 1);
                 p_page =
                     (ABTI_mem_pool_page *)(((char *)p_alloc_mem) + page_size -
                                            sizeof(ABTI_mem_pool_page));
@@ -275,6 +645,18 @@ ABTI_mem_pool_take_bucket(ABTI_mem_pool_global_pool *p_global_pool,
                 p_page->lp_type = lp_type;
                 p_page->p_mem_extra = p_alloc_mem;
                 p_page->mem_extra_size = page_size - sizeof(ABTI_mem_pool_page);
+                /* Register it to the list of all the pages, which is
+                 * push-only. */
+                void *p_cur_mem_page;
+                do {
+                    p_cur_mem_page =
+                        ABTD_atomic_acquire_load_ptr(&p_global_pool
+                                                          ->p_mem_pages);
+                    p_page->p_next_page = (ABTI_mem_pool_page *)p_cur_mem_page;
+                } while (!ABTD_atomic_bool_cas_weak_ptr(&p_global_pool
+                                                             ->p_mem_pages,
+                                                        p_cur_mem_page,
+                                                        p_page));
             }
             /* Take some memory left in this page. */
             int num_provided = p_page->mem_extra_size / header_size;
@@ -315,6 +697,7 @@ ABTI_mem_pool_take_bucket(ABTI_mem_pool_global_pool *p_global_pool,
             ABTI_mem_pool_header *p_local_tail =
                 (ABTI_mem_pool_header *)(((char *)p_mem_extra) + header_offset);
             p_local_tail->p_next = p_head;
+            p_local_tail->is_released = ABT_FALSE;
             ABTI_mem_pool_header *p_prev = p_local_tail;
             if (!p_global_pool->mprotect_config.enabled) {
                 /* Fast path. */
@@ -323,6 +706,7 @@ ABTI_mem_pool_take_bucket(ABTI_mem_pool_global_pool *p_global_pool,
                         (ABTI_mem_pool_header *)(((char *)p_prev) +
                                                  header_size);
                     p_cur->p_next = p_prev;
+                    p_cur->is_released = ABT_FALSE;
                     p_prev = p_cur;
                 }
             } else {
@@ -349,6 +733,7 @@ ABTI_mem_pool_take_bucket(ABTI_mem_pool_global_pool *p_global_pool,
                         (ABTI_mem_pool_header *)(((char *)p_prev) +
                                                  header_size);
                     p_cur->p_next = p_prev;
+                    p_cur->is_released = ABT_FALSE;
                     p_prev = p_cur;
                     abt_errno =
                         protect_memory((void *)(((char *)p_prev) -
@@ -364,6 +749,8 @@ ABTI_mem_pool_take_bucket(ABTI_mem_pool_global_pool *p_global_pool,
             num_headers += num_provided;
             if (num_headers == num_headers_per_bucket) {
                 p_head->bucket_info.num_headers = num_headers_per_bucket;
+                ABTD_atomic_fetch_add_uint64(&p_global_pool->num_taken_buckets,
+                                             1);
                 *p_bucket = p_head;
                 return ABT_SUCCESS;
             }
@@ -374,7 +761,102 @@ ABTI_mem_pool_take_bucket(ABTI_mem_pool_global_pool *p_global_pool,
 void ABTI_mem_pool_return_bucket(ABTI_mem_pool_global_pool *p_global_pool,
                                  ABTI_mem_pool_header *bucket)
 {
+    if (p_global_pool->reclaim_config.enabled) {
+        /* The memory is reclaimed later by ABTI_mem_pool_trim_local_pool(). */
+        ABTI_sync_lifo_push(&p_global_pool->reclaim_bucket_lifo,
+                            &bucket->bucket_info.lifo_elem);
+        ABTD_atomic_fetch_add_uint64(&p_global_pool->num_returned_buckets, 1);
+        return;
+    }
     /* Simply return that bucket to the pool */
-    ABTI_sync_lifo_push(&p_global_pool->bucket_lifo,
-                        &bucket->bucket_info.lifo_elem);
+    mem_pool_push_bucket(p_global_pool, bucket);
+}
+
+void ABTI_mem_pool_print_global_pool(ABTI_mem_pool_global_pool *p_global_pool,
+                                     FILE *p_os, int indent)
+{
+    fprintf(p_os,
+            "%*snuma_id          : %d\n"
+            "%*sbucket_size      : %zu\n"
+            "%*spages            : %" PRIu64 " (%zu KB each)\n"
+            "%*staken_buckets    : %" PRIu64 "\n"
+            "%*sreturned_buckets : %" PRIu64 "\n"
+            "%*smigrated_buckets : %" PRIu64 "\n",
+            indent, "", p_global_pool->numa_id, indent, "",
+            p_global_pool->num_headers_per_bucket, indent, "",
+            ABTD_atomic_relaxed_load_uint64(&p_global_pool->num_pages),
+            p_global_pool->page_size / 1024, indent, "",
+            ABTD_atomic_relaxed_load_uint64(&p_global_pool->num_taken_buckets),
+            indent, "",
+            ABTD_atomic_relaxed_load_uint64(
+                &p_global_pool->num_returned_buckets),
+            indent, "",
+            ABTD_atomic_relaxed_load_uint64(
+                &p_global_pool->num_migrated_buckets));
+    /* Count resident memory of all the pages. */
+    size_t num_pages = 0, num_resident_pages = 0;
+    const size_t sys_page_size = ABTD_env_get_sys_pagesize();
+    ABT_bool rss_available = ABT_TRUE;
+    ABTI_mem_pool_page *p_page = (ABTI_mem_pool_page *)
+        ABTD_atomic_acquire_load_ptr(&p_global_pool->p_mem_pages);
+    while (p_page) {
+        size_t num_page_resident_pages;
+        void *p_lowest_page;
+        char *p_mem = (char *)ABTU_roundup_ptr(p_page->mem, sys_page_size);
+        size_t size = (((char *)p_page->mem) + p_page->page_size - p_mem) &
+                      ~(sys_page_size - 1);
+        if (ABTU_get_resident_pages(p_mem, size, sys_page_size,
+                                    &num_page_resident_pages,
+                                    &p_lowest_page) != ABT_SUCCESS) {
+            rss_available = ABT_FALSE;
+            break;
+        }
+        num_pages += size / sys_page_size;
+        num_resident_pages += num_page_resident_pages;
+        p_page = p_page->p_next_page;
+    }
+    if (rss_available) {
+        fprintf(p_os, "%*sresident         : %zu KB / %zu KB\n", indent, "",
+                num_resident_pages * sys_page_size / 1024,
+                num_pages * sys_page_size / 1024);
+    }
+    if (p_global_pool->reclaim_config.enabled) {
+        fprintf(p_os,
+                "%*sprobed_headers   : %" PRIu64 "\n"
+                "%*smax_used_size    : %" PRIu64 " bytes\n"
+                "%*sreclaimed        : %" PRIu64 " headers (%" PRIu64
+                " KB)\n",
+                indent, "",
+                ABTD_atomic_relaxed_load_uint64(
+                    &p_global_pool->num_probed_headers),
+                indent, "",
+                ABTD_atomic_relaxed_load_uint64(&p_global_pool->max_used_size),
+                indent, "",
+                ABTD_atomic_relaxed_load_uint64(
+                    &p_global_pool->num_reclaimed_headers),
+                ABTD_atomic_relaxed_load_uint64(
+                    &p_global_pool->reclaimed_size) /
+                    1024);
+    }
+}
+
+void ABTI_mem_pool_print_local_pool(ABTI_mem_pool_local_pool *p_local_pool,
+                                    FILE *p_os, int indent)
+{
+    /* Statistics might be being updated by the owner. */
+    fprintf(p_os,
+            "%*sbuckets          : %zu / %zu (max: %zu)\n"
+            "%*sglobal_takes     : %" PRIu64 "\n"
+            "%*sglobal_returns   : %" PRIu64 "\n"
+            "%*sgrows            : %" PRIu64 "\n"
+            "%*strimmed_buckets  : %" PRIu64 "\n"
+            "%*sremote_frees     : %" PRIu64 "\n",
+            indent, "", p_local_pool->bucket_index + 1,
+            p_local_pool->max_buckets,
+            p_local_pool->p_global_pool->max_local_buckets, indent, "",
+            p_local_pool->num_global_takes, indent, "",
+            p_local_pool->num_global_returns, indent, "",
+            p_local_pool->num_grows, indent, "",
+            p_local_pool->num_trimmed_buckets, indent, "",
+            p_local_pool->num_remote_frees);
 }
@@ -375,7 +375,8 @@ int ABT_mutex_unlock(ABT_mutex mutex)
     ABTI_UB_ASSERT(!((p_mutex->attrs & ABTI_MUTEX_ATTR_RECURSIVE) &&
                      p_mutex->owner_id != ABTI_self_get_thread_id(p_local)));
 
-    ABTI_mutex_unlock(p_local, p_mutex);
+    ABTI_mutex_unlock_handover(&p_local, p_mutex,
+                               ABTI_MUTEX_HANDOVER_SAME_XSTREAM);
     return ABT_SUCCESS;
 }
 
@@ -427,7 +428,8 @@ int ABT_mutex_unlock_se(ABT_mutex mutex)
     ABTI_UB_ASSERT(!((p_mutex->attrs & ABTI_MUTEX_ATTR_RECURSIVE) &&
                      p_mutex->owner_id != ABTI_self_get_thread_id(p_local)));
 
-    ABTI_mutex_unlock(p_local, p_mutex);
+    ABTI_mutex_unlock_handover(&p_local, p_mutex,
+                               ABTI_MUTEX_HANDOVER_SAME_XSTREAM);
     return ABT_SUCCESS;
 }
 
@@ -479,7 +481,8 @@ int ABT_mutex_unlock_de(ABT_mutex mutex)
     ABTI_UB_ASSERT(!((p_mutex->attrs & ABTI_MUTEX_ATTR_RECURSIVE) &&
                      p_mutex->owner_id != ABTI_self_get_thread_id(p_local)));
 
-    ABTI_mutex_unlock(p_local, p_mutex);
+    ABTI_mutex_unlock_handover(&p_local, p_mutex,
+                               ABTI_MUTEX_HANDOVER_DIFF_XSTREAM);
     return ABT_SUCCESS;
 }
 
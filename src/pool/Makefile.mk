@@ -5,9 +5,12 @@
 
 abt_sources += \
 	pool/fifo.c \
+	pool/fifo_lockfree.c \
 	pool/fifo_wait.c \
 	pool/pool.c \
 	pool/pool_config.c \
 	pool/pool_user_def.c \
 	pool/randws.c \
+	pool/thread_deque.h \
+	pool/thread_lockfree_queue.h \
 	pool/thread_queue.h
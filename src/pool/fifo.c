@@ -61,7 +61,6 @@ ABTI_pool_get_fifo_def(ABT_pool_access access,
                        ABTI_pool_deprecated_def *p_deprecated_def)
 {
     /* Definitions according to the access type */
-    /* FIXME: need better implementation, e.g., lock-free one */
     switch (access) {
         case ABT_POOL_ACCESS_PRIV:
             p_required_def->p_push = pool_push_private;
@@ -73,6 +72,14 @@ ABTI_pool_get_fifo_def(ABT_pool_access access,
 
         case ABT_POOL_ACCESS_SPSC:
         case ABT_POOL_ACCESS_MPSC:
+            /* A pool that has a single consumer uses the FIFO_LOCKFREE
+             * implementation.  Neither producers nor the consumer take a lock;
+             * only rare operations such as remove take the consumer-side
+             * lock. */
+            return ABTI_pool_get_fifo_lockfree_def(access, p_required_def,
+                                                   p_optional_def,
+                                                   p_deprecated_def);
+
         case ABT_POOL_ACCESS_SPMC:
         case ABT_POOL_ACCESS_MPMC:
             p_required_def->p_push = pool_push_shared;
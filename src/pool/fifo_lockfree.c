@@ -0,0 +1,354 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include "abti.h"
+#include "thread_lockfree_queue.h"
+#include <time.h>
+
+/* FIFO_LOCKFREE pool implementation */
+
+static int pool_init(ABT_pool pool, ABT_pool_config config);
+static void pool_free(ABT_pool pool);
+static ABT_bool pool_is_empty(ABT_pool pool);
+static size_t pool_get_size(ABT_pool pool);
+static void pool_push(ABT_pool pool, ABT_unit unit, ABT_pool_context context);
+static ABT_thread pool_pop(ABT_pool pool, ABT_pool_context context);
+static ABT_thread pool_pop_single_consumer(ABT_pool pool,
+                                           ABT_pool_context context);
+static ABT_thread pool_pop_wait(ABT_pool pool, double time_secs,
+                                ABT_pool_context context);
+static void pool_push_many(ABT_pool pool, const ABT_unit *units,
+                           size_t num_units, ABT_pool_context context);
+static void pool_pop_many(ABT_pool pool, ABT_thread *threads,
+                          size_t max_threads, size_t *num_popped,
+                          ABT_pool_context context);
+static void pool_pop_many_single_consumer(ABT_pool pool, ABT_thread *threads,
+                                          size_t max_threads,
+                                          size_t *num_popped,
+                                          ABT_pool_context context);
+static void pool_print_all(ABT_pool pool, void *arg,
+                           void (*print_fn)(void *, ABT_thread));
+static void pool_print_all_single_consumer(ABT_pool pool, void *arg,
+                                           void (*print_fn)(void *,
+                                                            ABT_thread));
+static ABT_unit pool_create_unit(ABT_pool pool, ABT_thread thread);
+static void pool_free_unit(ABT_pool pool, ABT_unit unit);
+
+/* For backward compatibility */
+static int pool_remove(ABT_pool pool, ABT_unit unit);
+static int pool_remove_single_consumer(ABT_pool pool, ABT_unit unit);
+static ABT_unit pool_pop_timedwait(ABT_pool pool, double abstime_secs);
+static ABT_bool pool_unit_is_in_pool(ABT_unit unit);
+
+struct data {
+    thread_lockfree_queue_t queue;
+};
+typedef struct data data_t;
+
+static inline data_t *pool_get_data_ptr(void *p_data)
+{
+    return (data_t *)p_data;
+}
+
+static inline ABT_bool pool_has_single_consumer(ABT_pool_access access)
+{
+    return (access == ABT_POOL_ACCESS_SPSC || access == ABT_POOL_ACCESS_MPSC)
+               ? ABT_TRUE
+               : ABT_FALSE;
+}
+
+/* Obtain the FIFO_LOCKFREE pool definition.  Push operations are the same
+ * regardless of the access type.  If the pool has a single consumer, pop
+ * operations do not take the consumer-side lock. */
+ABTU_ret_err int
+ABTI_pool_get_fifo_lockfree_def(ABT_pool_access access,
+                                ABTI_pool_required_def *p_required_def,
+                                ABTI_pool_optional_def *p_optional_def,
+                                ABTI_pool_deprecated_def *p_deprecated_def)
+{
+    p_optional_def->p_init = pool_init;
+    p_optional_def->p_free = pool_free;
+    p_required_def->p_is_empty = pool_is_empty;
+    p_optional_def->p_get_size = pool_get_size;
+    p_required_def->p_push = pool_push;
+    p_optional_def->p_pop_wait = pool_pop_wait;
+    p_optional_def->p_push_many = pool_push_many;
+    p_required_def->p_create_unit = pool_create_unit;
+    p_required_def->p_free_unit = pool_free_unit;
+
+    p_deprecated_def->p_pop_timedwait = pool_pop_timedwait;
+    p_deprecated_def->u_is_in_pool = pool_unit_is_in_pool;
+    if (pool_has_single_consumer(access)) {
+        p_required_def->p_pop = pool_pop_single_consumer;
+        p_optional_def->p_pop_many = pool_pop_many_single_consumer;
+        p_optional_def->p_print_all = pool_print_all_single_consumer;
+        p_deprecated_def->p_remove = pool_remove_single_consumer;
+    } else {
+        p_required_def->p_pop = pool_pop;
+        p_optional_def->p_pop_many = pool_pop_many;
+        p_optional_def->p_print_all = pool_print_all;
+        p_deprecated_def->p_remove = pool_remove;
+    }
+    return ABT_SUCCESS;
+}
+
+/* Pool functions */
+
+static int pool_init(ABT_pool pool, ABT_pool_config config)
+{
+    ABTI_UNUSED(config);
+    int abt_errno = ABT_SUCCESS;
+    ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
+
+    data_t *p_data;
+    abt_errno = ABTU_malloc(sizeof(data_t), (void **)&p_data);
+    ABTI_CHECK_ERROR(abt_errno);
+    thread_lockfree_queue_init(&p_data->queue);
+
+    p_pool->data = p_data;
+    return abt_errno;
+}
+
+static void pool_free(ABT_pool pool)
+{
+    ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
+    data_t *p_data = pool_get_data_ptr(p_pool->data);
+    thread_lockfree_queue_free(&p_data->queue);
+    ABTU_free(p_data);
+}
+
+static ABT_bool pool_is_empty(ABT_pool pool)
+{
+    ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
+    data_t *p_data = pool_get_data_ptr(p_pool->data);
+    return thread_lockfree_queue_is_empty(&p_data->queue);
+}
+
+static size_t pool_get_size(ABT_pool pool)
+{
+    ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
+    data_t *p_data = pool_get_data_ptr(p_pool->data);
+    return thread_lockfree_queue_get_size(&p_data->queue);
+}
+
+static void pool_push(ABT_pool pool, ABT_unit unit, ABT_pool_context context)
+{
+    (void)context;
+    ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
+    data_t *p_data = pool_get_data_ptr(p_pool->data);
+    ABTI_thread *p_thread = ABTI_unit_get_thread_from_builtin_unit(unit);
+    thread_lockfree_queue_push(&p_data->queue, p_thread);
+}
+
+static void pool_push_many(ABT_pool pool, const ABT_unit *units,
+                           size_t num_units, ABT_pool_context context)
+{
+    (void)context;
+    ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
+    data_t *p_data = pool_get_data_ptr(p_pool->data);
+    thread_lockfree_queue_push_many(&p_data->queue, units, num_units);
+}
+
+static ABT_thread pool_pop(ABT_pool pool, ABT_pool_context context)
+{
+    (void)context;
+    ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
+    data_t *p_data = pool_get_data_ptr(p_pool->data);
+    if (thread_lockfree_queue_acquire_if_not_empty(&p_data->queue) == 0) {
+        ABTI_thread *p_thread =
+            thread_lockfree_queue_pop_head_unsafe(&p_data->queue);
+        thread_lockfree_queue_release(&p_data->queue);
+        return ABTI_thread_get_handle(p_thread);
+    } else {
+        return ABT_THREAD_NULL;
+    }
+}
+
+static ABT_thread pool_pop_single_consumer(ABT_pool pool,
+                                           ABT_pool_context context)
+{
+    ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
+    data_t *p_data = pool_get_data_ptr(p_pool->data);
+    if (thread_lockfree_queue_is_empty(&p_data->queue))
+        return ABT_THREAD_NULL;
+    if (thread_lockfree_queue_enter_single_consumer(&p_data->queue)) {
+        /* Another thread is walking the queue.  Take the lock. */
+        return pool_pop(pool, context);
+    }
+    ABTI_thread *p_thread =
+        thread_lockfree_queue_pop_head_unsafe(&p_data->queue);
+    thread_lockfree_queue_leave_single_consumer(&p_data->queue);
+    return ABTI_thread_get_handle(p_thread);
+}
+
+static inline ABT_thread pool_pop_by_access(ABT_pool pool,
+                                            ABT_pool_context context)
+{
+    ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
+    if (pool_has_single_consumer(p_pool->access)) {
+        return pool_pop_single_consumer(pool, context);
+    } else {
+        return pool_pop(pool, context);
+    }
+}
+
+static ABT_thread pool_pop_wait(ABT_pool pool, double time_secs,
+                                ABT_pool_context context)
+{
+    double time_start = 0.0;
+    while (1) {
+        ABT_thread thread = pool_pop_by_access(pool, context);
+        if (thread != ABT_THREAD_NULL)
+            return thread;
+        if (time_start == 0.0) {
+            time_start = ABTI_get_wtime();
+        } else {
+            double elapsed = ABTI_get_wtime() - time_start;
+            if (elapsed > time_secs)
+                return ABT_THREAD_NULL;
+        }
+        /* Sleep. */
+        const int sleep_nsecs = 100;
+        struct timespec ts = { 0, sleep_nsecs };
+        nanosleep(&ts, NULL);
+    }
+}
+
+static ABT_unit pool_pop_timedwait(ABT_pool pool, double abstime_secs)
+{
+    while (1) {
+        ABT_thread thread =
+            pool_pop_by_access(pool, ABT_POOL_CONTEXT_OWNER_DEFAULT);
+        if (thread != ABT_THREAD_NULL) {
+            return ABTI_unit_get_builtin_unit(ABTI_thread_get_ptr(thread));
+        }
+        const int sleep_nsecs = 100;
+        struct timespec ts = { 0, sleep_nsecs };
+        nanosleep(&ts, NULL);
+
+        if (ABTI_get_wtime() > abstime_secs)
+            return ABT_UNIT_NULL;
+    }
+}
+
+static void pool_pop_many(ABT_pool pool, ABT_thread *threads,
+                          size_t max_threads, size_t *num_popped,
+                          ABT_pool_context context)
+{
+    (void)context;
+    ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
+    data_t *p_data = pool_get_data_ptr(p_pool->data);
+    if (max_threads != 0 &&
+        thread_lockfree_queue_acquire_if_not_empty(&p_data->queue) == 0) {
+        size_t i;
+        for (i = 0; i < max_threads; i++) {
+            ABTI_thread *p_thread =
+                thread_lockfree_queue_pop_head_unsafe(&p_data->queue);
+            if (!p_thread)
+                break;
+            threads[i] = ABTI_thread_get_handle(p_thread);
+        }
+        *num_popped = i;
+        thread_lockfree_queue_release(&p_data->queue);
+    } else {
+        *num_popped = 0;
+    }
+}
+
+static void pool_pop_many_single_consumer(ABT_pool pool, ABT_thread *threads,
+                                          size_t max_threads,
+                                          size_t *num_popped,
+                                          ABT_pool_context context)
+{
+    ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
+    data_t *p_data = pool_get_data_ptr(p_pool->data);
+    if (max_threads == 0 || thread_lockfree_queue_is_empty(&p_data->queue)) {
+        *num_popped = 0;
+        return;
+    }
+    if (thread_lockfree_queue_enter_single_consumer(&p_data->queue)) {
+        /* Another thread is walking the queue.  Take the lock. */
+        pool_pop_many(pool, threads, max_threads, num_popped, context);
+        return;
+    }
+    size_t i;
+    for (i = 0; i < max_threads; i++) {
+        ABTI_thread *p_thread =
+            thread_lockfree_queue_pop_head_unsafe(&p_data->queue);
+        if (!p_thread)
+            break;
+        threads[i] = ABTI_thread_get_handle(p_thread);
+    }
+    *num_popped = i;
+    thread_lockfree_queue_leave_single_consumer(&p_data->queue);
+}
+
+static int pool_remove(ABT_pool pool, ABT_unit unit)
+{
+    ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
+    data_t *p_data = pool_get_data_ptr(p_pool->data);
+    ABTI_thread *p_thread = ABTI_unit_get_thread_from_builtin_unit(unit);
+    ABTD_spinlock_acquire(&p_data->queue.lock);
+    int abt_errno =
+        thread_lockfree_queue_remove_unsafe(&p_data->queue, p_thread);
+    thread_lockfree_queue_release(&p_data->queue);
+    return abt_errno;
+}
+
+static int pool_remove_single_consumer(ABT_pool pool, ABT_unit unit)
+{
+    ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
+    data_t *p_data = pool_get_data_ptr(p_pool->data);
+    ABTI_thread *p_thread = ABTI_unit_get_thread_from_builtin_unit(unit);
+    thread_lockfree_queue_acquire_single_consumer(&p_data->queue);
+    int abt_errno =
+        thread_lockfree_queue_remove_unsafe(&p_data->queue, p_thread);
+    thread_lockfree_queue_release(&p_data->queue);
+    return abt_errno;
+}
+
+static void pool_print_all(ABT_pool pool, void *arg,
+                           void (*print_fn)(void *, ABT_thread))
+{
+    ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
+    data_t *p_data = pool_get_data_ptr(p_pool->data);
+    ABTD_spinlock_acquire(&p_data->queue.lock);
+    thread_lockfree_queue_print_all_unsafe(&p_data->queue, arg, print_fn);
+    thread_lockfree_queue_release(&p_data->queue);
+}
+
+static void pool_print_all_single_consumer(ABT_pool pool, void *arg,
+                                           void (*print_fn)(void *,
+                                                            ABT_thread))
+{
+    ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
+    data_t *p_data = pool_get_data_ptr(p_pool->data);
+    thread_lockfree_queue_acquire_single_consumer(&p_data->queue);
+    thread_lockfree_queue_print_all_unsafe(&p_data->queue, arg, print_fn);
+    thread_lockfree_queue_release(&p_data->queue);
+}
+
+/* Unit functions */
+
+static ABT_bool pool_unit_is_in_pool(ABT_unit unit)
+{
+    ABTI_thread *p_thread = ABTI_unit_get_thread_from_builtin_unit(unit);
+    return ABTD_atomic_acquire_load_int(&p_thread->is_in_pool) ? ABT_TRUE
+                                                               : ABT_FALSE;
+}
+
+static ABT_unit pool_create_unit(ABT_pool pool, ABT_thread thread)
+{
+    /* Call ABTI_unit_init_builtin() instead. */
+    ABTI_ASSERT(0);
+    return ABT_UNIT_NULL;
+}
+
+static void pool_free_unit(ABT_pool pool, ABT_unit unit)
+{
+    /* A built-in unit does not need to be freed.  This function may not be
+     * called. */
+    ABTI_ASSERT(0);
+}
@@ -31,9 +31,15 @@ static int pool_remove(ABT_pool pool, ABT_unit unit);
 static ABT_unit pool_pop_timedwait(ABT_pool pool, double abstime_secs);
 static ABT_bool pool_unit_is_in_pool(ABT_unit unit);
 
+/* Producers and consumers update the queue while holding the spinlock.  A
+ * consumer that waits for a work unit increments num_waiters and sleeps on
+ * futex, so producers issue a wake-up only when num_waiters is non-zero. */
 struct data {
-    pthread_mutex_t mutex;
-    pthread_cond_t cond;
+    ABTD_spinlock mutex;
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+    int num_waiters; /* Protected by mutex. */
+    ABTD_futex_multiple futex;
+#endif
     thread_queue_t queue;
 };
 typedef struct data data_t;
@@ -70,27 +76,64 @@ ABTI_pool_get_fifo_wait_def(ABT_pool_access access,
 
 /* Pool functions */
 
+/* Return the current time of a monotonic clock, which is not affected by
+ * changes of the system time. */
+static inline double pool_get_monotonic_sec(void)
+{
+#if defined(ABT_CONFIG_USE_CLOCK_GETTIME)
+    struct timespec ts;
+    int ret = clock_gettime(CLOCK_MONOTONIC, &ts);
+    ABTI_ASSERT(ret == 0);
+    return ((double)ts.tv_sec) + 1.0e-9 * ((double)ts.tv_nsec);
+#else
+    return ABTI_get_wtime();
+#endif
+}
+
+/* Pop a work unit.  If the pool is empty, wait until either a work unit is
+ * pushed or get_time_sec() reaches deadline.  The caller must hold
+ * p_data->mutex. */
+static inline ABTI_thread *pool_pop_wait_locked(data_t *p_data,
+                                                double deadline,
+                                                double (*get_time_sec)(void))
+{
+    while (1) {
+        ABTI_thread *p_thread = thread_queue_pop_head(&p_data->queue);
+        if (p_thread)
+            return p_thread;
+        double remaining_sec = deadline - get_time_sec();
+        if (remaining_sec <= 0.0)
+            return NULL;
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+        /* A wake-up can be spurious, so check the time again. */
+        p_data->num_waiters++;
+        ABTD_futex_timedwait_and_unlock(&p_data->futex, &p_data->mutex,
+                                        remaining_sec);
+        ABTD_spinlock_acquire(&p_data->mutex);
+        p_data->num_waiters--;
+#else
+        ABTD_spinlock_release(&p_data->mutex);
+        ABTD_atomic_pause();
+        ABTD_spinlock_acquire(&p_data->mutex);
+#endif
+    }
+}
+
 static int pool_init(ABT_pool pool, ABT_pool_config config)
 {
     ABTI_UNUSED(config);
-    int ret, abt_errno = ABT_SUCCESS;
+    int abt_errno = ABT_SUCCESS;
     ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
 
     data_t *p_data;
     abt_errno = ABTU_malloc(sizeof(data_t), (void **)&p_data);
     ABTI_CHECK_ERROR(abt_errno);
 
-    ret = pthread_mutex_init(&p_data->mutex, NULL);
-    if (ret != 0) {
-        ABTU_free(p_data);
-        return ABT_ERR_SYS;
-    }
-    ret = pthread_cond_init(&p_data->cond, NULL);
-    if (ret != 0) {
-        pthread_mutex_destroy(&p_data->mutex);
-        ABTU_free(p_data);
-        return ABT_ERR_SYS;
-    }
+    ABTD_spinlock_clear(&p_data->mutex);
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+    p_data->num_waiters = 0;
+    ABTD_futex_multiple_init(&p_data->futex);
+#endif
     thread_queue_init(&p_data->queue);
 
     p_pool->data = p_data;
@@ -102,8 +145,6 @@ static void pool_free(ABT_pool pool)
     ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
     data_t *p_data = pool_get_data_ptr(p_pool->data);
     thread_queue_free(&p_data->queue);
-    pthread_mutex_destroy(&p_data->mutex);
-    pthread_cond_destroy(&p_data->cond);
     ABTU_free(p_data);
 }
 
@@ -128,10 +169,15 @@ static void pool_push(ABT_pool pool, ABT_unit unit, ABT_pool_context context)
     data_t *p_data = pool_get_data_ptr(p_pool->data);
     ABTI_thread *p_thread = ABTI_unit_get_thread_from_builtin_unit(unit);
 
-    pthread_mutex_lock(&p_data->mutex);
+    ABTD_spinlock_acquire(&p_data->mutex);
     thread_queue_push_tail(&p_data->queue, p_thread);
-    pthread_cond_signal(&p_data->cond);
-    pthread_mutex_unlock(&p_data->mutex);
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+    if (p_data->num_waiters > 0) {
+        /* Wake up a single waiter. */
+        ABTD_futex_signal(&p_data->futex);
+    }
+#endif
+    ABTD_spinlock_release(&p_data->mutex);
 }
 
 static void pool_push_many(ABT_pool pool, const ABT_unit *units,
@@ -142,21 +188,25 @@ static void pool_push_many(ABT_pool pool, const ABT_unit *units,
     data_t *p_data = pool_get_data_ptr(p_pool->data);
 
     if (num_units > 0) {
-        pthread_mutex_lock(&p_data->mutex);
+        ABTD_spinlock_acquire(&p_data->mutex);
         size_t i;
         for (i = 0; i < num_units; i++) {
             ABTI_thread *p_thread =
                 ABTI_unit_get_thread_from_builtin_unit(units[i]);
             thread_queue_push_tail(&p_data->queue, p_thread);
         }
-        if (num_units == 1) {
-            /* Wake up a single waiter. */
-            pthread_cond_signal(&p_data->cond);
-        } else {
-            /* Wake up all the waiters. */
-            pthread_cond_broadcast(&p_data->cond);
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+        if (p_data->num_waiters > 0) {
+            if (num_units == 1) {
+                /* Wake up a single waiter. */
+                ABTD_futex_signal(&p_data->futex);
+            } else {
+                /* Wake up all the waiters. */
+                ABTD_futex_broadcast(&p_data->futex);
+            }
         }
-        pthread_mutex_unlock(&p_data->mutex);
+#endif
+        ABTD_spinlock_release(&p_data->mutex);
     }
 }
 
@@ -166,57 +216,24 @@ static ABT_thread pool_pop_wait(ABT_pool pool, double time_secs,
     (void)context;
     ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
     data_t *p_data = pool_get_data_ptr(p_pool->data);
-    pthread_mutex_lock(&p_data->mutex);
-    if (thread_queue_is_empty(&p_data->queue)) {
-#if defined(ABT_CONFIG_USE_CLOCK_GETTIME)
-        struct timespec ts;
-        clock_gettime(CLOCK_REALTIME, &ts);
-        ts.tv_sec += (time_t)time_secs;
-        ts.tv_nsec += (long)((time_secs - (time_t)time_secs) * 1e9);
-        if (ts.tv_nsec > 1e9) {
-            ts.tv_sec += 1;
-            ts.tv_nsec -= 1e9;
-        }
-        pthread_cond_timedwait(&p_data->cond, &p_data->mutex, &ts);
-#else
-        /* We cannot use pthread_cond_timedwait().  Let's use nanosleep()
-         * instead */
-        double start_time = ABTI_get_wtime();
-        while (ABTI_get_wtime() - start_time < time_secs) {
-            pthread_mutex_unlock(&p_data->mutex);
-            const int sleep_nsecs = 100;
-            struct timespec ts = { 0, sleep_nsecs };
-            nanosleep(&ts, NULL);
-            pthread_mutex_lock(&p_data->mutex);
-            if (p_data->num_threads > 0)
-                break;
-        }
-#endif
-    }
-    ABTI_thread *p_thread = thread_queue_pop_head(&p_data->queue);
-    pthread_mutex_unlock(&p_data->mutex);
+    /* time_secs is relative, so use a monotonic clock. */
+    double deadline = pool_get_monotonic_sec() + time_secs;
+    ABTD_spinlock_acquire(&p_data->mutex);
+    ABTI_thread *p_thread =
+        pool_pop_wait_locked(p_data, deadline, pool_get_monotonic_sec);
+    ABTD_spinlock_release(&p_data->mutex);
     return ABTI_thread_get_handle(p_thread);
 }
 
-static inline void convert_double_sec_to_timespec(struct timespec *ts_out,
-                                                  double seconds)
-{
-    ts_out->tv_sec = (time_t)seconds;
-    ts_out->tv_nsec = (long)((seconds - ts_out->tv_sec) * 1000000000.0);
-}
-
 static ABT_unit pool_pop_timedwait(ABT_pool pool, double abstime_secs)
 {
     ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
     data_t *p_data = pool_get_data_ptr(p_pool->data);
-    pthread_mutex_lock(&p_data->mutex);
-    if (thread_queue_is_empty(&p_data->queue)) {
-        struct timespec ts;
-        convert_double_sec_to_timespec(&ts, abstime_secs);
-        pthread_cond_timedwait(&p_data->cond, &p_data->mutex, &ts);
-    }
-    ABTI_thread *p_thread = thread_queue_pop_head(&p_data->queue);
-    pthread_mutex_unlock(&p_data->mutex);
+    /* abstime_secs is based on ABT_get_wtime(). */
+    ABTD_spinlock_acquire(&p_data->mutex);
+    ABTI_thread *p_thread =
+        pool_pop_wait_locked(p_data, abstime_secs, ABTI_get_wtime);
+    ABTD_spinlock_release(&p_data->mutex);
     if (p_thread) {
         return ABTI_unit_get_builtin_unit(p_thread);
     } else {
@@ -230,9 +247,9 @@ static ABT_thread pool_pop(ABT_pool pool, ABT_pool_context context)
     ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
     data_t *p_data = pool_get_data_ptr(p_pool->data);
     if (!thread_queue_is_empty(&p_data->queue)) {
-        pthread_mutex_lock(&p_data->mutex);
+        ABTD_spinlock_acquire(&p_data->mutex);
         ABTI_thread *p_thread = thread_queue_pop_head(&p_data->queue);
-        pthread_mutex_unlock(&p_data->mutex);
+        ABTD_spinlock_release(&p_data->mutex);
         return ABTI_thread_get_handle(p_thread);
     } else {
         return ABT_THREAD_NULL;
@@ -247,7 +264,7 @@ static void pool_pop_many(ABT_pool pool, ABT_thread *threads,
     ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
     data_t *p_data = pool_get_data_ptr(p_pool->data);
     if (max_threads != 0 && !thread_queue_is_empty(&p_data->queue)) {
-        pthread_mutex_lock(&p_data->mutex);
+        ABTD_spinlock_acquire(&p_data->mutex);
         size_t i;
         for (i = 0; i < max_threads; i++) {
             ABTI_thread *p_thread = thread_queue_pop_head(&p_data->queue);
@@ -256,7 +273,7 @@ static void pool_pop_many(ABT_pool pool, ABT_thread *threads,
             threads[i] = ABTI_thread_get_handle(p_thread);
         }
         *num_popped = i;
-        pthread_mutex_unlock(&p_data->mutex);
+        ABTD_spinlock_release(&p_data->mutex);
     } else {
         *num_popped = 0;
     }
@@ -272,9 +289,9 @@ static int pool_remove(ABT_pool pool, ABT_unit unit)
     ABTI_CHECK_TRUE(ABTD_atomic_acquire_load_int(&p_thread->is_in_pool) == 1,
                     ABT_ERR_POOL);
 
-    pthread_mutex_lock(&p_data->mutex);
+    ABTD_spinlock_acquire(&p_data->mutex);
     int abt_errno = thread_queue_remove(&p_data->queue, p_thread);
-    pthread_mutex_unlock(&p_data->mutex);
+    ABTD_spinlock_release(&p_data->mutex);
     return abt_errno;
 }
 
@@ -284,9 +301,9 @@ static void pool_print_all(ABT_pool pool, void *arg,
     ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
     data_t *p_data = pool_get_data_ptr(p_pool->data);
 
-    pthread_mutex_lock(&p_data->mutex);
+    ABTD_spinlock_acquire(&p_data->mutex);
     thread_queue_print_all(&p_data->queue, arg, print_fn);
-    pthread_mutex_unlock(&p_data->mutex);
+    ABTD_spinlock_release(&p_data->mutex);
 }
 
 /* Unit functions */
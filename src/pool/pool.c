@@ -1416,6 +1416,11 @@ ABTU_ret_err int ABTI_pool_create_basic(ABT_pool_kind kind,
                 ABTI_pool_get_randws_def(access, &required_def, &optional_def,
                                          &deprecated_def);
             break;
+        case ABT_POOL_FIFO_LOCKFREE:
+            abt_errno =
+                ABTI_pool_get_fifo_lockfree_def(access, &required_def,
+                                                &optional_def, &deprecated_def);
+            break;
         default:
             abt_errno = ABT_ERR_INV_POOL_KIND;
             break;
@@ -1710,6 +1715,13 @@ pool_create(ABT_pool_access access,
     p_pool->is_builtin = is_builtin;
     ABTD_atomic_release_store_int32(&p_pool->num_scheds, 0);
     ABTD_atomic_release_store_int32(&p_pool->num_blocked, 0);
+    ABTD_atomic_release_store_int32(&p_pool->num_inlined_forks, 0);
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+    ABTD_atomic_release_store_int32(&p_pool->has_parked_scheds, 0);
+    ABTD_atomic_release_store_int32(&p_pool->num_parked_scheds, 0);
+    ABTD_spinlock_clear(&p_pool->park_lock);
+    p_pool->p_parked_head = NULL;
+#endif
     p_pool->data = NULL;
     memcpy(&p_pool->required_def, p_required_def,
            sizeof(ABTI_pool_required_def));
@@ -1748,7 +1760,11 @@ pool_create(ABT_pool_access access,
 
 static inline uint64_t pool_get_new_id(void)
 {
-    return (uint64_t)ABTD_atomic_fetch_add_uint64(&g_pool_id, 1);
+    ABTI_xstream *p_local_xstream =
+        ABTI_local_get_xstream_or_null(ABTI_local_get_local());
+    ABTI_id_block *p_block =
+        p_local_xstream ? &p_local_xstream->pool_id_block : NULL;
+    return ABTI_id_block_get_new_id(p_block, &g_pool_id);
 }
 
 static inline int pool_pop_thread_ex(ABT_pool pool, ABT_thread *thread,
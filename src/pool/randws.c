@@ -5,6 +5,7 @@
 
 #include "abti.h"
 #include "thread_queue.h"
+#include "thread_deque.h"
 #include <time.h>
 
 /* RANDWS pool implementation */
@@ -48,7 +49,23 @@ static ABT_bool pool_unit_is_in_pool(ABT_unit unit);
      ABT_POOL_CONTEXT_OP_THREAD_REVIVE | ABT_POOL_CONTEXT_OP_THREAD_REVIVE_TO)
 #define POOL_CONTEXT_POP_TAIL (ABT_POOL_CONTEXT_OWNER_SECONDARY)
 
+/*
+ * A shared RANDWS pool consists of two queues:
+ *  - deque: a Chase-Lev deque.  Only the owner pushes work units to and pops
+ *    work units from its bottom without taking a lock.  The other ESs steal
+ *    work units from its top.
+ *  - queue: a queue protected by mutex.  Work units that are pushed to the tail
+ *    or pushed by non-owners are stored here.
+ * The owner is bound explicitly by ABTI_pool_randws_bind_owner(), which
+ * ABT_SCHED_RANDWS calls for its first pool when it starts running on an ES.
+ * If several ESs run ABT_SCHED_RANDWS on the same first pool, the first one
+ * becomes the owner.  A pool without an owner uses only queue.
+ *
+ * A private pool uses only queue.
+ */
 struct data {
+    thread_deque_t deque;
+    ABTD_atomic_ptr p_owner; /* ABTI_xstream * */
     ABTD_spinlock mutex;
     thread_queue_t queue;
 };
@@ -67,7 +84,6 @@ ABTI_pool_get_randws_def(ABT_pool_access access,
                          ABTI_pool_deprecated_def *p_deprecated_def)
 {
     /* Definitions according to the access type */
-    /* FIXME: need better implementation, e.g., lock-free one */
     switch (access) {
         case ABT_POOL_ACCESS_PRIV:
             p_required_def->p_push = pool_push_private;
@@ -107,6 +123,26 @@ ABTI_pool_get_randws_def(ABT_pool_access access,
     return ABT_SUCCESS;
 }
 
+/* Bind the deque of a shared RANDWS pool to p_xstream.  This function does
+ * nothing if p_pool is not a shared RANDWS pool or has already been bound. */
+void ABTI_pool_randws_bind_owner(ABTI_pool *p_pool, ABTI_xstream *p_xstream)
+{
+    if (p_pool->required_def.p_push != pool_push_shared)
+        return;
+    data_t *p_data = pool_get_data_ptr(p_pool->data);
+    ABTD_atomic_bool_cas_strong_ptr(&p_data->p_owner, NULL, p_xstream);
+}
+
+/* Unbind the deque if p_xstream is its owner.  The remaining work units in the
+ * deque can still be stolen by any ES. */
+void ABTI_pool_randws_unbind_owner(ABTI_pool *p_pool, ABTI_xstream *p_xstream)
+{
+    if (p_pool->required_def.p_push != pool_push_shared)
+        return;
+    data_t *p_data = pool_get_data_ptr(p_pool->data);
+    ABTD_atomic_bool_cas_strong_ptr(&p_data->p_owner, p_xstream, NULL);
+}
+
 /* Pool functions */
 
 static int pool_init(ABT_pool pool, ABT_pool_config config)
@@ -120,6 +156,12 @@ static int pool_init(ABT_pool pool, ABT_pool_config config)
     abt_errno = ABTU_malloc(sizeof(data_t), (void **)&p_data);
     ABTI_CHECK_ERROR(abt_errno);
 
+    abt_errno = thread_deque_init(&p_data->deque);
+    if (ABTI_IS_ERROR_CHECK_ENABLED && abt_errno != ABT_SUCCESS) {
+        ABTU_free(p_data);
+        ABTI_HANDLE_ERROR(abt_errno);
+    }
+    ABTD_atomic_relaxed_store_ptr(&p_data->p_owner, NULL);
     access = p_pool->access;
     if (access != ABT_POOL_ACCESS_PRIV) {
         /* Initialize the mutex */
@@ -136,6 +178,7 @@ static void pool_free(ABT_pool pool)
     ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
     data_t *p_data = pool_get_data_ptr(p_pool->data);
     thread_queue_free(&p_data->queue);
+    thread_deque_free(&p_data->deque);
     ABTU_free(p_data);
 }
 
@@ -143,14 +186,87 @@ static ABT_bool pool_is_empty(ABT_pool pool)
 {
     ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
     data_t *p_data = pool_get_data_ptr(p_pool->data);
-    return thread_queue_is_empty(&p_data->queue);
+    return (thread_deque_is_empty(&p_data->deque) &&
+            thread_queue_is_empty(&p_data->queue))
+               ? ABT_TRUE
+               : ABT_FALSE;
 }
 
 static size_t pool_get_size(ABT_pool pool)
 {
     ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
     data_t *p_data = pool_get_data_ptr(p_pool->data);
-    return thread_queue_get_size(&p_data->queue);
+    return thread_deque_get_size(&p_data->deque) +
+           thread_queue_get_size(&p_data->queue);
+}
+
+/* Return ABT_TRUE if the caller is the owner of the deque. */
+static inline ABT_bool pool_is_owner(data_t *p_data)
+{
+    void *p_owner = ABTD_atomic_relaxed_load_ptr(&p_data->p_owner);
+    if (!p_owner)
+        return ABT_FALSE;
+    ABTI_xstream *p_local_xstream =
+        ABTI_local_get_xstream_or_null(ABTI_local_get_local());
+    return p_owner == (void *)p_local_xstream ? ABT_TRUE : ABT_FALSE;
+}
+
+static inline ABTI_thread *pool_pop_queue_locked(data_t *p_data, int tail)
+{
+    ABTI_thread *p_thread = NULL;
+    if (thread_queue_acquire_spinlock_if_not_empty(&p_data->queue,
+                                                   &p_data->mutex) == 0) {
+        if (tail) {
+            p_thread = thread_queue_pop_tail(&p_data->queue);
+        } else {
+            p_thread = thread_queue_pop_head(&p_data->queue);
+        }
+        ABTD_spinlock_release(&p_data->mutex);
+    }
+    return p_thread;
+}
+
+/* Pop up to max_threads work units from queue while taking the lock once. */
+static inline size_t pool_pop_many_queue_locked(data_t *p_data, int tail,
+                                                ABT_thread *threads,
+                                                size_t max_threads)
+{
+    size_t i = 0;
+    if (max_threads != 0 &&
+        thread_queue_acquire_spinlock_if_not_empty(&p_data->queue,
+                                                   &p_data->mutex) == 0) {
+        for (; i < max_threads; i++) {
+            ABTI_thread *p_thread = tail ? thread_queue_pop_tail(&p_data->queue)
+                                         : thread_queue_pop_head(&p_data->queue);
+            if (!p_thread)
+                break;
+            threads[i] = ABTI_thread_get_handle(p_thread);
+        }
+        ABTD_spinlock_release(&p_data->mutex);
+    }
+    return i;
+}
+
+static ABTI_thread *pool_pop_shared_impl(data_t *p_data,
+                                         ABT_pool_context context)
+{
+    ABTI_thread *p_thread;
+    if (context & POOL_CONTEXT_POP_TAIL) {
+        /* Remote pop.  The tail of queue is closer to the tail. */
+        p_thread = pool_pop_queue_locked(p_data, 1);
+        if (!p_thread)
+            p_thread = thread_deque_steal_top(&p_data->deque);
+    } else if (pool_is_owner(p_data)) {
+        /* Local pop.  The bottom of deque is the head. */
+        p_thread = thread_deque_pop_bottom(&p_data->deque);
+        if (!p_thread)
+            p_thread = pool_pop_queue_locked(p_data, 0);
+    } else {
+        p_thread = pool_pop_queue_locked(p_data, 0);
+        if (!p_thread)
+            p_thread = thread_deque_steal_top(&p_data->deque);
+    }
+    return p_thread;
 }
 
 static void pool_push_shared(ABT_pool pool, ABT_unit unit,
@@ -159,6 +275,12 @@ static void pool_push_shared(ABT_pool pool, ABT_unit unit,
     ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
     data_t *p_data = pool_get_data_ptr(p_pool->data);
     ABTI_thread *p_thread = ABTI_unit_get_thread_from_builtin_unit(unit);
+    if ((context & POOL_CONTEXT_PUSH_HEAD) && pool_is_owner(p_data)) {
+        int abt_errno = thread_deque_push_bottom(&p_data->deque, p_thread);
+        if (abt_errno == ABT_SUCCESS)
+            return;
+        /* If the deque cannot grow, push it to the queue. */
+    }
     ABTD_spinlock_acquire(&p_data->mutex);
     if (context & POOL_CONTEXT_PUSH_HEAD) {
         thread_queue_push_head(&p_data->queue, p_thread);
@@ -187,6 +309,14 @@ static void pool_push_many_shared(ABT_pool pool, const ABT_unit *units,
     ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
     data_t *p_data = pool_get_data_ptr(p_pool->data);
     if (num_units > 0) {
+        if ((context & POOL_CONTEXT_PUSH_HEAD) &&
+            pool_is_owner(p_data)) {
+            int abt_errno =
+                thread_deque_push_many_bottom(&p_data->deque, units, num_units);
+            if (abt_errno == ABT_SUCCESS)
+                return;
+            /* If the deque cannot grow, push them to the queue. */
+        }
         ABTD_spinlock_acquire(&p_data->mutex);
         size_t i;
         for (i = 0; i < num_units; i++) {
@@ -226,18 +356,9 @@ static ABT_thread pool_pop_wait(ABT_pool pool, double time_secs,
     data_t *p_data = pool_get_data_ptr(p_pool->data);
     double time_start = 0.0;
     while (1) {
-        if (thread_queue_acquire_spinlock_if_not_empty(&p_data->queue,
-                                                       &p_data->mutex) == 0) {
-            ABTI_thread *p_thread;
-            if (context & POOL_CONTEXT_POP_TAIL) {
-                p_thread = thread_queue_pop_tail(&p_data->queue);
-            } else {
-                p_thread = thread_queue_pop_head(&p_data->queue);
-            }
-            ABTD_spinlock_release(&p_data->mutex);
-            if (p_thread)
-                return ABTI_thread_get_handle(p_thread);
-        }
+        ABTI_thread *p_thread = pool_pop_shared_impl(p_data, context);
+        if (p_thread)
+            return ABTI_thread_get_handle(p_thread);
         if (time_start == 0.0) {
             time_start = ABTI_get_wtime();
         } else {
@@ -257,14 +378,10 @@ static ABT_unit pool_pop_timedwait(ABT_pool pool, double abstime_secs)
     ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
     data_t *p_data = pool_get_data_ptr(p_pool->data);
     while (1) {
-        if (thread_queue_acquire_spinlock_if_not_empty(&p_data->queue,
-                                                       &p_data->mutex) == 0) {
-            ABTI_thread *p_thread = thread_queue_pop_head(&p_data->queue);
-            ABTD_spinlock_release(&p_data->mutex);
-            if (p_thread) {
-                return ABTI_unit_get_builtin_unit(p_thread);
-            }
-        }
+        ABTI_thread *p_thread =
+            pool_pop_shared_impl(p_data, ABT_POOL_CONTEXT_OWNER_DEFAULT);
+        if (p_thread)
+            return ABTI_unit_get_builtin_unit(p_thread);
         const int sleep_nsecs = 100;
         struct timespec ts = { 0, sleep_nsecs };
         nanosleep(&ts, NULL);
@@ -278,19 +395,8 @@ static ABT_thread pool_pop_shared(ABT_pool pool, ABT_pool_context context)
 {
     ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
     data_t *p_data = pool_get_data_ptr(p_pool->data);
-    if (thread_queue_acquire_spinlock_if_not_empty(&p_data->queue,
-                                                   &p_data->mutex) == 0) {
-        ABTI_thread *p_thread;
-        if (context & POOL_CONTEXT_POP_TAIL) {
-            p_thread = thread_queue_pop_tail(&p_data->queue);
-        } else {
-            p_thread = thread_queue_pop_head(&p_data->queue);
-        }
-        ABTD_spinlock_release(&p_data->mutex);
-        return ABTI_thread_get_handle(p_thread);
-    } else {
-        return ABT_THREAD_NULL;
-    }
+    ABTI_thread *p_thread = pool_pop_shared_impl(p_data, context);
+    return ABTI_thread_get_handle(p_thread);
 }
 
 static ABT_thread pool_pop_private(ABT_pool pool, ABT_pool_context context)
@@ -312,26 +418,28 @@ static void pool_pop_many_shared(ABT_pool pool, ABT_thread *threads,
 {
     ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
     data_t *p_data = pool_get_data_ptr(p_pool->data);
-    if (max_threads != 0 &&
-        thread_queue_acquire_spinlock_if_not_empty(&p_data->queue,
-                                                   &p_data->mutex) == 0) {
-        size_t i;
-        for (i = 0; i < max_threads; i++) {
-            ABTI_thread *p_thread;
-            if (context & POOL_CONTEXT_POP_TAIL) {
-                p_thread = thread_queue_pop_tail(&p_data->queue);
-            } else {
-                p_thread = thread_queue_pop_head(&p_data->queue);
-            }
+    size_t i = 0;
+    if (!(context & POOL_CONTEXT_POP_TAIL) && pool_is_owner(p_data)) {
+        /* Local pop.  The bottom of deque is the head. */
+        for (; i < max_threads; i++) {
+            ABTI_thread *p_thread = thread_deque_pop_bottom(&p_data->deque);
             if (!p_thread)
                 break;
             threads[i] = ABTI_thread_get_handle(p_thread);
         }
-        *num_popped = i;
-        ABTD_spinlock_release(&p_data->mutex);
+        i += pool_pop_many_queue_locked(p_data, 0, &threads[i],
+                                        max_threads - i);
     } else {
-        *num_popped = 0;
+        /* For a remote pop, the tail of queue is closer to the tail.  The rest
+         * is stolen from the top of deque in batches. */
+        i = pool_pop_many_queue_locked(p_data,
+                                       (context & POOL_CONTEXT_POP_TAIL) ? 1
+                                                                         : 0,
+                                       threads, max_threads);
+        i += thread_deque_steal_many_top(&p_data->deque, &threads[i],
+                                         max_threads - i);
     }
+    *num_popped = i;
 }
 
 static void pool_pop_many_private(ABT_pool pool, ABT_thread *threads,
@@ -360,8 +468,30 @@ static int pool_remove_shared(ABT_pool pool, ABT_unit unit)
     ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
     data_t *p_data = pool_get_data_ptr(p_pool->data);
     ABTI_thread *p_thread = ABTI_unit_get_thread_from_builtin_unit(unit);
+    ABTI_CHECK_TRUE(ABTD_atomic_acquire_load_int(&p_thread->is_in_pool) == 1,
+                    ABT_ERR_POOL);
     ABTD_spinlock_acquire(&p_data->mutex);
-    int abt_errno = thread_queue_remove(&p_data->queue, p_thread);
+    if (p_thread->p_next) {
+        int abt_errno = thread_queue_remove(&p_data->queue, p_thread);
+        ABTD_spinlock_release(&p_data->mutex);
+        return abt_errno;
+    }
+    /* The work unit is in the deque.  Any ES may steal work units from its top,
+     * so take work units from the top until p_thread is found and move the
+     * others to the head of the queue.  Since the owner reads the queue after
+     * the deque, this keeps the order of the moved work units. */
+    int abt_errno = ABT_ERR_POOL;
+    while (1) {
+        ABTI_thread *p_top = thread_deque_steal_top(&p_data->deque);
+        if (!p_top) {
+            /* p_thread has been taken by another ES. */
+            break;
+        } else if (p_top == p_thread) {
+            abt_errno = ABT_SUCCESS;
+            break;
+        }
+        thread_queue_push_head(&p_data->queue, p_top);
+    }
     ABTD_spinlock_release(&p_data->mutex);
     return abt_errno;
 }
@@ -384,6 +514,7 @@ static void pool_print_all(ABT_pool pool, void *arg,
     access = p_pool->access;
     if (access != ABT_POOL_ACCESS_PRIV) {
         ABTD_spinlock_acquire(&p_data->mutex);
+        thread_deque_print_all(&p_data->deque, arg, print_fn);
     }
     thread_queue_print_all(&p_data->queue, arg, print_fn);
     if (access != ABT_POOL_ACCESS_PRIV) {
@@ -0,0 +1,295 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#ifndef THREAD_DEQUE_H_INCLUDED
+#define THREAD_DEQUE_H_INCLUDED
+
+#include "abti.h"
+
+/*
+ * Work-stealing deque for work units based on the Chase-Lev deque ("Dynamic
+ * Circular Work-Stealing Deque", SPAA '05) with the memory orders proposed by
+ * Le et al. ("Correct and Efficient Work-Stealing for Weak Memory Models",
+ * PPoPP '13).
+ *
+ * Only a single owner may call push_bottom(), push_many_bottom(), and
+ * pop_bottom(), which never take a lock.  Any thread may call steal_top() and
+ * steal_many_top(), which take work units from the top by CAS.
+ *
+ * steal_many_top() reserves up to THREAD_DEQUE_STEAL_MANY_MAX work units with a
+ * single CAS on top.  Unlike a single steal, a thief that has read an old
+ * bottom might reserve a work unit that the owner is popping at the same time.
+ * To avoid this, the owner pops the bottom without an atomic read-modify-write
+ * operation only if more than THREAD_DEQUE_STEAL_MANY_MAX work units are above
+ * it.  Otherwise, the owner takes all the remaining work units by CAS on top
+ * and puts all but the bottom one back, which keeps their order.
+ *
+ * The buffer is a circular array that grows when it gets full.  Since a thief
+ * might be reading an old buffer, replaced buffers are kept until the deque is
+ * freed.
+ */
+#define THREAD_DEQUE_INIT_BUFFER_SIZE 256
+#define THREAD_DEQUE_STEAL_MANY_MAX 8
+
+typedef struct thread_deque_buffer {
+    int64_t size; /* Must be a power of two. */
+    struct thread_deque_buffer *p_prev; /* Replaced buffer. */
+    ABTD_atomic_ptr *elems;             /* ABTI_thread * */
+} thread_deque_buffer_t;
+
+typedef struct {
+    /* Updated by thieves. */
+    ABTD_atomic_int64 top;
+    /* Updated by the owner. */
+    ABTU_align_member_var(ABT_CONFIG_STATIC_CACHELINE_SIZE)
+        ABTD_atomic_int64 bottom;
+    ABTD_atomic_ptr p_buffer; /* thread_deque_buffer_t * */
+} thread_deque_t;
+
+ABTU_ret_err static inline int
+thread_deque_buffer_create(int64_t size, thread_deque_buffer_t **pp_buffer)
+{
+    thread_deque_buffer_t *p_buffer;
+    int abt_errno =
+        ABTU_malloc(sizeof(thread_deque_buffer_t) +
+                        sizeof(ABTD_atomic_ptr) * (size_t)size,
+                    (void **)&p_buffer);
+    ABTI_CHECK_ERROR(abt_errno);
+    p_buffer->size = size;
+    p_buffer->p_prev = NULL;
+    p_buffer->elems = (ABTD_atomic_ptr *)(((char *)p_buffer) +
+                                          sizeof(thread_deque_buffer_t));
+    *pp_buffer = p_buffer;
+    return ABT_SUCCESS;
+}
+
+ABTU_ret_err static inline int thread_deque_init(thread_deque_t *p_deque)
+{
+    thread_deque_buffer_t *p_buffer;
+    int abt_errno =
+        thread_deque_buffer_create(THREAD_DEQUE_INIT_BUFFER_SIZE, &p_buffer);
+    ABTI_CHECK_ERROR(abt_errno);
+    ABTD_atomic_relaxed_store_int64(&p_deque->top, 0);
+    ABTD_atomic_relaxed_store_int64(&p_deque->bottom, 0);
+    ABTD_atomic_relaxed_store_ptr(&p_deque->p_buffer, p_buffer);
+    return ABT_SUCCESS;
+}
+
+static inline void thread_deque_free(thread_deque_t *p_deque)
+{
+    thread_deque_buffer_t *p_buffer =
+        (thread_deque_buffer_t *)ABTD_atomic_relaxed_load_ptr(
+            &p_deque->p_buffer);
+    while (p_buffer) {
+        thread_deque_buffer_t *p_prev = p_buffer->p_prev;
+        ABTU_free(p_buffer);
+        p_buffer = p_prev;
+    }
+}
+
+static inline size_t thread_deque_get_size(const thread_deque_t *p_deque)
+{
+    int64_t t = ABTD_atomic_acquire_load_int64(&p_deque->top);
+    int64_t b = ABTD_atomic_acquire_load_int64(&p_deque->bottom);
+    return b > t ? (size_t)(b - t) : 0;
+}
+
+static inline ABT_bool thread_deque_is_empty(const thread_deque_t *p_deque)
+{
+    return thread_deque_get_size(p_deque) == 0 ? ABT_TRUE : ABT_FALSE;
+}
+
+/* Make sure that the buffer can hold num_threads more work units.  Only the
+ * owner may call this function. */
+ABTU_ret_err static inline int
+thread_deque_reserve(thread_deque_t *p_deque, int64_t b, size_t num_threads,
+                     thread_deque_buffer_t **pp_buffer)
+{
+    int64_t t = ABTD_atomic_acquire_load_int64(&p_deque->top);
+    thread_deque_buffer_t *p_buffer =
+        (thread_deque_buffer_t *)ABTD_atomic_relaxed_load_ptr(
+            &p_deque->p_buffer);
+    int64_t new_size = p_buffer->size;
+    while (b - t + (int64_t)num_threads > new_size)
+        new_size *= 2;
+    if (new_size != p_buffer->size) {
+        thread_deque_buffer_t *p_new_buffer;
+        int abt_errno = thread_deque_buffer_create(new_size, &p_new_buffer);
+        ABTI_CHECK_ERROR(abt_errno);
+        int64_t i;
+        for (i = t; i < b; i++) {
+            void *p_elem = ABTD_atomic_relaxed_load_ptr(
+                &p_buffer->elems[i & (p_buffer->size - 1)]);
+            ABTD_atomic_relaxed_store_ptr(
+                &p_new_buffer->elems[i & (new_size - 1)], p_elem);
+        }
+        p_new_buffer->p_prev = p_buffer;
+        ABTD_atomic_release_store_ptr(&p_deque->p_buffer, p_new_buffer);
+        p_buffer = p_new_buffer;
+    }
+    *pp_buffer = p_buffer;
+    return ABT_SUCCESS;
+}
+
+ABTU_ret_err static inline int
+thread_deque_push_many_bottom(thread_deque_t *p_deque, const ABT_unit *units,
+                              size_t num_units)
+{
+    int64_t b = ABTD_atomic_relaxed_load_int64(&p_deque->bottom);
+    thread_deque_buffer_t *p_buffer;
+    int abt_errno = thread_deque_reserve(p_deque, b, num_units, &p_buffer);
+    ABTI_CHECK_ERROR(abt_errno);
+    size_t i;
+    for (i = 0; i < num_units; i++) {
+        ABTI_thread *p_thread =
+            ABTI_unit_get_thread_from_builtin_unit(units[i]);
+        /* p_next == NULL tells that this work unit is in the deque. */
+        p_thread->p_prev = NULL;
+        p_thread->p_next = NULL;
+        ABTD_atomic_relaxed_store_int(&p_thread->is_in_pool, 1);
+        ABTD_atomic_relaxed_store_ptr(&p_buffer->elems[(b + (int64_t)i) &
+                                                       (p_buffer->size - 1)],
+                                      p_thread);
+    }
+    /* Publish the work units. */
+    ABTD_atomic_release_store_int64(&p_deque->bottom, b + (int64_t)num_units);
+    return ABT_SUCCESS;
+}
+
+ABTU_ret_err static inline int
+thread_deque_push_bottom(thread_deque_t *p_deque, ABTI_thread *p_thread)
+{
+    ABT_unit unit = ABTI_unit_get_builtin_unit(p_thread);
+    return thread_deque_push_many_bottom(p_deque, &unit, 1);
+}
+
+static inline ABTI_thread *thread_deque_pop_bottom(thread_deque_t *p_deque)
+{
+    while (1) {
+        int64_t b = ABTD_atomic_relaxed_load_int64(&p_deque->bottom) - 1;
+        thread_deque_buffer_t *p_buffer =
+            (thread_deque_buffer_t *)ABTD_atomic_relaxed_load_ptr(
+                &p_deque->p_buffer);
+        const int64_t mask = p_buffer->size - 1;
+        ABTD_atomic_relaxed_store_int64(&p_deque->bottom, b);
+        ABTD_atomic_full_barrier();
+        int64_t t = ABTD_atomic_relaxed_load_int64(&p_deque->top);
+        ABTI_thread *p_thread;
+        if (b - t > THREAD_DEQUE_STEAL_MANY_MAX) {
+            /* No thief can reserve the bottom one. */
+            p_thread = (ABTI_thread *)ABTD_atomic_relaxed_load_ptr(
+                &p_buffer->elems[b & mask]);
+        } else if (t <= b) {
+            /* A thief might be reserving work units down to the bottom one.
+             * Take all of them by CAS and put the others back above b. */
+            ABTI_thread *p_others[THREAD_DEQUE_STEAL_MANY_MAX];
+            int64_t i, num_others = b - t;
+            for (i = 0; i < num_others; i++) {
+                p_others[i] = (ABTI_thread *)ABTD_atomic_relaxed_load_ptr(
+                    &p_buffer->elems[(t + i) & mask]);
+            }
+            p_thread = (ABTI_thread *)ABTD_atomic_relaxed_load_ptr(
+                &p_buffer->elems[b & mask]);
+            if (!ABTD_atomic_bool_cas_strong_int64(&p_deque->top, t, b + 1)) {
+                /* A thief has taken some.  Retry. */
+                ABTD_atomic_relaxed_store_int64(&p_deque->bottom, b + 1);
+                continue;
+            }
+            for (i = 0; i < num_others; i++) {
+                ABTD_atomic_relaxed_store_ptr(&p_buffer->elems[(b + 1 + i) &
+                                                               mask],
+                                              p_others[i]);
+            }
+            ABTD_atomic_release_store_int64(&p_deque->bottom,
+                                            b + 1 + num_others);
+        } else {
+            /* Empty. */
+            ABTD_atomic_relaxed_store_int64(&p_deque->bottom, b + 1);
+            return NULL;
+        }
+        ABTD_atomic_release_store_int(&p_thread->is_in_pool, 0);
+        return p_thread;
+    }
+}
+
+static inline ABTI_thread *thread_deque_steal_top(thread_deque_t *p_deque)
+{
+    while (1) {
+        int64_t t = ABTD_atomic_acquire_load_int64(&p_deque->top);
+        ABTD_atomic_full_barrier();
+        int64_t b = ABTD_atomic_acquire_load_int64(&p_deque->bottom);
+        if (t >= b)
+            return NULL;
+        thread_deque_buffer_t *p_buffer =
+            (thread_deque_buffer_t *)ABTD_atomic_acquire_load_ptr(
+                &p_deque->p_buffer);
+        ABTI_thread *p_thread = (ABTI_thread *)ABTD_atomic_relaxed_load_ptr(
+            &p_buffer->elems[t & (p_buffer->size - 1)]);
+        if (ABTD_atomic_bool_cas_strong_int64(&p_deque->top, t, t + 1)) {
+            ABTD_atomic_release_store_int(&p_thread->is_in_pool, 0);
+            return p_thread;
+        }
+        /* Another consumer took it.  Retry. */
+    }
+}
+
+/* Steal up to max_threads work units from the top.  Each CAS reserves up to
+ * THREAD_DEQUE_STEAL_MANY_MAX work units.  Return the number of stolen ones. */
+static inline size_t thread_deque_steal_many_top(thread_deque_t *p_deque,
+                                                 ABT_thread *threads,
+                                                 size_t max_threads)
+{
+    size_t num_stolen = 0;
+    while (num_stolen < max_threads) {
+        int64_t t = ABTD_atomic_acquire_load_int64(&p_deque->top);
+        ABTD_atomic_full_barrier();
+        int64_t b = ABTD_atomic_acquire_load_int64(&p_deque->bottom);
+        if (t >= b)
+            break;
+        int64_t i, num = b - t;
+        if (num > THREAD_DEQUE_STEAL_MANY_MAX)
+            num = THREAD_DEQUE_STEAL_MANY_MAX;
+        if (num > (int64_t)(max_threads - num_stolen))
+            num = (int64_t)(max_threads - num_stolen);
+        thread_deque_buffer_t *p_buffer =
+            (thread_deque_buffer_t *)ABTD_atomic_acquire_load_ptr(
+                &p_deque->p_buffer);
+        for (i = 0; i < num; i++) {
+            ABTI_thread *p_thread = (ABTI_thread *)ABTD_atomic_relaxed_load_ptr(
+                &p_buffer->elems[(t + i) & (p_buffer->size - 1)]);
+            threads[num_stolen + i] = ABTI_thread_get_handle(p_thread);
+        }
+        if (ABTD_atomic_bool_cas_strong_int64(&p_deque->top, t, t + num)) {
+            for (i = 0; i < num; i++) {
+                ABTI_thread *p_thread =
+                    ABTI_thread_get_ptr(threads[num_stolen + i]);
+                ABTD_atomic_release_store_int(&p_thread->is_in_pool, 0);
+            }
+            num_stolen += (size_t)num;
+        }
+        /* Otherwise, another consumer took some.  Retry. */
+    }
+    return num_stolen;
+}
+
+/* This function is not atomic.  Work units might be popped while they are
+ * being printed. */
+static inline void thread_deque_print_all(thread_deque_t *p_deque, void *arg,
+                                          void (*print_fn)(void *, ABT_thread))
+{
+    int64_t t = ABTD_atomic_acquire_load_int64(&p_deque->top);
+    int64_t b = ABTD_atomic_acquire_load_int64(&p_deque->bottom);
+    thread_deque_buffer_t *p_buffer =
+        (thread_deque_buffer_t *)ABTD_atomic_acquire_load_ptr(
+            &p_deque->p_buffer);
+    int64_t i;
+    for (i = b - 1; i >= t; i--) {
+        ABTI_thread *p_thread = (ABTI_thread *)ABTD_atomic_relaxed_load_ptr(
+            &p_buffer->elems[i & (p_buffer->size - 1)]);
+        print_fn(arg, ABTI_thread_get_handle(p_thread));
+    }
+}
+
+#endif /* THREAD_DEQUE_H_INCLUDED */
@@ -0,0 +1,338 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#ifndef THREAD_LOCKFREE_QUEUE_H_INCLUDED
+#define THREAD_LOCKFREE_QUEUE_H_INCLUDED
+
+#include "abti.h"
+
+/*
+ * Intrusive queue for work units whose push operations are lock-free.  The
+ * implementation is based on Vyukov's intrusive MPSC queue and reuses
+ * ABTI_thread's p_next as a link.
+ *
+ * Producers only swap p_tail with a single atomic exchange (push_many links all
+ * the work units with one exchange), so a push never waits for a consumer or
+ * another producer.  Consumers are serialized by a consumer-side spinlock
+ * (lock), which producers never touch.  Work units are intrusive and can be
+ * freed as soon as they are popped, so a consumer may not dereference a work
+ * unit that might have been taken by another consumer; serializing consumers
+ * avoids this memory reclamation problem.
+ *
+ * If the queue has a single consumer, the consumer does not need to take the
+ * lock to pop work units (see thread_lockfree_queue_enter_single_consumer()).
+ * The lock is then taken only by other operations that walk the queue (e.g.,
+ * removal), which wait for an ongoing pop after taking the lock.
+ *
+ * The number of work units is tracked by two counters so that producers and
+ * the consumer do not write the same cache line: num_pushed is updated next to
+ * p_tail and num_popped next to p_head.
+ *
+ * All the functions whose names end with "_unsafe" must be called while the
+ * consumer-side lock is taken (or in a single-consumer section).
+ */
+typedef struct {
+    /* Producer side. */
+    ABTD_atomic_ptr p_tail; /* ABTI_thread * */
+    ABTD_atomic_size num_pushed;
+    /* Consumer side. */
+    ABTU_align_member_var(ABT_CONFIG_STATIC_CACHELINE_SIZE)
+        ABTD_spinlock lock;
+    ABTD_atomic_int is_popping; /* Set by a single consumer. */
+    ABTD_atomic_ptr p_head;     /* ABTI_thread *.  Read by is_empty(). */
+    ABTD_atomic_size num_popped;
+    /* Dummy element that is linked when the queue would otherwise become
+     * empty.  Only p_next is used. */
+    ABTI_thread stub;
+} thread_lockfree_queue_t;
+
+static inline ABTD_atomic_ptr *
+thread_lockfree_queue_next_ptr(ABTI_thread *p_thread)
+{
+    return (ABTD_atomic_ptr *)&p_thread->p_next;
+}
+
+static inline void thread_lockfree_queue_init(thread_lockfree_queue_t *p_queue)
+{
+    ABTD_spinlock_clear(&p_queue->lock);
+    ABTD_atomic_relaxed_store_int(&p_queue->is_popping, 0);
+    ABTD_atomic_relaxed_store_size(&p_queue->num_pushed, 0);
+    ABTD_atomic_relaxed_store_size(&p_queue->num_popped, 0);
+    p_queue->stub.p_prev = NULL;
+    p_queue->stub.p_next = NULL;
+    ABTD_atomic_relaxed_store_ptr(&p_queue->p_head, &p_queue->stub);
+    ABTD_atomic_relaxed_store_ptr(&p_queue->p_tail, &p_queue->stub);
+}
+
+static inline void thread_lockfree_queue_free(thread_lockfree_queue_t *p_queue)
+{
+    ; /* Do nothing. */
+}
+
+/* Append a chain of work units [p_first, ..., p_last] that are already linked
+ * by p_next.  This is wait-free. */
+static inline void
+thread_lockfree_queue_link_tail(thread_lockfree_queue_t *p_queue,
+                                ABTI_thread *p_first, ABTI_thread *p_last)
+{
+    ABTD_atomic_relaxed_store_ptr(thread_lockfree_queue_next_ptr(p_last), NULL);
+    ABTI_thread *p_prev =
+        (ABTI_thread *)ABTD_atomic_exchange_ptr(&p_queue->p_tail, p_last);
+    /* Until the following store, consumers cannot reach p_first. */
+    ABTD_atomic_release_store_ptr(thread_lockfree_queue_next_ptr(p_prev),
+                                  p_first);
+}
+
+static inline ABT_bool
+thread_lockfree_queue_is_empty(const thread_lockfree_queue_t *p_queue)
+{
+    /* p_tail must be read first.  The stub is pushed only after p_head points
+     * to the last work unit, so p_head observed after p_tail points to the stub
+     * is not the stub if any work unit remains. */
+    const ABTI_thread *p_stub = &p_queue->stub;
+    if (ABTD_atomic_acquire_load_ptr(&p_queue->p_tail) != p_stub)
+        return ABT_FALSE;
+    return ABTD_atomic_acquire_load_ptr(&p_queue->p_head) == p_stub ? ABT_TRUE
+                                                                    : ABT_FALSE;
+}
+
+static inline void thread_lockfree_queue_push(thread_lockfree_queue_t *p_queue,
+                                              ABTI_thread *p_thread)
+{
+    ABTD_atomic_release_store_int(&p_thread->is_in_pool, 1);
+    /* The counter is incremented before p_thread becomes visible to the
+     * consumer so that num_popped never exceeds num_pushed. */
+    ABTD_atomic_fetch_add_size(&p_queue->num_pushed, 1);
+    thread_lockfree_queue_link_tail(p_queue, p_thread, p_thread);
+}
+
+static inline void
+thread_lockfree_queue_push_many(thread_lockfree_queue_t *p_queue,
+                                const ABT_unit *units, size_t num_units)
+{
+    if (num_units == 0)
+        return;
+    ABTI_thread *p_first = ABTI_unit_get_thread_from_builtin_unit(units[0]);
+    ABTI_thread *p_last = p_first;
+    size_t i;
+    ABTD_atomic_relaxed_store_int(&p_first->is_in_pool, 1);
+    for (i = 1; i < num_units; i++) {
+        ABTI_thread *p_thread =
+            ABTI_unit_get_thread_from_builtin_unit(units[i]);
+        ABTD_atomic_relaxed_store_int(&p_thread->is_in_pool, 1);
+        p_last->p_next = p_thread;
+        p_last = p_thread;
+    }
+    ABTD_atomic_fetch_add_size(&p_queue->num_pushed, num_units);
+    /* The exchange in link_tail() publishes all the stores above. */
+    thread_lockfree_queue_link_tail(p_queue, p_first, p_last);
+}
+
+ABTU_ret_err static inline int
+thread_lockfree_queue_acquire_if_not_empty(thread_lockfree_queue_t *p_queue)
+{
+    if (thread_lockfree_queue_is_empty(p_queue)) {
+        /* The queue is empty.  Lock is not taken. */
+        return 1;
+    }
+    while (ABTD_spinlock_try_acquire(&p_queue->lock)) {
+        /* Lock acquisition failed.  Check the size. */
+        while (1) {
+            if (thread_lockfree_queue_is_empty(p_queue)) {
+                /* The queue becomes empty.  Lock is not taken. */
+                return 1;
+            } else if (!ABTD_spinlock_is_locked(&p_queue->lock)) {
+                /* Lock seems released.  Let's try to take a lock again. */
+                break;
+            }
+        }
+    }
+    /* Lock is acquired. */
+    return 0;
+}
+
+static inline void
+thread_lockfree_queue_release(thread_lockfree_queue_t *p_queue)
+{
+    ABTD_spinlock_release(&p_queue->lock);
+}
+
+/* Take the consumer-side lock of a queue that has a single consumer.  The
+ * consumer might be popping a work unit without the lock, so this function
+ * waits for it.  The consumer never blocks in a pop, so the wait is short. */
+static inline void
+thread_lockfree_queue_acquire_single_consumer(thread_lockfree_queue_t *p_queue)
+{
+    ABTD_spinlock_acquire(&p_queue->lock);
+    /* The consumer must observe the lock before it touches p_head, or this
+     * thread must observe is_popping set by the consumer. */
+    ABTD_atomic_full_barrier();
+    while (ABTD_atomic_acquire_load_int(&p_queue->is_popping))
+        ABTD_atomic_pause();
+}
+
+/* Start a pop operation of the single consumer.  If this function returns
+ * ABT_FALSE, the consumer may call "_unsafe" pop functions without the lock
+ * and must call thread_lockfree_queue_leave_single_consumer() after them.
+ * Otherwise, another thread is holding the lock, so the consumer must take it
+ * as usual. */
+static inline ABT_bool
+thread_lockfree_queue_enter_single_consumer(thread_lockfree_queue_t *p_queue)
+{
+    ABTD_atomic_relaxed_store_int(&p_queue->is_popping, 1);
+    ABTD_atomic_full_barrier();
+    if (ABTU_likely(!ABTD_spinlock_is_locked(&p_queue->lock)))
+        return ABT_FALSE;
+    ABTD_atomic_release_store_int(&p_queue->is_popping, 0);
+    return ABT_TRUE;
+}
+
+static inline void
+thread_lockfree_queue_leave_single_consumer(thread_lockfree_queue_t *p_queue)
+{
+    ABTD_atomic_release_store_int(&p_queue->is_popping, 0);
+}
+
+/* Return NULL if the queue is empty or if a producer has not completed linking
+ * the next work unit yet.  In the latter case, the caller may retry later. */
+static inline ABTI_thread *
+thread_lockfree_queue_pop_head_unsafe(thread_lockfree_queue_t *p_queue)
+{
+    ABTI_thread *p_stub = &p_queue->stub;
+    ABTI_thread *p_head =
+        (ABTI_thread *)ABTD_atomic_relaxed_load_ptr(&p_queue->p_head);
+    ABTI_thread *p_next = (ABTI_thread *)ABTD_atomic_acquire_load_ptr(
+        thread_lockfree_queue_next_ptr(p_head));
+    if (p_head == p_stub) {
+        /* Skip the stub. */
+        if (!p_next)
+            return NULL;
+        ABTD_atomic_relaxed_store_ptr(&p_queue->p_head, p_next);
+        p_head = p_next;
+        p_next = (ABTI_thread *)ABTD_atomic_acquire_load_ptr(
+            thread_lockfree_queue_next_ptr(p_head));
+    }
+    if (!p_next) {
+        /* p_head might be the last one.  To pop p_head, the stub needs to be
+         * pushed after it. */
+        if (p_head != ABTD_atomic_acquire_load_ptr(&p_queue->p_tail))
+            return NULL; /* A producer is linking the next one. */
+        thread_lockfree_queue_link_tail(p_queue, p_stub, p_stub);
+        p_next = (ABTI_thread *)ABTD_atomic_acquire_load_ptr(
+            thread_lockfree_queue_next_ptr(p_head));
+        if (!p_next)
+            return NULL; /* A producer pushed one before the stub. */
+    }
+    ABTD_atomic_relaxed_store_ptr(&p_queue->p_head, p_next);
+    /* Only one thread updates num_popped at a time. */
+    ABTD_atomic_release_store_size(&p_queue->num_popped,
+                                   ABTD_atomic_relaxed_load_size(
+                                       &p_queue->num_popped) +
+                                       1);
+    p_head->p_prev = NULL;
+    p_head->p_next = NULL;
+    ABTD_atomic_release_store_int(&p_head->is_in_pool, 0);
+    return p_head;
+}
+
+/* Return the next work unit of p_thread.  If p_thread is not the tail, a
+ * producer is about to link the next one, so this function waits for it.
+ * NULL is returned only if p_thread is the tail. */
+static inline ABTI_thread *
+thread_lockfree_queue_wait_next_unsafe(thread_lockfree_queue_t *p_queue,
+                                       ABTI_thread *p_thread)
+{
+    while (1) {
+        ABTI_thread *p_next = (ABTI_thread *)ABTD_atomic_acquire_load_ptr(
+            thread_lockfree_queue_next_ptr(p_thread));
+        if (p_next) {
+            return p_next;
+        } else if (p_thread == ABTD_atomic_acquire_load_ptr(&p_queue->p_tail)) {
+            return NULL;
+        }
+        ABTD_atomic_pause();
+    }
+}
+
+ABTU_ret_err static inline int
+thread_lockfree_queue_remove_unsafe(thread_lockfree_queue_t *p_queue,
+                                    ABTI_thread *p_thread)
+{
+    ABTI_CHECK_TRUE(ABTD_atomic_acquire_load_int(&p_thread->is_in_pool) == 1,
+                    ABT_ERR_POOL);
+
+    ABTI_thread *p_stub = &p_queue->stub;
+    ABTI_thread *p_prev = NULL;
+    ABTI_thread *p_cur =
+        (ABTI_thread *)ABTD_atomic_relaxed_load_ptr(&p_queue->p_head);
+    /* Find p_thread.  The stub is unlinked on the way so that it can be pushed
+     * again if p_thread is the tail. */
+    while (p_cur != p_thread) {
+        ABTI_thread *p_next =
+            thread_lockfree_queue_wait_next_unsafe(p_queue, p_cur);
+        ABTI_CHECK_TRUE(p_next, ABT_ERR_POOL);
+        if (p_cur == p_stub) {
+            if (p_prev) {
+                ABTD_atomic_relaxed_store_ptr(
+                    thread_lockfree_queue_next_ptr(p_prev), p_next);
+            } else {
+                ABTD_atomic_relaxed_store_ptr(&p_queue->p_head, p_next);
+            }
+        } else {
+            p_prev = p_cur;
+        }
+        p_cur = p_next;
+    }
+    ABTI_thread *p_next =
+        thread_lockfree_queue_wait_next_unsafe(p_queue, p_thread);
+    if (!p_next) {
+        /* p_thread is the tail.  The stub is not in the queue now. */
+        thread_lockfree_queue_link_tail(p_queue, p_stub, p_stub);
+        p_next = thread_lockfree_queue_wait_next_unsafe(p_queue, p_thread);
+        ABTI_ASSERT(p_next);
+    }
+    if (p_prev) {
+        ABTD_atomic_relaxed_store_ptr(thread_lockfree_queue_next_ptr(p_prev),
+                                      p_next);
+    } else {
+        ABTD_atomic_relaxed_store_ptr(&p_queue->p_head, p_next);
+    }
+    ABTD_atomic_release_store_size(&p_queue->num_popped,
+                                   ABTD_atomic_relaxed_load_size(
+                                       &p_queue->num_popped) +
+                                       1);
+    p_thread->p_prev = NULL;
+    p_thread->p_next = NULL;
+    ABTD_atomic_release_store_int(&p_thread->is_in_pool, 0);
+    return ABT_SUCCESS;
+}
+
+static inline size_t
+thread_lockfree_queue_get_size(const thread_lockfree_queue_t *p_queue)
+{
+    /* num_popped must be read first.  A work unit is counted by num_pushed
+     * before it can be popped, so the difference is never negative. */
+    size_t num_popped = ABTD_atomic_acquire_load_size(&p_queue->num_popped);
+    size_t num_pushed = ABTD_atomic_acquire_load_size(&p_queue->num_pushed);
+    return num_pushed - num_popped;
+}
+
+static inline void
+thread_lockfree_queue_print_all_unsafe(thread_lockfree_queue_t *p_queue,
+                                       void *arg,
+                                       void (*print_fn)(void *, ABT_thread))
+{
+    ABTI_thread *p_stub = &p_queue->stub;
+    ABTI_thread *p_cur =
+        (ABTI_thread *)ABTD_atomic_relaxed_load_ptr(&p_queue->p_head);
+    while (p_cur) {
+        if (p_cur != p_stub)
+            print_fn(arg, ABTI_thread_get_handle(p_cur));
+        p_cur = (ABTI_thread *)ABTD_atomic_acquire_load_ptr(
+            thread_lockfree_queue_next_ptr(p_cur));
+    }
+}
+
+#endif /* THREAD_LOCKFREE_QUEUE_H_INCLUDED */
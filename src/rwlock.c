@@ -19,6 +19,13 @@
  *
  * \c newrwlock must be freed by \c ABT_rwlock_free() after its use.
  *
+ * @note
+ * \c newrwlock keeps a cache-line-sized reader counter per execution stream,
+ * up to the maximum number of execution streams (see
+ * \c ABT_INFO_QUERY_KIND_MAX_NUM_XSTREAMS) or 16 counters (1 KB with 64-byte
+ * cache lines), whichever is smaller.  Execution streams whose ranks exceed the number of counters
+ * share counters.  A writer needs to check all the counters.
+ *
  * @changev20
  * \DOC_DESC_V1X_SET_VALUE_ON_ERROR{\c newrwlock, \c ABT_RWLOCK_NULL}
  * @endchangev20
@@ -50,11 +57,11 @@ int ABT_rwlock_create(ABT_rwlock *newrwlock)
 
     int abt_errno = ABTU_malloc(sizeof(ABTI_rwlock), (void **)&p_newrwlock);
     ABTI_CHECK_ERROR(abt_errno);
-
-    ABTI_mutex_init(&p_newrwlock->mutex);
-    ABTI_cond_init(&p_newrwlock->cond);
-    p_newrwlock->reader_count = 0;
-    p_newrwlock->write_flag = 0;
+    abt_errno = ABTI_rwlock_init(p_newrwlock);
+    if (ABTI_IS_ERROR_CHECK_ENABLED && abt_errno != ABT_SUCCESS) {
+        ABTU_free(p_newrwlock);
+        ABTI_HANDLE_ERROR(abt_errno);
+    }
 
     /* Return value */
     *newrwlock = ABTI_rwlock_get_handle(p_newrwlock);
@@ -96,7 +103,7 @@ int ABT_rwlock_free(ABT_rwlock *rwlock)
     ABTI_rwlock *p_rwlock = ABTI_rwlock_get_ptr(h_rwlock);
     ABTI_CHECK_NULL_RWLOCK_PTR(p_rwlock);
 
-    ABTI_cond_fini(&p_rwlock->cond);
+    ABTI_rwlock_fini(p_rwlock);
     ABTU_free(p_rwlock);
 
     /* Return value */
@@ -159,16 +166,7 @@ int ABT_rwlock_rdlock(ABT_rwlock rwlock)
     }
 #endif
 
-    ABTI_mutex_lock(&p_local, &p_rwlock->mutex);
-    int abt_errno = ABT_SUCCESS;
-    while (p_rwlock->write_flag && abt_errno == ABT_SUCCESS) {
-        abt_errno = ABTI_cond_wait(&p_local, &p_rwlock->cond, &p_rwlock->mutex);
-    }
-    if (abt_errno == ABT_SUCCESS) {
-        p_rwlock->reader_count++;
-    }
-    ABTI_mutex_unlock(p_local, &p_rwlock->mutex);
-    ABTI_CHECK_ERROR(abt_errno);
+    ABTI_rwlock_rdlock(&p_local, p_rwlock);
     return ABT_SUCCESS;
 }
 
@@ -222,17 +220,7 @@ int ABT_rwlock_wrlock(ABT_rwlock rwlock)
     }
 #endif
 
-    ABTI_mutex_lock(&p_local, &p_rwlock->mutex);
-    int abt_errno = ABT_SUCCESS;
-    while ((p_rwlock->write_flag || p_rwlock->reader_count) &&
-           abt_errno == ABT_SUCCESS) {
-        abt_errno = ABTI_cond_wait(&p_local, &p_rwlock->cond, &p_rwlock->mutex);
-    }
-    if (abt_errno == ABT_SUCCESS) {
-        p_rwlock->write_flag = 1;
-    }
-    ABTI_mutex_unlock(p_local, &p_rwlock->mutex);
-    ABTI_CHECK_ERROR(abt_errno);
+    ABTI_rwlock_wrlock(&p_local, p_rwlock);
     return ABT_SUCCESS;
 }
 
@@ -268,14 +256,6 @@ int ABT_rwlock_unlock(ABT_rwlock rwlock)
     ABTI_rwlock *p_rwlock = ABTI_rwlock_get_ptr(rwlock);
     ABTI_CHECK_NULL_RWLOCK_PTR(p_rwlock);
 
-    ABTI_mutex_lock(&p_local, &p_rwlock->mutex);
-    if (p_rwlock->write_flag) {
-        p_rwlock->write_flag = 0;
-    } else {
-        ABTI_UB_ASSERT(p_rwlock->reader_count > 0);
-        p_rwlock->reader_count--;
-    }
-    ABTI_cond_broadcast(p_local, &p_rwlock->cond);
-    ABTI_mutex_unlock(p_local, &p_rwlock->mutex);
+    ABTI_rwlock_unlock(p_local, p_rwlock);
     return ABT_SUCCESS;
 }
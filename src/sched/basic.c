@@ -96,7 +96,7 @@ static void sched_run(ABT_sched sched)
     ABTI_xstream *p_local_xstream =
         ABTI_local_get_xstream(ABTI_local_get_local());
     ABT_thread thread = ABT_THREAD_NULL;
-    uint32_t pop_count = 0;
+    uint32_t pop_count = 0, idle_count = 0;
     sched_data *p_data;
     uint32_t event_freq;
     int num_pools;
@@ -122,6 +122,11 @@ static void sched_run(ABT_sched sched)
                 break;
             }
         }
+        if (thread == ABT_THREAD_NULL) {
+            ABTI_sched_idle(p_global, p_sched, &idle_count);
+        } else {
+            idle_count = 0;
+        }
         /* if we attempted event_freq pops, check for events */
         if (pop_count >= event_freq) {
             ABTI_xstream_check_events(p_local_xstream, p_sched);
@@ -87,7 +87,7 @@ static void sched_run(ABT_sched sched)
     ABTI_global *p_global = ABTI_global_get_global();
     ABTI_xstream *p_local_xstream =
         ABTI_local_get_xstream(ABTI_local_get_local());
-    uint32_t work_count = 0;
+    uint32_t work_count = 0, idle_count = 0;
     sched_data *p_data;
     uint32_t event_freq;
     int num_pools;
@@ -108,11 +108,11 @@ static void sched_run(ABT_sched sched)
 
         /* Execute one work unit from the scheduler's pool */
         /* The pool with lower index has higher priority. */
+        ABT_thread thread = ABT_THREAD_NULL;
         for (i = 0; i < num_pools; i++) {
             ABT_pool pool = pools[i];
             ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
-            ABT_thread thread =
-                ABTI_pool_pop(p_pool, ABT_POOL_CONTEXT_OP_POOL_OTHER);
+            thread = ABTI_pool_pop(p_pool, ABT_POOL_CONTEXT_OP_POOL_OTHER);
             if (thread != ABT_THREAD_NULL) {
                 ABTI_thread *p_thread = ABTI_thread_get_ptr(thread);
                 ABTI_ythread_schedule(p_global, &p_local_xstream, p_thread);
@@ -120,6 +120,11 @@ static void sched_run(ABT_sched sched)
                 break;
             }
         }
+        if (thread == ABT_THREAD_NULL) {
+            ABTI_sched_idle(p_global, p_sched, &idle_count);
+        } else {
+            idle_count = 0;
+        }
 
         if (++work_count >= event_freq) {
             ABTI_xstream_check_events(p_local_xstream, p_sched);
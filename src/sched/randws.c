@@ -19,10 +19,31 @@ static ABT_sched_def sched_randws_def = {
     .get_migr_pool = NULL,
 };
 
+/* The maximum number of work units stolen at once in the steal-half mode. */
+#define SCHED_RANDWS_MAX_STEAL 64
+/* Intervals in seconds between attempts to locate victim pools.  The interval
+ * doubles after each failed attempt. */
+#define SCHED_RANDWS_RESOLVE_INTERVAL_MIN 1.0e-3
+#define SCHED_RANDWS_RESOLVE_INTERVAL_MAX 0.1
+
 typedef struct {
     uint32_t event_freq;
+    ABT_bool steal_half;
     int num_pools;
     ABT_pool *pools;
+    /* Hierarchical victim selection.  victims keeps the indices of victim
+     * pools sorted by the topology level.  Victims of level l are
+     * victims[victim_offsets[l]], ..., victims[victim_offsets[l + 1] - 1]. */
+    ABT_bool victim_hierarchy;
+    int *victim_levels; /* Level of each pool.  Given by the user. */
+    int *victims;       /* Also used as a work buffer. */
+    int victim_offsets[ABTD_TOPOLOGY_NUM_LEVELS + 1];
+    /* Whether all the victim pools have been located.  Until then, victims
+     * are chosen uniformly at random and the scheduler retries locating them
+     * when it checks events. */
+    ABT_bool victims_resolved;
+    double next_resolve_time;
+    double resolve_interval;
 #ifdef ABT_CONFIG_USE_SCHED_SLEEP
     struct timespec sleep_time;
 #endif
@@ -54,14 +75,39 @@ static int sched_init(ABT_sched sched, ABT_sched_config config)
 
     /* Set the default value by default. */
     p_data->event_freq = p_global->sched_event_freq;
+    p_data->steal_half = ABT_FALSE;
+    p_data->victim_hierarchy = ABT_FALSE;
+    p_data->victims_resolved = ABT_TRUE;
+    p_data->victim_levels = NULL;
+    p_data->victims = NULL;
+    const int *victim_levels = NULL;
     if (p_config) {
-        int event_freq;
+        int event_freq, steal_half, victim_hierarchy;
         /* Set the variables from config */
         abt_errno = ABTI_sched_config_read(p_config, ABT_sched_basic_freq.idx,
                                            &event_freq);
         if (abt_errno == ABT_SUCCESS) {
             p_data->event_freq = event_freq;
         }
+        abt_errno =
+            ABTI_sched_config_read(p_config, ABT_sched_randws_steal_half.idx,
+                                   &steal_half);
+        if (abt_errno == ABT_SUCCESS) {
+            p_data->steal_half = steal_half ? ABT_TRUE : ABT_FALSE;
+        }
+        abt_errno = ABTI_sched_config_read(p_config,
+                                           ABT_sched_randws_victim_hierarchy
+                                               .idx,
+                                           &victim_hierarchy);
+        if (abt_errno == ABT_SUCCESS) {
+            p_data->victim_hierarchy = victim_hierarchy ? ABT_TRUE : ABT_FALSE;
+        }
+        abt_errno =
+            ABTI_sched_config_read(p_config, ABT_sched_randws_victim_levels.idx,
+                                   &victim_levels);
+        if (abt_errno == ABT_SUCCESS && victim_levels) {
+            p_data->victim_hierarchy = ABT_TRUE;
+        }
     }
 
     /* Save the list of pools */
@@ -75,16 +121,213 @@ static int sched_init(ABT_sched sched, ABT_sched_config config)
     }
     memcpy(p_data->pools, p_sched->pools, sizeof(ABT_pool) * num_pools);
 
+    if (p_data->victim_hierarchy) {
+        /* victims, victim_levels, and two work buffers. */
+        abt_errno = ABTU_malloc(num_pools * sizeof(int) * 4,
+                                (void **)&p_data->victims);
+        if (ABTI_IS_ERROR_CHECK_ENABLED && abt_errno != ABT_SUCCESS) {
+            ABTU_free(p_data->pools);
+            ABTU_free(p_data);
+            ABTI_HANDLE_ERROR(abt_errno);
+        }
+        if (victim_levels) {
+            /* The user specifies the hierarchy. */
+            int i;
+            p_data->victim_levels = p_data->victims + num_pools;
+            for (i = 0; i < num_pools; i++) {
+                int level = victim_levels[i];
+                if (level < 0 || level >= ABTD_TOPOLOGY_NUM_LEVELS)
+                    level = ABTD_TOPOLOGY_LEVEL_REMOTE;
+                p_data->victim_levels[i] = level;
+            }
+        }
+    }
+
     p_sched->data = p_data;
     return ABT_SUCCESS;
 }
 
+/* Return the CPU ID if p_xstream is bound to a single CPU.  Otherwise, return
+ * -1. */
+static int sched_get_xstream_cpuid(ABTI_xstream *p_xstream)
+{
+    int cpuid, num_cpuids;
+    int ret = ABTD_affinity_cpuset_read(&p_xstream->ctx, 1, &cpuid,
+                                        &num_cpuids);
+    return (ret == ABT_SUCCESS && num_cpuids == 1) ? cpuid : -1;
+}
+
+/* Sort victim pools by the topology level.  If the user does not specify the
+ * levels, the level of a victim pool is determined by the CPU topology of the
+ * ES whose main scheduler has the victim pool as its first pool.  If some
+ * victim pool is not the first pool of any ES yet (e.g., its ES has not been
+ * created), all the victims are regarded as remote ones so that victims are
+ * chosen uniformly at random, and this function returns ABT_FALSE so that the
+ * caller tries it again later. */
+static ABT_bool sched_update_victims(ABTI_global *p_global,
+                                     ABTI_xstream *p_local_xstream,
+                                     sched_data *p_data)
+{
+    ABT_bool is_resolved = ABT_TRUE;
+    int i, level, num_pools = p_data->num_pools;
+    int *levels = p_data->victim_levels;
+
+    if (!levels) {
+        int *tmp_levels = p_data->victims + num_pools * 2;
+        int *cpuids = p_data->victims + num_pools * 3;
+        ABTD_topology_cpu self_cpu, cpu;
+        cpuids[0] = sched_get_xstream_cpuid(p_local_xstream);
+        for (i = 1; i < num_pools; i++)
+            cpuids[i] = -2; /* Not found. */
+        /* Find ESs that have the victim pools. */
+        ABTD_spinlock_acquire(&p_global->xstream_list_lock);
+        ABTI_xstream *p_xstream = p_global->p_xstream_head;
+        while (p_xstream) {
+            ABTI_sched *p_main_sched = p_xstream->p_main_sched;
+            if (p_xstream != p_local_xstream && p_main_sched &&
+                p_main_sched->num_pools > 0) {
+                for (i = 1; i < num_pools; i++) {
+                    if (p_main_sched->pools[0] == p_data->pools[i])
+                        cpuids[i] = sched_get_xstream_cpuid(p_xstream);
+                }
+            }
+            p_xstream = p_xstream->p_next;
+        }
+        ABTD_spinlock_release(&p_global->xstream_list_lock);
+
+        /* Read the topology.  Victims on unknown CPUs are regarded as remote
+         * ones.  If some victim is not located, all the victims are flat. */
+        ABT_bool use_topology =
+            (cpuids[0] >= 0 &&
+             ABTD_topology_cpu_read(cpuids[0], &self_cpu) == ABT_SUCCESS)
+                ? ABT_TRUE
+                : ABT_FALSE;
+        for (i = 1; i < num_pools; i++) {
+            if (cpuids[i] == -2) {
+                /* If the topology of this ES is unknown, locating the victims
+                 * does not change the result. */
+                if (use_topology)
+                    is_resolved = ABT_FALSE;
+                use_topology = ABT_FALSE;
+                break;
+            }
+        }
+        for (i = 1; i < num_pools; i++) {
+            if (use_topology && cpuids[i] >= 0 &&
+                ABTD_topology_cpu_read(cpuids[i], &cpu) == ABT_SUCCESS) {
+                tmp_levels[i] = ABTD_topology_get_level(&self_cpu, &cpu);
+            } else {
+                tmp_levels[i] = ABTD_TOPOLOGY_LEVEL_REMOTE;
+            }
+        }
+        levels = tmp_levels;
+    }
+
+    /* Sort victims by level.  The first pool is not a victim. */
+    int num_victims = 0;
+    for (level = 0; level < ABTD_TOPOLOGY_NUM_LEVELS; level++) {
+        p_data->victim_offsets[level] = num_victims;
+        for (i = 1; i < num_pools; i++) {
+            if (levels[i] == level)
+                p_data->victims[num_victims++] = i;
+        }
+    }
+    p_data->victim_offsets[ABTD_TOPOLOGY_NUM_LEVELS] = num_victims;
+    return is_resolved;
+}
+
+/* Try to locate the victim pools again if the last attempt has failed.  The
+ * attempts are rate-limited since each one scans all the ESs. */
+static void sched_retry_update_victims(ABTI_global *p_global,
+                                       ABTI_xstream *p_local_xstream,
+                                       sched_data *p_data)
+{
+    double cur_time = ABTI_get_wtime();
+    if (cur_time < p_data->next_resolve_time)
+        return;
+    p_data->victims_resolved =
+        sched_update_victims(p_global, p_local_xstream, p_data);
+    if (!p_data->victims_resolved) {
+        p_data->resolve_interval *= 2.0;
+        if (p_data->resolve_interval > SCHED_RANDWS_RESOLVE_INTERVAL_MAX)
+            p_data->resolve_interval = SCHED_RANDWS_RESOLVE_INTERVAL_MAX;
+        p_data->next_resolve_time = cur_time + p_data->resolve_interval;
+    }
+}
+
+/* Steal up to half of the work units in p_victim_pool.  The first one is
+ * returned and the others are pushed to p_pool.  Their associated pools are not
+ * changed, as is the case with stealing a single work unit. */
+static ABT_thread sched_steal_half(ABTI_pool *p_pool, ABTI_pool *p_victim_pool)
+{
+    size_t size = ABTI_pool_get_size(p_victim_pool);
+    size_t num_steal = (size + 1) / 2;
+    if (num_steal <= 1) {
+        return ABTI_pool_pop(p_victim_pool, ABT_POOL_CONTEXT_OWNER_SECONDARY);
+    } else if (num_steal > SCHED_RANDWS_MAX_STEAL) {
+        num_steal = SCHED_RANDWS_MAX_STEAL;
+    }
+    ABT_thread threads[SCHED_RANDWS_MAX_STEAL];
+    ABT_unit units[SCHED_RANDWS_MAX_STEAL];
+    size_t i, num_popped;
+    ABTI_pool_pop_many(p_victim_pool, threads, num_steal, &num_popped,
+                       ABT_POOL_CONTEXT_OWNER_SECONDARY);
+    if (num_popped == 0)
+        return ABT_THREAD_NULL;
+    for (i = 1; i < num_popped; i++) {
+        ABTI_thread *p_thread = ABTI_thread_get_ptr(threads[i]);
+        /* The stolen work units live in p_pool from now on.  Both pools use the
+         * built-in ABT_unit, so the unit does not need to be recreated. */
+        p_thread->p_pool = p_pool;
+        units[i - 1] = p_thread->unit;
+    }
+    if (num_popped > 1) {
+        ABTI_pool_push_many(p_pool, units, num_popped - 1,
+                            ABT_POOL_CONTEXT_OP_THREAD_MIGRATE);
+    }
+    return threads[0];
+}
+
+static ABT_thread sched_steal(sched_data *p_data, ABTI_pool *p_pool,
+                              int target)
+{
+    ABTI_pool *p_victim_pool = ABTI_pool_get_ptr(p_data->pools[target]);
+    /* Work units can be moved between pools only if both pools use the
+     * built-in ABT_unit. */
+    if (p_data->steal_half && p_pool->is_builtin && p_victim_pool->is_builtin &&
+        p_victim_pool->optional_def.p_get_size &&
+        p_victim_pool->optional_def.p_pop_many &&
+        p_pool->optional_def.p_push_many) {
+        return sched_steal_half(p_pool, p_victim_pool);
+    } else {
+        return ABTI_pool_pop(p_victim_pool, ABT_POOL_CONTEXT_OWNER_SECONDARY);
+    }
+}
+
+/* Try a random victim in each topology level from the nearest one. */
+static ABT_thread sched_steal_hierarchical(sched_data *p_data,
+                                           ABTI_pool *p_pool, unsigned *p_seed)
+{
+    int level;
+    for (level = 0; level < ABTD_TOPOLOGY_NUM_LEVELS; level++) {
+        int offset = p_data->victim_offsets[level];
+        int num_victims = p_data->victim_offsets[level + 1] - offset;
+        if (num_victims == 0)
+            continue;
+        int target = p_data->victims[offset + rand_r(p_seed) % num_victims];
+        ABT_thread thread = sched_steal(p_data, p_pool, target);
+        if (thread != ABT_THREAD_NULL)
+            return thread;
+    }
+    return ABT_THREAD_NULL;
+}
+
 static void sched_run(ABT_sched sched)
 {
     ABTI_global *p_global = ABTI_global_get_global();
     ABTI_xstream *p_local_xstream =
         ABTI_local_get_xstream(ABTI_local_get_local());
-    uint32_t work_count = 0;
+    uint32_t work_count = 0, idle_count = 0;
     sched_data *p_data;
     int num_pools;
     ABT_pool *pools;
@@ -98,6 +341,16 @@ static void sched_run(ABT_sched sched)
     p_data = (sched_data *)p_sched->data;
     num_pools = p_sched->num_pools;
     pools = p_data->pools;
+    if (p_data->victim_hierarchy) {
+        p_data->victims_resolved =
+            sched_update_victims(p_global, p_local_xstream, p_data);
+        p_data->resolve_interval = SCHED_RANDWS_RESOLVE_INTERVAL_MIN;
+        p_data->next_resolve_time =
+            ABTI_get_wtime() + SCHED_RANDWS_RESOLVE_INTERVAL_MIN;
+    }
+    /* This ES owns the deque of the first pool while this scheduler runs. */
+    ABTI_xstream *p_owner_xstream = p_local_xstream;
+    ABTI_pool_randws_bind_owner(ABTI_pool_get_ptr(pools[0]), p_owner_xstream);
 
     while (1) {
         CNT_INIT(run_cnt, 0);
@@ -113,26 +366,37 @@ static void sched_run(ABT_sched sched)
             CNT_INC(run_cnt);
         } else if (num_pools > 1) {
             /* Steal a work unit from other pools */
-            target =
-                (num_pools == 2) ? 1 : (rand_r(&seed) % (num_pools - 1) + 1);
-            pool = pools[target];
-            p_pool = ABTI_pool_get_ptr(pool);
-            thread = ABTI_pool_pop(p_pool, ABT_POOL_CONTEXT_OWNER_SECONDARY);
+            if (p_data->victim_hierarchy) {
+                thread = sched_steal_hierarchical(p_data, p_pool, &seed);
+            } else {
+                target = (num_pools == 2) ? 1
+                                          : (rand_r(&seed) % (num_pools - 1) +
+                                             1);
+                thread = sched_steal(p_data, p_pool, target);
+            }
             if (thread != ABT_THREAD_NULL) {
                 ABTI_thread *p_thread = ABTI_thread_get_ptr(thread);
                 ABTI_ythread_schedule(p_global, &p_local_xstream, p_thread);
                 CNT_INC(run_cnt);
             }
         }
+        if (thread == ABT_THREAD_NULL) {
+            ABTI_sched_idle(p_global, p_sched, &idle_count);
+        } else {
+            idle_count = 0;
+        }
 
         if (++work_count >= p_data->event_freq) {
             ABTI_xstream_check_events(p_local_xstream, p_sched);
             if (ABTI_sched_has_to_stop(p_sched) == ABT_TRUE)
                 break;
+            if (p_data->victim_hierarchy && !p_data->victims_resolved)
+                sched_retry_update_victims(p_global, p_local_xstream, p_data);
             work_count = 0;
             SCHED_SLEEP(run_cnt, p_data->sleep_time);
         }
     }
+    ABTI_pool_randws_unbind_owner(ABTI_pool_get_ptr(pools[0]), p_owner_xstream);
 }
 
 static int sched_free(ABT_sched sched)
@@ -141,6 +405,8 @@ static int sched_free(ABT_sched sched)
     ABTI_ASSERT(p_sched);
 
     sched_data *p_data = (sched_data *)p_sched->data;
+    if (p_data->victims)
+        ABTU_free(p_data->victims);
     ABTU_free(p_data->pools);
     ABTU_free(p_data);
     return ABT_SUCCESS;
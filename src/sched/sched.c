@@ -11,6 +11,13 @@ ABTU_ret_err static int sched_create(ABT_sched_def *def, int num_pools,
                                      ABT_bool def_automatic,
                                      ABTI_sched **pp_newsched);
 static inline ABTI_sched_kind sched_get_kind(ABT_sched_def *def);
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+static ABT_bool sched_add_park_node(ABTI_pool *p_pool,
+                                    ABTI_sched_park_node *p_node);
+static void sched_remove_park_node(ABTI_pool *p_pool,
+                                   ABTI_sched_park_node *p_node);
+static ABT_bool sched_unpark(ABTI_sched *p_sched);
+#endif
 #ifdef ABT_CONFIG_USE_DEBUG_LOG
 static inline uint64_t sched_get_new_id(void);
 #endif
@@ -700,13 +707,110 @@ int ABT_sched_get_total_size(ABT_sched sched, size_t *size)
 void ABTI_sched_finish(ABTI_sched *p_sched)
 {
     ABTI_sched_set_request(p_sched, ABTI_SCHED_REQ_FINISH);
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+    sched_unpark(p_sched);
+#endif
 }
 
 void ABTI_sched_exit(ABTI_sched *p_sched)
 {
     ABTI_sched_set_request(p_sched, ABTI_SCHED_REQ_EXIT);
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+    sched_unpark(p_sched);
+#endif
+}
+
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+/* Park the calling ES until a work unit is pushed to one of the pools of
+ * p_sched or a request is set to p_sched.  p_sched must be the main scheduler
+ * of the calling ES.  This function may return spuriously. */
+void ABTI_sched_park(ABTI_sched *p_sched)
+{
+    size_t p, num_pools = p_sched->num_pools;
+    ABT_bool has_work = ABT_FALSE;
+
+    if (!p_sched->park_nodes) {
+        ABTI_sched_park_node *park_nodes;
+        int abt_errno = ABTU_malloc(sizeof(ABTI_sched_park_node) * num_pools,
+                                    (void **)&park_nodes);
+        if (abt_errno != ABT_SUCCESS)
+            return;
+        for (p = 0; p < num_pools; p++) {
+            park_nodes[p].p_sched = p_sched;
+            park_nodes[p].p_prev = NULL;
+            park_nodes[p].p_next = NULL;
+            park_nodes[p].has_set_flag = ABT_FALSE;
+        }
+        p_sched->park_nodes = park_nodes;
+    }
+
+    ABTD_spinlock_acquire(&p_sched->park_lock);
+    p_sched->is_parked = ABT_TRUE;
+    ABTD_spinlock_release(&p_sched->park_lock);
+    for (p = 0; p < num_pools; p++) {
+        ABTI_pool *p_pool = ABTI_pool_get_ptr(p_sched->pools[p]);
+        if (sched_add_park_node(p_pool, &p_sched->park_nodes[p])) {
+            /* A pusher might not see has_parked_scheds yet, so this call does
+             * not sleep. */
+            has_work = ABT_TRUE;
+        }
+    }
+    /* This barrier pairs with the one in ABTI_pool_unpark_scheds(): either the
+     * pusher sees num_parked_scheds or this ES sees the pushed work unit. */
+    ABTD_atomic_full_barrier();
+    if (!has_work) {
+        if (ABTD_atomic_acquire_load_uint32(&p_sched->request) != 0) {
+            has_work = ABT_TRUE;
+        } else {
+            for (p = 0; p < num_pools; p++) {
+                ABTI_pool *p_pool = ABTI_pool_get_ptr(p_sched->pools[p]);
+                if (!ABTI_pool_is_empty(p_pool)) {
+                    has_work = ABT_TRUE;
+                    break;
+                }
+            }
+        }
+    }
+    ABTD_spinlock_acquire(&p_sched->park_lock);
+    if (!has_work && p_sched->is_parked) {
+        /* The timeout is a safety net for events that do not push a work unit,
+         * such as ABT_info_trigger_print_all_thread_stacks(). */
+        ABTD_futex_timedwait_and_unlock(&p_sched->park_futex,
+                                        &p_sched->park_lock,
+                                        ABTI_SCHED_PARK_TIMEOUT_SEC);
+        ABTD_spinlock_acquire(&p_sched->park_lock);
+    }
+    p_sched->is_parked = ABT_FALSE;
+    ABTD_spinlock_release(&p_sched->park_lock);
+    for (p = 0; p < num_pools; p++) {
+        ABTI_pool *p_pool = ABTI_pool_get_ptr(p_sched->pools[p]);
+        sched_remove_park_node(p_pool, &p_sched->park_nodes[p]);
+    }
 }
 
+/* Wake up at most num_units schedulers parked on p_pool.  Schedulers that use
+ * p_pool as their first pool are woken up first. */
+void ABTI_sched_unpark_pool(ABTI_pool *p_pool, size_t num_units)
+{
+    int pass;
+    ABTD_spinlock_acquire(&p_pool->park_lock);
+    for (pass = 0; pass < 2 && num_units > 0; pass++) {
+        ABTI_sched_park_node *p_node = p_pool->p_parked_head;
+        while (p_node && num_units > 0) {
+            ABTI_sched *p_sched = p_node->p_sched;
+            ABT_bool is_first_pool =
+                (p_node == &p_sched->park_nodes[0]) ? ABT_TRUE : ABT_FALSE;
+            if (is_first_pool == (pass == 0 ? ABT_TRUE : ABT_FALSE) &&
+                sched_unpark(p_sched)) {
+                num_units--;
+            }
+            p_node = p_node->p_next;
+        }
+    }
+    ABTD_spinlock_release(&p_pool->park_lock);
+}
+#endif
+
 ABTU_ret_err int ABTI_sched_create_basic(ABT_sched_predef predef, int num_pools,
                                          ABT_pool *pools,
                                          ABTI_sched_config *p_config,
@@ -911,6 +1015,9 @@ void ABTI_sched_free(ABTI_global *p_global, ABTI_local *p_local,
         }
     }
     ABTU_free(p_sched->pools);
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+    ABTU_free(p_sched->park_nodes);
+#endif
 
     /* Free the associated work unit */
     if (p_sched->p_ythread) {
@@ -1157,6 +1264,13 @@ ABTU_ret_err static int sched_create(ABT_sched_def *def, int num_pools,
     p_sched->free = def->free;
     p_sched->get_migr_pool = def->get_migr_pool;
 
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+    ABTD_spinlock_clear(&p_sched->park_lock);
+    p_sched->is_parked = ABT_FALSE;
+    ABTD_futex_multiple_init(&p_sched->park_futex);
+    p_sched->park_nodes = NULL;
+#endif
+
 #ifdef ABT_CONFIG_USE_DEBUG_LOG
     p_sched->id = sched_get_new_id();
 #endif
@@ -1187,9 +1301,74 @@ ABTU_ret_err static int sched_create(ABT_sched_def *def, int num_pools,
     return ABT_SUCCESS;
 }
 
+#ifndef ABT_CONFIG_ACTIVE_WAIT_POLICY
+/* Return ABT_TRUE if this call sets has_parked_scheds of p_pool. */
+static ABT_bool sched_add_park_node(ABTI_pool *p_pool,
+                                    ABTI_sched_park_node *p_node)
+{
+    ABTD_spinlock_acquire(&p_pool->park_lock);
+    p_node->has_set_flag = ABT_FALSE;
+    if (ABTD_atomic_relaxed_load_int32(&p_pool->has_parked_scheds) == 0) {
+        ABTD_atomic_relaxed_store_int32(&p_pool->has_parked_scheds, 1);
+        p_node->has_set_flag = ABT_TRUE;
+    }
+    ABTI_sched_park_node *p_head = p_pool->p_parked_head;
+    p_node->p_prev = NULL;
+    p_node->p_next = p_head;
+    if (p_head)
+        p_head->p_prev = p_node;
+    p_pool->p_parked_head = p_node;
+    ABTD_atomic_fetch_add_int32(&p_pool->num_parked_scheds, 1);
+    ABTD_spinlock_release(&p_pool->park_lock);
+    return p_node->has_set_flag;
+}
+
+static void sched_remove_park_node(ABTI_pool *p_pool,
+                                   ABTI_sched_park_node *p_node)
+{
+    ABTD_spinlock_acquire(&p_pool->park_lock);
+    ABTI_sched_park_node *p_prev = p_node->p_prev;
+    ABTI_sched_park_node *p_next = p_node->p_next;
+    if (p_prev) {
+        p_prev->p_next = p_next;
+    } else {
+        p_pool->p_parked_head = p_next;
+    }
+    if (p_next)
+        p_next->p_prev = p_prev;
+    p_node->p_prev = NULL;
+    p_node->p_next = NULL;
+    if (ABTD_atomic_fetch_sub_int32(&p_pool->num_parked_scheds, 1) == 1 &&
+        !p_node->has_set_flag) {
+        /* No scheduler is parked on p_pool, so pushes can skip the barrier
+         * again. */
+        ABTD_atomic_relaxed_store_int32(&p_pool->has_parked_scheds, 0);
+    }
+    ABTD_spinlock_release(&p_pool->park_lock);
+}
+
+/* Wake up p_sched if it is parked.  Return ABT_TRUE if it is woken up. */
+static ABT_bool sched_unpark(ABTI_sched *p_sched)
+{
+    ABT_bool is_parked;
+    ABTD_spinlock_acquire(&p_sched->park_lock);
+    is_parked = p_sched->is_parked;
+    if (is_parked) {
+        p_sched->is_parked = ABT_FALSE;
+        ABTD_futex_broadcast(&p_sched->park_futex);
+    }
+    ABTD_spinlock_release(&p_sched->park_lock);
+    return is_parked;
+}
+#endif
+
 #ifdef ABT_CONFIG_USE_DEBUG_LOG
 static inline uint64_t sched_get_new_id(void)
 {
-    return ABTD_atomic_fetch_add_uint64(&g_sched_id, 1);
+    ABTI_xstream *p_local_xstream =
+        ABTI_local_get_xstream_or_null(ABTI_local_get_local());
+    ABTI_id_block *p_block =
+        p_local_xstream ? &p_local_xstream->sched_id_block : NULL;
+    return ABTI_id_block_get_new_id(p_block, &g_sched_id);
 }
 #endif
@@ -51,6 +51,18 @@ ABT_sched_config_var ABT_sched_config_automatic = { .idx = -3,
 ABT_sched_config_var ABT_sched_basic_freq = { .idx = -4,
                                               .type = ABT_SCHED_CONFIG_INT };
 
+ABT_sched_config_var ABT_sched_randws_steal_half = { .idx = -5,
+                                                     .type =
+                                                         ABT_SCHED_CONFIG_INT };
+
+ABT_sched_config_var ABT_sched_randws_victim_hierarchy = {
+    .idx = -6, .type = ABT_SCHED_CONFIG_INT
+};
+
+ABT_sched_config_var ABT_sched_randws_victim_levels = {
+    .idx = -7, .type = ABT_SCHED_CONFIG_PTR
+};
+
 /**
  * @ingroup SCHED_CONFIG
  * @brief   Create a new scheduler configuration.
@@ -70,6 +82,37 @@ ABT_sched_config_var ABT_sched_basic_freq = { .idx = -4,
  *   indicates more frequent check.  If this is not specified, the default value
  *   is used for scheduler creation.
  *
+ * - \c ABT_sched_randws_steal_half:
+ *
+ *   Whether \c ABT_SCHED_RANDWS steals half of the work units in a victim pool
+ *   at once or not.  If the value is non-zero, the scheduler steals up to half
+ *   of the work units in a victim pool, runs one of them, and pushes the others
+ *   to its first pool.  This reduces the number of steals when work units are
+ *   unevenly created.  If this is not specified, the scheduler steals one work
+ *   unit at a time.
+ *
+ * - \c ABT_sched_randws_victim_hierarchy:
+ *
+ *   Whether \c ABT_SCHED_RANDWS chooses victim pools based on the CPU topology
+ *   or not.  If the value is non-zero, the scheduler first tries a victim pool
+ *   that belongs to an execution stream on the same core, then on the same L3
+ *   cache, then on the same NUMA node, and finally a remote one.  The victim
+ *   pool is chosen at random within each level.  The topology is obtained from
+ *   the affinity of the execution stream whose main scheduler has the victim
+ *   pool as its first pool; a victim pool is regarded as remote if the
+ *   execution streams are not bound to a single CPU or the topology is not
+ *   available.  If this is not specified, the scheduler chooses a victim pool
+ *   uniformly at random.
+ *
+ * - \c ABT_sched_randws_victim_levels:
+ *
+ *   An array of \c int that gives the topology level of each pool of
+ *   \c ABT_SCHED_RANDWS explicitly: 0 (same core), 1 (same L3 cache), 2 (same
+ *   NUMA node), or 3 (remote).  The array must have as many elements as the
+ *   pools of the scheduler; the first element is ignored.  The array is copied
+ *   on scheduler creation.  Specifying this variable enables the hierarchical
+ *   victim selection.
+ *
  * - \c ABT_sched_config_automatic:
  *
  *   Whether the scheduler is automatically freed or not.  If the value is
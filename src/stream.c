@@ -1629,13 +1629,16 @@ void ABTI_xstream_check_events(ABTI_xstream *p_xstream, ABTI_sched *p_sched)
     if (request & ABTI_THREAD_REQ_CANCEL) {
         ABTI_sched_exit(p_sched);
     }
+
+    /* Return memory that this ES has not used for a while. */
+    ABTI_mem_trim_local(p_xstream);
 }
 
 void ABTI_xstream_free(ABTI_global *p_global, ABTI_local *p_local,
                        ABTI_xstream *p_xstream, ABT_bool force_free)
 {
     /* Clean up memory pool. */
-    ABTI_mem_finalize_local(p_xstream);
+    ABTI_mem_finalize_local(p_global, p_xstream);
     /* Return rank for reuse. rank must be returned prior to other free
      * functions so that other xstreams cannot refer to this xstream. */
     xstream_return_rank(p_global, p_xstream);
@@ -1716,6 +1719,7 @@ void ABTI_xstream_print(ABTI_xstream *p_xstream, FILE *p_os, int indent,
         }
         fprintf(p_os, "%*sctx          :\n", indent, "");
         ABTD_xstream_context_print(&p_xstream->ctx, p_os, indent + ABTI_INDENT);
+        ABTI_mem_print_local(p_xstream, p_os, indent);
     }
     fflush(p_os);
 }
@@ -1772,6 +1776,11 @@ ABTU_ret_err static int xstream_create(ABTI_global *p_global,
                                   ABT_XSTREAM_STATE_RUNNING);
     p_newxstream->p_main_sched = NULL;
     p_newxstream->p_thread = NULL;
+    ABTI_id_block_init(&p_newxstream->thread_id_block);
+    ABTI_id_block_init(&p_newxstream->pool_id_block);
+#ifdef ABT_CONFIG_USE_DEBUG_LOG
+    ABTI_id_block_init(&p_newxstream->sched_id_block);
+#endif
     abt_errno = ABTI_mem_init_local(p_global, p_newxstream);
     if (abt_errno != ABT_SUCCESS)
         goto FAILED;
@@ -1843,7 +1852,7 @@ FAILED:
     }
     if (init_stage >= 2) {
         p_sched->used = ABTI_SCHED_NOT_USED;
-        ABTI_mem_finalize_local(p_newxstream);
+        ABTI_mem_finalize_local(p_global, p_newxstream);
     }
     if (init_stage >= 1) {
         xstream_return_rank(p_global, p_newxstream);
@@ -10,6 +10,22 @@ ABTU_ret_err static int task_create(ABTI_global *p_global, ABTI_local *p_local,
                                     void (*task_func)(void *), void *arg,
                                     ABTI_sched *p_sched, int refcount,
                                     ABTI_thread **pp_newtask);
+ABTU_ret_err static int task_init(ABTI_global *p_global, ABTI_local *p_local,
+                                  ABTI_pool *p_pool, void (*task_func)(void *),
+                                  void *arg, int refcount,
+                                  ABTI_thread **pp_newtask);
+ABTU_ret_err static int task_init_desc(ABTI_global *p_global,
+                                       ABTI_pool *p_pool,
+                                       void (*task_func)(void *), void *arg,
+                                       int refcount, ABTI_thread *p_newtask);
+static void task_release(ABTI_global *p_global, ABTI_local *p_local,
+                         ABTI_thread *p_task);
+
+/* A tasklet descriptor is taken from the descriptor pool, whose elements are
+ * large enough to hold ABTI_ythread.  ABT_task_create_inline() copies an
+ * argument into the unused space after ABTI_thread. */
+#define TASK_INLINE_ARG_OFFSET ((sizeof(ABTI_thread) + 15) & ~((size_t)15))
+#define TASK_MANY_BUFFER_SIZE 64
 
 /** @defgroup TASK Tasklet
  * This group is for Tasklet.  A tasklet is a work unit that cannot yield.
@@ -151,6 +167,209 @@ int ABT_task_create_on_xstream(ABT_xstream xstream, void (*task_func)(void *),
     return ABT_SUCCESS;
 }
 
+/**
+ * @ingroup TASK
+ * @brief   Create a new tasklet with an argument stored in its descriptor.
+ *
+ * \c ABT_task_create_inline() creates a new tasklet, associates it with the
+ * pool \c pool, and returns its handle through \c newtask.  This routine copies
+ * \c arg_size bytes pointed to by \c arg into the descriptor of the created
+ * tasklet and pushes the created tasklet to the pool \c pool.  The created
+ * tasklet calls \c task_func() with a pointer to the copied argument when it is
+ * scheduled.  The copied argument is aligned to 16 bytes and is valid until the
+ * tasklet is freed.  This routine does not allocate any memory other than the
+ * descriptor of the tasklet.
+ *
+ * \c arg_size may not be larger than \c ABT_TASK_INLINE_ARG_SIZE.
+ *
+ * If \c newtask is \c NULL, this routine creates an unnamed tasklet.  An
+ * unnamed tasklet is automatically released on the completion of
+ * \c task_func().  Otherwise, \c newtask must be explicitly freed by
+ * \c ABT_thread_free().  \c newtask is not updated on error.
+ *
+ * @contexts
+ * \DOC_CONTEXT_INIT \DOC_CONTEXT_NOCTXSWITCH
+ *
+ * @errors
+ * \DOC_ERROR_SUCCESS
+ * \DOC_ERROR_INV_POOL_HANDLE{\c pool}
+ * \DOC_ERROR_INV_ARG_GREATER_THAN{\c arg_size, \c ABT_TASK_INLINE_ARG_SIZE}
+ * \DOC_ERROR_RESOURCE
+ * \DOC_ERROR_RESOURCE_UNIT_CREATE
+ *
+ * @undefined
+ * \DOC_UNDEFINED_UNINIT
+ * \DOC_UNDEFINED_NULL_PTR{\c task_func}
+ * \DOC_UNDEFINED_NULL_PTR_CONDITIONAL{\c arg, \c arg_size is not zero}
+ *
+ * @param[in]  pool       pool handle
+ * @param[in]  task_func  function to be executed by a new tasklet
+ * @param[in]  arg        argument to be copied for \c task_func()
+ * @param[in]  arg_size   size of \c arg in bytes
+ * @param[out] newtask    tasklet handle
+ * @return Error code
+ */
+int ABT_task_create_inline(ABT_pool pool, void (*task_func)(void *),
+                           const void *arg, size_t arg_size, ABT_task *newtask)
+{
+    ABTI_UB_ASSERT(ABTI_initialized());
+    ABTI_UB_ASSERT(task_func);
+    ABTI_UB_ASSERT(arg || arg_size == 0);
+
+    ABTI_global *p_global = ABTI_global_get_global();
+    ABTI_local *p_local = ABTI_local_get_local();
+    ABTI_thread *p_newtask;
+    ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
+    ABTI_CHECK_NULL_POOL_PTR(p_pool);
+    ABTI_CHECK_TRUE(arg_size <= ABT_TASK_INLINE_ARG_SIZE, ABT_ERR_INV_ARG);
+    ABTI_STATIC_ASSERT(TASK_INLINE_ARG_OFFSET + ABT_TASK_INLINE_ARG_SIZE <=
+                       ABTI_MEM_POOL_DESC_ELEM_SIZE);
+
+    int refcount = (newtask != NULL) ? 1 : 0;
+    int abt_errno = task_init(p_global, p_local, p_pool, task_func, NULL,
+                              refcount, &p_newtask);
+    ABTI_CHECK_ERROR(abt_errno);
+    /* Copy the argument into the descriptor. */
+    void *p_inline_arg = (void *)(((char *)p_newtask) + TASK_INLINE_ARG_OFFSET);
+    if (arg_size > 0)
+        memcpy(p_inline_arg, arg, arg_size);
+    p_newtask->p_arg = p_inline_arg;
+
+    ABTI_event_thread_create(p_local, p_newtask,
+                             ABTI_local_get_xstream_or_null(p_local)
+                                 ? ABTI_local_get_xstream(p_local)->p_thread
+                                 : NULL,
+                             p_pool);
+    ABTI_pool_push(p_pool, p_newtask->unit, ABT_POOL_CONTEXT_OP_THREAD_CREATE);
+
+    /* Return value */
+    if (newtask)
+        *newtask = ABTI_thread_get_handle(p_newtask);
+    return ABT_SUCCESS;
+}
+
+/**
+ * @ingroup TASK
+ * @brief   Create a set of tasklets in the same pool.
+ *
+ * \c ABT_task_create_many() creates \c num_tasks tasklets, associates them
+ * with the pool \c pool, and returns their handles through \c newtask_list.
+ * The \c i th created tasklet calls \c task_func() with \c arg_list[i] when it
+ * is scheduled.  If \c arg_list is \c NULL, \c NULL is passed to all the
+ * tasklets.
+ *
+ * This routine first creates all the tasklets, whose descriptors are allocated
+ * from the memory pool at once, and then pushes them to the pool \c pool at
+ * once by \c ABT_pool_user_push_many_fn if \c pool supports it.
+ * Otherwise, the tasklets are pushed to \c pool one by one.  If this routine
+ * fails, no tasklet is created.
+ *
+ * If \c newtask_list is \c NULL, this routine creates unnamed tasklets.  An
+ * unnamed tasklet is automatically released on the completion of
+ * \c task_func().  Otherwise, each of \c newtask_list must be explicitly freed
+ * by \c ABT_thread_free().  \c newtask_list is not updated on error.
+ *
+ * @contexts
+ * \DOC_CONTEXT_INIT \DOC_CONTEXT_NOCTXSWITCH
+ *
+ * @errors
+ * \DOC_ERROR_SUCCESS
+ * \DOC_ERROR_INV_POOL_HANDLE{\c pool}
+ * \DOC_ERROR_INV_ARG_NEG{\c num_tasks}
+ * \DOC_ERROR_RESOURCE
+ * \DOC_ERROR_RESOURCE_UNIT_CREATE
+ *
+ * @undefined
+ * \DOC_UNDEFINED_UNINIT
+ * \DOC_UNDEFINED_NULL_PTR{\c task_func}
+ *
+ * @param[in]  num_tasks     number of tasklets
+ * @param[in]  pool          pool handle
+ * @param[in]  task_func     function to be executed by new tasklets
+ * @param[in]  arg_list      list of arguments for \c task_func()
+ * @param[out] newtask_list  list of tasklet handles
+ * @return Error code
+ */
+int ABT_task_create_many(int num_tasks, ABT_pool pool,
+                         void (*task_func)(void *), void **arg_list,
+                         ABT_task *newtask_list)
+{
+    ABTI_UB_ASSERT(ABTI_initialized());
+    ABTI_UB_ASSERT(task_func);
+
+    ABTI_global *p_global = ABTI_global_get_global();
+    ABTI_local *p_local = ABTI_local_get_local();
+    ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
+    ABTI_CHECK_NULL_POOL_PTR(p_pool);
+    ABTI_CHECK_TRUE(num_tasks >= 0, ABT_ERR_INV_ARG);
+    if (num_tasks == 0)
+        return ABT_SUCCESS;
+
+    int abt_errno, i, j;
+    ABTI_thread *newtasks_buffer[TASK_MANY_BUFFER_SIZE], **p_newtasks;
+    ABT_unit units_buffer[TASK_MANY_BUFFER_SIZE], *units;
+    if (num_tasks > TASK_MANY_BUFFER_SIZE) {
+        /* Allocate both lists at once. */
+        abt_errno = ABTU_malloc((sizeof(ABTI_thread *) + sizeof(ABT_unit)) *
+                                    num_tasks,
+                                (void **)&units);
+        ABTI_CHECK_ERROR(abt_errno);
+        p_newtasks = (ABTI_thread **)(units + num_tasks);
+    } else {
+        p_newtasks = newtasks_buffer;
+        units = units_buffer;
+    }
+
+    /* Allocate all the descriptors from the memory pool at once. */
+    abt_errno =
+        ABTI_mem_alloc_nythread_many(p_local, (size_t)num_tasks, p_newtasks);
+    if (ABTI_IS_ERROR_CHECK_ENABLED && abt_errno != ABT_SUCCESS) {
+        if (units != units_buffer)
+            ABTU_free(units);
+        ABTI_HANDLE_ERROR(abt_errno);
+    }
+    int refcount = (newtask_list != NULL) ? 1 : 0;
+    for (i = 0; i < num_tasks; i++) {
+        void *arg = arg_list ? arg_list[i] : NULL;
+        abt_errno = task_init_desc(p_global, p_pool, task_func, arg, refcount,
+                                   p_newtasks[i]);
+        if (ABTI_IS_ERROR_CHECK_ENABLED && abt_errno != ABT_SUCCESS) {
+            /* Free descriptors that have not been initialized and release
+             * tasklets that have been already created. */
+            for (j = i; j < num_tasks; j++)
+                ABTI_mem_free_thread(p_global, p_local, p_newtasks[j]);
+            while (i-- > 0)
+                task_release(p_global, p_local, p_newtasks[i]);
+            if (units != units_buffer)
+                ABTU_free(units);
+            ABTI_HANDLE_ERROR(abt_errno);
+        }
+        units[i] = p_newtasks[i]->unit;
+    }
+
+    ABTI_thread *p_caller = ABTI_local_get_xstream_or_null(p_local)
+                                ? ABTI_local_get_xstream(p_local)->p_thread
+                                : NULL;
+    for (i = 0; i < num_tasks; i++) {
+        ABTI_event_thread_create(p_local, p_newtasks[i], p_caller, p_pool);
+        if (newtask_list)
+            newtask_list[i] = ABTI_thread_get_handle(p_newtasks[i]);
+    }
+
+    /* Add tasklets to the pool. */
+    if (p_pool->optional_def.p_push_many) {
+        ABTI_pool_push_many(p_pool, units, num_tasks,
+                            ABT_POOL_CONTEXT_OP_THREAD_CREATE);
+    } else {
+        for (i = 0; i < num_tasks; i++) {
+            ABTI_pool_push(p_pool, units[i], ABT_POOL_CONTEXT_OP_THREAD_CREATE);
+        }
+    }
+    if (units != units_buffer)
+        ABTU_free(units);
+    return ABT_SUCCESS;
+}
+
 /**
  * @ingroup TASK
  * @brief   Revive a terminated work unit.
@@ -577,15 +796,59 @@ ABTU_ret_err static int task_create(ABTI_global *p_global, ABTI_local *p_local,
 {
     ABTI_thread *p_newtask;
 
+    int abt_errno = task_init(p_global, p_local, p_pool, task_func, arg,
+                              refcount, &p_newtask);
+    ABTI_CHECK_ERROR(abt_errno);
+
+    ABTI_event_thread_create(p_local, p_newtask,
+                             ABTI_local_get_xstream_or_null(p_local)
+                                 ? ABTI_local_get_xstream(p_local)->p_thread
+                                 : NULL,
+                             p_pool);
+
+    /* Add this task to the scheduler's pool */
+    ABTI_pool_push(p_pool, p_newtask->unit, ABT_POOL_CONTEXT_OP_THREAD_CREATE);
+
+    /* Return value */
+    *pp_newtask = p_newtask;
+
+    return ABT_SUCCESS;
+}
+
+/* Allocate and initialize a tasklet associated with p_pool.  The tasklet is
+ * neither pushed to p_pool nor reported to the event interface. */
+ABTU_ret_err static int task_init(ABTI_global *p_global, ABTI_local *p_local,
+                                  ABTI_pool *p_pool, void (*task_func)(void *),
+                                  void *arg, int refcount,
+                                  ABTI_thread **pp_newtask)
+{
+    ABTI_thread *p_newtask;
+
     /* Allocate a task object */
     int abt_errno = ABTI_mem_alloc_nythread(p_local, &p_newtask);
     ABTI_CHECK_ERROR(abt_errno);
-    abt_errno = ABTI_thread_init_pool(p_global, p_newtask, p_pool);
+    abt_errno =
+        task_init_desc(p_global, p_pool, task_func, arg, refcount, p_newtask);
     if (ABTI_IS_ERROR_CHECK_ENABLED && abt_errno != ABT_SUCCESS) {
         ABTI_mem_free_thread(p_global, p_local, p_newtask);
         ABTI_HANDLE_ERROR(abt_errno);
     }
 
+    /* Return value */
+    *pp_newtask = p_newtask;
+    return ABT_SUCCESS;
+}
+
+/* Initialize an allocated tasklet descriptor.  If it fails, p_newtask is not
+ * associated with p_pool and can be freed by ABTI_mem_free_thread(). */
+ABTU_ret_err static int task_init_desc(ABTI_global *p_global,
+                                       ABTI_pool *p_pool,
+                                       void (*task_func)(void *), void *arg,
+                                       int refcount, ABTI_thread *p_newtask)
+{
+    int abt_errno = ABTI_thread_init_pool(p_global, p_newtask, p_pool);
+    ABTI_CHECK_ERROR(abt_errno);
+
     p_newtask->p_last_xstream = NULL;
     p_newtask->p_parent = NULL;
     ABTD_atomic_relaxed_store_int(&p_newtask->state, ABT_THREAD_STATE_READY);
@@ -603,18 +866,13 @@ ABTU_ret_err static int task_create(ABTI_global *p_global, ABTI_local *p_local,
     thread_type |= ABTI_THREAD_TYPE_MIGRATABLE;
 #endif
     p_newtask->type |= thread_type;
-
-    ABTI_event_thread_create(p_local, p_newtask,
-                             ABTI_local_get_xstream_or_null(p_local)
-                                 ? ABTI_local_get_xstream(p_local)->p_thread
-                                 : NULL,
-                             p_pool);
-
-    /* Add this task to the scheduler's pool */
-    ABTI_pool_push(p_pool, p_newtask->unit, ABT_POOL_CONTEXT_OP_THREAD_CREATE);
-
-    /* Return value */
-    *pp_newtask = p_newtask;
-
     return ABT_SUCCESS;
 }
+
+/* Release a tasklet created by task_init() that has not been pushed. */
+static void task_release(ABTI_global *p_global, ABTI_local *p_local,
+                         ABTI_thread *p_task)
+{
+    ABTI_thread_unset_associated_pool(p_global, p_task);
+    ABTI_mem_free_thread(p_global, p_local, p_task);
+}
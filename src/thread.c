@@ -16,12 +16,22 @@ ythread_create(ABTI_global *p_global, ABTI_local *p_local, ABTI_pool *p_pool,
                ABTI_thread_type thread_type, ABTI_sched *p_sched,
                thread_pool_op_kind pool_op, ABTI_ythread **pp_newthread);
 ABTU_ret_err static inline int
+ythread_init(ABTI_global *p_global, ABTI_local *p_local, ABTI_pool *p_pool,
+             void (*thread_func)(void *), void *arg, ABTI_thread_attr *p_attr,
+             ABTI_thread_type thread_type, ABTI_sched *p_sched,
+             thread_pool_op_kind pool_op, ABTI_ythread *p_newthread);
+ABTU_ret_err static inline int
 thread_revive(ABTI_global *p_global, ABTI_local *p_local, ABTI_pool *p_pool,
               void (*thread_func)(void *), void *arg,
               thread_pool_op_kind pool_op, ABTI_thread *p_thread);
+ABTU_ret_err static inline int thread_check_joinable(ABTI_local *p_local,
+                                                     ABTI_thread *p_thread);
 static inline void thread_join(ABTI_local **pp_local, ABTI_thread *p_thread);
+static inline ABT_bool thread_is_fork_in_pool(ABTI_thread *p_thread);
 static inline void thread_free(ABTI_global *p_global, ABTI_local *p_local,
                                ABTI_thread *p_thread, ABT_bool free_unit);
+static void thread_free_resources(ABTI_global *p_global, ABTI_local *p_local,
+                                  ABTI_thread *p_thread, ABT_bool free_unit);
 static void thread_root_func(void *arg);
 static void thread_main_sched_func(void *arg);
 #ifndef ABT_CONFIG_DISABLE_MIGRATION
@@ -41,6 +51,8 @@ static ABTI_key g_thread_mig_data_key =
     ABTI_KEY_STATIC_INITIALIZER(thread_key_destructor_migration,
                                 ABTI_KEY_ID_MIGRATION);
 
+#define THREAD_MANY_BUFFER_SIZE 64
+
 /** @defgroup ULT User-level Thread (ULT)
  * This group is for User-level Thread (ULT).
  * A ULT is a work unit that can yield.
@@ -214,6 +226,146 @@ int ABT_thread_create_to(ABT_pool pool, void (*thread_func)(void *), void *arg,
     return ABT_SUCCESS;
 }
 
+/**
+ * @ingroup ULT
+ * @brief   Fork a new ULT that its joiner can execute in place.
+ *
+ * \c ABT_thread_fork() creates a new ULT with the default ULT attribute,
+ * associates it with the pool \c pool, and returns its handle through
+ * \c newthread.  The created ULT is pushed to \c pool.
+ *
+ * Unlike \c ABT_thread_create(), the created ULT does not have to be executed
+ * by a scheduler.  If a ULT joins (or frees) \c newthread before any scheduler
+ * pops it from \c pool, the joiner calls \c thread_func() with \c arg on its
+ * own stack as if it were a normal function call.  In this case, neither a
+ * stack nor a context switch is needed for \c newthread.  Otherwise,
+ * \c newthread runs as a normal ULT and the joiner waits for its termination.
+ * This routine is useful for fork-join parallelism where most children are
+ * not stolen by other execution streams (e.g., recursive divide and conquer).
+ *
+ * If the caller is a ULT, this routine does not push \c newthread immediately.
+ * \c newthread is pushed when the caller forks another ULT, yields, suspends,
+ * or terminates, so the caller that joins (or frees) \c newthread before then
+ * executes \c newthread in place without any pool operation.
+ *
+ * If \c newthread is \c NULL, this routine creates an unnamed ULT in the same
+ * way as \c ABT_thread_create().
+ *
+ * @note
+ * While \c thread_func() is executed by the joiner, it runs as a part of the
+ * joiner.  For example, \c ABT_self_get_thread() returns the joiner, and
+ * \c ABT_self_exit() terminates the joiner.  \c thread_func() that depends on
+ * its own ULT identity should be created by \c ABT_thread_create().\n
+ * A tasklet, a main scheduler, and an external thread never execute a forked
+ * ULT in place; they just wait for its completion.\n
+ * Until the caller pushes \c newthread, no other ULT can run \c newthread, so
+ * the caller must not wait for \c newthread without yielding (e.g., by
+ * busy-waiting on a flag that \c newthread sets).\n
+ * If a joiner executes \c newthread in place after it has been pushed, the
+ * joiner removes \c newthread from \c pool.  If \c pool does not support
+ * removal of a unit, \c newthread instead stays in \c pool as a stale entry
+ * until a scheduler pops and discards it.  A stale entry costs one pop
+ * operation, and its descriptor is not released even after \c newthread is
+ * freed until the pop; \c newthread cannot be revived until then.  Stale
+ * entries are not counted as the size of the pool.\n
+ * Forked ULTs executed in place nest on the stack of the joiner.  The joiner
+ * executes \c newthread in place only while at least half of its own stack is
+ * free; otherwise, it waits for \c newthread as \c ABT_thread_join() does, so
+ * \c newthread runs on its own stack.
+ *
+ * @changev20
+ * \DOC_DESC_V1X_SET_VALUE_ON_ERROR_CONDITIONAL{\c newthread,
+ *                                              \c ABT_THREAD_NULL,
+ *                                              \c newthread is not \c NULL}
+ * @endchangev20
+ *
+ * @contexts
+ * \DOC_CONTEXT_INIT \DOC_CONTEXT_NOCTXSWITCH
+ *
+ * @errors
+ * \DOC_ERROR_SUCCESS
+ * \DOC_ERROR_INV_POOL_HANDLE{\c pool}
+ * \DOC_ERROR_RESOURCE
+ * \DOC_ERROR_RESOURCE_UNIT_CREATE
+ *
+ * @undefined
+ * \DOC_UNDEFINED_UNINIT
+ * \DOC_UNDEFINED_NULL_PTR{\c thread_func}
+ *
+ * @param[in]  pool         pool handle
+ * @param[in]  thread_func  function to be executed by a new ULT
+ * @param[in]  arg          argument for \c thread_func()
+ * @param[out] newthread    ULT handle
+ * @return Error code
+ */
+int ABT_thread_fork(ABT_pool pool, void (*thread_func)(void *), void *arg,
+                    ABT_thread *newthread)
+{
+    ABTI_UB_ASSERT(ABTI_initialized());
+    ABTI_UB_ASSERT(thread_func);
+
+#ifndef ABT_CONFIG_ENABLE_VER_20_API
+    /* Argobots 1.x sets newthread to NULL on error. */
+    if (newthread)
+        *newthread = ABT_THREAD_NULL;
+#endif
+    ABTI_global *p_global;
+    ABTI_SETUP_GLOBAL(&p_global);
+    ABTI_local *p_local = ABTI_local_get_local();
+    ABTI_ythread *p_newthread;
+
+    ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
+    ABTI_CHECK_NULL_POOL_PTR(p_pool);
+
+    if (!newthread) {
+        /* Nobody joins an unnamed ULT, so it is a normal ULT. */
+        int abt_errno =
+            ythread_create(p_global, p_local, p_pool, thread_func, arg, NULL,
+                           ABTI_THREAD_TYPE_YIELDABLE, NULL,
+                           THREAD_POOL_OP_PUSH, &p_newthread);
+        ABTI_CHECK_ERROR(abt_errno);
+        return ABT_SUCCESS;
+    }
+
+    /* A stack is allocated only when a scheduler runs the new ULT since a
+     * ULT executed by its joiner runs on the joiner's stack. */
+    ABTI_thread_attr attr;
+    ABTI_thread_attr_init(&attr, NULL, p_global->thread_stacksize, ABT_TRUE);
+    attr.lazy_stack = ABT_TRUE;
+    int abt_errno =
+        ythread_create(p_global, p_local, p_pool, thread_func, arg, &attr,
+                       ABTI_THREAD_TYPE_YIELDABLE | ABTI_THREAD_TYPE_NAMED |
+                           ABTI_THREAD_TYPE_FORK,
+                       NULL, THREAD_POOL_OP_INIT, &p_newthread);
+    ABTI_CHECK_ERROR(abt_errno);
+    ABTI_xstream *p_local_xstream = ABTI_local_get_xstream_or_null(p_local);
+    ABTI_ythread *p_self =
+        p_local_xstream
+            ? ABTI_thread_get_ythread_or_null(p_local_xstream->p_thread)
+            : NULL;
+    if (p_self && !(p_self->thread.type & ABTI_THREAD_TYPE_MAIN_SCHED)) {
+        /* No scheduler can steal the new ULT before the caller stops running,
+         * so the push is deferred until then.  If the caller joins the new ULT
+         * first, the pool is not touched at all.  Only the latest forked ULT
+         * is kept. */
+        ABTI_ythread_push_deferred_fork(p_self);
+        ABTD_atomic_relaxed_store_uint32(&p_newthread->thread.request,
+                                         ABTI_THREAD_REQ_FORK |
+                                             ABTI_THREAD_REQ_FORK_DEFERRED);
+        p_self->p_deferred_fork = &p_newthread->thread;
+    } else {
+        /* The request must be set before the new ULT is pushed to a pool. */
+        ABTD_atomic_relaxed_store_uint32(&p_newthread->thread.request,
+                                         ABTI_THREAD_REQ_FORK);
+        ABTI_pool_push(p_pool, p_newthread->thread.unit,
+                       ABT_POOL_CONTEXT_OP_THREAD_CREATE);
+    }
+
+    /* Return value */
+    *newthread = ABTI_ythread_get_handle(p_newthread);
+    return ABT_SUCCESS;
+}
+
 /**
  * @ingroup ULT
  * @brief   Create a new ULT associated with an execution stream.
@@ -314,7 +466,14 @@ int ABT_thread_create_on_xstream(ABT_xstream xstream,
  * pool of \c pool_list that has \c num_threads of pools handles.  That is, the
  * \a i th ULT is pushed to \a i th pool of \c pool_list and, when scheduled,
  * calls the \a i th function of \c thread_func_list with the \a i th argument
- * of \c arg_list.  This routine pushes newly created ULTs to pools \c pool.
+ * of \c arg_list.  If \c arg_list is \c NULL, \c NULL is passed to all the
+ * ULT functions.
+ *
+ * This routine first creates all the ULTs and then pushes them to their pools.
+ * ULTs that use a stack of the default size are allocated from the memory pool
+ * at once.  ULTs associated with the same pool are pushed to the pool at once
+ * by \c ABT_pool_user_push_many_fn if the pool supports it.  If this routine
+ * fails, no ULT is created and \c newthread_list is not updated.
  *
  * \c attr can be created by \c ABT_thread_attr_create().  If the user passes
  * \c ABT_THREAD_ATTR_NULL for \c attr, the default ULT attribute is used.
@@ -337,9 +496,16 @@ int ABT_thread_create_on_xstream(ABT_xstream xstream,
  *
  * @errors
  * \DOC_ERROR_SUCCESS
+ * \DOC_ERROR_INV_POOL_HANDLE{an element of \c pool_list}
+ * \DOC_ERROR_INV_ARG_NEG{\c num_threads}
+ * \c ABT_ERR_INV_THREAD_ATTR is returned if \c attr has a user-provided stack.
+ * \DOC_ERROR_RESOURCE
+ * \DOC_ERROR_RESOURCE_UNIT_CREATE
  *
  * @undefined
- * \DOC_UNDEFINED_NO_ERROR_HANDLING
+ * \DOC_UNDEFINED_UNINIT
+ * \DOC_UNDEFINED_NULL_PTR{\c pool_list}
+ * \DOC_UNDEFINED_NULL_PTR{\c thread_func_list}
  *
  * @param[in]  num_threads       number of array elements
  * @param[in]  pool_list         array of pool handles
@@ -353,54 +519,120 @@ int ABT_thread_create_many(int num_threads, ABT_pool *pool_list,
                            void (**thread_func_list)(void *), void **arg_list,
                            ABT_thread_attr attr, ABT_thread *newthread_list)
 {
+    ABTI_UB_ASSERT(ABTI_initialized());
+
     ABTI_global *p_global;
     ABTI_SETUP_GLOBAL(&p_global);
     ABTI_local *p_local = ABTI_local_get_local();
-    int i;
+    ABTI_thread_attr *p_attr = ABTI_thread_attr_get_ptr(attr);
+    int abt_errno, i, j;
 
-    if (attr != ABT_THREAD_ATTR_NULL) {
+    ABTI_CHECK_TRUE(num_threads >= 0, ABT_ERR_INV_ARG);
+    if (p_attr) {
         /* This implies that the stack is given by a user.  Since threads
          * cannot use the same stack region, this is illegal. */
-        ABTI_CHECK_TRUE(ABTI_thread_attr_get_ptr(attr)->p_stack == NULL,
-                        ABT_ERR_INV_THREAD_ATTR);
+        ABTI_CHECK_TRUE(p_attr->p_stack == NULL, ABT_ERR_INV_THREAD_ATTR);
+    }
+    for (i = 0; i < num_threads; i++) {
+        ABTI_pool *p_pool = ABTI_pool_get_ptr(pool_list[i]);
+        ABTI_CHECK_NULL_POOL_PTR(p_pool);
     }
+    if (num_threads == 0)
+        return ABT_SUCCESS;
 
-    if (newthread_list == NULL) {
-        for (i = 0; i < num_threads; i++) {
-            ABTI_ythread *p_newthread;
-            ABT_pool pool = pool_list[i];
-            ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
-            ABTI_CHECK_NULL_POOL_PTR(p_pool);
-
-            void (*thread_f)(void *) = thread_func_list[i];
-            void *arg = arg_list ? arg_list[i] : NULL;
-            int abt_errno = ythread_create(p_global, p_local, p_pool, thread_f,
-                                           arg, ABTI_thread_attr_get_ptr(attr),
-                                           ABTI_THREAD_TYPE_YIELDABLE, NULL,
-                                           THREAD_POOL_OP_PUSH, &p_newthread);
-            ABTI_CHECK_ERROR(abt_errno);
-        }
+    ABTI_ythread *newthreads_buffer[THREAD_MANY_BUFFER_SIZE], **p_newthreads;
+    ABT_unit units_buffer[THREAD_MANY_BUFFER_SIZE], *units;
+    if (num_threads > THREAD_MANY_BUFFER_SIZE) {
+        /* Allocate both lists at once. */
+        abt_errno = ABTU_malloc((sizeof(ABTI_ythread *) + sizeof(ABT_unit)) *
+                                    num_threads,
+                                (void **)&units);
+        ABTI_CHECK_ERROR(abt_errno);
+        p_newthreads = (ABTI_ythread **)(units + num_threads);
     } else {
-        for (i = 0; i < num_threads; i++) {
-            ABTI_ythread *p_newthread;
-            ABT_pool pool = pool_list[i];
-            ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
-            ABTI_CHECK_NULL_POOL_PTR(p_pool);
-
-            void (*thread_f)(void *) = thread_func_list[i];
-            void *arg = arg_list ? arg_list[i] : NULL;
-            int abt_errno =
-                ythread_create(p_global, p_local, p_pool, thread_f, arg,
-                               ABTI_thread_attr_get_ptr(attr),
-                               ABTI_THREAD_TYPE_YIELDABLE |
-                                   ABTI_THREAD_TYPE_NAMED,
-                               NULL, THREAD_POOL_OP_PUSH, &p_newthread);
-            newthread_list[i] = ABTI_ythread_get_handle(p_newthread);
-            /* TODO: Release threads that have been already created. */
-            ABTI_CHECK_ERROR(abt_errno);
+        p_newthreads = newthreads_buffer;
+        units = units_buffer;
+    }
+
+    /* Allocate ULTs that use a stack of the default size at once. */
+    const ABT_bool is_default_stack =
+        (!p_attr || p_attr->stacksize == p_global->thread_stacksize)
+            ? ABT_TRUE
+            : ABT_FALSE;
+    if (is_default_stack) {
+        abt_errno = ABTI_mem_alloc_ythread_mempool_desc_stack_many(
+            p_global, p_local, p_global->thread_stacksize,
+            p_attr ? p_attr->lazy_stack : ABT_FALSE, num_threads, p_newthreads);
+        if (ABTI_IS_ERROR_CHECK_ENABLED && abt_errno != ABT_SUCCESS) {
+            if (units != units_buffer)
+                ABTU_free(units);
+            ABTI_HANDLE_ERROR(abt_errno);
+        }
+    }
+    ABTI_thread_type thread_type =
+        ABTI_THREAD_TYPE_YIELDABLE | (newthread_list ? ABTI_THREAD_TYPE_NAMED : 0);
+    for (i = 0; i < num_threads; i++) {
+        ABTI_pool *p_pool = ABTI_pool_get_ptr(pool_list[i]);
+        void *arg = arg_list ? arg_list[i] : NULL;
+        if (is_default_stack) {
+            abt_errno = ythread_init(p_global, p_local, p_pool,
+                                     thread_func_list[i], arg, p_attr,
+                                     thread_type, NULL, THREAD_POOL_OP_INIT,
+                                     p_newthreads[i]);
+        } else {
+            abt_errno = ythread_create(p_global, p_local, p_pool,
+                                       thread_func_list[i], arg, p_attr,
+                                       thread_type, NULL, THREAD_POOL_OP_INIT,
+                                       &p_newthreads[i]);
+        }
+        if (ABTI_IS_ERROR_CHECK_ENABLED && abt_errno != ABT_SUCCESS) {
+            /* Release ULTs that have been already allocated or created. */
+            if (is_default_stack) {
+                for (j = i + 1; j < num_threads; j++) {
+                    ABTI_mem_free_thread(p_global, p_local,
+                                         &p_newthreads[j]->thread);
+                }
+            }
+            while (i-- > 0)
+                ABTI_thread_free(p_global, p_local, &p_newthreads[i]->thread);
+            if (units != units_buffer)
+                ABTU_free(units);
+            ABTI_HANDLE_ERROR(abt_errno);
         }
     }
 
+    /* Return value */
+    if (newthread_list) {
+        for (i = 0; i < num_threads; i++)
+            newthread_list[i] = ABTI_ythread_get_handle(p_newthreads[i]);
+    }
+
+    /* Add ULTs to pools.  Since unnamed ULTs might be freed once they are
+     * pushed, p_newthreads[j] is set to NULL before the ULT is pushed. */
+    for (i = 0; i < num_threads; i++) {
+        if (!p_newthreads[i])
+            continue;
+        ABT_pool pool = pool_list[i];
+        ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
+        int num_units = 0;
+        for (j = i; j < num_threads; j++) {
+            if (p_newthreads[j] && pool_list[j] == pool) {
+                units[num_units++] = p_newthreads[j]->thread.unit;
+                p_newthreads[j] = NULL;
+            }
+        }
+        if (p_pool->optional_def.p_push_many) {
+            ABTI_pool_push_many(p_pool, units, num_units,
+                                ABT_POOL_CONTEXT_OP_THREAD_CREATE);
+        } else {
+            for (j = 0; j < num_units; j++) {
+                ABTI_pool_push(p_pool, units[j],
+                               ABT_POOL_CONTEXT_OP_THREAD_CREATE);
+            }
+        }
+    }
+    if (units != units_buffer)
+        ABTU_free(units);
     return ABT_SUCCESS;
 }
 
@@ -469,6 +701,7 @@ int ABT_thread_revive(ABT_pool pool, void (*thread_func)(void *), void *arg,
     ABTI_CHECK_TRUE(ABTD_atomic_relaxed_load_int(&p_thread->state) ==
                         ABT_THREAD_STATE_TERMINATED,
                     ABT_ERR_INV_THREAD);
+    ABTI_CHECK_TRUE(!thread_is_fork_in_pool(p_thread), ABT_ERR_INV_THREAD);
 
     ABTI_pool *p_pool = ABTI_pool_get_ptr(pool);
     ABTI_CHECK_NULL_POOL_PTR(p_pool);
@@ -549,6 +782,7 @@ int ABT_thread_revive_to(ABT_pool pool, void (*thread_func)(void *), void *arg,
         ABTI_CHECK_TRUE(ABTD_atomic_relaxed_load_int(&p_thread->state) ==
                             ABT_THREAD_STATE_TERMINATED,
                         ABT_ERR_INV_THREAD);
+        ABTI_CHECK_TRUE(!thread_is_fork_in_pool(p_thread), ABT_ERR_INV_THREAD);
         ABTI_CHECK_YIELDABLE(p_thread, &p_target, ABT_ERR_INV_THREAD);
     }
 
@@ -645,7 +879,12 @@ int ABT_thread_free(ABT_thread *thread)
  * \c thread_list that has \c num_threads work unit handles.  If any of work
  * units is still running, this routine will be blocked on the running work unit
  * until it terminates.  Each handle referenced by \c thread_list is set to
- * \c ABT_THRAED_NULL.
+ * \c ABT_THRAED_NULL.  \c ABT_THREAD_NULL in \c thread_list is ignored.
+ *
+ * This routine checks all the work units before it joins any of them, so if
+ * this routine fails, no work unit is joined or freed.  Then, this routine
+ * waits for all the work units and frees them one by one, which is equivalent
+ * to calling \c ABT_thread_free() for each of them.
  *
  * This routine is deprecated because this routine does not provide a way for
  * the user to keep track of an error that happens during this routine.  The
@@ -662,9 +901,18 @@ int ABT_thread_free(ABT_thread *thread)
  *
  * @errors
  * \DOC_ERROR_SUCCESS
+ * \DOC_ERROR_INV_ARG_NEG{\c num_threads}
+ * \DOC_ERROR_INV_THREAD_CALLER{an element of \c thread_list}
+ * \DOC_ERROR_INV_THREAD_PRIMARY_ULT{an element of \c thread_list}
+ * \DOC_ERROR_INV_THREAD_MAIN_SCHED_THREAD{an element of \c thread_list}
  *
  * @undefined
- * \DOC_UNDEFINED_NO_ERROR_HANDLING
+ * \DOC_UNDEFINED_UNINIT
+ * \DOC_UNDEFINED_NULL_PTR{\c thread_list}
+ * \DOC_UNDEFINED_WORK_UNIT_BLOCKED{an element of \c thread_list,
+ *                                   \c ABT_thread_join() or
+ *                                   \c ABT_thread_free()}
+ * \DOC_UNDEFINED_THREAD_UNSAFE_FREE{an element of \c thread_list}
  *
  * @param[in]     num_threads  the number of array elements
  * @param[in,out] thread_list  array of work unit handles
@@ -672,19 +920,31 @@ int ABT_thread_free(ABT_thread *thread)
  */
 int ABT_thread_free_many(int num_threads, ABT_thread *thread_list)
 {
+    ABTI_UB_ASSERT(ABTI_initialized());
+
     ABTI_global *p_global;
     ABTI_SETUP_GLOBAL(&p_global);
     ABTI_local *p_local = ABTI_local_get_local();
     int i;
 
+    ABTI_CHECK_TRUE(num_threads >= 0, ABT_ERR_INV_ARG);
+    for (i = 0; i < num_threads; i++) {
+        int abt_errno =
+            thread_check_joinable(p_local, ABTI_thread_get_ptr(thread_list[i]));
+        ABTI_CHECK_ERROR(abt_errno);
+    }
+    /* Wait for all the work units before freeing any of them so that the
+     * caller does not free work units while the others are still running. */
     for (i = 0; i < num_threads; i++) {
         ABTI_thread *p_thread = ABTI_thread_get_ptr(thread_list[i]);
+        if (p_thread)
+            thread_join(&p_local, p_thread);
+    }
+    for (i = 0; i < num_threads; i++) {
+        ABTI_thread *p_thread = ABTI_thread_get_ptr(thread_list[i]);
+        if (p_thread)
+            ABTI_thread_free(p_global, p_local, p_thread);
         thread_list[i] = ABT_THREAD_NULL;
-        if (!p_thread)
-            continue;
-        /* TODO: check input */
-        thread_join(&p_local, p_thread);
-        ABTI_thread_free(p_global, p_local, p_thread);
     }
     return ABT_SUCCESS;
 }
@@ -752,7 +1012,13 @@ int ABT_thread_join(ABT_thread thread)
  *
  * The caller of \c ABT_thread_join_many() waits for all the work units in
  * \c thread_list that has \c num_threads work unit handles until all the work
- * units in \c thread_list terminate.
+ * units in \c thread_list terminate.  \c ABT_THREAD_NULL in \c thread_list is
+ * ignored.
+ *
+ * This routine checks all the work units before it joins any of them, so if
+ * this routine fails, no work unit is joined.  Then, this routine waits for the
+ * work units one by one, which is equivalent to calling \c ABT_thread_join()
+ * for each of them.
  *
  * This routine is deprecated because this routine does not provide a way for
  * the user to keep track of an error that happens during this routine.  The
@@ -769,9 +1035,18 @@ int ABT_thread_join(ABT_thread thread)
  *
  * @errors
  * \DOC_ERROR_SUCCESS
+ * \DOC_ERROR_INV_ARG_NEG{\c num_threads}
+ * \DOC_ERROR_INV_THREAD_CALLER{an element of \c thread_list}
+ * \DOC_ERROR_INV_THREAD_PRIMARY_ULT{an element of \c thread_list}
+ * \DOC_ERROR_INV_THREAD_MAIN_SCHED_THREAD{an element of \c thread_list}
  *
  * @undefined
- * \DOC_UNDEFINED_NO_ERROR_HANDLING
+ * \DOC_UNDEFINED_UNINIT
+ * \DOC_UNDEFINED_NULL_PTR{\c thread_list}
+ * \DOC_UNDEFINED_WORK_UNIT_BLOCKED{an element of \c thread_list,
+ *                                   \c ABT_thread_join() or
+ *                                   \c ABT_thread_free()}
+ * \DOC_UNDEFINED_THREAD_UNSAFE{an element of \c thread_list}
  *
  * @param[in] num_threads  the number of ULTs to join
  * @param[in] thread_list  array of target ULT handles
@@ -779,14 +1054,21 @@ int ABT_thread_join(ABT_thread thread)
  */
 int ABT_thread_join_many(int num_threads, ABT_thread *thread_list)
 {
+    ABTI_UB_ASSERT(ABTI_initialized());
+
     ABTI_local *p_local = ABTI_local_get_local();
     int i;
+
+    ABTI_CHECK_TRUE(num_threads >= 0, ABT_ERR_INV_ARG);
+    for (i = 0; i < num_threads; i++) {
+        int abt_errno =
+            thread_check_joinable(p_local, ABTI_thread_get_ptr(thread_list[i]));
+        ABTI_CHECK_ERROR(abt_errno);
+    }
     for (i = 0; i < num_threads; i++) {
         ABTI_thread *p_thread = ABTI_thread_get_ptr(thread_list[i]);
-        if (!p_thread)
-            continue;
-        /* TODO: check input */
-        thread_join(&p_local, p_thread);
+        if (p_thread)
+            thread_join(&p_local, p_thread);
     }
     return ABT_SUCCESS;
 }
@@ -1304,6 +1586,9 @@ int ABT_thread_yield_to(ABT_thread thread)
     ABTI_CHECK_TRUE(p_tar_ythread->thread.p_pool->deprecated_def.p_remove,
                     ABT_ERR_POOL);
 
+    /* p_tar_ythread might be a forked ULT that has not been pushed yet. */
+    ABTI_ythread_push_deferred_fork(p_cur_ythread);
+
     /* If the target thread is not in READY, we don't yield.  Note that ULT can
      * be regarded as 'ready' only if its state is READY and it has been
      * pushed into a pool. Since we set ULT's state to READY and then push it
@@ -1326,6 +1611,19 @@ int ABT_thread_yield_to(ABT_thread thread)
         ABTI_pool_dec_num_blocked(p_cur_ythread->thread.p_pool);
         ABTI_HANDLE_ERROR(abt_errno);
     }
+    if (ABTU_unlikely(ABTD_atomic_acquire_load_uint32(
+                          &p_tar_ythread->thread.request) &
+                      (ABTI_THREAD_REQ_FORK | ABTI_THREAD_REQ_FORK_INLINED))) {
+        /* The target ULT is a forked one.  Its joiner might have executed it.
+         */
+        if (ABTI_thread_handle_request_fork(ABTI_global_get_global(),
+                                            ABTI_xstream_get_local(
+                                                p_local_xstream),
+                                            &p_tar_ythread->thread)) {
+            ABTI_pool_dec_num_blocked(p_cur_ythread->thread.p_pool);
+            return ABT_SUCCESS;
+        }
+    }
 
     /* We set the last ES */
     p_tar_ythread->thread.p_last_xstream = p_local_xstream;
@@ -2183,7 +2481,8 @@ int ABT_thread_get_stacksize(ABT_thread thread, size_t *stacksize)
  * @brief   Get ID of a work unit
  *
  * \c ABT_thread_get_id() returns the ID of the work unit \c thread through
- * \c thread_id.
+ * \c thread_id.  IDs are unique among work units but are not necessarily
+ * assigned in creation order.
  *
  * @changev11
  * \DOC_DESC_V10_ACCEPT_TASK{\c thread}
@@ -2477,6 +2776,11 @@ int ABT_thread_get_attr(ABT_thread thread, ABT_thread_attr *attr)
         thread_attr.p_stack = NULL;
         thread_attr.stacksize = 0;
     }
+    thread_attr.lazy_stack =
+        (p_thread->type & (ABTI_THREAD_TYPE_MEM_MEMPOOL_DESC_MEMPOOL_LAZY_STACK |
+                           ABTI_THREAD_TYPE_MEM_MALLOC_DESC_MEMPOOL_LAZY_STACK))
+            ? ABT_TRUE
+            : ABT_FALSE;
 #ifndef ABT_CONFIG_DISABLE_MIGRATION
     thread_attr.migratable =
         (p_thread->type & ABTI_THREAD_TYPE_MIGRATABLE) ? ABT_TRUE : ABT_FALSE;
@@ -2697,6 +3001,30 @@ ABTU_ret_err int ABTI_thread_handle_request_migrate(ABTI_global *p_global,
     return ABT_SUCCESS;
 }
 
+ABT_bool ABTI_thread_handle_request_fork(ABTI_global *p_global,
+                                         ABTI_local *p_local,
+                                         ABTI_thread *p_thread)
+{
+    /* This is called when p_thread is popped from a pool.  Either the caller
+     * or the joiner of p_thread takes p_thread by clearing or replacing
+     * ABTI_THREAD_REQ_FORK. */
+    uint32_t req = ABTD_atomic_fetch_and_uint32(&p_thread->request,
+                                                ~ABTI_THREAD_REQ_FORK);
+    if (req & ABTI_THREAD_REQ_FORK) {
+        /* p_thread runs as a normal ULT. */
+        return ABT_FALSE;
+    }
+    /* The joiner has executed p_thread, so the pool no longer refers to it.  If
+     * the joiner has already freed p_thread, release its resources. */
+    ABTD_atomic_fetch_sub_int32(&p_thread->p_pool->num_inlined_forks, 1);
+    req = ABTD_atomic_fetch_or_uint32(&p_thread->request,
+                                      ABTI_THREAD_REQ_FORK_RELEASED);
+    if (req & ABTI_THREAD_REQ_FORK_RELEASED) {
+        thread_free_resources(p_global, p_local, p_thread, ABT_TRUE);
+    }
+    return ABT_TRUE;
+}
+
 void ABTI_thread_print(ABTI_thread *p_thread, FILE *p_os, int indent)
 {
     if (p_thread == NULL) {
@@ -2821,16 +3149,12 @@ ythread_create(ABTI_global *p_global, ABTI_local *p_local, ABTI_pool *p_pool,
 {
     int abt_errno;
     ABTI_ythread *p_newthread;
-    ABTI_ktable *p_keytable = NULL;
 
     /* Allocate a ULT object and its stack, then create a thread context. */
     if (!p_attr) {
         abt_errno =
             ABTI_mem_alloc_ythread_default(p_global, p_local, &p_newthread);
         ABTI_CHECK_ERROR(abt_errno);
-#ifndef ABT_CONFIG_DISABLE_MIGRATION
-        thread_type |= ABTI_THREAD_TYPE_MIGRATABLE;
-#endif
     } else {
         /*
          * There are four memory management types for ULTs.
@@ -2852,13 +3176,15 @@ ythread_create(ABTI_global *p_global, ABTI_local *p_local, ABTI_pool *p_pool,
                 abt_errno =
                     ABTI_mem_alloc_ythread_mempool_desc_stack(p_global, p_local,
                                                               stacksize,
+                                                              p_attr
+                                                                  ->lazy_stack,
                                                               &p_newthread);
             } else if (stacksize != 0) {
                 /* 2. A thread that uses a stack of a non-default size. */
                 abt_errno =
-                    ABTI_mem_alloc_ythread_malloc_desc_stack(p_global,
-                                                             stacksize,
-                                                             &p_newthread);
+                    ABTI_mem_alloc_ythread_sized_desc_stack(p_global, p_local,
+                                                            stacksize,
+                                                            &p_newthread);
             } else {
                 /* 3. A thread that uses OS-level thread's stack */
                 abt_errno =
@@ -2876,7 +3202,32 @@ ythread_create(ABTI_global *p_global, ABTI_local *p_local, ABTI_pool *p_pool,
                                                     p_stacktop, &p_newthread);
             ABTI_CHECK_ERROR(abt_errno);
         }
+    }
+
+    abt_errno = ythread_init(p_global, p_local, p_pool, thread_func, arg, p_attr,
+                             thread_type, p_sched, pool_op, p_newthread);
+    ABTI_CHECK_ERROR(abt_errno);
+
+    /* Return value */
+    *pp_newthread = p_newthread;
+    return ABT_SUCCESS;
+}
+
+/* Initialize p_newthread that has been allocated by ABTI_mem functions.  If it
+ * fails, p_newthread is freed. */
+ABTU_ret_err static inline int
+ythread_init(ABTI_global *p_global, ABTI_local *p_local, ABTI_pool *p_pool,
+             void (*thread_func)(void *), void *arg, ABTI_thread_attr *p_attr,
+             ABTI_thread_type thread_type, ABTI_sched *p_sched,
+             thread_pool_op_kind pool_op, ABTI_ythread *p_newthread)
+{
+    int abt_errno;
+    ABTI_ktable *p_keytable = NULL;
+
 #ifndef ABT_CONFIG_DISABLE_MIGRATION
+    if (!p_attr) {
+        thread_type |= ABTI_THREAD_TYPE_MIGRATABLE;
+    } else {
         thread_type |= p_attr->migratable ? ABTI_THREAD_TYPE_MIGRATABLE : 0;
         if (ABTU_unlikely(p_attr->f_cb)) {
             ABTI_thread_mig_data *p_mig_data;
@@ -2901,8 +3252,8 @@ ythread_create(ABTI_global *p_global, ABTI_local *p_local, ABTI_pool *p_pool,
                 return abt_errno;
             }
         }
-#endif
     }
+#endif
 
     p_newthread->thread.f_thread = thread_func;
     p_newthread->thread.p_arg = arg;
@@ -2912,6 +3263,7 @@ ythread_create(ABTI_global *p_global, ABTI_local *p_local, ABTI_pool *p_pool,
     ABTD_atomic_release_store_uint32(&p_newthread->thread.request, 0);
     p_newthread->thread.p_last_xstream = NULL;
     p_newthread->thread.p_parent = NULL;
+    p_newthread->p_deferred_fork = NULL;
     p_newthread->thread.type |= thread_type;
     p_newthread->thread.id = ABTI_THREAD_INIT_ID;
     if (p_sched && !(thread_type & (ABTI_THREAD_TYPE_PRIMARY |
@@ -2962,9 +3314,6 @@ ythread_create(ABTI_global *p_global, ABTI_local *p_local, ABTI_pool *p_pool,
                                      : NULL,
                                  NULL);
     }
-
-    /* Return value */
-    *pp_newthread = p_newthread;
     return ABT_SUCCESS;
 }
 
@@ -3032,6 +3381,17 @@ ABTU_ret_err static int thread_migrate_to_pool(ABTI_global *p_global,
 }
 #endif
 
+static inline ABT_bool thread_is_fork_in_pool(ABTI_thread *p_thread)
+{
+    /* A forked ULT that has been executed by its joiner stays in a pool until
+     * a scheduler pops it. */
+    const uint32_t req = ABTD_atomic_acquire_load_uint32(&p_thread->request);
+    return ((req & ABTI_THREAD_REQ_FORK_INLINED) &&
+            !(req & ABTI_THREAD_REQ_FORK_RELEASED))
+               ? ABT_TRUE
+               : ABT_FALSE;
+}
+
 static inline void thread_free(ABTI_global *p_global, ABTI_local *p_local,
                                ABTI_thread *p_thread, ABT_bool free_unit)
 {
@@ -3041,6 +3401,21 @@ static inline void thread_free(ABTI_global *p_global, ABTI_local *p_local,
                                ? ABTI_local_get_xstream(p_local)->p_thread
                                : NULL);
 
+    if (ABTU_unlikely(ABTD_atomic_relaxed_load_uint32(&p_thread->request) &
+                      ABTI_THREAD_REQ_FORK_INLINED)) {
+        /* p_thread might be still in a pool.  The latter of this caller and a
+         * scheduler that pops p_thread releases its resources. */
+        uint32_t req = ABTD_atomic_fetch_or_uint32(&p_thread->request,
+                                                   ABTI_THREAD_REQ_FORK_RELEASED);
+        if (!(req & ABTI_THREAD_REQ_FORK_RELEASED))
+            return;
+    }
+    thread_free_resources(p_global, p_local, p_thread, free_unit);
+}
+
+static void thread_free_resources(ABTI_global *p_global, ABTI_local *p_local,
+                                  ABTI_thread *p_thread, ABT_bool free_unit)
+{
     /* Free the unit */
     if (free_unit) {
         ABTI_thread_unset_associated_pool(p_global, p_thread);
@@ -3136,6 +3511,105 @@ static void thread_join_yield_thread(ABTI_xstream **pp_local_xstream,
                            &p_self->thread);
 }
 
+static inline ABT_bool thread_fork_has_stack_space(ABTI_ythread *p_self)
+{
+    /* Forked ULTs executed in place nest on the stack of p_self, so p_self
+     * executes them only while at least half of its stack is free. */
+    char *p_stacktop = (char *)ABTD_ythread_context_get_stacktop(&p_self->ctx);
+    size_t stacksize = ABTD_ythread_context_get_stacksize(&p_self->ctx);
+    char *p_sp = (char *)&p_stacktop;
+    if (!p_stacktop || p_sp > p_stacktop || p_sp < p_stacktop - stacksize) {
+        /* p_self is not running on a stack allocated by Argobots (e.g., the
+         * primary ULT). */
+        return ABT_TRUE;
+    }
+    return ((size_t)(p_sp - (p_stacktop - stacksize)) >= stacksize / 2)
+               ? ABT_TRUE
+               : ABT_FALSE;
+}
+
+static inline void thread_fork_run_inline(ABTI_xstream **pp_local_xstream,
+                                          ABTI_ythread *p_self,
+                                          ABTI_thread *p_thread)
+{
+    /* Execute p_thread as a part of p_self.  p_self might be migrated to
+     * another execution stream while running thread_func. */
+    ABTD_atomic_relaxed_store_int(&p_thread->state, ABT_THREAD_STATE_RUNNING);
+    p_thread->p_last_xstream = *pp_local_xstream;
+    ABTI_event_thread_run(*pp_local_xstream, p_thread, &p_self->thread,
+                          &p_self->thread);
+    p_thread->f_thread(p_thread->p_arg);
+    *pp_local_xstream = ABTI_local_get_xstream(ABTI_local_get_local());
+    ABTI_event_thread_finish(*pp_local_xstream, p_thread, &p_self->thread);
+    ABTD_atomic_release_store_int(&p_thread->state,
+                                  ABT_THREAD_STATE_TERMINATED);
+    ABTI_event_thread_join(ABTI_xstream_get_local(*pp_local_xstream), p_thread,
+                           &p_self->thread);
+}
+
+static ABT_bool thread_join_fork(ABTI_xstream **pp_local_xstream,
+                                 ABTI_ythread *p_self, ABTI_thread *p_thread)
+{
+    if (!thread_fork_has_stack_space(p_self))
+        return ABT_FALSE;
+    /* Take p_thread if no scheduler has taken it and no other request (e.g.,
+     * cancellation) has been made. */
+    if (!ABTD_atomic_bool_cas_strong_uint32(&p_thread->request,
+                                            ABTI_THREAD_REQ_FORK,
+                                            ABTI_THREAD_REQ_FORK_INLINED)) {
+        return ABT_FALSE;
+    }
+    /* If possible, remove p_thread from its pool so that the pool does not
+     * keep p_thread after its termination. */
+    ABTI_pool *p_pool = p_thread->p_pool;
+    if (p_pool->deprecated_def.p_remove &&
+        ABTI_pool_remove(p_pool, p_thread->unit) == ABT_SUCCESS) {
+        /* No scheduler will pop p_thread, so it is a normal ULT now. */
+        ABTD_atomic_relaxed_store_uint32(&p_thread->request, 0);
+    } else {
+        /* p_thread stays in p_pool until a scheduler pops it, but it is no
+         * longer a runnable unit. */
+        ABTD_atomic_fetch_add_int32(&p_pool->num_inlined_forks, 1);
+    }
+    thread_fork_run_inline(pp_local_xstream, p_self, p_thread);
+    return ABT_TRUE;
+}
+
+static ABT_bool thread_join_deferred_fork(ABTI_xstream **pp_local_xstream,
+                                          ABTI_ythread *p_self,
+                                          ABTI_thread *p_thread)
+{
+    /* p_thread has never been pushed to a pool, so p_self can take it unless
+     * another request (e.g., cancellation) has been made. */
+    if (thread_fork_has_stack_space(p_self) &&
+        ABTD_atomic_bool_cas_strong_uint32(&p_thread->request,
+                                           ABTI_THREAD_REQ_FORK |
+                                               ABTI_THREAD_REQ_FORK_DEFERRED,
+                                           0)) {
+        p_self->p_deferred_fork = NULL;
+        thread_fork_run_inline(pp_local_xstream, p_self, p_thread);
+        return ABT_TRUE;
+    }
+    /* p_thread needs to run as a normal ULT. */
+    ABTI_ythread_push_deferred_fork(p_self);
+    return ABT_FALSE;
+}
+
+/* Check if the caller can join p_thread.  NULL is accepted. */
+ABTU_ret_err static inline int thread_check_joinable(ABTI_local *p_local,
+                                                     ABTI_thread *p_thread)
+{
+    if (!p_thread)
+        return ABT_SUCCESS;
+    ABTI_CHECK_TRUE(!ABTI_local_get_xstream_or_null(p_local) ||
+                        p_thread != ABTI_local_get_xstream(p_local)->p_thread,
+                    ABT_ERR_INV_THREAD);
+    ABTI_CHECK_TRUE(!(p_thread->type &
+                      (ABTI_THREAD_TYPE_PRIMARY | ABTI_THREAD_TYPE_MAIN_SCHED)),
+                    ABT_ERR_INV_THREAD);
+    return ABT_SUCCESS;
+}
+
 static inline void thread_join(ABTI_local **pp_local, ABTI_thread *p_thread)
 {
     if (ABTD_atomic_acquire_load_int(&p_thread->state) ==
@@ -3174,6 +3648,23 @@ static inline void thread_join(ABTI_local **pp_local, ABTI_thread *p_thread)
     /* The target ULT should be different. */
     ABTI_ASSERT(p_thread != p_self_thread);
 
+    if (ABTU_unlikely(p_self->p_deferred_fork == p_thread)) {
+        /* p_self forked p_thread but has not pushed it to a pool. */
+        if (thread_join_deferred_fork(&p_local_xstream, p_self, p_thread)) {
+            *pp_local = ABTI_xstream_get_local(p_local_xstream);
+            return;
+        }
+    }
+    if (ABTU_unlikely(ABTD_atomic_relaxed_load_uint32(&p_thread->request) ==
+                      ABTI_THREAD_REQ_FORK) &&
+        !(p_self->thread.type & ABTI_THREAD_TYPE_MAIN_SCHED)) {
+        /* p_thread is a forked ULT that might be still in a pool. */
+        if (thread_join_fork(&p_local_xstream, p_self, p_thread)) {
+            *pp_local = ABTI_xstream_get_local(p_local_xstream);
+            return;
+        }
+    }
+
     ABTI_ythread *p_ythread = ABTI_thread_get_ythread_or_null(p_thread);
     if (!p_ythread) {
         thread_join_yield_thread(&p_local_xstream, p_self, p_thread);
@@ -3301,5 +3792,9 @@ static void thread_main_sched_func(void *arg)
 
 static inline ABT_unit_id thread_get_new_id(void)
 {
-    return (ABT_unit_id)ABTD_atomic_fetch_add_uint64(&g_thread_id, 1);
+    ABTI_xstream *p_local_xstream =
+        ABTI_local_get_xstream_or_null(ABTI_local_get_local());
+    ABTI_id_block *p_block =
+        p_local_xstream ? &p_local_xstream->thread_id_block : NULL;
+    return (ABT_unit_id)ABTI_id_block_get_new_id(p_block, &g_thread_id);
 }
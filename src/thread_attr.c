@@ -26,6 +26,8 @@ static void thread_attr_set_stack(ABTI_global *p_global,
  * - Default stack size, which can be set via \c ABT_THREAD_STACKSIZE.
  * - Migratable.
  * - Invoking no callback function on migration.
+ * - Allocating a stack when the ULT starts only if Argobots is configured with
+ *   \c --enable-lazy-stack-alloc.
  *
  * \c newattr must be freed by \c ABT_thread_attr_free() after its use.
  *
@@ -382,6 +384,54 @@ int ABT_thread_attr_set_migratable(ABT_thread_attr attr, ABT_bool is_migratable)
 #endif
 }
 
+/**
+ * @ingroup ULT_ATTR
+ * @brief   Set the ULT's lazy stack allocation in a ULT attribute.
+ *
+ * \c ABT_thread_attr_set_lazy_stack() sets whether the ULT created with the ULT
+ * attribute \c attr allocates its stack lazily.  If \c lazy_stack is
+ * \c ABT_TRUE, the ULT does not have a stack until it starts.  When it starts,
+ * the ULT borrows a stack that the running execution stream keeps for such
+ * ULTs and gives it back when it terminates, so the ULT owns a stack only while
+ * it is suspended, e.g., by being blocked on \c ABT_mutex or \c ABT_eventual or
+ * by yielding.  This reduces the memory footprint of ULTs that are created
+ * long before they are executed and the stack traffic of ULTs that run to
+ * completion.  If \c lazy_stack is \c ABT_FALSE, the ULT allocates its stack
+ * lazily only if Argobots is configured with \c --enable-lazy-stack-alloc.
+ *
+ * This attribute is ignored if the ULT uses a stack of a non-default size or a
+ * stack given by \c ABT_thread_attr_set_stack(), or if the memory pool is
+ * disabled.
+ *
+ * @contexts
+ * \DOC_CONTEXT_INIT \DOC_CONTEXT_NOCTXSWITCH
+ *
+ * @errors
+ * \DOC_ERROR_SUCCESS
+ * \DOC_ERROR_INV_THREAD_ATTR_HANDLE{\c attr}
+ *
+ * @undefined
+ * \DOC_UNDEFINED_UNINIT
+ * \DOC_UNDEFINED_BOOL{\c lazy_stack}
+ * \DOC_UNDEFINED_THREAD_UNSAFE{\c attr}
+ *
+ * @param[in] attr        ULT attribute handle
+ * @param[in] lazy_stack  flag (\c ABT_TRUE: lazy, \c ABT_FALSE: default)
+ * @return Error code
+ */
+int ABT_thread_attr_set_lazy_stack(ABT_thread_attr attr, ABT_bool lazy_stack)
+{
+    ABTI_UB_ASSERT(ABTI_initialized());
+    ABTI_UB_ASSERT_BOOL(lazy_stack);
+
+    ABTI_thread_attr *p_attr = ABTI_thread_attr_get_ptr(attr);
+    ABTI_CHECK_NULL_THREAD_ATTR_PTR(p_attr);
+
+    /* Set the value */
+    p_attr->lazy_stack = lazy_stack;
+    return ABT_SUCCESS;
+}
+
 /*****************************************************************************/
 /* Private APIs                                                              */
 /*****************************************************************************/
@@ -396,10 +446,12 @@ void ABTI_thread_attr_print(ABTI_thread_attr *p_attr, FILE *p_os, int indent)
                 "%*sULT attr: ["
                 "stack:%p "
                 "stacksize:%zu "
+                "lazy_stack:%s "
                 "migratable:%s "
                 "cb_arg:%p"
                 "]\n",
                 indent, "", p_attr->p_stack, p_attr->stacksize,
+                (p_attr->lazy_stack == ABT_TRUE ? "TRUE" : "FALSE"),
                 (p_attr->migratable == ABT_TRUE ? "TRUE" : "FALSE"),
                 p_attr->p_cb_arg);
 #else
@@ -407,8 +459,10 @@ void ABTI_thread_attr_print(ABTI_thread_attr *p_attr, FILE *p_os, int indent)
                 "%*sULT attr: ["
                 "stack:%p "
                 "stacksize:%zu "
+                "lazy_stack:%s "
                 "]\n",
-                indent, "", p_attr->p_stack, p_attr->stacksize);
+                indent, "", p_attr->p_stack, p_attr->stacksize,
+                (p_attr->lazy_stack == ABT_TRUE ? "TRUE" : "FALSE"));
 #endif
     }
     fflush(p_os);
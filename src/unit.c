@@ -5,7 +5,7 @@
 
 #include "abti.h"
 
-static void unit_init_hash_table(ABTI_global *p_global);
+ABTU_ret_err static int unit_init_hash_table(ABTI_global *p_global);
 static void unit_finalize_hash_table(ABTI_global *p_global);
 ABTU_ret_err static inline int
 unit_map_thread(ABTI_global *p_global, ABT_unit unit, ABTI_thread *p_thread);
@@ -93,9 +93,9 @@ int ABT_unit_get_thread(ABT_unit unit, ABT_thread *thread)
 /* Private APIs                                                              */
 /*****************************************************************************/
 
-void ABTI_unit_init_hash_table(ABTI_global *p_global)
+ABTU_ret_err int ABTI_unit_init_hash_table(ABTI_global *p_global)
 {
-    unit_init_hash_table(p_global);
+    return unit_init_hash_table(p_global);
 }
 
 void ABTI_unit_finalize_hash_table(ABTI_global *p_global)
@@ -124,18 +124,12 @@ ABTI_thread *ABTI_unit_get_thread_from_user_defined_unit(ABTI_global *p_global,
 /* Internal static functions                                                 */
 /*****************************************************************************/
 
-static inline size_t unit_get_hash_index(ABT_unit unit)
+static inline size_t unit_get_hash_index(ABT_unit unit, int size_exp)
 {
-    size_t val = (uintptr_t)unit;
-    /* Let's ignore the first 3 bits and use the next 29 bits. */
-    size_t base_val = val >> 3;
-#if ABTI_UNIT_HASH_TABLE_SIZE_EXP <= 14
-    base_val += val >> (ABTI_UNIT_HASH_TABLE_SIZE_EXP + 3);
-#endif
-#if ABTI_UNIT_HASH_TABLE_SIZE_EXP <= 9
-    base_val += val >> (ABTI_UNIT_HASH_TABLE_SIZE_EXP * 2 + 3);
-#endif
-    return base_val & (ABTI_UNIT_HASH_TABLE_SIZE - 1);
+    /* Let's ignore the first 3 bits and apply Fibonacci hashing so that the
+     * upper bits, which are used as an index, depend on all the other bits. */
+    uint64_t val = ((uint64_t)(uintptr_t)unit) >> 3;
+    return (size_t)((val * UINT64_C(0x9E3779B97F4A7C15)) >> (64 - size_exp));
 }
 
 typedef struct atomic_unit {
@@ -190,44 +184,185 @@ atomic_relaxed_store_unit_to_thread(ABTI_atomic_unit_to_thread *p_ptr,
     ABTD_atomic_relaxed_store_ptr(&p_ptr->val, (void *)val);
 }
 
-static void unit_init_hash_table(ABTI_global *p_global)
+/*
+ * The hash table is resizable.  get() does not take any lock while map() and
+ * unmap() take a lock of the corresponding entry.  When the number of list
+ * elements gets larger than ABTI_UNIT_HASH_TABLE_MAX_LOAD times the number of
+ * entries, the table is replaced with a new table that has twice as many
+ * entries.  The resizer takes all the locks of the old table, copies all the
+ * mapped elements to the new table, and then publishes the new table.
+ *
+ * Since get() might be traversing an old table, replaced tables and their
+ * elements are kept until the table is finalized.  This is safe because get()
+ * for a unit mapped after the replacement must see the new table: map() has
+ * read the new table, and get() is performed after map() from the memory order
+ * viewpoint.  Units mapped before the replacement can be found in both tables.
+ */
+ABTU_ret_err static int
+unit_table_create(int size_exp, ABTI_unit_to_thread_table **pp_table)
 {
-    int i;
-    for (i = 0; i < (int)ABTI_UNIT_HASH_TABLE_SIZE; i++) {
-        atomic_relaxed_store_unit_to_thread(&p_global->unit_to_thread_entires[i]
-                                                 .list,
-                                            NULL);
-        ABTD_spinlock_clear(&p_global->unit_to_thread_entires[i].lock);
+    size_t i, size = ((size_t)1) << size_exp;
+    ABTI_unit_to_thread_table *p_table;
+    int abt_errno =
+        ABTU_malloc(sizeof(ABTI_unit_to_thread_table) +
+                        sizeof(ABTI_unit_to_thread_entry) * size,
+                    (void **)&p_table);
+    ABTI_CHECK_ERROR(abt_errno);
+    p_table->size_exp = size_exp;
+    ABTD_atomic_relaxed_store_size(&p_table->num_nodes, 0);
+    p_table->p_prev = NULL;
+    p_table->entries =
+        (ABTI_unit_to_thread_entry *)(((char *)p_table) +
+                                      sizeof(ABTI_unit_to_thread_table));
+    for (i = 0; i < size; i++) {
+        atomic_relaxed_store_unit_to_thread(&p_table->entries[i].list, NULL);
+        ABTD_spinlock_clear(&p_table->entries[i].lock);
     }
+    *pp_table = p_table;
+    return ABT_SUCCESS;
 }
 
-static void unit_finalize_hash_table(ABTI_global *p_global)
+static void unit_table_free(ABTI_unit_to_thread_table *p_table)
 {
-    int i;
-    for (i = 0; i < (int)ABTI_UNIT_HASH_TABLE_SIZE; i++) {
-        ABTI_ASSERT(!ABTD_spinlock_is_locked(
-            &p_global->unit_to_thread_entires[i].lock));
-        unit_to_thread *p_cur = atomic_relaxed_load_unit_to_thread(
-            &p_global->unit_to_thread_entires[i].list);
+    size_t i, size = ((size_t)1) << p_table->size_exp;
+    for (i = 0; i < size; i++) {
+        ABTI_ASSERT(!ABTD_spinlock_is_locked(&p_table->entries[i].lock));
+        unit_to_thread *p_cur =
+            atomic_relaxed_load_unit_to_thread(&p_table->entries[i].list);
         while (p_cur) {
-            ABTI_ASSERT(atomic_relaxed_load_unit(&p_cur->unit) ==
-                        ABT_UNIT_NULL);
             unit_to_thread *p_next = p_cur->p_next;
             ABTU_free(p_cur);
             p_cur = p_next;
         }
     }
+    ABTU_free(p_table);
+}
+
+/* Take a lock of the entry for unit in the latest table. */
+static inline ABTI_unit_to_thread_table *
+unit_table_lock_entry(ABTI_global *p_global, ABT_unit unit,
+                      ABTI_unit_to_thread_entry **pp_entry)
+{
+    while (1) {
+        ABTI_unit_to_thread_table *p_table =
+            (ABTI_unit_to_thread_table *)ABTD_atomic_acquire_load_ptr(
+                &p_global->p_unit_to_thread_table);
+        ABTI_unit_to_thread_entry *p_entry =
+            &p_table->entries[unit_get_hash_index(unit, p_table->size_exp)];
+        ABTD_spinlock_acquire(&p_entry->lock);
+        /* The resizer publishes a new table while holding all the locks of the
+         * old table, so the table must be checked after taking the lock. */
+        if (ABTU_likely(ABTD_atomic_relaxed_load_ptr(
+                            &p_global->p_unit_to_thread_table) == p_table)) {
+            *pp_entry = p_entry;
+            return p_table;
+        }
+        /* The table has been replaced.  Retry. */
+        ABTD_spinlock_release(&p_entry->lock);
+    }
+}
+
+static void unit_table_grow(ABTI_global *p_global,
+                            ABTI_unit_to_thread_table *p_table)
+{
+    ABTD_spinlock_acquire(&p_global->unit_to_thread_resize_lock);
+    if (ABTD_atomic_relaxed_load_ptr(&p_global->p_unit_to_thread_table) !=
+        p_table) {
+        /* Another caller has already replaced the table. */
+        ABTD_spinlock_release(&p_global->unit_to_thread_resize_lock);
+        return;
+    }
+    ABTI_unit_to_thread_table *p_new_table;
+    int abt_errno = unit_table_create(p_table->size_exp + 1, &p_new_table);
+    if (abt_errno != ABT_SUCCESS) {
+        /* Keep using the current table.  It is slower but still correct. */
+        ABTD_spinlock_release(&p_global->unit_to_thread_resize_lock);
+        return;
+    }
+    size_t i, size = ((size_t)1) << p_table->size_exp, num_nodes = 0;
+    for (i = 0; i < size; i++)
+        ABTD_spinlock_acquire(&p_table->entries[i].lock);
+    for (i = 0; i < size; i++) {
+        unit_to_thread *p_cur =
+            atomic_relaxed_load_unit_to_thread(&p_table->entries[i].list);
+        for (; p_cur; p_cur = p_cur->p_next) {
+            ABT_unit unit = atomic_relaxed_load_unit(&p_cur->unit);
+            if (unit == ABT_UNIT_NULL)
+                continue;
+            unit_to_thread *p_new;
+            abt_errno = ABTU_malloc(sizeof(unit_to_thread), (void **)&p_new);
+            if (abt_errno != ABT_SUCCESS) {
+                /* Give up resizing. */
+                for (i = 0; i < size; i++)
+                    ABTD_spinlock_release(&p_table->entries[i].lock);
+                unit_table_free(p_new_table);
+                ABTD_spinlock_release(&p_global->unit_to_thread_resize_lock);
+                return;
+            }
+            size_t new_index =
+                unit_get_hash_index(unit, p_new_table->size_exp);
+            ABTI_atomic_unit_to_thread *p_list =
+                &p_new_table->entries[new_index].list;
+            atomic_relaxed_store_unit(&p_new->unit, unit);
+            p_new->p_thread = p_cur->p_thread;
+            p_new->p_next = atomic_relaxed_load_unit_to_thread(p_list);
+            atomic_relaxed_store_unit_to_thread(p_list, p_new);
+            num_nodes++;
+        }
+    }
+    ABTD_atomic_relaxed_store_size(&p_new_table->num_nodes, num_nodes);
+    p_new_table->p_prev = p_table;
+    ABTD_atomic_release_store_ptr(&p_global->p_unit_to_thread_table,
+                                  p_new_table);
+    for (i = 0; i < size; i++)
+        ABTD_spinlock_release(&p_table->entries[i].lock);
+    ABTD_spinlock_release(&p_global->unit_to_thread_resize_lock);
+}
+
+ABTU_ret_err static int unit_init_hash_table(ABTI_global *p_global)
+{
+    ABTI_unit_to_thread_table *p_table;
+    int abt_errno =
+        unit_table_create(ABTI_UNIT_HASH_TABLE_INIT_SIZE_EXP, &p_table);
+    ABTI_CHECK_ERROR(abt_errno);
+    ABTD_atomic_relaxed_store_ptr(&p_global->p_unit_to_thread_table, p_table);
+    ABTD_spinlock_clear(&p_global->unit_to_thread_resize_lock);
+    return ABT_SUCCESS;
+}
+
+static void unit_finalize_hash_table(ABTI_global *p_global)
+{
+    ABTI_unit_to_thread_table *p_table =
+        (ABTI_unit_to_thread_table *)ABTD_atomic_relaxed_load_ptr(
+            &p_global->p_unit_to_thread_table);
+#if ABTI_IS_ERROR_CHECK_ENABLED
+    /* All the units in the latest table must have been unmapped.  Old tables
+     * might have stale elements. */
+    size_t i, size = ((size_t)1) << p_table->size_exp;
+    for (i = 0; i < size; i++) {
+        unit_to_thread *p_cur =
+            atomic_relaxed_load_unit_to_thread(&p_table->entries[i].list);
+        for (; p_cur; p_cur = p_cur->p_next) {
+            ABTI_ASSERT(atomic_relaxed_load_unit(&p_cur->unit) ==
+                        ABT_UNIT_NULL);
+        }
+    }
+#endif
+    while (p_table) {
+        ABTI_unit_to_thread_table *p_prev = p_table->p_prev;
+        unit_table_free(p_table);
+        p_table = p_prev;
+    }
 }
 
 ABTU_ret_err static inline int
 unit_map_thread(ABTI_global *p_global, ABT_unit unit, ABTI_thread *p_thread)
 {
     ABTI_ASSERT(!ABTI_unit_is_builtin(unit));
-    size_t hash_index = unit_get_hash_index(unit);
-    ABTI_unit_to_thread_entry *p_entry =
-        &p_global->unit_to_thread_entires[hash_index];
+    ABTI_unit_to_thread_entry *p_entry;
+    ABTI_unit_to_thread_table *p_table =
+        unit_table_lock_entry(p_global, unit, &p_entry);
 
-    ABTD_spinlock_acquire(&p_entry->lock);
     unit_to_thread *p_cur = atomic_relaxed_load_unit_to_thread(&p_entry->list);
     while (p_cur) {
         if (atomic_relaxed_load_unit(&p_cur->unit) == ABT_UNIT_NULL) {
@@ -255,17 +390,23 @@ unit_map_thread(ABTI_global *p_global, ABT_unit unit, ABTI_thread *p_thread)
     p_new->p_next = p_cur;
     atomic_release_store_unit_to_thread(&p_entry->list, p_new);
     ABTD_spinlock_release(&p_entry->lock);
+
+    size_t num_nodes = ABTD_atomic_fetch_add_size(&p_table->num_nodes, 1) + 1;
+    if (ABTU_unlikely(num_nodes > (((size_t)ABTI_UNIT_HASH_TABLE_MAX_LOAD)
+                                   << p_table->size_exp) &&
+                      p_table->size_exp < ABTI_UNIT_HASH_TABLE_MAX_SIZE_EXP)) {
+        /* Chains are getting long.  Let's enlarge the table. */
+        unit_table_grow(p_global, p_table);
+    }
     return ABT_SUCCESS;
 }
 
 static inline void unit_unmap_thread(ABTI_global *p_global, ABT_unit unit)
 {
     ABTI_ASSERT(!ABTI_unit_is_builtin(unit));
-    size_t hash_index = unit_get_hash_index(unit);
-    ABTI_unit_to_thread_entry *p_entry =
-        &p_global->unit_to_thread_entires[hash_index];
+    ABTI_unit_to_thread_entry *p_entry;
+    unit_table_lock_entry(p_global, unit, &p_entry);
 
-    ABTD_spinlock_acquire(&p_entry->lock);
     unit_to_thread *p_cur = atomic_relaxed_load_unit_to_thread(&p_entry->list);
     /* Update the corresponding unit to "NULL". */
     while (1) {
@@ -283,10 +424,13 @@ static inline ABTI_thread *
 unit_get_thread_from_user_defined_unit(ABTI_global *p_global, ABT_unit unit)
 {
     ABTI_ASSERT(!ABTI_unit_is_builtin(unit));
-    /* Find an element. */
-    size_t hash_index = unit_get_hash_index(unit);
+    /* Find an element.  The table might be replaced concurrently, but any table
+     * that is visible here contains this unit (see the comment above). */
+    ABTI_unit_to_thread_table *p_table =
+        (ABTI_unit_to_thread_table *)ABTD_atomic_acquire_load_ptr(
+            &p_global->p_unit_to_thread_table);
     ABTI_unit_to_thread_entry *p_entry =
-        &p_global->unit_to_thread_entires[hash_index];
+        &p_table->entries[unit_get_hash_index(unit, p_table->size_exp)];
     /* The first element must be accessed in a release-acquire manner.  The new
      * element is release-stored to the head, so acquire-load can always get a
      * valid linked-list chain. */
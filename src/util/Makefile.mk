@@ -7,4 +7,5 @@ abt_sources += \
 	util/atoi.c \
 	util/hashtable.c \
 	util/largepage.c \
+	util/madvise.c \
 	util/mprotect.c
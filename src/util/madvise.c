@@ -0,0 +1,58 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include "abti.h"
+#include <sys/mman.h>
+
+/* # of pages checked by one mincore() call. */
+#define ABTU_MINCORE_VEC_SIZE 256
+
+ABTU_ret_err int ABTU_release_pages(void *addr, size_t size, ABT_bool lazy)
+{
+#ifdef HAVE_MADVISE
+    int ret = -1;
+#ifdef MADV_FREE
+    if (lazy)
+        ret = madvise(addr, size, MADV_FREE);
+#endif
+    if (ret != 0)
+        ret = madvise(addr, size, MADV_DONTNEED);
+    return ret == 0 ? ABT_SUCCESS : ABT_ERR_SYS;
+#else
+    return ABT_ERR_SYS;
+#endif
+}
+
+ABTU_ret_err int ABTU_get_resident_pages(void *addr, size_t size,
+                                         size_t page_size,
+                                         size_t *p_num_pages,
+                                         void **p_lowest_page)
+{
+#ifdef HAVE_MINCORE
+    unsigned char vec[ABTU_MINCORE_VEC_SIZE];
+    const size_t num_pages = size / page_size;
+    size_t num_resident_pages = 0, i, j;
+    void *p_lowest = NULL;
+    for (i = 0; i < num_pages; i += ABTU_MINCORE_VEC_SIZE) {
+        size_t len = ABTU_min_size(num_pages - i, ABTU_MINCORE_VEC_SIZE);
+        char *p_cur = ((char *)addr) + i * page_size;
+        /* Some systems take char * instead of unsigned char *. */
+        if (mincore((void *)p_cur, len * page_size, (void *)vec) != 0)
+            return ABT_ERR_SYS;
+        for (j = 0; j < len; j++) {
+            if (vec[j] & 1) {
+                if (!p_lowest)
+                    p_lowest = (void *)(p_cur + j * page_size);
+                num_resident_pages++;
+            }
+        }
+    }
+    *p_num_pages = num_resident_pages;
+    *p_lowest_page = p_lowest;
+    return ABT_SUCCESS;
+#else
+    return ABT_ERR_SYS;
+#endif
+}
@@ -0,0 +1,168 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This test uses ABT_barrier repeatedly from ULTs that can move between ESs.
+ * All the ESs share a single pool, so waiters of a barrier can be resumed on
+ * ESs different from those on which they started waiting.  The second part
+ * uses a barrier whose number of waiters is smaller than the number of ULTs,
+ * so waiters of different phases can be blocked on the barrier at the same
+ * time.  The third part reinitializes a barrier right after its last waiter
+ * returns, while the other waiters might not have been resumed yet. */
+
+#define DEFAULT_NUM_XSTREAMS 4
+#define DEFAULT_NUM_THREADS 16
+#define DEFAULT_NUM_ITER 50
+
+static int g_num_threads = DEFAULT_NUM_THREADS;
+static int g_num_iter = DEFAULT_NUM_ITER;
+static ABT_barrier g_barrier;
+static volatile int *g_values;
+static volatile int g_counter = 0;
+static volatile int g_num_arrivals = 0;
+
+static void phase_func(void *arg)
+{
+    int i, j, ret, id = (int)(size_t)arg;
+
+    for (i = 0; i < g_num_iter; i++) {
+        ATS_atomic_store(&g_values[id], i);
+        ret = ABT_barrier_wait(g_barrier);
+        ATS_ERROR(ret, "ABT_barrier_wait");
+        /* All the ULTs have reached this phase, and no ULT can pass the next
+         * barrier before this ULT arrives there. */
+        for (j = 0; j < g_num_threads; j++)
+            assert(ATS_atomic_load(&g_values[j]) == i);
+        ret = ABT_thread_yield();
+        ATS_ERROR(ret, "ABT_thread_yield");
+        ret = ABT_barrier_wait(g_barrier);
+        ATS_ERROR(ret, "ABT_barrier_wait");
+    }
+}
+
+static void overlap_func(void *arg)
+{
+    int i, ret;
+    for (i = 0; i < g_num_iter; i++) {
+        ret = ABT_barrier_wait(g_barrier);
+        ATS_ERROR(ret, "ABT_barrier_wait");
+        ATS_atomic_fetch_add(&g_counter, 1);
+        ret = ABT_thread_yield();
+        ATS_ERROR(ret, "ABT_thread_yield");
+    }
+}
+
+static void reinit_func(void *arg)
+{
+    ATS_UNUSED(arg);
+    int ret;
+    int is_last =
+        (ATS_atomic_fetch_add(&g_num_arrivals, 1) == g_num_threads - 1);
+    ret = ABT_barrier_wait(g_barrier);
+    ATS_ERROR(ret, "ABT_barrier_wait");
+    if (is_last) {
+        /* All the ULTs have arrived, so the barrier can be reinitialized even
+         * if some of them are still being resumed. */
+        ret = ABT_barrier_reinit(g_barrier, (uint32_t)g_num_threads);
+        ATS_ERROR(ret, "ABT_barrier_reinit");
+    }
+}
+
+static void run_threads(ABT_pool pool, void (*thread_func)(void *))
+{
+    int i, ret;
+    ABT_thread *threads =
+        (ABT_thread *)malloc(sizeof(ABT_thread) * g_num_threads);
+    for (i = 0; i < g_num_threads; i++) {
+        ret = ABT_thread_create(pool, thread_func, (void *)(size_t)i,
+                                ABT_THREAD_ATTR_NULL, &threads[i]);
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+    for (i = 0; i < g_num_threads; i++) {
+        ret = ABT_thread_free(&threads[i]);
+        ATS_ERROR(ret, "ABT_thread_free");
+    }
+    free(threads);
+}
+
+int main(int argc, char *argv[])
+{
+    int i, ret;
+    int num_xstreams = DEFAULT_NUM_XSTREAMS;
+    uint32_t num_waiters;
+
+    ATS_read_args(argc, argv);
+    if (argc > 1) {
+        num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+        g_num_threads = ATS_get_arg_val(ATS_ARG_N_ULT);
+        g_num_iter = ATS_get_arg_val(ATS_ARG_N_ITER);
+    }
+    /* The second part needs an even number of ULTs. */
+    if (g_num_threads % 2 == 1)
+        g_num_threads++;
+    ABT_xstream *xstreams =
+        (ABT_xstream *)malloc(sizeof(ABT_xstream) * num_xstreams);
+    g_values = (volatile int *)calloc(g_num_threads, sizeof(int));
+
+    ATS_init(argc, argv, num_xstreams);
+
+    /* Create a pool shared by all the ESs. */
+    ABT_pool pool;
+    ret = ABT_pool_create_basic(ABT_POOL_FIFO, ABT_POOL_ACCESS_MPMC, ABT_TRUE,
+                                &pool);
+    ATS_ERROR(ret, "ABT_pool_create_basic");
+    ret = ABT_xstream_self(&xstreams[0]);
+    ATS_ERROR(ret, "ABT_xstream_self");
+    ret = ABT_xstream_set_main_sched_basic(xstreams[0], ABT_SCHED_DEFAULT, 1,
+                                           &pool);
+    ATS_ERROR(ret, "ABT_xstream_set_main_sched_basic");
+    for (i = 1; i < num_xstreams; i++) {
+        ret = ABT_xstream_create_basic(ABT_SCHED_DEFAULT, 1, &pool,
+                                       ABT_SCHED_CONFIG_NULL, &xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_create_basic");
+    }
+
+    /* All the ULTs wait on the barrier. */
+    ret = ABT_barrier_create((uint32_t)g_num_threads, &g_barrier);
+    ATS_ERROR(ret, "ABT_barrier_create");
+    run_threads(pool, phase_func);
+
+    /* Half of the ULTs complete each phase. */
+    ret = ABT_barrier_reinit(g_barrier, (uint32_t)(g_num_threads / 2));
+    ATS_ERROR(ret, "ABT_barrier_reinit");
+    ret = ABT_barrier_get_num_waiters(g_barrier, &num_waiters);
+    ATS_ERROR(ret, "ABT_barrier_get_num_waiters");
+    assert(num_waiters == (uint32_t)(g_num_threads / 2));
+    run_threads(pool, overlap_func);
+    assert(ATS_atomic_load(&g_counter) == g_num_threads * g_num_iter);
+
+    /* ABT_barrier_reinit() is called right after ABT_barrier_wait(). */
+    ret = ABT_barrier_reinit(g_barrier, (uint32_t)g_num_threads);
+    ATS_ERROR(ret, "ABT_barrier_reinit");
+    for (i = 0; i < g_num_iter; i++) {
+        ATS_atomic_store(&g_num_arrivals, 0);
+        run_threads(pool, reinit_func);
+    }
+
+    ret = ABT_barrier_free(&g_barrier);
+    ATS_ERROR(ret, "ABT_barrier_free");
+
+    for (i = 1; i < num_xstreams; i++) {
+        ret = ABT_xstream_join(xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_join");
+        ret = ABT_xstream_free(&xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_free");
+    }
+
+    ret = ATS_finalize(0);
+
+    free(xstreams);
+    free((void *)g_values);
+    return ret;
+}
@@ -0,0 +1,227 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This test checks ABT_eventual_set_ptr() with eventuals that have memory
+ * buffers of different sizes, including a statically initialized one.  The
+ * second part creates eventuals on one ES and frees them on another ES. */
+
+#define DEFAULT_NUM_XSTREAMS 4
+#define DEFAULT_NUM_THREADS 8
+#define DEFAULT_NUM_ITER 50
+#define LARGE_NBYTES (1024 * 1024)
+
+static int g_num_xstreams = DEFAULT_NUM_XSTREAMS;
+static int g_num_threads = DEFAULT_NUM_THREADS;
+static int g_num_iter = DEFAULT_NUM_ITER;
+static ABT_eventual_memory g_eventual_mem = ABT_EVENTUAL_INITIALIZER;
+static ABT_pool *g_pools;
+static ABT_barrier g_barrier;
+static ABT_eventual *g_eventuals;
+static int *g_values;
+
+typedef struct {
+    ABT_eventual eventual;
+    void *expected;
+} wait_arg_t;
+
+static void wait_func(void *arg)
+{
+    wait_arg_t *p_arg = (wait_arg_t *)arg;
+    void *value;
+    int ret = ABT_eventual_wait(p_arg->eventual, &value);
+    ATS_ERROR(ret, "ABT_eventual_wait");
+    assert(value == p_arg->expected);
+}
+
+static void test_set_ptr(ABT_eventual eventual, int nbytes)
+{
+    int i, ret, data = 42;
+    int num_total = g_num_xstreams * g_num_threads;
+    void *value;
+    ABT_bool is_ready;
+    ABT_thread *threads = (ABT_thread *)malloc(sizeof(ABT_thread) * num_total);
+    wait_arg_t arg;
+    arg.eventual = eventual;
+    arg.expected = (void *)&data;
+
+    for (i = 0; i < num_total; i++) {
+        ret = ABT_thread_create(g_pools[i % g_num_xstreams], wait_func, &arg,
+                                ABT_THREAD_ATTR_NULL, &threads[i]);
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+    /* Let ULTs be blocked on the eventual before it is set. */
+    for (i = 0; i < 10; i++) {
+        ret = ABT_thread_yield();
+        ATS_ERROR(ret, "ABT_thread_yield");
+    }
+    ret = ABT_eventual_set_ptr(eventual, &data);
+    ATS_ERROR(ret, "ABT_eventual_set_ptr");
+    for (i = 0; i < num_total; i++) {
+        ret = ABT_thread_free(&threads[i]);
+        ATS_ERROR(ret, "ABT_thread_free");
+    }
+    free(threads);
+
+    ret = ABT_eventual_test(eventual, &value, &is_ready);
+    ATS_ERROR(ret, "ABT_eventual_test");
+    assert(is_ready == ABT_TRUE && value == (void *)&data);
+
+    /* A ready eventual may not be set again. */
+    ret = ABT_eventual_set_ptr(eventual, NULL);
+    assert(ret == ABT_ERR_EVENTUAL);
+    ret = ABT_eventual_set(eventual, NULL, 0);
+    assert(ret == ABT_ERR_EVENTUAL);
+
+    /* After reset, ABT_eventual_set() copies the value into the memory buffer
+     * of the eventual again. */
+    ret = ABT_eventual_reset(eventual);
+    ATS_ERROR(ret, "ABT_eventual_reset");
+    ret = ABT_eventual_test(eventual, &value, &is_ready);
+    ATS_ERROR(ret, "ABT_eventual_test");
+    assert(is_ready == ABT_FALSE);
+    data = 43;
+    ret = ABT_eventual_set(eventual, &data,
+                           nbytes >= (int)sizeof(int) ? (int)sizeof(int) : 0);
+    ATS_ERROR(ret, "ABT_eventual_set");
+    ret = ABT_eventual_wait(eventual, &value);
+    ATS_ERROR(ret, "ABT_eventual_wait");
+    if (nbytes == 0) {
+        assert(value == NULL);
+    } else {
+        assert(value != NULL && value != (void *)&data);
+        assert(*(int *)value == 43);
+        /* The memory buffer must be usable up to its size. */
+        assert(((size_t)value) % sizeof(double) == 0);
+    }
+    ret = ABT_eventual_reset(eventual);
+    ATS_ERROR(ret, "ABT_eventual_reset");
+}
+
+static void handover_func(void *arg)
+{
+    int i, ret, id = (int)(size_t)arg;
+    int num_total = g_num_xstreams * g_num_threads;
+    /* The next ULT is associated with a different pool. */
+    int next = (id + 1) % num_total;
+    int nbytes_list[] = { 0, sizeof(int), 256, 4096 };
+
+    for (i = 0; i < g_num_iter; i++) {
+        int nbytes = nbytes_list[(i + id) % 4];
+        void *value;
+        ret = ABT_eventual_create(nbytes, &g_eventuals[id]);
+        ATS_ERROR(ret, "ABT_eventual_create");
+        ret = ABT_barrier_wait(g_barrier);
+        ATS_ERROR(ret, "ABT_barrier_wait");
+        /* Set the eventual that is created by the next ULT. */
+        if (nbytes_list[(i + next) % 4] == 0) {
+            ret = ABT_eventual_set_ptr(g_eventuals[next], &g_values[next]);
+            ATS_ERROR(ret, "ABT_eventual_set_ptr");
+        } else {
+            ret = ABT_eventual_set(g_eventuals[next], &next, sizeof(int));
+            ATS_ERROR(ret, "ABT_eventual_set");
+        }
+        ret = ABT_eventual_wait(g_eventuals[id], &value);
+        ATS_ERROR(ret, "ABT_eventual_wait");
+        if (nbytes == 0) {
+            assert(value == (void *)&g_values[id]);
+        } else {
+            assert(*(int *)value == id);
+            /* Write the whole memory buffer to detect overruns. */
+            memset(value, 0xff, nbytes);
+        }
+        ret = ABT_barrier_wait(g_barrier);
+        ATS_ERROR(ret, "ABT_barrier_wait");
+        /* Free the eventual that is created by the next ULT. */
+        ret = ABT_eventual_free(&g_eventuals[next]);
+        ATS_ERROR(ret, "ABT_eventual_free");
+        assert(g_eventuals[next] == ABT_EVENTUAL_NULL);
+        ret = ABT_barrier_wait(g_barrier);
+        ATS_ERROR(ret, "ABT_barrier_wait");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int i, ret, num_total;
+    ABT_xstream *xstreams;
+    ABT_thread *threads;
+    ABT_eventual eventual;
+
+    ATS_read_args(argc, argv);
+    if (argc > 1) {
+        g_num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+        g_num_threads = ATS_get_arg_val(ATS_ARG_N_ULT);
+        g_num_iter = ATS_get_arg_val(ATS_ARG_N_ITER);
+    }
+    num_total = g_num_xstreams * g_num_threads;
+    xstreams = (ABT_xstream *)malloc(sizeof(ABT_xstream) * g_num_xstreams);
+    g_pools = (ABT_pool *)malloc(sizeof(ABT_pool) * g_num_xstreams);
+    threads = (ABT_thread *)malloc(sizeof(ABT_thread) * num_total);
+    g_eventuals = (ABT_eventual *)malloc(sizeof(ABT_eventual) * num_total);
+    g_values = (int *)calloc(num_total, sizeof(int));
+
+    ATS_init(argc, argv, g_num_xstreams);
+
+    ret = ABT_xstream_self(&xstreams[0]);
+    ATS_ERROR(ret, "ABT_xstream_self");
+    for (i = 1; i < g_num_xstreams; i++) {
+        ret = ABT_xstream_create(ABT_SCHED_NULL, &xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_create");
+    }
+    for (i = 0; i < g_num_xstreams; i++) {
+        ret = ABT_xstream_get_main_pools(xstreams[i], 1, &g_pools[i]);
+        ATS_ERROR(ret, "ABT_xstream_get_main_pools");
+    }
+
+    /* Eventuals without a memory buffer and with small and large ones. */
+    int nbytes_list[] = { 0, sizeof(int), LARGE_NBYTES };
+    for (i = 0; i < (int)(sizeof(nbytes_list) / sizeof(nbytes_list[0])); i++) {
+        ret = ABT_eventual_create(nbytes_list[i], &eventual);
+        ATS_ERROR(ret, "ABT_eventual_create");
+        test_set_ptr(eventual, nbytes_list[i]);
+        ret = ABT_eventual_free(&eventual);
+        ATS_ERROR(ret, "ABT_eventual_free");
+    }
+    /* A statically initialized eventual. */
+    test_set_ptr(ABT_EVENTUAL_MEMORY_GET_HANDLE(&g_eventual_mem), 0);
+
+    /* Eventuals are created, set, and freed by ULTs on different ESs. */
+    ret = ABT_barrier_create((uint32_t)num_total, &g_barrier);
+    ATS_ERROR(ret, "ABT_barrier_create");
+    for (i = 0; i < num_total; i++) {
+        ret = ABT_thread_create(g_pools[i % g_num_xstreams], handover_func,
+                                (void *)(size_t)i, ABT_THREAD_ATTR_NULL,
+                                &threads[i]);
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+    for (i = 0; i < num_total; i++) {
+        ret = ABT_thread_free(&threads[i]);
+        ATS_ERROR(ret, "ABT_thread_free");
+    }
+    ret = ABT_barrier_free(&g_barrier);
+    ATS_ERROR(ret, "ABT_barrier_free");
+
+    for (i = 1; i < g_num_xstreams; i++) {
+        ret = ABT_xstream_join(xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_join");
+        ret = ABT_xstream_free(&xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_free");
+    }
+
+    ret = ATS_finalize(0);
+
+    free(xstreams);
+    free(g_pools);
+    free(threads);
+    free(g_eventuals);
+    free(g_values);
+    return ret;
+}
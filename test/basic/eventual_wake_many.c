@@ -0,0 +1,162 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This test blocks many ULTs associated with different pools on ABT_eventual,
+ * ABT_cond, and ABT_barrier and wakes them up at once.  The number of ULTs per
+ * pool is larger than the internal buffer used to resume ULTs in bulk. */
+
+#define DEFAULT_NUM_XSTREAMS 4
+#define DEFAULT_NUM_THREADS 200
+
+static int g_num_xstreams = DEFAULT_NUM_XSTREAMS;
+static int g_num_threads = DEFAULT_NUM_THREADS;
+static ABT_eventual g_eventual;
+static ABT_mutex g_mutex;
+static ABT_cond g_cond;
+static ABT_barrier g_barrier;
+static int g_cond_flag = 0;
+static int g_num_cond_waiters = 0;
+static volatile int g_counter = 0;
+
+static void thread_func(void *arg)
+{
+    int ret, *p_value;
+
+    ret = ABT_eventual_wait(g_eventual, (void **)&p_value);
+    ATS_ERROR(ret, "ABT_eventual_wait");
+    assert(*p_value == 42);
+    ATS_atomic_fetch_add(&g_counter, 1);
+
+    ret = ABT_mutex_lock(g_mutex);
+    ATS_ERROR(ret, "ABT_mutex_lock");
+    g_num_cond_waiters++;
+    while (g_cond_flag == 0) {
+        ret = ABT_cond_wait(g_cond, g_mutex);
+        ATS_ERROR(ret, "ABT_cond_wait");
+    }
+    ret = ABT_mutex_unlock(g_mutex);
+    ATS_ERROR(ret, "ABT_mutex_unlock");
+    ATS_atomic_fetch_add(&g_counter, 1);
+
+    ret = ABT_barrier_wait(g_barrier);
+    ATS_ERROR(ret, "ABT_barrier_wait");
+    ATS_atomic_fetch_add(&g_counter, 1);
+}
+
+int main(int argc, char *argv[])
+{
+    ABT_xstream *xstreams;
+    ABT_pool *pools;
+    ABT_thread *threads;
+    int i, ret, num_total, value = 42;
+
+    ATS_read_args(argc, argv);
+    if (argc > 1) {
+        g_num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+        g_num_threads = ATS_get_arg_val(ATS_ARG_N_ULT);
+    }
+    num_total = g_num_xstreams * g_num_threads;
+    xstreams = (ABT_xstream *)malloc(sizeof(ABT_xstream) * g_num_xstreams);
+    pools = (ABT_pool *)malloc(sizeof(ABT_pool) * g_num_xstreams);
+    threads = (ABT_thread *)malloc(sizeof(ABT_thread) * num_total);
+
+    ATS_init(argc, argv, g_num_xstreams);
+
+    ret = ABT_eventual_create(sizeof(int), &g_eventual);
+    ATS_ERROR(ret, "ABT_eventual_create");
+    ret = ABT_mutex_create(&g_mutex);
+    ATS_ERROR(ret, "ABT_mutex_create");
+    ret = ABT_cond_create(&g_cond);
+    ATS_ERROR(ret, "ABT_cond_create");
+    ret = ABT_barrier_create(num_total + 1, &g_barrier);
+    ATS_ERROR(ret, "ABT_barrier_create");
+
+    ret = ABT_xstream_self(&xstreams[0]);
+    ATS_ERROR(ret, "ABT_xstream_self");
+    for (i = 1; i < g_num_xstreams; i++) {
+        ret = ABT_xstream_create(ABT_SCHED_NULL, &xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_create");
+    }
+    for (i = 0; i < g_num_xstreams; i++) {
+        ret = ABT_xstream_get_main_pools(xstreams[i], 1, &pools[i]);
+        ATS_ERROR(ret, "ABT_xstream_get_main_pools");
+    }
+
+    /* Interleave pools so that ULTs of the same pool are not adjacent in the
+     * waitlists. */
+    for (i = 0; i < num_total; i++) {
+        ret = ABT_thread_create(pools[i % g_num_xstreams], thread_func, NULL,
+                                ABT_THREAD_ATTR_NULL, &threads[i]);
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+
+    /* Let ULTs be blocked on the eventual before it is set. */
+    for (i = 0; i < 10; i++) {
+        ret = ABT_thread_yield();
+        ATS_ERROR(ret, "ABT_thread_yield");
+    }
+    ret = ABT_eventual_set(g_eventual, &value, sizeof(int));
+    ATS_ERROR(ret, "ABT_eventual_set");
+
+    /* Wait until all the ULTs are blocked on the condition variable. */
+    while (1) {
+        ret = ABT_mutex_lock(g_mutex);
+        ATS_ERROR(ret, "ABT_mutex_lock");
+        if (g_num_cond_waiters == num_total)
+            break;
+        ret = ABT_mutex_unlock(g_mutex);
+        ATS_ERROR(ret, "ABT_mutex_unlock");
+        ret = ABT_thread_yield();
+        ATS_ERROR(ret, "ABT_thread_yield");
+    }
+    assert(ATS_atomic_load(&g_counter) == num_total);
+    g_cond_flag = 1;
+    ret = ABT_cond_broadcast(g_cond);
+    ATS_ERROR(ret, "ABT_cond_broadcast");
+    ret = ABT_mutex_unlock(g_mutex);
+    ATS_ERROR(ret, "ABT_mutex_unlock");
+
+    /* Wait until all the ULTs pass the condition variable. */
+    while (ATS_atomic_load(&g_counter) != num_total * 2) {
+        ret = ABT_thread_yield();
+        ATS_ERROR(ret, "ABT_thread_yield");
+    }
+    ret = ABT_barrier_wait(g_barrier);
+    ATS_ERROR(ret, "ABT_barrier_wait");
+
+    for (i = 0; i < num_total; i++) {
+        ret = ABT_thread_free(&threads[i]);
+        ATS_ERROR(ret, "ABT_thread_free");
+    }
+    assert(ATS_atomic_load(&g_counter) == num_total * 3);
+
+    for (i = 1; i < g_num_xstreams; i++) {
+        ret = ABT_xstream_join(xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_join");
+        ret = ABT_xstream_free(&xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_free");
+    }
+
+    ret = ABT_barrier_free(&g_barrier);
+    ATS_ERROR(ret, "ABT_barrier_free");
+    ret = ABT_cond_free(&g_cond);
+    ATS_ERROR(ret, "ABT_cond_free");
+    ret = ABT_mutex_free(&g_mutex);
+    ATS_ERROR(ret, "ABT_mutex_free");
+    ret = ABT_eventual_free(&g_eventual);
+    ATS_ERROR(ret, "ABT_eventual_free");
+
+    ret = ATS_finalize(0);
+
+    free(xstreams);
+    free(pools);
+    free(threads);
+    return ret;
+}
@@ -0,0 +1,154 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This test sets compartments of a future from ULTs running on different ESs
+ * at the same time while other ULTs wait on the future.  The callback checks
+ * that every value is stored in exactly one compartment. */
+
+#define DEFAULT_NUM_XSTREAMS 4
+#define DEFAULT_NUM_THREADS 16
+#define DEFAULT_NUM_ITER 50
+
+static int g_num_setters;
+static int *g_seen;
+static ABT_future g_future;
+static ABT_barrier g_barrier;
+static volatile int g_num_callbacks = 0;
+
+static void callback_func(void **values)
+{
+    int i;
+    for (i = 0; i < g_num_setters; i++)
+        g_seen[i] = 0;
+    for (i = 0; i < g_num_setters; i++) {
+        int id = (int)(intptr_t)values[i];
+        assert(0 <= id && id < g_num_setters);
+        assert(g_seen[id] == 0);
+        g_seen[id] = 1;
+    }
+    ATS_atomic_fetch_add(&g_num_callbacks, 1);
+}
+
+typedef struct {
+    int id;
+    int is_setter;
+    int num_iter;
+} thread_arg_t;
+
+static void thread_func(void *arg)
+{
+    thread_arg_t *p_arg = (thread_arg_t *)arg;
+    int i, ret;
+    for (i = 0; i < p_arg->num_iter; i++) {
+        if (p_arg->is_setter) {
+            ret = ABT_future_set(g_future, (void *)(intptr_t)p_arg->id);
+            ATS_ERROR(ret, "ABT_future_set");
+        } else {
+            ABT_bool is_ready;
+            ret = ABT_future_wait(g_future);
+            ATS_ERROR(ret, "ABT_future_wait");
+            ret = ABT_future_test(g_future, &is_ready);
+            ATS_ERROR(ret, "ABT_future_test");
+            assert(is_ready == ABT_TRUE);
+            /* The callback must have been called before the future gets
+             * ready. */
+            assert(ATS_atomic_load(&g_num_callbacks) == i + 1);
+        }
+        /* Reset the future after all the ULTs pass it. */
+        ret = ABT_barrier_wait(g_barrier);
+        ATS_ERROR(ret, "ABT_barrier_wait");
+        if (p_arg->is_setter && p_arg->id == 0) {
+            ret = ABT_future_reset(g_future);
+            ATS_ERROR(ret, "ABT_future_reset");
+        }
+        ret = ABT_barrier_wait(g_barrier);
+        ATS_ERROR(ret, "ABT_barrier_wait");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int i, ret;
+    int num_xstreams = DEFAULT_NUM_XSTREAMS;
+    int num_threads = DEFAULT_NUM_THREADS;
+    int num_iter = DEFAULT_NUM_ITER;
+
+    ATS_read_args(argc, argv);
+    if (argc > 1) {
+        num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+        num_threads = ATS_get_arg_val(ATS_ARG_N_ULT);
+        num_iter = ATS_get_arg_val(ATS_ARG_N_ITER);
+    }
+    /* A quarter of ULTs wait on the future while the others set it. */
+    int num_total = num_xstreams * num_threads;
+    int num_waiters = num_total / 4;
+    g_num_setters = num_total - num_waiters;
+    ABT_xstream *xstreams =
+        (ABT_xstream *)malloc(sizeof(ABT_xstream) * num_xstreams);
+    ABT_pool *pools = (ABT_pool *)malloc(sizeof(ABT_pool) * num_xstreams);
+    ABT_thread *threads = (ABT_thread *)malloc(sizeof(ABT_thread) * num_total);
+    thread_arg_t *args =
+        (thread_arg_t *)malloc(sizeof(thread_arg_t) * num_total);
+    g_seen = (int *)calloc(g_num_setters, sizeof(int));
+
+    ATS_init(argc, argv, num_xstreams);
+
+    ret = ABT_future_create((uint32_t)g_num_setters, callback_func, &g_future);
+    ATS_ERROR(ret, "ABT_future_create");
+    ret = ABT_barrier_create((uint32_t)num_total, &g_barrier);
+    ATS_ERROR(ret, "ABT_barrier_create");
+
+    ret = ABT_xstream_self(&xstreams[0]);
+    ATS_ERROR(ret, "ABT_xstream_self");
+    for (i = 1; i < num_xstreams; i++) {
+        ret = ABT_xstream_create(ABT_SCHED_NULL, &xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_create");
+    }
+    for (i = 0; i < num_xstreams; i++) {
+        ret = ABT_xstream_get_main_pools(xstreams[i], 1, &pools[i]);
+        ATS_ERROR(ret, "ABT_xstream_get_main_pools");
+    }
+
+    for (i = 0; i < num_total; i++) {
+        args[i].id = (i < g_num_setters) ? i : i - g_num_setters;
+        args[i].is_setter = (i < g_num_setters) ? 1 : 0;
+        args[i].num_iter = num_iter;
+        ret = ABT_thread_create(pools[i % num_xstreams], thread_func, &args[i],
+                                ABT_THREAD_ATTR_NULL, &threads[i]);
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+    for (i = 0; i < num_total; i++) {
+        ret = ABT_thread_free(&threads[i]);
+        ATS_ERROR(ret, "ABT_thread_free");
+    }
+    assert(ATS_atomic_load(&g_num_callbacks) == num_iter);
+
+    for (i = 1; i < num_xstreams; i++) {
+        ret = ABT_xstream_join(xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_join");
+        ret = ABT_xstream_free(&xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_free");
+    }
+
+    ret = ABT_barrier_free(&g_barrier);
+    ATS_ERROR(ret, "ABT_barrier_free");
+    ret = ABT_future_free(&g_future);
+    ATS_ERROR(ret, "ABT_future_free");
+
+    ret = ATS_finalize(0);
+
+    free(xstreams);
+    free(pools);
+    free(threads);
+    free(args);
+    free(g_seen);
+    return ret;
+}
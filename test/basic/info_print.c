@@ -79,6 +79,10 @@ int main(int argc, char *argv[])
     ATS_ERROR(ret, "ABT_info_print_all_xstreams");
     fprintf(stdout, "\n");
 
+    ret = ABT_info_print_mem_pool(stdout);
+    ATS_ERROR(ret, "ABT_info_print_mem_pool");
+    fprintf(stdout, "\n");
+
     for (i = 0; i < num_xstreams; i++) {
         ret = ABT_xstream_get_main_sched(xstreams[i], &scheds[i]);
         ATS_ERROR(ret, "ABT_xstream_get_main_sched");
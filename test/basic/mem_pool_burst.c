@@ -0,0 +1,142 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This test creates and frees bursts of work units that are much larger than
+ * the stack and descriptor caches of each ES so that the caches of ESs are
+ * deepened and then trimmed while ESs are idle.  Each burst is followed by an
+ * idle period. */
+
+#define DEFAULT_NUM_XSTREAMS 4
+#define DEFAULT_NUM_THREADS 200
+#define DEFAULT_NUM_ITER 10
+#define NUM_IDLE_YIELDS 10000
+
+static int g_num_threads = DEFAULT_NUM_THREADS;
+static int g_num_iter = DEFAULT_NUM_ITER;
+static ABT_xstream *g_xstreams;
+
+static void thread_func(void *arg)
+{
+    (*(int *)arg)++;
+}
+
+static void burst_func(void *arg)
+{
+    int i, iter, ret;
+    int counter = 0;
+    ABT_pool pool;
+    ABT_thread *threads =
+        (ABT_thread *)malloc(sizeof(ABT_thread) * g_num_threads);
+    ABT_task *tasks = (ABT_task *)malloc(sizeof(ABT_task) * g_num_threads);
+    ATS_UNUSED(arg);
+
+    ret = ABT_self_get_last_pool(&pool);
+    ATS_ERROR(ret, "ABT_self_get_last_pool");
+    for (iter = 0; iter < g_num_iter; iter++) {
+        /* Burst. */
+        for (i = 0; i < g_num_threads; i++) {
+            ret = ABT_thread_create(pool, thread_func, &counter,
+                                    ABT_THREAD_ATTR_NULL, &threads[i]);
+            ATS_ERROR(ret, "ABT_thread_create");
+            ret = ABT_task_create(pool, thread_func, &counter, &tasks[i]);
+            ATS_ERROR(ret, "ABT_task_create");
+        }
+        for (i = 0; i < g_num_threads; i++) {
+            ret = ABT_thread_free(&threads[i]);
+            ATS_ERROR(ret, "ABT_thread_free");
+            ret = ABT_task_free(&tasks[i]);
+            ATS_ERROR(ret, "ABT_task_free");
+        }
+        /* Idle so that the scheduler trims the caches. */
+        for (i = 0; i < NUM_IDLE_YIELDS; i++) {
+            ret = ABT_thread_yield();
+            ATS_ERROR(ret, "ABT_thread_yield");
+        }
+    }
+    assert(counter == g_num_threads * 2 * g_num_iter);
+    free(threads);
+    free(tasks);
+}
+
+int main(int argc, char *argv[])
+{
+    int num_xstreams = DEFAULT_NUM_XSTREAMS;
+    const char *max_local_buckets[] = { "2", "8", "16" };
+    const int num_configs = sizeof(max_local_buckets) / sizeof(char *);
+    static char env_str[64];
+    int i, k, ret;
+
+    ATS_read_args(argc, argv);
+    if (argc > 1) {
+        num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+        g_num_threads = ATS_get_arg_val(ATS_ARG_N_ULT);
+        g_num_iter = ATS_get_arg_val(ATS_ARG_N_ITER);
+    }
+    g_xstreams = (ABT_xstream *)malloc(sizeof(ABT_xstream) * num_xstreams);
+
+    /* Use tiny buckets. */
+    putenv("ABT_MEM_MAX_NUM_STACKS=8");
+    putenv("ABT_MEM_MAX_NUM_DESCS=8");
+    for (k = 0; k < num_configs; k++) {
+        unsetenv("ABT_MEM_MAX_LOCAL_BUCKETS");
+        sprintf(env_str, "ABT_MEM_MAX_LOCAL_BUCKETS=%s", max_local_buckets[k]);
+        putenv(env_str);
+
+        /* Use ATS_init for the last run. */
+        if (k == num_configs - 1) {
+            ATS_init(argc, argv, num_xstreams);
+        } else {
+            ret = ABT_init(argc, argv);
+            ATS_ERROR(ret, "ABT_init");
+        }
+
+        ret = ABT_xstream_self(&g_xstreams[0]);
+        ATS_ERROR(ret, "ABT_xstream_self");
+        for (i = 1; i < num_xstreams; i++) {
+            ret = ABT_xstream_create(ABT_SCHED_NULL, &g_xstreams[i]);
+            ATS_ERROR(ret, "ABT_xstream_create");
+        }
+
+        ABT_thread *threads =
+            (ABT_thread *)malloc(sizeof(ABT_thread) * num_xstreams);
+        for (i = 0; i < num_xstreams; i++) {
+            ABT_pool pool;
+            ret = ABT_xstream_get_main_pools(g_xstreams[i], 1, &pool);
+            ATS_ERROR(ret, "ABT_xstream_get_main_pools");
+            ret = ABT_thread_create(pool, burst_func, NULL,
+                                    ABT_THREAD_ATTR_NULL, &threads[i]);
+            ATS_ERROR(ret, "ABT_thread_create");
+        }
+        for (i = 0; i < num_xstreams; i++) {
+            ret = ABT_thread_free(&threads[i]);
+            ATS_ERROR(ret, "ABT_thread_free");
+        }
+        free(threads);
+
+        /* Join and free ESs */
+        for (i = 1; i < num_xstreams; i++) {
+            ret = ABT_xstream_join(g_xstreams[i]);
+            ATS_ERROR(ret, "ABT_xstream_join");
+            ret = ABT_xstream_free(&g_xstreams[i]);
+            ATS_ERROR(ret, "ABT_xstream_free");
+        }
+
+        /* Finalize */
+        if (k == num_configs - 1) {
+            ret = ATS_finalize(0);
+        } else {
+            ret = ABT_finalize();
+            ATS_ERROR(ret, "ABT_finalize");
+        }
+    }
+    free(g_xstreams);
+    return ret;
+}
@@ -0,0 +1,133 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This test checks that ULTs can be freed by threads other than the ES that
+ * allocated their stacks.  The primary ES creates ULTs and pushes them to the
+ * pools of the other ESs.  Those ULTs are freed by
+ *  - a ULT running on another ES,
+ *  - an external thread, or
+ *  - the ES that runs them (unnamed ULTs).
+ * Stacks freed in such ways are returned to the primary ES. */
+
+#define DEFAULT_NUM_XSTREAMS 3
+#define DEFAULT_NUM_THREADS 100
+#define DEFAULT_NUM_ITER 20
+
+static int g_num_threads = DEFAULT_NUM_THREADS;
+static ABT_thread *g_threads;
+
+static void thread_func(void *arg)
+{
+    int i;
+    /* Use some stack. */
+    volatile char buffer[256];
+    ATS_UNUSED(arg);
+    for (i = 0; i < (int)sizeof(buffer); i++)
+        buffer[i] = (char)i;
+}
+
+static void free_threads(void *arg)
+{
+    int i, ret;
+    ATS_UNUSED(arg);
+    for (i = 0; i < g_num_threads; i++) {
+        ret = ABT_thread_free(&g_threads[i]);
+        ATS_ERROR(ret, "ABT_thread_free");
+    }
+}
+
+static void *ext_free_threads(void *arg)
+{
+    free_threads(arg);
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    int num_xstreams = DEFAULT_NUM_XSTREAMS;
+    int num_iter = DEFAULT_NUM_ITER;
+    ABT_xstream *xstreams;
+    ABT_pool *pools;
+    int i, iter, ret;
+
+    /* Initialize */
+    ATS_read_args(argc, argv);
+    if (argc > 1) {
+        num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+        g_num_threads = ATS_get_arg_val(ATS_ARG_N_ULT);
+        num_iter = ATS_get_arg_val(ATS_ARG_N_ITER);
+    }
+    if (num_xstreams < 2)
+        num_xstreams = 2;
+    ATS_init(argc, argv, num_xstreams);
+
+    xstreams = (ABT_xstream *)malloc(sizeof(ABT_xstream) * num_xstreams);
+    pools = (ABT_pool *)malloc(sizeof(ABT_pool) * num_xstreams);
+    g_threads = (ABT_thread *)malloc(sizeof(ABT_thread) * g_num_threads);
+
+    ret = ABT_xstream_self(&xstreams[0]);
+    ATS_ERROR(ret, "ABT_xstream_self");
+    for (i = 1; i < num_xstreams; i++) {
+        ret = ABT_xstream_create(ABT_SCHED_NULL, &xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_create");
+    }
+    for (i = 0; i < num_xstreams; i++) {
+        ret = ABT_xstream_get_main_pools(xstreams[i], 1, &pools[i]);
+        ATS_ERROR(ret, "ABT_xstream_get_main_pools");
+    }
+
+    for (iter = 0; iter < num_iter; iter++) {
+        /* Create ULTs on the primary ES and run them on the others. */
+        for (i = 0; i < g_num_threads; i++) {
+            ABT_pool pool = pools[1 + i % (num_xstreams - 1)];
+            ret = ABT_thread_create(pool, thread_func, NULL,
+                                    ABT_THREAD_ATTR_NULL, &g_threads[i]);
+            ATS_ERROR(ret, "ABT_thread_create");
+            /* Unnamed ULTs are freed by the ES that runs them. */
+            ret = ABT_thread_create(pool, thread_func, NULL,
+                                    ABT_THREAD_ATTR_NULL, NULL);
+            ATS_ERROR(ret, "ABT_thread_create");
+        }
+        if (iter % 2 == 0) {
+            /* Free ULTs on another ES. */
+            ABT_thread thread;
+            ret = ABT_thread_create(pools[num_xstreams - 1], free_threads, NULL,
+                                    ABT_THREAD_ATTR_NULL, &thread);
+            ATS_ERROR(ret, "ABT_thread_create");
+            ret = ABT_thread_free(&thread);
+            ATS_ERROR(ret, "ABT_thread_free");
+        } else {
+            /* Free ULTs on an external thread. */
+            pthread_t ext_thread;
+            ret = pthread_create(&ext_thread, NULL, ext_free_threads, NULL);
+            assert(ret == 0);
+            ret = pthread_join(ext_thread, NULL);
+            assert(ret == 0);
+        }
+    }
+
+    /* Join and free ESs */
+    for (i = 1; i < num_xstreams; i++) {
+        ret = ABT_xstream_join(xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_join");
+        ret = ABT_xstream_free(&xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_free");
+    }
+
+    /* Finalize */
+    ret = ATS_finalize(0);
+
+    free(xstreams);
+    free(pools);
+    free(g_threads);
+
+    return ret;
+}
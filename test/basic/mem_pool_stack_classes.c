@@ -0,0 +1,163 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This test creates ULTs that have stacks of non-default sizes under different
+ * settings of stack size classes.  Each ULT consumes half of its stack.  Half
+ * of the ULTs are freed by the ES that creates them and the others are freed
+ * by the primary ES. */
+
+#define DEFAULT_NUM_XSTREAMS 3
+#define DEFAULT_NUM_THREADS 50
+#define FRAME_SIZE 1024
+
+static int g_num_xstreams = DEFAULT_NUM_XSTREAMS;
+static int g_num_threads = DEFAULT_NUM_THREADS;
+static ABT_thread *g_threads;
+
+static const size_t g_stacksizes[] = { 12000,  16384,  20000,  65536,
+                                       100000, 300000, 1048576, 2097152 };
+#define NUM_STACKSIZES ((int)(sizeof(g_stacksizes) / sizeof(g_stacksizes[0])))
+
+static int consume_stack(int depth)
+{
+    volatile char buffer[FRAME_SIZE];
+    int i, sum = 0;
+    for (i = 0; i < FRAME_SIZE; i++)
+        buffer[i] = (char)(i + depth);
+    if (depth > 0)
+        sum = consume_stack(depth - 1);
+    for (i = 0; i < FRAME_SIZE; i++)
+        sum += buffer[i];
+    return sum;
+}
+
+static void thread_func(void *arg)
+{
+    size_t stacksize = *(const size_t *)arg, stacksize2;
+    ABT_thread self_thread;
+    int ret = ABT_self_get_thread(&self_thread);
+    ATS_ERROR(ret, "ABT_self_get_thread");
+    ret = ABT_thread_get_stacksize(self_thread, &stacksize2);
+    ATS_ERROR(ret, "ABT_thread_get_stacksize");
+    assert(stacksize == stacksize2);
+    consume_stack((int)(stacksize / 2 / FRAME_SIZE));
+}
+
+static void create_func(void *arg)
+{
+    int rank = (int)(intptr_t)arg;
+    int i, ret;
+    ABT_pool pool;
+    ABT_thread_attr attr;
+
+    ret = ABT_self_get_last_pool(&pool);
+    ATS_ERROR(ret, "ABT_self_get_last_pool");
+    ret = ABT_thread_attr_create(&attr);
+    ATS_ERROR(ret, "ABT_thread_attr_create");
+    for (i = 0; i < g_num_threads; i++) {
+        const size_t *p_stacksize = &g_stacksizes[(i + rank) % NUM_STACKSIZES];
+        ret = ABT_thread_attr_set_stacksize(attr, *p_stacksize);
+        ATS_ERROR(ret, "ABT_thread_attr_set_stacksize");
+        ret = ABT_thread_create(pool, thread_func, (void *)p_stacksize, attr,
+                                &g_threads[rank * g_num_threads + i]);
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+    ret = ABT_thread_attr_free(&attr);
+    ATS_ERROR(ret, "ABT_thread_attr_free");
+    /* Free half of them here. */
+    for (i = 0; i < g_num_threads; i += 2) {
+        ret = ABT_thread_free(&g_threads[rank * g_num_threads + i]);
+        ATS_ERROR(ret, "ABT_thread_free");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *stack_classes[] = { "0", NULL, "20000,300000,20000,100" };
+    const int num_configs = sizeof(stack_classes) / sizeof(char *);
+    static char env_str[256];
+    ABT_xstream *xstreams;
+    ABT_thread *creators;
+    int i, k, ret;
+
+    ATS_read_args(argc, argv);
+    if (argc > 1) {
+        g_num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+        g_num_threads = ATS_get_arg_val(ATS_ARG_N_ULT);
+    }
+    xstreams = (ABT_xstream *)malloc(sizeof(ABT_xstream) * g_num_xstreams);
+    creators = (ABT_thread *)malloc(sizeof(ABT_thread) * g_num_xstreams);
+    g_threads = (ABT_thread *)malloc(sizeof(ABT_thread) * g_num_xstreams *
+                                     g_num_threads);
+
+    for (k = 0; k < num_configs; k++) {
+        unsetenv("ABT_MEM_STACK_CLASSES");
+        if (stack_classes[k]) {
+            sprintf(env_str, "ABT_MEM_STACK_CLASSES=%s", stack_classes[k]);
+            putenv(env_str);
+        }
+
+        /* Use ATS_init for the last run. */
+        if (k == num_configs - 1) {
+            ATS_init(argc, argv, g_num_xstreams);
+        } else {
+            ret = ABT_init(argc, argv);
+            ATS_ERROR(ret, "ABT_init");
+        }
+
+        ret = ABT_xstream_self(&xstreams[0]);
+        ATS_ERROR(ret, "ABT_xstream_self");
+        for (i = 1; i < g_num_xstreams; i++) {
+            ret = ABT_xstream_create(ABT_SCHED_NULL, &xstreams[i]);
+            ATS_ERROR(ret, "ABT_xstream_create");
+        }
+        for (i = 0; i < g_num_xstreams; i++) {
+            ABT_pool pool;
+            ret = ABT_xstream_get_main_pools(xstreams[i], 1, &pool);
+            ATS_ERROR(ret, "ABT_xstream_get_main_pools");
+            ret = ABT_thread_create(pool, create_func, (void *)(intptr_t)i,
+                                    ABT_THREAD_ATTR_NULL, &creators[i]);
+            ATS_ERROR(ret, "ABT_thread_create");
+        }
+        for (i = 0; i < g_num_xstreams; i++) {
+            ret = ABT_thread_free(&creators[i]);
+            ATS_ERROR(ret, "ABT_thread_free");
+        }
+        /* Free the others on the primary ES. */
+        for (i = 0; i < g_num_xstreams; i++) {
+            int j;
+            for (j = 1; j < g_num_threads; j += 2) {
+                ret = ABT_thread_free(&g_threads[i * g_num_threads + j]);
+                ATS_ERROR(ret, "ABT_thread_free");
+            }
+        }
+
+        /* Join and free ESs */
+        for (i = 1; i < g_num_xstreams; i++) {
+            ret = ABT_xstream_join(xstreams[i]);
+            ATS_ERROR(ret, "ABT_xstream_join");
+            ret = ABT_xstream_free(&xstreams[i]);
+            ATS_ERROR(ret, "ABT_xstream_free");
+        }
+
+        /* Finalize */
+        if (k == num_configs - 1) {
+            ret = ATS_finalize(0);
+        } else {
+            ret = ABT_finalize();
+            ATS_ERROR(ret, "ABT_finalize");
+        }
+    }
+    free(xstreams);
+    free(creators);
+    free(g_threads);
+    return ret;
+}
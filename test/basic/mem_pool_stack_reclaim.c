@@ -0,0 +1,162 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This test creates ULTs that consume a large part of their stacks under
+ * different settings of ABT_MEM_STACK_RECLAIM.  The number of stacks cached by
+ * each ES is made small so that stacks are frequently returned to the global
+ * memory pool, where their pages are released.  Stacks that are taken again
+ * from the global pool must be usable as usual. */
+
+#define DEFAULT_NUM_XSTREAMS 3
+#define DEFAULT_NUM_THREADS 100
+#define DEFAULT_NUM_ITER 5
+#define FRAME_SIZE 1024
+#define STACKSIZE (256 * 1024)
+
+static int g_num_threads = DEFAULT_NUM_THREADS;
+static ABT_thread *g_threads;
+static ABT_thread_attr g_attr;
+
+static int consume_stack(int depth)
+{
+    volatile char buffer[FRAME_SIZE];
+    int i, sum = 0;
+    for (i = 0; i < FRAME_SIZE; i++)
+        buffer[i] = (char)(i + depth);
+    if (depth > 0)
+        sum = consume_stack(depth - 1);
+    for (i = 0; i < FRAME_SIZE; i++)
+        sum += buffer[i];
+    return sum;
+}
+
+static void thread_func(void *arg)
+{
+    int depth = (int)(intptr_t)arg;
+    int sum1 = consume_stack(depth);
+    /* Released pages must be usable again. */
+    int sum2 = consume_stack(depth);
+    assert(sum1 == sum2);
+}
+
+static void create_func(void *arg)
+{
+    int rank = (int)(intptr_t)arg;
+    int i, ret;
+    ABT_pool pool;
+
+    ret = ABT_self_get_last_pool(&pool);
+    ATS_ERROR(ret, "ABT_self_get_last_pool");
+    for (i = 0; i < g_num_threads; i++) {
+        /* Use 1/8 - 5/8 of the stack. */
+        int depth = (int)(STACKSIZE / FRAME_SIZE / 8 * (1 + (i + rank) % 5));
+        ret = ABT_thread_create(pool, thread_func, (void *)(intptr_t)depth,
+                                g_attr, &g_threads[rank * g_num_threads + i]);
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+    for (i = 0; i < g_num_threads; i++) {
+        ret = ABT_thread_free(&g_threads[rank * g_num_threads + i]);
+        ATS_ERROR(ret, "ABT_thread_free");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *reclaim_modes[] = { "none", "free", "dontneed" };
+    const int num_configs = sizeof(reclaim_modes) / sizeof(char *);
+    static char env_str1[64], env_str2[64], env_str3[64];
+    int num_xstreams = DEFAULT_NUM_XSTREAMS;
+    int num_iter = DEFAULT_NUM_ITER;
+    ABT_xstream *xstreams;
+    ABT_thread *creators;
+    int i, k, iter, ret;
+
+    ATS_read_args(argc, argv);
+    if (argc > 1) {
+        num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+        g_num_threads = ATS_get_arg_val(ATS_ARG_N_ULT);
+        num_iter = ATS_get_arg_val(ATS_ARG_N_ITER);
+    }
+    xstreams = (ABT_xstream *)malloc(sizeof(ABT_xstream) * num_xstreams);
+    creators = (ABT_thread *)malloc(sizeof(ABT_thread) * num_xstreams);
+    g_threads =
+        (ABT_thread *)malloc(sizeof(ABT_thread) * num_xstreams * g_num_threads);
+
+    /* Let each ES keep only a few stacks. */
+    sprintf(env_str1, "ABT_MEM_MAX_NUM_STACKS=8");
+    putenv(env_str1);
+    sprintf(env_str2, "ABT_MEM_STACK_RECLAIM_KEEP_SIZE=4096");
+    putenv(env_str2);
+    for (k = 0; k < num_configs; k++) {
+        sprintf(env_str3, "ABT_MEM_STACK_RECLAIM=%s", reclaim_modes[k]);
+        putenv(env_str3);
+
+        /* Use ATS_init for the last run. */
+        if (k == num_configs - 1) {
+            ATS_init(argc, argv, num_xstreams);
+        } else {
+            ret = ABT_init(argc, argv);
+            ATS_ERROR(ret, "ABT_init");
+        }
+        ret = ABT_thread_attr_create(&g_attr);
+        ATS_ERROR(ret, "ABT_thread_attr_create");
+        ret = ABT_thread_attr_set_stacksize(g_attr, STACKSIZE);
+        ATS_ERROR(ret, "ABT_thread_attr_set_stacksize");
+
+        ret = ABT_xstream_self(&xstreams[0]);
+        ATS_ERROR(ret, "ABT_xstream_self");
+        for (i = 1; i < num_xstreams; i++) {
+            ret = ABT_xstream_create(ABT_SCHED_NULL, &xstreams[i]);
+            ATS_ERROR(ret, "ABT_xstream_create");
+        }
+        for (iter = 0; iter < num_iter; iter++) {
+            for (i = 0; i < num_xstreams; i++) {
+                ABT_pool pool;
+                ret = ABT_xstream_get_main_pools(xstreams[i], 1, &pool);
+                ATS_ERROR(ret, "ABT_xstream_get_main_pools");
+                ret = ABT_thread_create(pool, create_func, (void *)(intptr_t)i,
+                                        ABT_THREAD_ATTR_NULL, &creators[i]);
+                ATS_ERROR(ret, "ABT_thread_create");
+            }
+            for (i = 0; i < num_xstreams; i++) {
+                ret = ABT_thread_free(&creators[i]);
+                ATS_ERROR(ret, "ABT_thread_free");
+            }
+        }
+        ret = ABT_info_print_mem_pool(stdout);
+        ATS_ERROR(ret, "ABT_info_print_mem_pool");
+
+        /* Join and free ESs */
+        for (i = 1; i < num_xstreams; i++) {
+            ret = ABT_xstream_join(xstreams[i]);
+            ATS_ERROR(ret, "ABT_xstream_join");
+            ret = ABT_xstream_free(&xstreams[i]);
+            ATS_ERROR(ret, "ABT_xstream_free");
+        }
+        ret = ABT_thread_attr_free(&g_attr);
+        ATS_ERROR(ret, "ABT_thread_attr_free");
+
+        /* Finalize */
+        if (k == num_configs - 1) {
+            ret = ATS_finalize(0);
+        } else {
+            ret = ABT_finalize();
+            ATS_ERROR(ret, "ABT_finalize");
+        }
+    }
+    unsetenv("ABT_MEM_MAX_NUM_STACKS");
+    unsetenv("ABT_MEM_STACK_RECLAIM_KEEP_SIZE");
+    unsetenv("ABT_MEM_STACK_RECLAIM");
+    free(xstreams);
+    free(creators);
+    free(g_threads);
+    return ret;
+}
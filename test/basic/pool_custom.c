@@ -19,7 +19,7 @@ ABT_pool create_pool4(void);
 
 #define DEFAULT_NUM_XSTREAMS 3
 #define DEFAULT_NUM_THREADS 200
-#define NUM_POOLS 7
+#define NUM_POOLS 8
 
 void thread_func(void *arg)
 {
@@ -67,6 +67,12 @@ ABT_pool create_pool(int pool_type)
     } else if (pool_type == 6) {
         /* ABTI_pool_user_def-based pool (poo; 4). */
         newpool = create_pool4();
+    } else if (pool_type == 7) {
+        /* Built-in FIFO_LOCKFREE pool. */
+        int ret =
+            ABT_pool_create_basic(ABT_POOL_FIFO_LOCKFREE, ABT_POOL_ACCESS_MPMC,
+                                  ABT_FALSE, &newpool);
+        ATS_ERROR(ret, "ABT_pool_create_basic");
     }
     return newpool;
 }
@@ -0,0 +1,134 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This test checks timeouts and wake-ups of ABT_POOL_FIFO_WAIT.  The pool is
+ * not associated with any scheduler, so work units in it are never scheduled
+ * until they are moved to another pool. */
+
+#define DEFAULT_NUM_XSTREAMS 2
+#define DEFAULT_NUM_THREADS 16
+#define TIMEOUT_SEC 0.01
+#define PUSH_DELAY_SEC 0.005
+/* Large enough so that the test does not rely on a timeout. */
+#define LONG_TIMEOUT_SEC 60.0
+
+static ABT_pool g_wait_pool;
+static int g_num_threads = DEFAULT_NUM_THREADS;
+static ABT_thread *g_threads;
+
+static void thread_func(void *arg)
+{
+    ATS_UNUSED(arg);
+}
+
+static void push_func(void *arg)
+{
+    int i, ret;
+    ATS_UNUSED(arg);
+    for (i = 0; i < g_num_threads; i++) {
+        /* Give the consumer a chance to sleep. */
+        double start_time = ABT_get_wtime();
+        while (ABT_get_wtime() - start_time < PUSH_DELAY_SEC) {
+            ret = ABT_thread_yield();
+            ATS_ERROR(ret, "ABT_thread_yield");
+        }
+        ret = ABT_thread_create(g_wait_pool, thread_func, NULL,
+                                ABT_THREAD_ATTR_NULL, &g_threads[i]);
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int num_xstreams = DEFAULT_NUM_XSTREAMS;
+    ABT_xstream *xstreams;
+    ABT_pool main_pool;
+    ABT_thread thread, push_thread;
+    double start_time, elapsed_time;
+    int i, ret;
+
+    /* Initialize */
+    ATS_read_args(argc, argv);
+    if (argc > 1) {
+        num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+        g_num_threads = ATS_get_arg_val(ATS_ARG_N_ULT);
+    }
+    ATS_init(argc, argv, num_xstreams);
+    if (num_xstreams < 2)
+        num_xstreams = 2;
+
+    xstreams = (ABT_xstream *)malloc(sizeof(ABT_xstream) * num_xstreams);
+    g_threads = (ABT_thread *)malloc(sizeof(ABT_thread) * g_num_threads);
+
+    ret = ABT_xstream_self(&xstreams[0]);
+    ATS_ERROR(ret, "ABT_xstream_self");
+    for (i = 1; i < num_xstreams; i++) {
+        ret = ABT_xstream_create(ABT_SCHED_NULL, &xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_create");
+    }
+    ret = ABT_xstream_get_main_pools(xstreams[0], 1, &main_pool);
+    ATS_ERROR(ret, "ABT_xstream_get_main_pools");
+
+    ret = ABT_pool_create_basic(ABT_POOL_FIFO_WAIT, ABT_POOL_ACCESS_MPMC,
+                                ABT_FALSE, &g_wait_pool);
+    ATS_ERROR(ret, "ABT_pool_create_basic");
+
+    /* Timeout on an empty pool. */
+    start_time = ABT_get_wtime();
+    ret = ABT_pool_pop_wait_thread(g_wait_pool, &thread, TIMEOUT_SEC);
+    ATS_ERROR(ret, "ABT_pool_pop_wait_thread");
+    elapsed_time = ABT_get_wtime() - start_time;
+    assert(thread == ABT_THREAD_NULL);
+    assert(elapsed_time >= TIMEOUT_SEC * 0.9);
+
+    /* Another ES pushes work units while this ES waits. */
+    ABT_pool pusher_pool;
+    ret = ABT_xstream_get_main_pools(xstreams[1], 1, &pusher_pool);
+    ATS_ERROR(ret, "ABT_xstream_get_main_pools");
+    ret = ABT_thread_create(pusher_pool, push_func, NULL, ABT_THREAD_ATTR_NULL,
+                            &push_thread);
+    ATS_ERROR(ret, "ABT_thread_create");
+    for (i = 0; i < g_num_threads; i++) {
+        ret = ABT_pool_pop_wait_thread(g_wait_pool, &thread, LONG_TIMEOUT_SEC);
+        ATS_ERROR(ret, "ABT_pool_pop_wait_thread");
+        assert(thread != ABT_THREAD_NULL);
+        /* Run it in the main pool. */
+        ret = ABT_pool_push_thread(main_pool, thread);
+        ATS_ERROR(ret, "ABT_pool_push_thread");
+    }
+    ret = ABT_thread_free(&push_thread);
+    ATS_ERROR(ret, "ABT_thread_free");
+    for (i = 0; i < g_num_threads; i++) {
+        ret = ABT_thread_free(&g_threads[i]);
+        ATS_ERROR(ret, "ABT_thread_free");
+    }
+    ret = ABT_pool_pop_wait_thread(g_wait_pool, &thread, 0.0);
+    ATS_ERROR(ret, "ABT_pool_pop_wait_thread");
+    assert(thread == ABT_THREAD_NULL);
+
+    ret = ABT_pool_free(&g_wait_pool);
+    ATS_ERROR(ret, "ABT_pool_free");
+
+    /* Join and free ESs */
+    for (i = 1; i < num_xstreams; i++) {
+        ret = ABT_xstream_join(xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_join");
+        ret = ABT_xstream_free(&xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_free");
+    }
+
+    /* Finalize */
+    ret = ATS_finalize(0);
+
+    free(xstreams);
+    free(g_threads);
+
+    return ret;
+}
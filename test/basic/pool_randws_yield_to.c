@@ -0,0 +1,134 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This test checks ABT_thread_yield_to() with ABT_POOL_RANDWS pools used by
+ * ABT_SCHED_RANDWS.  ULTs created by the owner of a pool are stored in its
+ * work-stealing deque, so ABT_thread_yield_to() needs to remove the target ULT
+ * from any position of the deque. */
+
+#define DEFAULT_NUM_XSTREAMS 4
+#define DEFAULT_NUM_THREADS 8
+#define DEFAULT_NUM_ITER 20
+
+static int g_num_threads = DEFAULT_NUM_THREADS;
+static int g_num_iter = DEFAULT_NUM_ITER;
+static volatile int g_counter = 0;
+
+static void child_func(void *arg)
+{
+    ATS_UNUSED(arg);
+    ATS_atomic_fetch_add(&g_counter, 1);
+}
+
+static void parent_func(void *arg)
+{
+    ATS_UNUSED(arg);
+    int i, j, ret;
+    ABT_pool pool;
+    ABT_thread *children =
+        (ABT_thread *)malloc(sizeof(ABT_thread) * g_num_threads);
+
+    for (i = 0; i < g_num_iter; i++) {
+        ret = ABT_self_get_last_pool(&pool);
+        ATS_ERROR(ret, "ABT_self_get_last_pool");
+        for (j = 0; j < g_num_threads; j++) {
+            ret = ABT_thread_create(pool, child_func, NULL,
+                                    ABT_THREAD_ATTR_NULL, &children[j]);
+            ATS_ERROR(ret, "ABT_thread_create");
+        }
+        /* Yield to a ULT in the middle, the newest one, and the oldest one.
+         * Some of them might have been stolen or executed already. */
+        ret = ABT_thread_yield_to(children[g_num_threads / 2]);
+        ATS_ERROR(ret, "ABT_thread_yield_to");
+        ret = ABT_thread_yield_to(children[g_num_threads - 1]);
+        ATS_ERROR(ret, "ABT_thread_yield_to");
+        ret = ABT_thread_yield_to(children[0]);
+        ATS_ERROR(ret, "ABT_thread_yield_to");
+        for (j = 0; j < g_num_threads; j++) {
+            ret = ABT_thread_free(&children[j]);
+            ATS_ERROR(ret, "ABT_thread_free");
+        }
+    }
+    free(children);
+}
+
+int main(int argc, char *argv[])
+{
+    int i, ret;
+    int num_xstreams = DEFAULT_NUM_XSTREAMS;
+
+    ATS_read_args(argc, argv);
+    if (argc > 1) {
+        num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+        g_num_threads = ATS_get_arg_val(ATS_ARG_N_ULT);
+        g_num_iter = ATS_get_arg_val(ATS_ARG_N_ITER);
+    }
+    if (g_num_threads < 1)
+        g_num_threads = 1;
+    ABT_xstream *xstreams =
+        (ABT_xstream *)malloc(sizeof(ABT_xstream) * num_xstreams);
+    ABT_pool *pools = (ABT_pool *)malloc(sizeof(ABT_pool) * num_xstreams);
+    ABT_pool *my_pools = (ABT_pool *)malloc(sizeof(ABT_pool) * num_xstreams);
+    ABT_thread *parents =
+        (ABT_thread *)malloc(sizeof(ABT_thread) * num_xstreams);
+
+    ATS_init(argc, argv, num_xstreams);
+
+    for (i = 0; i < num_xstreams; i++) {
+        ret = ABT_pool_create_basic(ABT_POOL_RANDWS, ABT_POOL_ACCESS_MPMC,
+                                    ABT_TRUE, &pools[i]);
+        ATS_ERROR(ret, "ABT_pool_create_basic");
+    }
+    ret = ABT_xstream_self(&xstreams[0]);
+    ATS_ERROR(ret, "ABT_xstream_self");
+    for (i = 0; i < num_xstreams; i++) {
+        int k;
+        for (k = 0; k < num_xstreams; k++)
+            my_pools[k] = pools[(i + k) % num_xstreams];
+        if (i == 0) {
+            ret = ABT_xstream_set_main_sched_basic(xstreams[0],
+                                                   ABT_SCHED_RANDWS,
+                                                   num_xstreams, my_pools);
+            ATS_ERROR(ret, "ABT_xstream_set_main_sched_basic");
+        } else {
+            ret = ABT_xstream_create_basic(ABT_SCHED_RANDWS, num_xstreams,
+                                           my_pools, ABT_SCHED_CONFIG_NULL,
+                                           &xstreams[i]);
+            ATS_ERROR(ret, "ABT_xstream_create_basic");
+        }
+    }
+
+    for (i = 0; i < num_xstreams; i++) {
+        ret = ABT_thread_create(pools[i], parent_func, NULL,
+                                ABT_THREAD_ATTR_NULL, &parents[i]);
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+    for (i = 0; i < num_xstreams; i++) {
+        ret = ABT_thread_free(&parents[i]);
+        ATS_ERROR(ret, "ABT_thread_free");
+    }
+    assert(ATS_atomic_load(&g_counter) ==
+           num_xstreams * g_num_threads * g_num_iter);
+
+    for (i = 1; i < num_xstreams; i++) {
+        ret = ABT_xstream_join(xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_join");
+        ret = ABT_xstream_free(&xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_free");
+    }
+
+    ret = ATS_finalize(0);
+
+    free(xstreams);
+    free(pools);
+    free(my_pools);
+    free(parents);
+    return ret;
+}
@@ -0,0 +1,138 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This test checks ABT_rwlock when readers and writers move between ESs while
+ * holding the lock.  All the ESs share a single pool, so a ULT that yields
+ * while holding the lock can be resumed on another ES and unlock the lock
+ * there. */
+
+#define DEFAULT_NUM_XSTREAMS 4
+#define DEFAULT_NUM_THREADS 16
+#define DEFAULT_NUM_ITER 50
+
+static int g_num_iter = DEFAULT_NUM_ITER;
+static ABT_rwlock g_rwlock;
+static volatile int g_num_readers = 0;
+static volatile int g_num_writers = 0;
+static int g_counter = 0;
+
+static void thread_func(void *arg)
+{
+    int i, ret, id = (int)(size_t)arg;
+
+    for (i = 0; i < g_num_iter; i++) {
+        if (id % 4 != 0) {
+            /* Reader */
+            ret = ABT_rwlock_rdlock(g_rwlock);
+            ATS_ERROR(ret, "ABT_rwlock_rdlock");
+            ATS_atomic_fetch_add(&g_num_readers, 1);
+            assert(ATS_atomic_load(&g_num_writers) == 0);
+            ret = ABT_thread_yield();
+            ATS_ERROR(ret, "ABT_thread_yield");
+            assert(ATS_atomic_load(&g_num_writers) == 0);
+            ATS_atomic_fetch_add(&g_num_readers, -1);
+        } else {
+            /* Writer */
+            ret = ABT_rwlock_wrlock(g_rwlock);
+            ATS_ERROR(ret, "ABT_rwlock_wrlock");
+            ATS_atomic_fetch_add(&g_num_writers, 1);
+            assert(ATS_atomic_load(&g_num_readers) == 0);
+            assert(ATS_atomic_load(&g_num_writers) == 1);
+            g_counter++;
+            ret = ABT_thread_yield();
+            ATS_ERROR(ret, "ABT_thread_yield");
+            assert(ATS_atomic_load(&g_num_readers) == 0);
+            assert(ATS_atomic_load(&g_num_writers) == 1);
+            ATS_atomic_fetch_add(&g_num_writers, -1);
+        }
+        ret = ABT_rwlock_unlock(g_rwlock);
+        ATS_ERROR(ret, "ABT_rwlock_unlock");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int i, ret;
+    int num_xstreams = DEFAULT_NUM_XSTREAMS;
+    int num_threads = DEFAULT_NUM_THREADS;
+
+    ATS_read_args(argc, argv);
+    if (argc > 1) {
+        num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+        num_threads = ATS_get_arg_val(ATS_ARG_N_ULT);
+        g_num_iter = ATS_get_arg_val(ATS_ARG_N_ITER);
+    }
+    ABT_xstream *xstreams =
+        (ABT_xstream *)malloc(sizeof(ABT_xstream) * num_xstreams);
+    ABT_thread *threads =
+        (ABT_thread *)malloc(sizeof(ABT_thread) * num_threads);
+
+    ATS_init(argc, argv, num_xstreams);
+
+    /* Create a pool shared by all the ESs. */
+    ABT_pool pool;
+    ret = ABT_pool_create_basic(ABT_POOL_FIFO, ABT_POOL_ACCESS_MPMC, ABT_TRUE,
+                                &pool);
+    ATS_ERROR(ret, "ABT_pool_create_basic");
+    ret = ABT_xstream_self(&xstreams[0]);
+    ATS_ERROR(ret, "ABT_xstream_self");
+    ret = ABT_xstream_set_main_sched_basic(xstreams[0], ABT_SCHED_DEFAULT, 1,
+                                           &pool);
+    ATS_ERROR(ret, "ABT_xstream_set_main_sched_basic");
+    for (i = 1; i < num_xstreams; i++) {
+        ret = ABT_xstream_create_basic(ABT_SCHED_DEFAULT, 1, &pool,
+                                       ABT_SCHED_CONFIG_NULL, &xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_create_basic");
+    }
+
+    ret = ABT_rwlock_create(&g_rwlock);
+    ATS_ERROR(ret, "ABT_rwlock_create");
+
+    for (i = 0; i < num_threads; i++) {
+        ret = ABT_thread_create(pool, thread_func, (void *)(size_t)i,
+                                ABT_THREAD_ATTR_NULL, &threads[i]);
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+    for (i = 0; i < num_threads; i++) {
+        ret = ABT_thread_free(&threads[i]);
+        ATS_ERROR(ret, "ABT_thread_free");
+    }
+    assert(g_counter == ((num_threads + 3) / 4) * g_num_iter);
+
+    /* The lock must be available to both readers and writers. */
+    ret = ABT_rwlock_rdlock(g_rwlock);
+    ATS_ERROR(ret, "ABT_rwlock_rdlock");
+    ret = ABT_rwlock_rdlock(g_rwlock);
+    ATS_ERROR(ret, "ABT_rwlock_rdlock");
+    ret = ABT_rwlock_unlock(g_rwlock);
+    ATS_ERROR(ret, "ABT_rwlock_unlock");
+    ret = ABT_rwlock_unlock(g_rwlock);
+    ATS_ERROR(ret, "ABT_rwlock_unlock");
+    ret = ABT_rwlock_wrlock(g_rwlock);
+    ATS_ERROR(ret, "ABT_rwlock_wrlock");
+    ret = ABT_rwlock_unlock(g_rwlock);
+    ATS_ERROR(ret, "ABT_rwlock_unlock");
+
+    ret = ABT_rwlock_free(&g_rwlock);
+    ATS_ERROR(ret, "ABT_rwlock_free");
+
+    for (i = 1; i < num_xstreams; i++) {
+        ret = ABT_xstream_join(xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_join");
+        ret = ABT_xstream_free(&xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_free");
+    }
+
+    ret = ATS_finalize(0);
+
+    free(xstreams);
+    free(threads);
+    return ret;
+}
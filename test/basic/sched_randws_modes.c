@@ -0,0 +1,195 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This test runs ABT_SCHED_RANDWS with the steal-half mode and the
+ * topology-aware victim selection.  ULTs yield to their siblings, which
+ * removes the target ULT from its associated pool, so a ULT moved by
+ * steal-half must be associated with the pool that it is pushed to. */
+
+#define DEFAULT_NUM_XSTREAMS 4
+#define DEFAULT_NUM_THREADS 16
+#define DEFAULT_NUM_ITER 10
+#define NUM_CONFIGS 3
+
+static int g_num_threads = DEFAULT_NUM_THREADS;
+static int g_num_iter = DEFAULT_NUM_ITER;
+static volatile int g_counter = 0;
+
+typedef struct {
+    ABT_thread *threads;
+    volatile int is_ready;
+} thread_group_t;
+
+typedef struct {
+    thread_group_t *p_group;
+    int id;
+} thread_arg_t;
+
+static void thread_func(void *arg)
+{
+    thread_arg_t *p_arg = (thread_arg_t *)arg;
+    thread_group_t *p_group = p_arg->p_group;
+    int i, ret;
+
+    /* Wait until all the handles of the siblings are set. */
+    while (ATS_atomic_load(&p_group->is_ready) == 0) {
+        ret = ABT_thread_yield();
+        ATS_ERROR(ret, "ABT_thread_yield");
+    }
+    for (i = 0; i < g_num_iter; i++) {
+        ABT_thread next =
+            p_group->threads[(p_arg->id + i + 1) % g_num_threads];
+        ABT_thread self;
+        ret = ABT_thread_self(&self);
+        ATS_ERROR(ret, "ABT_thread_self");
+        if (next != self) {
+            ret = ABT_thread_yield_to(next);
+            ATS_ERROR(ret, "ABT_thread_yield_to");
+        }
+        ret = ABT_thread_yield();
+        ATS_ERROR(ret, "ABT_thread_yield");
+    }
+    ATS_atomic_fetch_add(&g_counter, 1);
+}
+
+static void create_threads(void *arg)
+{
+    ATS_UNUSED(arg);
+    int i, ret;
+    ABT_pool pool;
+    thread_group_t group;
+    thread_arg_t *args;
+
+    ret = ABT_self_get_last_pool(&pool);
+    ATS_ERROR(ret, "ABT_self_get_last_pool");
+
+    group.threads = (ABT_thread *)malloc(sizeof(ABT_thread) * g_num_threads);
+    group.is_ready = 0;
+    args = (thread_arg_t *)malloc(sizeof(thread_arg_t) * g_num_threads);
+    for (i = 0; i < g_num_threads; i++) {
+        args[i].p_group = &group;
+        args[i].id = i;
+        ret = ABT_thread_create(pool, thread_func, &args[i],
+                                ABT_THREAD_ATTR_NULL, &group.threads[i]);
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+    ATS_atomic_store(&group.is_ready, 1);
+    /* Siblings might yield to a terminated ULT, so free ULTs after all of them
+     * terminate. */
+    for (i = 0; i < g_num_threads; i++) {
+        ret = ABT_thread_join(group.threads[i]);
+        ATS_ERROR(ret, "ABT_thread_join");
+    }
+    for (i = 0; i < g_num_threads; i++) {
+        ret = ABT_thread_free(&group.threads[i]);
+        ATS_ERROR(ret, "ABT_thread_free");
+    }
+    free(group.threads);
+    free(args);
+}
+
+int main(int argc, char *argv[])
+{
+    int num_xstreams = DEFAULT_NUM_XSTREAMS;
+    ABT_xstream *xstreams;
+    ABT_sched *scheds;
+    ABT_sched_config configs[NUM_CONFIGS];
+    int *victim_levels;
+    ABT_pool *pools, *my_pools;
+    ABT_thread *main_threads;
+    int i, k, ret;
+
+    ATS_read_args(argc, argv);
+    if (argc > 1) {
+        num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+        g_num_threads = ATS_get_arg_val(ATS_ARG_N_ULT);
+        g_num_iter = ATS_get_arg_val(ATS_ARG_N_ITER);
+    }
+    ATS_init(argc, argv, num_xstreams);
+
+    xstreams = (ABT_xstream *)malloc(num_xstreams * sizeof(ABT_xstream));
+    scheds = (ABT_sched *)malloc(num_xstreams * sizeof(ABT_sched));
+    pools = (ABT_pool *)malloc(num_xstreams * sizeof(ABT_pool));
+    main_threads = (ABT_thread *)malloc(num_xstreams * sizeof(ABT_thread));
+
+    for (i = 0; i < num_xstreams; i++) {
+        ret = ABT_pool_create_basic(ABT_POOL_FIFO, ABT_POOL_ACCESS_MPMC,
+                                    ABT_TRUE, &pools[i]);
+        ATS_ERROR(ret, "ABT_pool_create_basic");
+    }
+
+    /* Create schedulers with different stealing strategies. */
+    victim_levels = (int *)malloc(num_xstreams * sizeof(int));
+    for (i = 0; i < num_xstreams; i++) {
+        victim_levels[i] = i % 4;
+    }
+    ret = ABT_sched_config_create(&configs[0], ABT_sched_randws_steal_half, 1,
+                                  ABT_sched_config_var_end);
+    ATS_ERROR(ret, "ABT_sched_config_create");
+    ret = ABT_sched_config_create(&configs[1],
+                                  ABT_sched_randws_victim_hierarchy, 1,
+                                  ABT_sched_config_var_end);
+    ATS_ERROR(ret, "ABT_sched_config_create");
+    ret = ABT_sched_config_create(&configs[2], ABT_sched_randws_steal_half, 1,
+                                  ABT_sched_randws_victim_levels, victim_levels,
+                                  ABT_sched_config_var_end);
+    ATS_ERROR(ret, "ABT_sched_config_create");
+    my_pools = (ABT_pool *)malloc(num_xstreams * sizeof(ABT_pool));
+    for (i = 0; i < num_xstreams; i++) {
+        for (k = 0; k < num_xstreams; k++) {
+            my_pools[k] = pools[(i + k) % num_xstreams];
+        }
+        ret = ABT_sched_create_basic(ABT_SCHED_RANDWS, num_xstreams, my_pools,
+                                     configs[i % NUM_CONFIGS], &scheds[i]);
+        ATS_ERROR(ret, "ABT_sched_create_basic");
+    }
+    free(my_pools);
+    for (i = 0; i < NUM_CONFIGS; i++) {
+        ret = ABT_sched_config_free(&configs[i]);
+        ATS_ERROR(ret, "ABT_sched_config_free");
+    }
+    /* The levels have been copied by the schedulers. */
+    free(victim_levels);
+
+    ret = ABT_xstream_self(&xstreams[0]);
+    ATS_ERROR(ret, "ABT_xstream_self");
+    ret = ABT_xstream_set_main_sched(xstreams[0], scheds[0]);
+    ATS_ERROR(ret, "ABT_xstream_set_main_sched");
+    for (i = 1; i < num_xstreams; i++) {
+        ret = ABT_xstream_create(scheds[i], &xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_create");
+    }
+
+    for (i = 0; i < num_xstreams; i++) {
+        ret = ABT_thread_create(pools[i], create_threads, NULL,
+                                ABT_THREAD_ATTR_NULL, &main_threads[i]);
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+    for (i = 0; i < num_xstreams; i++) {
+        ret = ABT_thread_free(&main_threads[i]);
+        ATS_ERROR(ret, "ABT_thread_free");
+    }
+    assert(ATS_atomic_load(&g_counter) == num_xstreams * g_num_threads);
+
+    for (i = 1; i < num_xstreams; i++) {
+        ret = ABT_xstream_join(xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_join");
+        ret = ABT_xstream_free(&xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_free");
+    }
+
+    ret = ATS_finalize(0);
+
+    free(xstreams);
+    free(scheds);
+    free(pools);
+    free(main_threads);
+    return ret;
+}
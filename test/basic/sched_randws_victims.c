@@ -0,0 +1,335 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <dirent.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This test checks the order of victims of ABT_SCHED_RANDWS with the
+ * hierarchical victim selection.  A thief ES steals work units one by one from
+ * victim pools that are not consumed by any other ES.  Each victim pool has a
+ * different level, so the thief must drain the victim pools from the nearest
+ * level to the farthest one.  The first part gives the levels through
+ * ABT_sched_randws_victim_levels.  The second part, which needs the CPU
+ * affinity, lets the thief locate victim pools whose ESs are created after the
+ * thief starts, so the thief needs to locate them again later. */
+
+#define NUM_LEVELS 4
+#define DEFAULT_NUM_THREADS 16
+#define MAX_CPUS 1024
+/* Longer than the maximum interval between attempts to locate victims. */
+#define RESOLVE_WAIT_SEC 0.5
+
+static int g_num_threads = DEFAULT_NUM_THREADS;
+static int *g_log;
+static volatile int g_log_index = 0;
+static volatile int g_gate = 0;
+static volatile int g_num_blocked = 0;
+static volatile int g_release_blockers = 0;
+
+static void marker_func(void *arg)
+{
+    int index = ATS_atomic_fetch_add(&g_log_index, 1);
+    g_log[index] = (int)(size_t)arg;
+}
+
+static void check_log(int num_markers)
+{
+    int i;
+    assert(ATS_atomic_load(&g_log_index) == num_markers);
+    for (i = 1; i < num_markers; i++) {
+        /* Work units in a nearer victim pool must be stolen first. */
+        assert(g_log[i - 1] <= g_log[i]);
+    }
+}
+
+static void create_markers(ABT_pool pool, int level, ABT_thread *threads)
+{
+    int i, ret;
+    for (i = 0; i < g_num_threads; i++) {
+        ret = ABT_thread_create(pool, marker_func, (void *)(size_t)level,
+                                ABT_THREAD_ATTR_NULL, &threads[i]);
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+}
+
+static void free_threads(ABT_thread *threads, int num_threads)
+{
+    int i, ret;
+    for (i = 0; i < num_threads; i++) {
+        ret = ABT_thread_free(&threads[i]);
+        ATS_ERROR(ret, "ABT_thread_free");
+    }
+}
+
+static ABT_pool create_pool(void)
+{
+    ABT_pool pool;
+    int ret = ABT_pool_create_basic(ABT_POOL_FIFO, ABT_POOL_ACCESS_MPMC,
+                                    ABT_TRUE, &pool);
+    ATS_ERROR(ret, "ABT_pool_create_basic");
+    return pool;
+}
+
+static void test_victim_levels(void)
+{
+    int i, ret;
+    /* Victims are not sorted by their levels. */
+    int levels[NUM_LEVELS] = { 0, 2, 0, 3 };
+    ABT_pool pools[NUM_LEVELS];
+    ABT_thread *threads =
+        (ABT_thread *)malloc(sizeof(ABT_thread) * g_num_threads * NUM_LEVELS);
+    ABT_sched_config config;
+    ABT_sched sched;
+    ABT_xstream xstream;
+
+    for (i = 0; i < NUM_LEVELS; i++)
+        pools[i] = create_pool();
+    for (i = 1; i < NUM_LEVELS; i++)
+        create_markers(pools[i], levels[i], &threads[g_num_threads * i]);
+
+    ret = ABT_sched_config_create(&config, ABT_sched_randws_victim_levels,
+                                  levels, ABT_sched_config_var_end);
+    ATS_ERROR(ret, "ABT_sched_config_create");
+    ret = ABT_sched_create_basic(ABT_SCHED_RANDWS, NUM_LEVELS, pools, config,
+                                 &sched);
+    ATS_ERROR(ret, "ABT_sched_create_basic");
+    ret = ABT_sched_config_free(&config);
+    ATS_ERROR(ret, "ABT_sched_config_free");
+    ret = ABT_xstream_create(sched, &xstream);
+    ATS_ERROR(ret, "ABT_xstream_create");
+
+    free_threads(&threads[g_num_threads], g_num_threads * (NUM_LEVELS - 1));
+    check_log(g_num_threads * (NUM_LEVELS - 1));
+
+    ret = ABT_xstream_free(&xstream);
+    ATS_ERROR(ret, "ABT_xstream_free");
+    free(threads);
+}
+
+/* The same rules as the topology module of Argobots. */
+static int read_first_int(const char *path)
+{
+    int val;
+    FILE *p_file = fopen(path, "r");
+    if (!p_file)
+        return -1;
+    if (fscanf(p_file, "%d", &val) != 1)
+        val = -1;
+    fclose(p_file);
+    return val;
+}
+
+static void read_topology(int cpuid, int *ids)
+{
+    char path[256];
+    int i;
+    snprintf(path, sizeof(path),
+             "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list",
+             cpuid);
+    ids[0] = read_first_int(path);
+    ids[1] = -1;
+    for (i = 0; i < 8; i++) {
+        snprintf(path, sizeof(path),
+                 "/sys/devices/system/cpu/cpu%d/cache/index%d/level", cpuid, i);
+        if (read_first_int(path) == 3) {
+            snprintf(path, sizeof(path),
+                     "/sys/devices/system/cpu/cpu%d/cache/index%d/"
+                     "shared_cpu_list",
+                     cpuid, i);
+            ids[1] = read_first_int(path);
+            break;
+        }
+    }
+    ids[2] = -1;
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpuid);
+    DIR *p_dir = opendir(path);
+    if (p_dir) {
+        struct dirent *p_entry;
+        while ((p_entry = readdir(p_dir)) != NULL) {
+            if (sscanf(p_entry->d_name, "node%d", &ids[2]) == 1)
+                break;
+        }
+        closedir(p_dir);
+    }
+}
+
+static int get_level(const int *ids1, const int *ids2)
+{
+    int i;
+    for (i = 0; i < NUM_LEVELS - 1; i++) {
+        if (ids1[i] != -1 && ids1[i] == ids2[i])
+            return i;
+    }
+    return NUM_LEVELS - 1;
+}
+
+static void gate_func(void *arg)
+{
+    ATS_UNUSED(arg);
+    /* Block the thief so that it cannot check events. */
+    ATS_atomic_store(&g_gate, 1);
+    while (ATS_atomic_load(&g_gate) == 1)
+        ;
+    /* Let the thief check events without stealing work units. */
+    while (ATS_atomic_load(&g_gate) == 2) {
+        int ret = ABT_thread_yield();
+        ATS_ERROR(ret, "ABT_thread_yield");
+    }
+}
+
+static void blocker_func(void *arg)
+{
+    ATS_UNUSED(arg);
+    /* Block a victim ES so that it does not consume its own pool. */
+    ATS_atomic_fetch_add(&g_num_blocked, 1);
+    while (ATS_atomic_load(&g_release_blockers) == 0)
+        ;
+}
+
+static void test_topology(void)
+{
+    int i, ret, num_cpuids;
+    int *cpuids = (int *)malloc(sizeof(int) * MAX_CPUS);
+    ABT_xstream self_xstream;
+
+    ret = ABT_xstream_self(&self_xstream);
+    ATS_ERROR(ret, "ABT_xstream_self");
+    ret = ABT_xstream_get_affinity(self_xstream, MAX_CPUS, cpuids, &num_cpuids);
+    if (ret != ABT_SUCCESS || num_cpuids <= 0) {
+        /* The CPU affinity is not supported. */
+        free(cpuids);
+        return;
+    }
+    if (num_cpuids > MAX_CPUS)
+        num_cpuids = MAX_CPUS;
+
+    /* Choose one CPU for each level from the CPU of the thief. */
+    int thief_ids[NUM_LEVELS - 1], ids[NUM_LEVELS - 1];
+    int victim_cpuids[NUM_LEVELS], victim_levels[NUM_LEVELS];
+    int num_victims = 0, level;
+    read_topology(cpuids[0], thief_ids);
+    for (level = 0; level < NUM_LEVELS; level++) {
+        for (i = 0; i < num_cpuids; i++) {
+            read_topology(cpuids[i], ids);
+            if (get_level(thief_ids, ids) == level) {
+                victim_cpuids[num_victims] = cpuids[i];
+                victim_levels[num_victims] = level;
+                num_victims++;
+                break;
+            }
+        }
+    }
+    free(cpuids);
+
+    /* The thief uses the reversed list of victims. */
+    ABT_pool thief_pools[NUM_LEVELS + 1], victim_pools[NUM_LEVELS];
+    ABT_pool blocker_pools[NUM_LEVELS];
+    thief_pools[0] = create_pool();
+    for (i = 0; i < num_victims; i++) {
+        victim_pools[i] = create_pool();
+        blocker_pools[i] = create_pool();
+        thief_pools[num_victims - i] = victim_pools[i];
+    }
+
+    /* Start the thief before the ESs of the victim pools are created. */
+    ABT_sched_config config;
+    ABT_sched sched;
+    ABT_xstream thief_xstream, victim_xstreams[NUM_LEVELS];
+    ABT_thread gate, blockers[NUM_LEVELS];
+    ABT_thread *threads =
+        (ABT_thread *)malloc(sizeof(ABT_thread) * g_num_threads * num_victims);
+    ret = ABT_sched_config_create(&config, ABT_sched_randws_victim_hierarchy, 1,
+                                  ABT_sched_config_var_end);
+    ATS_ERROR(ret, "ABT_sched_config_create");
+    ret = ABT_sched_create_basic(ABT_SCHED_RANDWS, num_victims + 1,
+                                 thief_pools, config, &sched);
+    ATS_ERROR(ret, "ABT_sched_create_basic");
+    ret = ABT_sched_config_free(&config);
+    ATS_ERROR(ret, "ABT_sched_config_free");
+    ret = ABT_xstream_create(sched, &thief_xstream);
+    ATS_ERROR(ret, "ABT_xstream_create");
+    ret = ABT_xstream_set_cpubind(thief_xstream, victim_cpuids[0]);
+    ATS_ERROR(ret, "ABT_xstream_set_cpubind");
+    ret = ABT_thread_create(thief_pools[0], gate_func, NULL,
+                            ABT_THREAD_ATTR_NULL, &gate);
+    ATS_ERROR(ret, "ABT_thread_create");
+    while (ATS_atomic_load(&g_gate) == 0) {
+        ret = ABT_thread_yield();
+        ATS_ERROR(ret, "ABT_thread_yield");
+    }
+
+    /* Create the ESs of the victim pools and block them. */
+    for (i = 0; i < num_victims; i++) {
+        ABT_pool pools[2] = { victim_pools[i], blocker_pools[i] };
+        ret = ABT_xstream_create_basic(ABT_SCHED_BASIC, 2, pools,
+                                       ABT_SCHED_CONFIG_NULL,
+                                       &victim_xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_create_basic");
+        ret = ABT_xstream_set_cpubind(victim_xstreams[i], victim_cpuids[i]);
+        ATS_ERROR(ret, "ABT_xstream_set_cpubind");
+        ret = ABT_thread_create(blocker_pools[i], blocker_func, NULL,
+                                ABT_THREAD_ATTR_NULL, &blockers[i]);
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+    while (ATS_atomic_load(&g_num_blocked) != num_victims) {
+        ret = ABT_thread_yield();
+        ATS_ERROR(ret, "ABT_thread_yield");
+    }
+    for (i = 0; i < num_victims; i++) {
+        create_markers(victim_pools[i], victim_levels[i],
+                       &threads[g_num_threads * i]);
+    }
+
+    /* Let the thief locate the victim pools before it steals work units. */
+    ATS_atomic_store(&g_gate, 2);
+    double start_time = ABT_get_wtime();
+    while (ABT_get_wtime() - start_time < RESOLVE_WAIT_SEC) {
+        ret = ABT_thread_yield();
+        ATS_ERROR(ret, "ABT_thread_yield");
+    }
+    ATS_atomic_store(&g_log_index, 0);
+    ATS_atomic_store(&g_gate, 3);
+
+    free_threads(threads, g_num_threads * num_victims);
+    check_log(g_num_threads * num_victims);
+
+    ATS_atomic_store(&g_release_blockers, 1);
+    free_threads(blockers, num_victims);
+    free_threads(&gate, 1);
+    for (i = 0; i < num_victims; i++) {
+        ret = ABT_xstream_free(&victim_xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_free");
+    }
+    ret = ABT_xstream_free(&thief_xstream);
+    ATS_ERROR(ret, "ABT_xstream_free");
+    free(threads);
+}
+
+int main(int argc, char *argv[])
+{
+    int ret;
+
+    ATS_read_args(argc, argv);
+    if (argc > 1) {
+        g_num_threads = ATS_get_arg_val(ATS_ARG_N_ULT);
+    }
+    if (g_num_threads < 1)
+        g_num_threads = 1;
+    g_log = (int *)malloc(sizeof(int) * g_num_threads * NUM_LEVELS);
+
+    ATS_init(argc, argv, 1);
+
+    test_victim_levels();
+    ATS_atomic_store(&g_log_index, 0);
+    test_topology();
+
+    ret = ATS_finalize(0);
+
+    free(g_log);
+    return ret;
+}
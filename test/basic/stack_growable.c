@@ -0,0 +1,233 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 199309L
+
+#include <stdint.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This test runs ULTs that use most of their stacks with ABT_STACK_GROWABLE.
+ * Only the top pages of each stack are accessible at first, so the stacks must
+ * be extended on demand.  Each ES keeps only a few stacks so that stacks are
+ * shrunk when they are returned to the global memory pool and extended again
+ * when they are reused.  It also checks that SIGSEGV that is not caused by a
+ * stack is forwarded to a handler that is installed before ABT_init(). */
+
+#define DEFAULT_NUM_XSTREAMS 3
+#define DEFAULT_NUM_THREADS 40
+#define DEFAULT_NUM_ITER 3
+#define FRAME_SIZE 1024
+#define STACKSIZE (1024 * 1024)
+#define SMALL_STACKSIZE (200 * 1024)
+
+static int g_num_threads = DEFAULT_NUM_THREADS;
+static ABT_thread *g_threads;
+static ABT_thread_attr g_small_attr;
+static size_t g_sys_page_size;
+static volatile char *gp_protected_page = NULL;
+static volatile int g_num_segv = 0;
+
+static void segv_handler(int sig, siginfo_t *si, void *unused)
+{
+    ATS_UNUSED(unused);
+    if (sig != SIGSEGV || si->si_addr != (void *)gp_protected_page) {
+        signal(sig, SIG_DFL);
+        return;
+    }
+    /* Allow the access.  Argobots also calls mprotect() in its handler. */
+    int ret = mprotect((void *)gp_protected_page, g_sys_page_size,
+                       PROT_READ | PROT_WRITE);
+    if (ret != 0)
+        signal(sig, SIG_DFL);
+    g_num_segv++;
+}
+
+static int consume_stack(int depth)
+{
+    volatile char buffer[FRAME_SIZE];
+    int i, sum = 0;
+    for (i = 0; i < FRAME_SIZE; i++)
+        buffer[i] = (char)(i + depth);
+    if (depth > 0)
+        sum = consume_stack(depth - 1);
+    for (i = 0; i < FRAME_SIZE; i++)
+        sum += buffer[i];
+    return sum;
+}
+
+static void thread_func(void *arg)
+{
+    int depth = (int)(intptr_t)arg;
+    int sum1 = consume_stack(depth);
+    int sum2 = consume_stack(depth);
+    assert(sum1 == sum2);
+}
+
+static void create_func(void *arg)
+{
+    int rank = (int)(intptr_t)arg;
+    int i, ret;
+    ABT_pool pool;
+
+    ret = ABT_self_get_last_pool(&pool);
+    ATS_ERROR(ret, "ABT_self_get_last_pool");
+    for (i = 0; i < g_num_threads; i++) {
+        ABT_thread *p_thread = &g_threads[rank * g_num_threads + i];
+        if (i % 2 == 0) {
+            /* Use 1/8 - 6/8 of the default stack. */
+            int depth = STACKSIZE / FRAME_SIZE / 8 * (1 + (i / 2 + rank) % 6);
+            ret = ABT_thread_create(pool, thread_func,
+                                    (void *)(intptr_t)depth,
+                                    ABT_THREAD_ATTR_NULL, p_thread);
+        } else {
+            /* Use 3/4 of a stack of a non-default size. */
+            int depth = SMALL_STACKSIZE / FRAME_SIZE * 3 / 4;
+            ret = ABT_thread_create(pool, thread_func,
+                                    (void *)(intptr_t)depth, g_small_attr,
+                                    p_thread);
+        }
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+    for (i = 0; i < g_num_threads; i++) {
+        ret = ABT_thread_free(&g_threads[rank * g_num_threads + i]);
+        ATS_ERROR(ret, "ABT_thread_free");
+    }
+    if (rank == 0) {
+        /* This SIGSEGV is not caused by a stack. */
+        gp_protected_page[0] = 1;
+        assert(g_num_segv == 1);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    static char env_str1[64], env_str2[64], env_str3[64];
+    int num_xstreams = DEFAULT_NUM_XSTREAMS;
+    int num_iter = DEFAULT_NUM_ITER;
+    ABT_xstream *xstreams;
+    ABT_thread *creators;
+    int i, iter, ret;
+
+    g_sys_page_size = getpagesize();
+    /* Catch SEGV. */
+    struct sigaction sa;
+    sa.sa_flags = SA_SIGINFO;
+    sa.sa_sigaction = segv_handler;
+    sigemptyset(&sa.sa_mask);
+    if (sigaction(SIGSEGV, &sa, NULL) == -1) {
+        /* Unsupported. */
+        return 77;
+    }
+    gp_protected_page =
+        (volatile char *)mmap(NULL, g_sys_page_size, PROT_READ,
+                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if ((void *)gp_protected_page == MAP_FAILED) {
+        /* Unsupported. */
+        return 77;
+    }
+
+    ATS_read_args(argc, argv);
+    if (argc > 1) {
+        num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+        g_num_threads = ATS_get_arg_val(ATS_ARG_N_ULT);
+        num_iter = ATS_get_arg_val(ATS_ARG_N_ITER);
+    }
+    xstreams = (ABT_xstream *)malloc(sizeof(ABT_xstream) * num_xstreams);
+    creators = (ABT_thread *)malloc(sizeof(ABT_thread) * num_xstreams);
+    g_threads =
+        (ABT_thread *)malloc(sizeof(ABT_thread) * num_xstreams * g_num_threads);
+
+    sprintf(env_str1, "ABT_STACK_GROWABLE=1");
+    putenv(env_str1);
+    sprintf(env_str2, "ABT_THREAD_STACKSIZE=%d", STACKSIZE);
+    putenv(env_str2);
+    /* Let each ES keep only a few stacks. */
+    sprintf(env_str3, "ABT_MEM_MAX_NUM_STACKS=4");
+    putenv(env_str3);
+
+    for (iter = 0; iter < num_iter; iter++) {
+        /* Use ATS_init for the last run. */
+        if (iter == num_iter - 1) {
+            ATS_init(argc, argv, num_xstreams);
+        } else {
+            ret = ABT_init(argc, argv);
+            ATS_ERROR(ret, "ABT_init");
+        }
+        ret = ABT_thread_attr_create(&g_small_attr);
+        ATS_ERROR(ret, "ABT_thread_attr_create");
+        ret = ABT_thread_attr_set_stacksize(g_small_attr, SMALL_STACKSIZE);
+        ATS_ERROR(ret, "ABT_thread_attr_set_stacksize");
+
+        ret = ABT_xstream_self(&xstreams[0]);
+        ATS_ERROR(ret, "ABT_xstream_self");
+        for (i = 1; i < num_xstreams; i++) {
+            ret = ABT_xstream_create(ABT_SCHED_NULL, &xstreams[i]);
+            ATS_ERROR(ret, "ABT_xstream_create");
+        }
+        for (i = 0; i < num_xstreams; i++) {
+            ABT_pool pool;
+            ret = ABT_xstream_get_main_pools(xstreams[i], 1, &pool);
+            ATS_ERROR(ret, "ABT_xstream_get_main_pools");
+            ret = ABT_thread_create(pool, create_func, (void *)(intptr_t)i,
+                                    ABT_THREAD_ATTR_NULL, &creators[i]);
+            ATS_ERROR(ret, "ABT_thread_create");
+        }
+        for (i = 0; i < num_xstreams; i++) {
+            ret = ABT_thread_free(&creators[i]);
+            ATS_ERROR(ret, "ABT_thread_free");
+        }
+        /* Protect the page again. */
+        g_num_segv = 0;
+        ret = mprotect((void *)gp_protected_page, g_sys_page_size, PROT_READ);
+        assert(ret == 0);
+
+        /* Join and free ESs */
+        for (i = 1; i < num_xstreams; i++) {
+            ret = ABT_xstream_join(xstreams[i]);
+            ATS_ERROR(ret, "ABT_xstream_join");
+            ret = ABT_xstream_free(&xstreams[i]);
+            ATS_ERROR(ret, "ABT_xstream_free");
+        }
+        ret = ABT_thread_attr_free(&g_small_attr);
+        ATS_ERROR(ret, "ABT_thread_attr_free");
+
+        /* Finalize */
+        if (iter == num_iter - 1) {
+            ret = ATS_finalize(0);
+        } else {
+            ret = ABT_finalize();
+            ATS_ERROR(ret, "ABT_finalize");
+        }
+    }
+    /* The original handler must be restored. */
+    gp_protected_page[0] = 2;
+    assert(g_num_segv == 1);
+
+    unsetenv("ABT_STACK_GROWABLE");
+    unsetenv("ABT_THREAD_STACKSIZE");
+    unsetenv("ABT_MEM_MAX_NUM_STACKS");
+    munmap((void *)gp_protected_page, g_sys_page_size);
+    free(xstreams);
+    free(creators);
+    free(g_threads);
+    return ret;
+}
+
+#else /* _POSIX_C_SOURCE */
+
+int main()
+{
+    /* Unsupported. */
+    return 77;
+}
+
+#endif
@@ -0,0 +1,173 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This test creates tasklets by ABT_task_create_many() and
+ * ABT_task_create_inline().  Each ES creates named and unnamed tasklets in its
+ * own pool and in the pool of the next ES.  The number of tasklets created at
+ * once is larger than the internal buffer of ABT_task_create_many(). */
+
+#define DEFAULT_NUM_XSTREAMS 4
+#define DEFAULT_NUM_TASKS 200
+
+typedef struct {
+    int rank;
+    int index;
+    char padding[ABT_TASK_INLINE_ARG_SIZE - 2 * sizeof(int)];
+} inline_arg_t;
+
+static int g_num_xstreams = DEFAULT_NUM_XSTREAMS;
+static int g_num_tasks = DEFAULT_NUM_TASKS;
+static ABT_pool *g_pools;
+static int *g_counters;
+static volatile int g_num_unnamed = 0;
+
+static void task_func(void *arg)
+{
+    int *p_counter = (int *)arg;
+    (*p_counter)++;
+}
+
+static void unnamed_task_func(void *arg)
+{
+    assert(arg == NULL);
+    ATS_atomic_fetch_add(&g_num_unnamed, 1);
+}
+
+static void inline_task_func(void *arg)
+{
+    inline_arg_t *p_arg = (inline_arg_t *)arg;
+    int i;
+    /* The argument must be aligned. */
+    assert(((uintptr_t)arg) % 16 == 0);
+    for (i = 0; i < (int)sizeof(p_arg->padding); i++)
+        assert(p_arg->padding[i] == (char)(p_arg->index + i));
+    int *p_counter = &g_counters[p_arg->rank * g_num_tasks + p_arg->index];
+    (*p_counter)++;
+}
+
+static void create_func(void *arg)
+{
+    int rank = (int)(intptr_t)arg;
+    int i, ret;
+    ABT_pool pool = g_pools[(rank + 1) % g_num_xstreams];
+    ABT_task *tasks = (ABT_task *)malloc(sizeof(ABT_task) * g_num_tasks);
+    void **args = (void **)malloc(sizeof(void *) * g_num_tasks);
+    int *counters = &g_counters[rank * g_num_tasks];
+
+    /* Named tasklets. */
+    for (i = 0; i < g_num_tasks; i++)
+        args[i] = (void *)&counters[i];
+    ret = ABT_task_create_many(g_num_tasks, pool, task_func, args, tasks);
+    ATS_ERROR(ret, "ABT_task_create_many");
+    for (i = 0; i < g_num_tasks; i++) {
+        ret = ABT_task_free(&tasks[i]);
+        ATS_ERROR(ret, "ABT_task_free");
+        assert(counters[i] == 1);
+    }
+
+    /* Unnamed tasklets. */
+    ret = ABT_task_create_many(g_num_tasks / 2, g_pools[rank],
+                               unnamed_task_func, NULL, NULL);
+    ATS_ERROR(ret, "ABT_task_create_many");
+    ret = ABT_task_create_many(0, pool, unnamed_task_func, NULL, NULL);
+    ATS_ERROR(ret, "ABT_task_create_many");
+
+    /* Tasklets with inline arguments. */
+    for (i = 0; i < g_num_tasks; i++) {
+        inline_arg_t inline_arg;
+        int j;
+        inline_arg.rank = rank;
+        inline_arg.index = i;
+        for (j = 0; j < (int)sizeof(inline_arg.padding); j++)
+            inline_arg.padding[j] = (char)(i + j);
+        ret = ABT_task_create_inline(pool, inline_task_func, &inline_arg,
+                                     sizeof(inline_arg), &tasks[i]);
+        ATS_ERROR(ret, "ABT_task_create_inline");
+        /* The argument has been copied. */
+        memset(&inline_arg, 0, sizeof(inline_arg));
+    }
+    for (i = 0; i < g_num_tasks; i++) {
+        ret = ABT_task_free(&tasks[i]);
+        ATS_ERROR(ret, "ABT_task_free");
+        assert(counters[i] == 2);
+    }
+
+    /* A too large argument must be rejected. */
+    char large_arg[ABT_TASK_INLINE_ARG_SIZE + 1];
+    memset(large_arg, 0, sizeof(large_arg));
+    ret = ABT_task_create_inline(pool, inline_task_func, large_arg,
+                                 sizeof(large_arg), NULL);
+    assert(ret == ABT_ERR_INV_ARG);
+
+    free(tasks);
+    free(args);
+}
+
+int main(int argc, char *argv[])
+{
+    ABT_xstream *xstreams;
+    ABT_thread *creators;
+    int i, ret;
+
+    ATS_read_args(argc, argv);
+    if (argc > 1) {
+        g_num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+        g_num_tasks = ATS_get_arg_val(ATS_ARG_N_TASK);
+    }
+    xstreams = (ABT_xstream *)malloc(sizeof(ABT_xstream) * g_num_xstreams);
+    creators = (ABT_thread *)malloc(sizeof(ABT_thread) * g_num_xstreams);
+    g_pools = (ABT_pool *)malloc(sizeof(ABT_pool) * g_num_xstreams);
+    g_counters = (int *)calloc(g_num_xstreams * g_num_tasks, sizeof(int));
+
+    ATS_init(argc, argv, g_num_xstreams);
+
+    ret = ABT_xstream_self(&xstreams[0]);
+    ATS_ERROR(ret, "ABT_xstream_self");
+    for (i = 1; i < g_num_xstreams; i++) {
+        ret = ABT_xstream_create(ABT_SCHED_NULL, &xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_create");
+    }
+    for (i = 0; i < g_num_xstreams; i++) {
+        ret = ABT_xstream_get_main_pools(xstreams[i], 1, &g_pools[i]);
+        ATS_ERROR(ret, "ABT_xstream_get_main_pools");
+    }
+    for (i = 0; i < g_num_xstreams; i++) {
+        ret = ABT_thread_create(g_pools[i], create_func, (void *)(intptr_t)i,
+                                ABT_THREAD_ATTR_NULL, &creators[i]);
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+    for (i = 0; i < g_num_xstreams; i++) {
+        ret = ABT_thread_free(&creators[i]);
+        ATS_ERROR(ret, "ABT_thread_free");
+    }
+
+    /* Join and free ESs.  Unnamed tasklets must have been executed. */
+    for (i = 1; i < g_num_xstreams; i++) {
+        ret = ABT_xstream_join(xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_join");
+        ret = ABT_xstream_free(&xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_free");
+    }
+    while (ATS_atomic_load(&g_num_unnamed) != g_num_xstreams *
+                                                  (g_num_tasks / 2)) {
+        ret = ABT_thread_yield();
+        ATS_ERROR(ret, "ABT_thread_yield");
+    }
+
+    ret = ATS_finalize(0);
+
+    free(xstreams);
+    free(creators);
+    free(g_pools);
+    free(g_counters);
+    return ret;
+}
@@ -0,0 +1,223 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This test creates ULTs with ABT_thread_attr_set_lazy_stack().  Some of them
+ * run to completion while others are blocked on ABT_mutex or ABT_eventual or
+ * yield, so ULTs that have their own stacks and ULTs that borrow stacks from
+ * ESs run at the same time. */
+
+#define DEFAULT_NUM_XSTREAMS 4
+#define DEFAULT_NUM_THREADS 200
+#define BUFFER_SIZE 1024
+
+static int g_num_xstreams = DEFAULT_NUM_XSTREAMS;
+static int g_num_threads = DEFAULT_NUM_THREADS;
+static ABT_pool *g_pools;
+static ABT_thread_attr g_attr;
+static ABT_mutex g_mutex;
+static ABT_eventual g_eventual;
+static int g_mutex_counter = 0;
+static volatile int g_num_unnamed = 0;
+
+typedef struct {
+    int index;
+    int ret;
+} thread_arg_t;
+
+/* Use the stack to check that it is not shared with other running ULTs. */
+static int fill_buffer(int index)
+{
+    volatile char buffer[BUFFER_SIZE];
+    int i, sum = 0;
+    for (i = 0; i < BUFFER_SIZE; i++)
+        buffer[i] = (char)(index + i);
+    for (i = 0; i < BUFFER_SIZE; i++)
+        sum += buffer[i];
+    return sum;
+}
+
+static void thread_func(void *arg)
+{
+    thread_arg_t *p_arg = (thread_arg_t *)arg;
+    int ret, index = p_arg->index;
+    volatile char buffer[BUFFER_SIZE];
+    int i, sum = 0;
+
+    for (i = 0; i < BUFFER_SIZE; i++)
+        buffer[i] = (char)(index * 3 + i);
+    switch (index % 4) {
+        case 0:
+            /* Run to completion. */
+            break;
+        case 1:
+            /* Block on a mutex. */
+            ret = ABT_mutex_lock(g_mutex);
+            ATS_ERROR(ret, "ABT_mutex_lock");
+            g_mutex_counter++;
+            ret = ABT_thread_yield();
+            ATS_ERROR(ret, "ABT_thread_yield");
+            ret = ABT_mutex_unlock(g_mutex);
+            ATS_ERROR(ret, "ABT_mutex_unlock");
+            break;
+        case 2:
+            /* Block on an eventual. */
+            ret = ABT_eventual_wait(g_eventual, NULL);
+            ATS_ERROR(ret, "ABT_eventual_wait");
+            break;
+        case 3:
+            /* Yield. */
+            ret = ABT_thread_yield();
+            ATS_ERROR(ret, "ABT_thread_yield");
+            break;
+    }
+    /* The stack must be preserved across suspension. */
+    for (i = 0; i < BUFFER_SIZE; i++) {
+        assert(buffer[i] == (char)(index * 3 + i));
+        sum += buffer[i];
+    }
+    p_arg->ret = sum + fill_buffer(index);
+}
+
+static int expected_ret(int index)
+{
+    int i, sum = 0;
+    for (i = 0; i < BUFFER_SIZE; i++)
+        sum += (char)(index * 3 + i);
+    return sum + fill_buffer(index);
+}
+
+static void unnamed_func(void *arg)
+{
+    assert(arg == NULL);
+    fill_buffer(0);
+    ATS_atomic_fetch_add(&g_num_unnamed, 1);
+}
+
+static void create_func(void *arg)
+{
+    int rank = (int)(intptr_t)arg;
+    int i, ret;
+    ABT_thread *threads =
+        (ABT_thread *)malloc(sizeof(ABT_thread) * g_num_threads);
+    thread_arg_t *args =
+        (thread_arg_t *)malloc(sizeof(thread_arg_t) * g_num_threads);
+
+    for (i = 0; i < g_num_threads; i++) {
+        ABT_pool pool = g_pools[(rank + i) % g_num_xstreams];
+        args[i].index = i;
+        args[i].ret = 0;
+        ret = ABT_thread_create(pool, thread_func, &args[i], g_attr,
+                                &threads[i]);
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+    ret = ABT_thread_create(g_pools[rank], unnamed_func, NULL, g_attr, NULL);
+    ATS_ERROR(ret, "ABT_thread_create");
+
+    /* Run ULTs that do not wait for the eventual first. */
+    for (i = 0; i < g_num_threads; i++) {
+        if (i % 4 != 2) {
+            ret = ABT_thread_free(&threads[i]);
+            ATS_ERROR(ret, "ABT_thread_free");
+            assert(args[i].ret == expected_ret(i));
+        }
+    }
+    for (i = 0; i < g_num_threads; i++) {
+        if (i % 4 == 2) {
+            ret = ABT_thread_free(&threads[i]);
+            ATS_ERROR(ret, "ABT_thread_free");
+            assert(args[i].ret == expected_ret(i));
+        }
+    }
+    free(threads);
+    free(args);
+}
+
+int main(int argc, char *argv[])
+{
+    ABT_xstream *xstreams;
+    ABT_thread *creators;
+    int i, ret;
+
+    ATS_read_args(argc, argv);
+    if (argc > 1) {
+        g_num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+        g_num_threads = ATS_get_arg_val(ATS_ARG_N_ULT);
+    }
+    xstreams = (ABT_xstream *)malloc(sizeof(ABT_xstream) * g_num_xstreams);
+    creators = (ABT_thread *)malloc(sizeof(ABT_thread) * g_num_xstreams);
+    g_pools = (ABT_pool *)malloc(sizeof(ABT_pool) * g_num_xstreams);
+
+    ATS_init(argc, argv, g_num_xstreams);
+
+    ret = ABT_thread_attr_create(&g_attr);
+    ATS_ERROR(ret, "ABT_thread_attr_create");
+    ret = ABT_thread_attr_set_lazy_stack(g_attr, ABT_TRUE);
+    ATS_ERROR(ret, "ABT_thread_attr_set_lazy_stack");
+    ret = ABT_mutex_create(&g_mutex);
+    ATS_ERROR(ret, "ABT_mutex_create");
+    ret = ABT_eventual_create(0, &g_eventual);
+    ATS_ERROR(ret, "ABT_eventual_create");
+
+    ret = ABT_xstream_self(&xstreams[0]);
+    ATS_ERROR(ret, "ABT_xstream_self");
+    for (i = 1; i < g_num_xstreams; i++) {
+        ret = ABT_xstream_create(ABT_SCHED_NULL, &xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_create");
+    }
+    for (i = 0; i < g_num_xstreams; i++) {
+        ret = ABT_xstream_get_main_pools(xstreams[i], 1, &g_pools[i]);
+        ATS_ERROR(ret, "ABT_xstream_get_main_pools");
+    }
+    for (i = 0; i < g_num_xstreams; i++) {
+        ret = ABT_thread_create(g_pools[i], create_func, (void *)(intptr_t)i,
+                                ABT_THREAD_ATTR_NULL, &creators[i]);
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+
+    /* Let ULTs be blocked on the eventual before it is set. */
+    for (i = 0; i < 10; i++) {
+        ret = ABT_thread_yield();
+        ATS_ERROR(ret, "ABT_thread_yield");
+    }
+    ret = ABT_eventual_set(g_eventual, NULL, 0);
+    ATS_ERROR(ret, "ABT_eventual_set");
+
+    for (i = 0; i < g_num_xstreams; i++) {
+        ret = ABT_thread_free(&creators[i]);
+        ATS_ERROR(ret, "ABT_thread_free");
+    }
+    for (i = 1; i < g_num_xstreams; i++) {
+        ret = ABT_xstream_join(xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_join");
+        ret = ABT_xstream_free(&xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_free");
+    }
+    while (ATS_atomic_load(&g_num_unnamed) != g_num_xstreams) {
+        ret = ABT_thread_yield();
+        ATS_ERROR(ret, "ABT_thread_yield");
+    }
+    assert(g_mutex_counter == g_num_xstreams * ((g_num_threads + 2) / 4));
+
+    ret = ABT_eventual_free(&g_eventual);
+    ATS_ERROR(ret, "ABT_eventual_free");
+    ret = ABT_mutex_free(&g_mutex);
+    ATS_ERROR(ret, "ABT_mutex_free");
+    ret = ABT_thread_attr_free(&g_attr);
+    ATS_ERROR(ret, "ABT_thread_attr_free");
+
+    ret = ATS_finalize(0);
+
+    free(xstreams);
+    free(creators);
+    free(g_pools);
+    return ret;
+}
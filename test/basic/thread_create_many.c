@@ -0,0 +1,184 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This test creates ULTs by ABT_thread_create_many() and joins and frees them
+ * by ABT_thread_join_many() and ABT_thread_free_many().  ULTs created at once
+ * are associated with different pools, and the number of ULTs created at once
+ * is larger than the internal buffer of ABT_thread_create_many(). */
+
+#define DEFAULT_NUM_XSTREAMS 4
+#define DEFAULT_NUM_THREADS 200
+
+static int g_num_xstreams = DEFAULT_NUM_XSTREAMS;
+static int g_num_threads = DEFAULT_NUM_THREADS;
+static ABT_pool *g_pools;
+static int *g_counters;
+static volatile int g_num_unnamed = 0;
+
+static void thread_func(void *arg)
+{
+    int *p_counter = (int *)arg;
+    int ret = ABT_thread_yield();
+    ATS_ERROR(ret, "ABT_thread_yield");
+    (*p_counter)++;
+}
+
+static void thread_func2(void *arg)
+{
+    int *p_counter = (int *)arg;
+    (*p_counter) += 2;
+}
+
+static void unnamed_func(void *arg)
+{
+    assert(arg == NULL);
+    ATS_atomic_fetch_add(&g_num_unnamed, 1);
+}
+
+static void create_func(void *arg)
+{
+    int rank = (int)(intptr_t)arg;
+    int i, ret, attr_kind;
+    int num_threads = g_num_threads;
+    ABT_thread *threads = (ABT_thread *)malloc(sizeof(ABT_thread) * num_threads);
+    ABT_pool *pools = (ABT_pool *)malloc(sizeof(ABT_pool) * num_threads);
+    void (**funcs)(void *) =
+        (void (**)(void *))malloc(sizeof(void (*)(void *)) * num_threads);
+    void **args = (void **)malloc(sizeof(void *) * num_threads);
+    int *counters = &g_counters[rank * num_threads];
+
+    for (i = 0; i < num_threads; i++) {
+        /* Interleave pools so that ULTs of the same pool are not adjacent. */
+        pools[i] = g_pools[(rank + i) % g_num_xstreams];
+        funcs[i] = (i % 3 == 0) ? thread_func2 : thread_func;
+        args[i] = (void *)&counters[i];
+    }
+
+    for (attr_kind = 0; attr_kind < 3; attr_kind++) {
+        ABT_thread_attr attr = ABT_THREAD_ATTR_NULL;
+        if (attr_kind == 1) {
+            /* A stack of a non-default size. */
+            ret = ABT_thread_attr_create(&attr);
+            ATS_ERROR(ret, "ABT_thread_attr_create");
+            ret = ABT_thread_attr_set_stacksize(attr, 32768);
+            ATS_ERROR(ret, "ABT_thread_attr_set_stacksize");
+        } else if (attr_kind == 2) {
+            /* A lazily allocated stack. */
+            ret = ABT_thread_attr_create(&attr);
+            ATS_ERROR(ret, "ABT_thread_attr_create");
+            ret = ABT_thread_attr_set_lazy_stack(attr, ABT_TRUE);
+            ATS_ERROR(ret, "ABT_thread_attr_set_lazy_stack");
+        }
+        for (i = 0; i < num_threads; i++)
+            counters[i] = 0;
+
+        /* Named ULTs. */
+        ret = ABT_thread_create_many(num_threads, pools, funcs, args, attr,
+                                     threads);
+        ATS_ERROR(ret, "ABT_thread_create_many");
+        /* Include ABT_THREAD_NULL, which must be ignored. */
+        ABT_thread tmp = threads[num_threads / 2];
+        threads[num_threads / 2] = ABT_THREAD_NULL;
+        ret = ABT_thread_join_many(num_threads, threads);
+        ATS_ERROR(ret, "ABT_thread_join_many");
+        threads[num_threads / 2] = tmp;
+        ret = ABT_thread_free_many(num_threads, threads);
+        ATS_ERROR(ret, "ABT_thread_free_many");
+        for (i = 0; i < num_threads; i++) {
+            assert(threads[i] == ABT_THREAD_NULL);
+            assert(counters[i] == ((i % 3 == 0) ? 2 : 1));
+        }
+
+        /* Unnamed ULTs. */
+        for (i = 0; i < num_threads; i++)
+            funcs[i] = unnamed_func;
+        ret = ABT_thread_create_many(num_threads, pools, funcs, NULL, attr,
+                                     NULL);
+        ATS_ERROR(ret, "ABT_thread_create_many");
+        for (i = 0; i < num_threads; i++)
+            funcs[i] = (i % 3 == 0) ? thread_func2 : thread_func;
+
+        if (attr != ABT_THREAD_ATTR_NULL) {
+            ret = ABT_thread_attr_free(&attr);
+            ATS_ERROR(ret, "ABT_thread_attr_free");
+        }
+    }
+
+    /* Zero ULTs. */
+    ret = ABT_thread_create_many(0, pools, funcs, args, ABT_THREAD_ATTR_NULL,
+                                 threads);
+    ATS_ERROR(ret, "ABT_thread_create_many");
+    ret = ABT_thread_free_many(0, threads);
+    ATS_ERROR(ret, "ABT_thread_free_many");
+
+    free(threads);
+    free(pools);
+    free(funcs);
+    free(args);
+}
+
+int main(int argc, char *argv[])
+{
+    ABT_xstream *xstreams;
+    ABT_thread *creators;
+    int i, ret;
+
+    ATS_read_args(argc, argv);
+    if (argc > 1) {
+        g_num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+        g_num_threads = ATS_get_arg_val(ATS_ARG_N_ULT);
+    }
+    xstreams = (ABT_xstream *)malloc(sizeof(ABT_xstream) * g_num_xstreams);
+    creators = (ABT_thread *)malloc(sizeof(ABT_thread) * g_num_xstreams);
+    g_pools = (ABT_pool *)malloc(sizeof(ABT_pool) * g_num_xstreams);
+    g_counters = (int *)calloc(g_num_xstreams * g_num_threads, sizeof(int));
+
+    ATS_init(argc, argv, g_num_xstreams);
+
+    ret = ABT_xstream_self(&xstreams[0]);
+    ATS_ERROR(ret, "ABT_xstream_self");
+    for (i = 1; i < g_num_xstreams; i++) {
+        ret = ABT_xstream_create(ABT_SCHED_NULL, &xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_create");
+    }
+    for (i = 0; i < g_num_xstreams; i++) {
+        ret = ABT_xstream_get_main_pools(xstreams[i], 1, &g_pools[i]);
+        ATS_ERROR(ret, "ABT_xstream_get_main_pools");
+    }
+    for (i = 0; i < g_num_xstreams; i++) {
+        ret = ABT_thread_create(g_pools[i], create_func, (void *)(intptr_t)i,
+                                ABT_THREAD_ATTR_NULL, &creators[i]);
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+    ret = ABT_thread_free_many(g_num_xstreams, creators);
+    ATS_ERROR(ret, "ABT_thread_free_many");
+
+    /* Join and free ESs.  Unnamed ULTs must have been executed. */
+    for (i = 1; i < g_num_xstreams; i++) {
+        ret = ABT_xstream_join(xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_join");
+        ret = ABT_xstream_free(&xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_free");
+    }
+    while (ATS_atomic_load(&g_num_unnamed) !=
+           g_num_xstreams * g_num_threads * 3) {
+        ret = ABT_thread_yield();
+        ATS_ERROR(ret, "ABT_thread_yield");
+    }
+
+    ret = ATS_finalize(0);
+
+    free(xstreams);
+    free(creators);
+    free(g_pools);
+    free(g_counters);
+    return ret;
+}
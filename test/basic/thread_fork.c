@@ -0,0 +1,198 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This test forks ULTs by ABT_thread_fork().  A forked ULT is executed either
+ * by a scheduler or in place by its joiner.  Fibonacci numbers are calculated
+ * by recursive forks so that some ULTs are stolen by other ESs. */
+
+#define DEFAULT_NUM_XSTREAMS 4
+#define DEFAULT_NUM_ITER 20
+#define FIB_N 15
+
+typedef struct {
+    int n;
+    int ret;
+} fib_arg_t;
+
+static int g_num_xstreams = DEFAULT_NUM_XSTREAMS;
+static int g_num_iter = DEFAULT_NUM_ITER;
+static ABT_pool *g_pools;
+static volatile int g_num_unnamed = 0;
+
+static void fib_func(void *arg)
+{
+    fib_arg_t *p_arg = (fib_arg_t *)arg;
+    if (p_arg->n <= 1) {
+        p_arg->ret = 1;
+    } else {
+        int ret, rank;
+        fib_arg_t child1_arg = { p_arg->n - 1, 0 };
+        fib_arg_t child2_arg = { p_arg->n - 2, 0 };
+        ABT_thread child1;
+        ret = ABT_xstream_self_rank(&rank);
+        ATS_ERROR(ret, "ABT_xstream_self_rank");
+        ret = ABT_thread_fork(g_pools[rank], fib_func, &child1_arg, &child1);
+        ATS_ERROR(ret, "ABT_thread_fork");
+        fib_func(&child2_arg);
+        ret = ABT_thread_free(&child1);
+        ATS_ERROR(ret, "ABT_thread_free");
+        p_arg->ret = child1_arg.ret + child2_arg.ret;
+    }
+}
+
+static int fib_seq(int n)
+{
+    return n <= 1 ? 1 : fib_seq(n - 1) + fib_seq(n - 2);
+}
+
+static void self_func(void *arg)
+{
+    ABT_thread self;
+    int ret = ABT_self_get_thread(&self);
+    ATS_ERROR(ret, "ABT_self_get_thread");
+    *(ABT_thread *)arg = self;
+}
+
+static void unnamed_func(void *arg)
+{
+    assert(arg == NULL);
+    ATS_atomic_fetch_add(&g_num_unnamed, 1);
+}
+
+static void forker_func(void *arg)
+{
+    int ret, i;
+    ABT_thread self, thread, executor;
+    ABT_thread_state state;
+    ABT_pool pool = g_pools[(int)(intptr_t)arg];
+
+    ret = ABT_self_get_thread(&self);
+    ATS_ERROR(ret, "ABT_self_get_thread");
+
+    for (i = 0; i < g_num_iter; i++) {
+        /* Join a forked ULT immediately.  It has not been pushed to a pool, so
+         * this ULT executes it. */
+        executor = ABT_THREAD_NULL;
+        ret = ABT_thread_fork(pool, self_func, &executor, &thread);
+        ATS_ERROR(ret, "ABT_thread_fork");
+        ret = ABT_thread_join(thread);
+        ATS_ERROR(ret, "ABT_thread_join");
+        ret = ABT_thread_get_state(thread, &state);
+        ATS_ERROR(ret, "ABT_thread_get_state");
+        assert(state == ABT_THREAD_STATE_TERMINATED);
+        ABT_bool is_self, is_thread;
+        ret = ABT_thread_equal(executor, self, &is_self);
+        ATS_ERROR(ret, "ABT_thread_equal");
+        ret = ABT_thread_equal(executor, thread, &is_thread);
+        ATS_ERROR(ret, "ABT_thread_equal");
+        assert(is_self && !is_thread);
+        ret = ABT_thread_free(&thread);
+        ATS_ERROR(ret, "ABT_thread_free");
+        assert(thread == ABT_THREAD_NULL);
+
+        /* Fork another ULT before joining a forked ULT.  The first one is
+         * pushed to a pool, so it is executed by either this ULT or a
+         * scheduler. */
+        ABT_thread thread2, executor2 = ABT_THREAD_NULL;
+        executor = ABT_THREAD_NULL;
+        ret = ABT_thread_fork(pool, self_func, &executor, &thread);
+        ATS_ERROR(ret, "ABT_thread_fork");
+        ret = ABT_thread_fork(pool, self_func, &executor2, &thread2);
+        ATS_ERROR(ret, "ABT_thread_fork");
+        ret = ABT_thread_free(&thread);
+        ATS_ERROR(ret, "ABT_thread_free");
+        ret = ABT_thread_free(&thread2);
+        ATS_ERROR(ret, "ABT_thread_free");
+        assert(executor != ABT_THREAD_NULL && executor2 != ABT_THREAD_NULL);
+
+        /* Yield before freeing a forked ULT so that a scheduler can run it. */
+        executor = ABT_THREAD_NULL;
+        ret = ABT_thread_fork(pool, self_func, &executor, &thread);
+        ATS_ERROR(ret, "ABT_thread_fork");
+        ret = ABT_thread_yield();
+        ATS_ERROR(ret, "ABT_thread_yield");
+        ret = ABT_thread_free(&thread);
+        ATS_ERROR(ret, "ABT_thread_free");
+        assert(executor != ABT_THREAD_NULL);
+
+        /* Unnamed ULTs. */
+        ret = ABT_thread_fork(pool, unnamed_func, NULL, NULL);
+        ATS_ERROR(ret, "ABT_thread_fork");
+
+        /* Recursive forks. */
+        fib_arg_t fib_arg = { FIB_N, 0 };
+        fib_func(&fib_arg);
+        assert(fib_arg.ret == fib_seq(FIB_N));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    ABT_xstream *xstreams;
+    ABT_thread *forkers;
+    int i, ret;
+
+    ATS_read_args(argc, argv);
+    if (argc > 1) {
+        g_num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+        g_num_iter = ATS_get_arg_val(ATS_ARG_N_ITER);
+    }
+    xstreams = (ABT_xstream *)malloc(sizeof(ABT_xstream) * g_num_xstreams);
+    forkers = (ABT_thread *)malloc(sizeof(ABT_thread) * g_num_xstreams);
+    g_pools = (ABT_pool *)malloc(sizeof(ABT_pool) * g_num_xstreams);
+
+    ATS_init(argc, argv, g_num_xstreams);
+
+    ret = ABT_xstream_self(&xstreams[0]);
+    ATS_ERROR(ret, "ABT_xstream_self");
+    for (i = 1; i < g_num_xstreams; i++) {
+        ret = ABT_xstream_create(ABT_SCHED_NULL, &xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_create");
+    }
+    for (i = 0; i < g_num_xstreams; i++) {
+        ret = ABT_xstream_get_main_pools(xstreams[i], 1, &g_pools[i]);
+        ATS_ERROR(ret, "ABT_xstream_get_main_pools");
+    }
+
+    /* Each forker forks ULTs to the pool of the next ES. */
+    for (i = 0; i < g_num_xstreams; i++) {
+        ret = ABT_thread_create(g_pools[i], forker_func,
+                                (void *)(intptr_t)((i + 1) % g_num_xstreams),
+                                ABT_THREAD_ATTR_NULL, &forkers[i]);
+        ATS_ERROR(ret, "ABT_thread_create");
+    }
+    /* The primary ULT also forks ULTs. */
+    fib_arg_t fib_arg = { FIB_N, 0 };
+    fib_func(&fib_arg);
+    assert(fib_arg.ret == fib_seq(FIB_N));
+    for (i = 0; i < g_num_xstreams; i++) {
+        ret = ABT_thread_free(&forkers[i]);
+        ATS_ERROR(ret, "ABT_thread_free");
+    }
+
+    for (i = 1; i < g_num_xstreams; i++) {
+        ret = ABT_xstream_join(xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_join");
+        ret = ABT_xstream_free(&xstreams[i]);
+        ATS_ERROR(ret, "ABT_xstream_free");
+    }
+    while (ATS_atomic_load(&g_num_unnamed) != g_num_xstreams * g_num_iter) {
+        ret = ABT_thread_yield();
+        ATS_ERROR(ret, "ABT_thread_yield");
+    }
+
+    ret = ATS_finalize(0);
+
+    free(xstreams);
+    free(forkers);
+    free(g_pools);
+    return ret;
+}
@@ -0,0 +1,267 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This benchmark measures the throughput of push/pop operations of a shared
+ * pool that is accessed by a varying number of ESs. */
+
+#define BATCH_SIZE 8
+
+enum {
+    T_PUSH_POP = 0,
+    T_PUSH_POP_MANY,
+    T_LAST
+};
+static char *t_names[] = {
+    "push/pop",
+    "push_many/pop_many",
+};
+
+typedef struct {
+    ABT_pool_kind kind;
+    const char *name;
+} pool_kind_t;
+static const pool_kind_t pool_kinds[] = {
+    { ABT_POOL_FIFO, "FIFO" },
+    { ABT_POOL_FIFO_LOCKFREE, "FIFO_LOCKFREE" },
+};
+#define NUM_POOL_KINDS ((int)(sizeof(pool_kinds) / sizeof(pool_kinds[0])))
+
+typedef struct {
+    int eid; /* ES id */
+    int test_kind;
+} arg_t;
+
+static int iter;
+static int num_xstreams;
+static int num_threads;
+
+static ABT_barrier g_barrier = ABT_BARRIER_NULL;
+static ABT_pool g_pool = ABT_POOL_NULL;
+
+static double t_overhead = 0.0;
+static double t_time_per_op = 0.0;
+
+static void thread_func(void *arg)
+{
+    ATS_UNUSED(arg);
+}
+
+static void pop_thread(ABT_thread *p_thread)
+{
+    /* Pop may fail if other ESs hold work units. */
+    do {
+        ABT_pool_pop_thread(g_pool, p_thread);
+    } while (*p_thread == ABT_THREAD_NULL);
+}
+
+static void pop_threads(ABT_thread *threads, size_t len)
+{
+    size_t num_popped = 0;
+    while (num_popped < len) {
+        size_t n;
+        ABT_pool_pop_threads(g_pool, &threads[num_popped], len - num_popped,
+                             &n);
+        num_popped += n;
+    }
+}
+
+void pool_push_pop(void *arg)
+{
+    arg_t *my_arg = (arg_t *)arg;
+    int eid = my_arg->eid;
+    int test_kind = my_arg->test_kind;
+
+    ABT_timer timer;
+    double t_time;
+    ABT_thread threads[BATCH_SIZE];
+    int i;
+
+    if (eid == 0) {
+        ABT_timer_create(&timer);
+    }
+
+    /* barrier */
+    ABT_barrier_wait(g_barrier);
+
+    /* start timer */
+    if (eid == 0)
+        ABT_timer_start(timer);
+
+    if (test_kind == T_PUSH_POP) {
+        for (i = 0; i < iter; i++) {
+            pop_thread(&threads[0]);
+            ABT_pool_push_thread(g_pool, threads[0]);
+        }
+    } else {
+        for (i = 0; i < iter; i++) {
+            pop_threads(threads, BATCH_SIZE);
+            ABT_pool_push_threads(g_pool, threads, BATCH_SIZE);
+        }
+    }
+
+    /* barrier */
+    ABT_barrier_wait(g_barrier);
+
+    /* stop timer */
+    if (eid == 0) {
+        ABT_timer_stop_and_read(timer, &t_time);
+        if (test_kind == T_PUSH_POP) {
+            t_time_per_op = (t_time - t_overhead) / iter;
+        } else {
+            t_time_per_op = (t_time - t_overhead) / (iter * BATCH_SIZE);
+        }
+        ABT_timer_free(&timer);
+    }
+}
+
+static double run_test(ABT_pool *pools, int num_active_xstreams, int test_kind)
+{
+    ABT_thread *threads;
+    arg_t *args;
+    int i;
+
+    threads = (ABT_thread *)malloc(num_active_xstreams * sizeof(ABT_thread));
+    args = (arg_t *)malloc(num_active_xstreams * sizeof(arg_t));
+    ABT_barrier_create(num_active_xstreams, &g_barrier);
+
+    for (i = 1; i < num_active_xstreams; i++) {
+        args[i].eid = i;
+        args[i].test_kind = test_kind;
+        ABT_thread_create(pools[i], pool_push_pop, (void *)&args[i],
+                          ABT_THREAD_ATTR_NULL, &threads[i]);
+    }
+    args[0].eid = 0;
+    args[0].test_kind = test_kind;
+    pool_push_pop((void *)&args[0]);
+
+    for (i = 1; i < num_active_xstreams; i++) {
+        ABT_thread_free(&threads[i]);
+    }
+    ABT_barrier_free(&g_barrier);
+    free(threads);
+    free(args);
+    return t_time_per_op;
+}
+
+int main(int argc, char *argv[])
+{
+    ABT_xstream *xstreams;
+    ABT_pool *pools;
+    ABT_thread *threads;
+    ABT_timer timer;
+    double *t_timers;
+    int i, j, k, num_configs;
+
+    /* read command-line arguments */
+    ATS_read_args(argc, argv);
+    num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+    num_threads = ATS_get_arg_val(ATS_ARG_N_ULT);
+    iter = ATS_get_arg_val(ATS_ARG_N_ITER);
+
+    /* initialize */
+    ATS_init(argc, argv, num_xstreams);
+
+    /* create a timer */
+    ABT_timer_create(&timer);
+    ABT_timer_start(timer);
+    ABT_timer_stop(timer);
+    ABT_timer_get_overhead(&t_overhead);
+    ABT_timer_free(&timer);
+
+    /* # of ESs: 1, 2, 4, ..., num_xstreams */
+    int *num_active_xstreams = (int *)malloc(num_xstreams * sizeof(int));
+    num_configs = 0;
+    for (i = 1; i < num_xstreams; i *= 2)
+        num_active_xstreams[num_configs++] = i;
+    num_active_xstreams[num_configs++] = num_xstreams;
+
+    t_timers =
+        (double *)malloc(NUM_POOL_KINDS * num_configs * T_LAST * sizeof(double));
+    xstreams = (ABT_xstream *)malloc(num_xstreams * sizeof(ABT_xstream));
+    pools = (ABT_pool *)malloc(num_xstreams * sizeof(ABT_pool));
+
+    ABT_xstream_self(&xstreams[0]);
+    for (i = 1; i < num_xstreams; i++) {
+        ABT_xstream_create(ABT_SCHED_NULL, &xstreams[i]);
+    }
+    for (i = 0; i < num_xstreams; i++) {
+        ABT_xstream_get_main_pools(xstreams[i], 1, &pools[i]);
+    }
+
+    /* Work units in the shared pool are never scheduled since the pool is not
+     * associated with any scheduler. */
+    const int num_total_threads = num_xstreams * (num_threads + BATCH_SIZE);
+    threads = (ABT_thread *)malloc(num_total_threads * sizeof(ABT_thread));
+
+    for (k = 0; k < NUM_POOL_KINDS; k++) {
+        ABT_pool_create_basic(pool_kinds[k].kind, ABT_POOL_ACCESS_MPMC,
+                              ABT_FALSE, &g_pool);
+        for (i = 0; i < num_total_threads; i++) {
+            ABT_thread_create(g_pool, thread_func, NULL, ABT_THREAD_ATTR_NULL,
+                              &threads[i]);
+        }
+        for (j = 0; j < num_configs; j++) {
+            for (i = 0; i < T_LAST; i++) {
+                t_timers[(k * num_configs + j) * T_LAST + i] =
+                    run_test(pools, num_active_xstreams[j], i);
+            }
+        }
+        /* Move all the work units to the main pool and run them. */
+        for (i = 0; i < num_total_threads; i++) {
+            ABT_thread thread;
+            pop_thread(&thread);
+            ABT_pool_push_thread(pools[0], thread);
+        }
+        for (i = 0; i < num_total_threads; i++) {
+            ABT_thread_free(&threads[i]);
+        }
+        ABT_pool_free(&g_pool);
+    }
+
+    for (i = 1; i < num_xstreams; i++) {
+        ABT_xstream_join(xstreams[i]);
+        ABT_xstream_free(&xstreams[i]);
+    }
+
+    /* finalize */
+    ATS_finalize(0);
+
+    /* output */
+    int line_size = 64;
+    ATS_print_line(stdout, '-', line_size);
+    printf("# of ESs        : %d\n", num_xstreams);
+    printf("# of ULTs per ES: %d\n", num_threads + BATCH_SIZE);
+    printf("Batch size      : %d\n", BATCH_SIZE);
+    ATS_print_line(stdout, '-', line_size);
+    printf("Avg. time per operation (in seconds, %d times)\n", iter);
+    ATS_print_line(stdout, '-', line_size);
+    printf("%-15s %-5s", "pool", "#ESs");
+    for (i = 0; i < T_LAST; i++)
+        printf("  %-19s", t_names[i]);
+    printf("\n");
+    for (k = 0; k < NUM_POOL_KINDS; k++) {
+        for (j = 0; j < num_configs; j++) {
+            printf("%-15s %-5d", pool_kinds[k].name, num_active_xstreams[j]);
+            for (i = 0; i < T_LAST; i++)
+                printf("  %-19.9f",
+                       t_timers[(k * num_configs + j) * T_LAST + i]);
+            printf("\n");
+        }
+    }
+    ATS_print_line(stdout, '-', line_size);
+
+    free(xstreams);
+    free(pools);
+    free(threads);
+    free(t_timers);
+    free(num_active_xstreams);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,362 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This benchmark compares the cost of push/pop operations of user-defined pools
+ * with that of built-in pools.  Each ES has two private pools that hold many
+ * ULTs.
+ *  - push/pop: pop a ULT from a pool and push it back to the same pool.
+ *  - move: pop a ULT from a pool and push it to the other pool.  For
+ *    user-defined pools, this creates a new ABT_unit and updates the mapping
+ *    from ABT_unit to ABT_thread, which is shared by all the ESs.
+ */
+
+enum {
+    T_PUSH_POP = 0,
+    T_MOVE,
+    T_LAST
+};
+static char *t_names[] = {
+    "push/pop",
+    "move",
+};
+
+enum {
+    P_BUILTIN = 0,
+    P_USER_DEF,
+    P_LAST
+};
+static char *p_names[] = {
+    "built-in",
+    "user-defined",
+};
+
+typedef struct {
+    int eid; /* ES id */
+    int test_kind;
+} arg_t;
+
+static int iter;
+static int num_xstreams;
+static int num_threads;
+
+static ABT_barrier g_barrier = ABT_BARRIER_NULL;
+static ABT_pool *g_pools; /* Two pools per ES. */
+
+static double t_overhead = 0.0;
+static double t_time_per_op = 0.0;
+
+/* A simple FIFO pool. */
+typedef struct unit_t {
+    ABT_thread thread;
+    struct unit_t *p_next;
+} unit_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    unit_t *p_head;
+    unit_t *p_tail;
+    size_t size;
+} pool_data_t;
+
+static ABT_unit pool_create_unit(ABT_pool pool, ABT_thread thread)
+{
+    ATS_UNUSED(pool);
+    unit_t *p_unit = (unit_t *)malloc(sizeof(unit_t));
+    p_unit->thread = thread;
+    p_unit->p_next = NULL;
+    return (ABT_unit)p_unit;
+}
+
+static void pool_free_unit(ABT_pool pool, ABT_unit unit)
+{
+    ATS_UNUSED(pool);
+    free((unit_t *)unit);
+}
+
+static pool_data_t *pool_get_data(ABT_pool pool)
+{
+    void *p_data;
+    ABT_pool_get_data(pool, &p_data);
+    return (pool_data_t *)p_data;
+}
+
+static ABT_bool pool_is_empty(ABT_pool pool)
+{
+    pool_data_t *p_data = pool_get_data(pool);
+    return p_data->size == 0 ? ABT_TRUE : ABT_FALSE;
+}
+
+static size_t pool_get_size(ABT_pool pool)
+{
+    pool_data_t *p_data = pool_get_data(pool);
+    return p_data->size;
+}
+
+static ABT_thread pool_pop(ABT_pool pool, ABT_pool_context context)
+{
+    ATS_UNUSED(context);
+    pool_data_t *p_data = pool_get_data(pool);
+    ABT_thread thread = ABT_THREAD_NULL;
+    pthread_mutex_lock(&p_data->lock);
+    if (p_data->p_head) {
+        unit_t *p_unit = p_data->p_head;
+        p_data->p_head = p_unit->p_next;
+        if (!p_data->p_head)
+            p_data->p_tail = NULL;
+        p_data->size--;
+        thread = p_unit->thread;
+    }
+    pthread_mutex_unlock(&p_data->lock);
+    return thread;
+}
+
+static void pool_push(ABT_pool pool, ABT_unit unit, ABT_pool_context context)
+{
+    ATS_UNUSED(context);
+    pool_data_t *p_data = pool_get_data(pool);
+    unit_t *p_unit = (unit_t *)unit;
+    p_unit->p_next = NULL;
+    pthread_mutex_lock(&p_data->lock);
+    if (p_data->p_tail) {
+        p_data->p_tail->p_next = p_unit;
+    } else {
+        p_data->p_head = p_unit;
+    }
+    p_data->p_tail = p_unit;
+    p_data->size++;
+    pthread_mutex_unlock(&p_data->lock);
+}
+
+static int pool_init(ABT_pool pool, ABT_pool_config config)
+{
+    ATS_UNUSED(config);
+    pool_data_t *p_data = (pool_data_t *)malloc(sizeof(pool_data_t));
+    pthread_mutex_init(&p_data->lock, NULL);
+    p_data->p_head = NULL;
+    p_data->p_tail = NULL;
+    p_data->size = 0;
+    ABT_pool_set_data(pool, (void *)p_data);
+    return ABT_SUCCESS;
+}
+
+static void pool_free(ABT_pool pool)
+{
+    pool_data_t *p_data = pool_get_data(pool);
+    pthread_mutex_destroy(&p_data->lock);
+    free(p_data);
+}
+
+static void create_pool(int pool_kind, ABT_pool *p_pool)
+{
+    if (pool_kind == P_BUILTIN) {
+        ABT_pool_create_basic(ABT_POOL_FIFO, ABT_POOL_ACCESS_MPMC, ABT_FALSE,
+                              p_pool);
+    } else {
+        ABT_pool_user_def def;
+        ABT_pool_user_def_create(pool_create_unit, pool_free_unit,
+                                 pool_is_empty, pool_pop, pool_push, &def);
+        ABT_pool_user_def_set_init(def, pool_init);
+        ABT_pool_user_def_set_free(def, pool_free);
+        ABT_pool_user_def_set_get_size(def, pool_get_size);
+        ABT_pool_create(def, ABT_POOL_CONFIG_NULL, p_pool);
+        ABT_pool_user_def_free(&def);
+    }
+}
+
+static void thread_func(void *arg)
+{
+    ATS_UNUSED(arg);
+}
+
+void pool_push_pop(void *arg)
+{
+    arg_t *my_arg = (arg_t *)arg;
+    int eid = my_arg->eid;
+    int test_kind = my_arg->test_kind;
+    ABT_pool pool_a = g_pools[eid * 2], pool_b = g_pools[eid * 2 + 1];
+
+    ABT_timer timer;
+    double t_time;
+    ABT_thread thread;
+    int i;
+
+    if (eid == 0) {
+        ABT_timer_create(&timer);
+    }
+
+    /* barrier */
+    ABT_barrier_wait(g_barrier);
+
+    /* start timer */
+    if (eid == 0)
+        ABT_timer_start(timer);
+
+    if (test_kind == T_PUSH_POP) {
+        for (i = 0; i < iter; i++) {
+            ABT_pool_pop_thread(pool_a, &thread);
+            ABT_pool_push_thread(pool_a, thread);
+        }
+    } else {
+        for (i = 0; i < iter; i++) {
+            ABT_pool_pop_thread(pool_a, &thread);
+            ABT_pool_push_thread(pool_b, thread);
+            ABT_pool_pop_thread(pool_b, &thread);
+            ABT_pool_push_thread(pool_a, thread);
+        }
+    }
+
+    /* barrier */
+    ABT_barrier_wait(g_barrier);
+
+    /* stop timer */
+    if (eid == 0) {
+        ABT_timer_stop_and_read(timer, &t_time);
+        if (test_kind == T_PUSH_POP) {
+            t_time_per_op = (t_time - t_overhead) / iter;
+        } else {
+            t_time_per_op = (t_time - t_overhead) / (iter * 2);
+        }
+        ABT_timer_free(&timer);
+    }
+}
+
+static double run_test(ABT_pool *main_pools, int test_kind)
+{
+    ABT_thread *threads;
+    arg_t *args;
+    int i;
+
+    threads = (ABT_thread *)malloc(num_xstreams * sizeof(ABT_thread));
+    args = (arg_t *)malloc(num_xstreams * sizeof(arg_t));
+    ABT_barrier_create(num_xstreams, &g_barrier);
+
+    for (i = 1; i < num_xstreams; i++) {
+        args[i].eid = i;
+        args[i].test_kind = test_kind;
+        ABT_thread_create(main_pools[i], pool_push_pop, (void *)&args[i],
+                          ABT_THREAD_ATTR_NULL, &threads[i]);
+    }
+    args[0].eid = 0;
+    args[0].test_kind = test_kind;
+    pool_push_pop((void *)&args[0]);
+
+    for (i = 1; i < num_xstreams; i++) {
+        ABT_thread_free(&threads[i]);
+    }
+    ABT_barrier_free(&g_barrier);
+    free(threads);
+    free(args);
+    return t_time_per_op;
+}
+
+int main(int argc, char *argv[])
+{
+    ABT_xstream *xstreams;
+    ABT_pool *main_pools;
+    ABT_thread *threads;
+    ABT_timer timer;
+    double t_timers[P_LAST][T_LAST];
+    int i, k, t;
+
+    /* read command-line arguments */
+    ATS_read_args(argc, argv);
+    num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+    num_threads = ATS_get_arg_val(ATS_ARG_N_ULT);
+    iter = ATS_get_arg_val(ATS_ARG_N_ITER);
+
+    /* initialize */
+    ATS_init(argc, argv, num_xstreams);
+
+    /* create a timer */
+    ABT_timer_create(&timer);
+    ABT_timer_start(timer);
+    ABT_timer_stop(timer);
+    ABT_timer_get_overhead(&t_overhead);
+    ABT_timer_free(&timer);
+
+    xstreams = (ABT_xstream *)malloc(num_xstreams * sizeof(ABT_xstream));
+    main_pools = (ABT_pool *)malloc(num_xstreams * sizeof(ABT_pool));
+    g_pools = (ABT_pool *)malloc(num_xstreams * 2 * sizeof(ABT_pool));
+
+    ABT_xstream_self(&xstreams[0]);
+    for (i = 1; i < num_xstreams; i++) {
+        ABT_xstream_create(ABT_SCHED_NULL, &xstreams[i]);
+    }
+    for (i = 0; i < num_xstreams; i++) {
+        ABT_xstream_get_main_pools(xstreams[i], 1, &main_pools[i]);
+    }
+
+    /* Work units in g_pools are never scheduled since the pools are not
+     * associated with any scheduler. */
+    const int num_total_threads = num_xstreams * num_threads;
+    threads = (ABT_thread *)malloc(num_total_threads * sizeof(ABT_thread));
+
+    for (k = 0; k < P_LAST; k++) {
+        for (i = 0; i < num_xstreams * 2; i++)
+            create_pool(k, &g_pools[i]);
+        for (i = 0; i < num_total_threads; i++) {
+            ABT_thread_create(g_pools[(i % num_xstreams) * 2], thread_func,
+                              NULL, ABT_THREAD_ATTR_NULL, &threads[i]);
+        }
+        for (t = 0; t < T_LAST; t++)
+            t_timers[k][t] = run_test(main_pools, t);
+        /* Move all the work units to the main pool and run them. */
+        for (i = 0; i < num_xstreams * 2; i++) {
+            ABT_thread thread;
+            while (1) {
+                ABT_pool_pop_thread(g_pools[i], &thread);
+                if (thread == ABT_THREAD_NULL)
+                    break;
+                ABT_pool_push_thread(main_pools[0], thread);
+            }
+        }
+        for (i = 0; i < num_total_threads; i++) {
+            ABT_thread_free(&threads[i]);
+        }
+        for (i = 0; i < num_xstreams * 2; i++)
+            ABT_pool_free(&g_pools[i]);
+    }
+
+    for (i = 1; i < num_xstreams; i++) {
+        ABT_xstream_join(xstreams[i]);
+        ABT_xstream_free(&xstreams[i]);
+    }
+
+    /* finalize */
+    ATS_finalize(0);
+
+    /* output */
+    int line_size = 45;
+    ATS_print_line(stdout, '-', line_size);
+    printf("# of ESs        : %d\n", num_xstreams);
+    printf("# of ULTs per ES: %d\n", num_threads);
+    ATS_print_line(stdout, '-', line_size);
+    printf("Avg. time per operation (in seconds, %d times)\n", iter);
+    ATS_print_line(stdout, '-', line_size);
+    printf("%-13s", "pool");
+    for (t = 0; t < T_LAST; t++)
+        printf("  %-14s", t_names[t]);
+    printf("\n");
+    for (k = 0; k < P_LAST; k++) {
+        printf("%-13s", p_names[k]);
+        for (t = 0; t < T_LAST; t++)
+            printf("  %-14.9f", t_timers[k][t]);
+        printf("\n");
+    }
+    ATS_print_line(stdout, '-', line_size);
+
+    free(xstreams);
+    free(main_pools);
+    free(g_pools);
+    free(threads);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,204 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "abt.h"
+#include "abttest.h"
+
+/* This benchmark measures ABT_SCHED_RANDWS with imbalanced spawn patterns.  All
+ * the work units are spawned from the first ES, so the other ESs need to steal
+ * them.  "hierarchy" steals half of the work units from the nearest victims in
+ * terms of the CPU topology, which requires ABT_SET_AFFINITY.
+ *  - flat: a single ULT creates all the work units.
+ *  - tree: each ULT creates two child ULTs of different sizes like Fibonacci.
+ */
+
+#define TREE_DEPTH 16
+#define LEAF_WORK 256
+
+enum {
+    T_FLAT = 0,
+    T_TREE,
+    T_LAST
+};
+static char *t_names[] = {
+    "flat",
+    "tree",
+};
+
+enum {
+    M_STEAL_ONE = 0,
+    M_STEAL_HALF,
+    M_HIERARCHY,
+    M_LAST
+};
+static char *m_names[] = {
+    "steal-one",
+    "steal-half",
+    "hierarchy",
+};
+
+static int iter;
+static int num_xstreams;
+static int num_threads;
+
+static double t_timers[M_LAST][T_LAST];
+
+static void leaf_func(void *arg)
+{
+    ATS_UNUSED(arg);
+    volatile int i, sum = 0;
+    for (i = 0; i < LEAF_WORK; i++)
+        sum += i;
+}
+
+static void flat_func(void *arg)
+{
+    ATS_UNUSED(arg);
+    ABT_xstream xstream;
+    ABT_pool pool;
+    int i;
+
+    ABT_xstream_self(&xstream);
+    ABT_xstream_get_main_pools(xstream, 1, &pool);
+    ABT_thread *threads =
+        (ABT_thread *)malloc(num_threads * sizeof(ABT_thread));
+    for (i = 0; i < num_threads; i++) {
+        ABT_thread_create(pool, leaf_func, NULL, ABT_THREAD_ATTR_NULL,
+                          &threads[i]);
+    }
+    for (i = 0; i < num_threads; i++) {
+        ABT_thread_free(&threads[i]);
+    }
+    free(threads);
+}
+
+static void tree_func(void *arg)
+{
+    int depth = (int)(intptr_t)arg;
+    if (depth < 2) {
+        leaf_func(NULL);
+        return;
+    }
+    ABT_xstream xstream;
+    ABT_pool pool;
+    ABT_thread threads[2];
+    ABT_xstream_self(&xstream);
+    ABT_xstream_get_main_pools(xstream, 1, &pool);
+    ABT_thread_create(pool, tree_func, (void *)(intptr_t)(depth - 1),
+                      ABT_THREAD_ATTR_NULL, &threads[0]);
+    ABT_thread_create(pool, tree_func, (void *)(intptr_t)(depth - 2),
+                      ABT_THREAD_ATTR_NULL, &threads[1]);
+    ABT_thread_free(&threads[0]);
+    ABT_thread_free(&threads[1]);
+}
+
+static void run_tests(int mode)
+{
+    ABT_xstream *xstreams;
+    ABT_sched *scheds;
+    ABT_pool *pools, *my_pools;
+    ABT_sched_config config = ABT_SCHED_CONFIG_NULL;
+    int i, k, t;
+
+    xstreams = (ABT_xstream *)malloc(num_xstreams * sizeof(ABT_xstream));
+    scheds = (ABT_sched *)malloc(num_xstreams * sizeof(ABT_sched));
+    pools = (ABT_pool *)malloc(num_xstreams * sizeof(ABT_pool));
+    my_pools = (ABT_pool *)malloc(num_xstreams * sizeof(ABT_pool));
+
+    if (mode == M_STEAL_HALF) {
+        ABT_sched_config_create(&config, ABT_sched_randws_steal_half, 1,
+                                ABT_sched_config_var_end);
+    } else if (mode == M_HIERARCHY) {
+        ABT_sched_config_create(&config, ABT_sched_randws_steal_half, 1,
+                                ABT_sched_randws_victim_hierarchy, 1,
+                                ABT_sched_config_var_end);
+    }
+    for (i = 0; i < num_xstreams; i++) {
+        ABT_pool_create_basic(ABT_POOL_RANDWS, ABT_POOL_ACCESS_MPMC, ABT_TRUE,
+                              &pools[i]);
+    }
+    for (i = 0; i < num_xstreams; i++) {
+        for (k = 0; k < num_xstreams; k++)
+            my_pools[k] = pools[(i + k) % num_xstreams];
+        ABT_sched_create_basic(ABT_SCHED_RANDWS, num_xstreams, my_pools, config,
+                               &scheds[i]);
+    }
+    if (config != ABT_SCHED_CONFIG_NULL)
+        ABT_sched_config_free(&config);
+    for (i = 0; i < num_xstreams; i++) {
+        ABT_xstream_create(scheds[i], &xstreams[i]);
+    }
+
+    for (t = 0; t < T_LAST; t++) {
+        void (*test_fn)(void *) = (t == T_FLAT) ? flat_func : tree_func;
+        void *arg = (t == T_FLAT) ? NULL : (void *)(intptr_t)TREE_DEPTH;
+        double t_start = 0.0;
+        /* The first iteration is a warm-up. */
+        for (i = 0; i < iter + 1; i++) {
+            ABT_thread thread;
+            if (i == 1)
+                t_start = ABT_get_wtime();
+            ABT_thread_create(pools[0], test_fn, arg, ABT_THREAD_ATTR_NULL,
+                              &thread);
+            ABT_thread_free(&thread);
+        }
+        t_timers[mode][t] = (ABT_get_wtime() - t_start) / iter;
+    }
+
+    for (i = 0; i < num_xstreams; i++) {
+        ABT_xstream_join(xstreams[i]);
+        ABT_xstream_free(&xstreams[i]);
+    }
+
+    free(xstreams);
+    free(scheds);
+    free(pools);
+    free(my_pools);
+}
+
+int main(int argc, char *argv[])
+{
+    int i, t;
+
+    /* read command-line arguments */
+    ATS_read_args(argc, argv);
+    num_xstreams = ATS_get_arg_val(ATS_ARG_N_ES);
+    num_threads = ATS_get_arg_val(ATS_ARG_N_ULT);
+    iter = ATS_get_arg_val(ATS_ARG_N_ITER);
+
+    /* initialize */
+    ATS_init(argc, argv, num_xstreams + 1);
+
+    for (i = 0; i < M_LAST; i++)
+        run_tests(i);
+
+    /* finalize */
+    ATS_finalize(0);
+
+    /* output */
+    int line_size = 45;
+    ATS_print_line(stdout, '-', line_size);
+    printf("# of ESs              : %d\n", num_xstreams);
+    printf("# of ULTs (flat)      : %d\n", num_threads);
+    printf("Depth (tree)          : %d\n", TREE_DEPTH);
+    ATS_print_line(stdout, '-', line_size);
+    printf("Avg. execution time (in seconds, %d times)\n", iter);
+    ATS_print_line(stdout, '-', line_size);
+    printf("%-12s", "mode");
+    for (t = 0; t < T_LAST; t++)
+        printf("  %-14s", t_names[t]);
+    printf("\n");
+    for (i = 0; i < M_LAST; i++) {
+        printf("%-12s", m_names[i]);
+        for (t = 0; t < T_LAST; t++)
+            printf("  %-14.9f", t_timers[i][t]);
+        printf("\n");
+    }
+    ATS_print_line(stdout, '-', line_size);
+
+    return EXIT_SUCCESS;
+}
@@ -17,6 +17,16 @@ enum {
     T_MUTEX_CREATE_FREE,
     T_MUTEX_LOCK_UNLOCK,
     T_MUTEX_LOCK_UNLOCK_ALL,
+    T_MUTEX_CONTENDED,
+    T_MUTEX_CONTENDED_ALL,
+    T_RWLOCK_RDLOCK_UNLOCK,
+    T_RWLOCK_RDLOCK_UNLOCK_ALL,
+    T_BARRIER_WAIT,
+    T_BARRIER_WAIT_ALL,
+    T_FUTURE_SET,
+    T_FUTURE_SET_ALL,
+    T_EVENTUAL_CREATE_FREE,
+    T_EVENTUAL_CREATE_FREE_ALL,
     T_LAST
 };
 static char *t_names[] = {
@@ -28,6 +38,16 @@ static char *t_names[] = {
     "mutex: create/free",
     "mutex: lock/unlock",
     "mutex: lock/unlock (all)",
+    "mutex: contended",
+    "mutex: contended (all)",
+    "rwlock: rdlock/unlock",
+    "rwlock: rdlock/unlock (all)",
+    "barrier: wait",
+    "barrier: wait (all)",
+    "future: set",
+    "future: set (all)",
+    "eventual: create/free",
+    "eventual: create/free (all)",
 };
 
 typedef struct {
@@ -46,6 +66,9 @@ static int num_threads;
 
 static ABT_barrier g_barrier = ABT_BARRIER_NULL;
 static ABT_mutex g_mutex = ABT_MUTEX_NULL;
+static ABT_rwlock g_rwlock = ABT_RWLOCK_NULL;
+static ABT_future *g_futures = NULL;
+static int g_counter = 0;
 
 static double t_overhead = 0.0;
 static double t_timers[T_LAST];
@@ -88,6 +111,211 @@ void mutex_lock_unlock(void *arg)
     }
 }
 
+/* Every ULT yields while holding the mutex, so the other ULTs are blocked on
+ * the mutex and every unlock needs to wake up a waiter. */
+void mutex_contended(void *arg)
+{
+    arg_t *my_arg = (arg_t *)arg;
+    int eid = my_arg->eid;
+    int tid = my_arg->tid;
+
+    ABT_timer timer;
+    double t_time;
+    int i;
+
+    if (eid == 0 && tid == 0) {
+        ABT_timer_create(&timer);
+    }
+
+    /* barrier */
+    ABT_barrier_wait(g_barrier);
+
+    /* start timer */
+    if (eid == 0 && tid == 0)
+        ABT_timer_start(timer);
+
+    /* measure contended mutex lock/unlock time */
+    for (i = 0; i < iter; i++) {
+        ABT_mutex_lock(g_mutex);
+        g_counter++;
+        ABT_thread_yield();
+        ABT_mutex_unlock(g_mutex);
+    }
+
+    /* barrier */
+    ABT_barrier_wait(g_barrier);
+
+    /* stop timer */
+    if (eid == 0 && tid == 0) {
+        ABT_timer_stop_and_read(timer, &t_time);
+        t_timers[T_MUTEX_CONTENDED] = (t_time - t_overhead) / iter;
+        ABT_timer_free(&timer);
+    }
+}
+
+/* All the ULTs take the read lock at the same time, so this shows how well
+ * readers on different ESs scale. */
+void rwlock_rdlock_unlock(void *arg)
+{
+    arg_t *my_arg = (arg_t *)arg;
+    int eid = my_arg->eid;
+    int tid = my_arg->tid;
+
+    ABT_timer timer;
+    double t_time;
+    int i;
+
+    if (eid == 0 && tid == 0) {
+        ABT_timer_create(&timer);
+    }
+
+    /* barrier */
+    ABT_barrier_wait(g_barrier);
+
+    /* start timer */
+    if (eid == 0 && tid == 0)
+        ABT_timer_start(timer);
+
+    /* measure rwlock rdlock/unlock time */
+    for (i = 0; i < iter; i++) {
+        ABT_rwlock_rdlock(g_rwlock);
+        ABT_rwlock_unlock(g_rwlock);
+    }
+
+    /* barrier */
+    ABT_barrier_wait(g_barrier);
+
+    /* stop timer */
+    if (eid == 0 && tid == 0) {
+        ABT_timer_stop_and_read(timer, &t_time);
+        t_timers[T_RWLOCK_RDLOCK_UNLOCK] = (t_time - t_overhead) / iter;
+        ABT_timer_free(&timer);
+    }
+}
+
+/* All the ULTs of all the ESs wait on the same barrier. */
+void barrier_wait(void *arg)
+{
+    arg_t *my_arg = (arg_t *)arg;
+    int eid = my_arg->eid;
+    int tid = my_arg->tid;
+
+    ABT_timer timer;
+    double t_time;
+    int i;
+
+    if (eid == 0 && tid == 0) {
+        ABT_timer_create(&timer);
+    }
+
+    /* barrier */
+    ABT_barrier_wait(g_barrier);
+
+    /* start timer */
+    if (eid == 0 && tid == 0)
+        ABT_timer_start(timer);
+
+    /* measure barrier wait time */
+    for (i = 0; i < iter; i++) {
+        ABT_barrier_wait(g_barrier);
+    }
+
+    /* stop timer */
+    if (eid == 0 && tid == 0) {
+        ABT_timer_stop_and_read(timer, &t_time);
+        t_timers[T_BARRIER_WAIT] = (t_time - t_overhead) / iter;
+        ABT_timer_free(&timer);
+    }
+}
+
+/* All the ULTs of all the ESs set a compartment of the same future.  Each
+ * iteration uses a different future, so no reset is needed in between. */
+void future_set(void *arg)
+{
+    arg_t *my_arg = (arg_t *)arg;
+    int eid = my_arg->eid;
+    int tid = my_arg->tid;
+
+    ABT_timer timer;
+    double t_time;
+    int i;
+
+    if (eid == 0 && tid == 0) {
+        ABT_timer_create(&timer);
+    }
+
+    /* barrier */
+    ABT_barrier_wait(g_barrier);
+
+    /* start timer */
+    if (eid == 0 && tid == 0)
+        ABT_timer_start(timer);
+
+    /* measure future set time */
+    for (i = 0; i < iter; i++) {
+        ABT_future_set(g_futures[i], arg);
+    }
+
+    /* barrier */
+    ABT_barrier_wait(g_barrier);
+
+    /* stop timer */
+    if (eid == 0 && tid == 0) {
+        ABT_timer_stop_and_read(timer, &t_time);
+        t_timers[T_FUTURE_SET] = (t_time - t_overhead) / iter;
+        ABT_timer_free(&timer);
+    }
+}
+
+/* Each iteration creates an eventual, sets a value, reads it, and frees the
+ * eventual, which is a typical use of an eventual per request. */
+void eventual_create_free(void *arg)
+{
+    arg_t *my_arg = (arg_t *)arg;
+    int eid = my_arg->eid;
+    int tid = my_arg->tid;
+
+    ABT_timer timer;
+    double t_time;
+    int i;
+
+    if (eid == 0 && tid == 0) {
+        ABT_timer_create(&timer);
+    }
+
+    /* barrier */
+    ABT_barrier_wait(g_barrier);
+
+    /* start timer */
+    if (eid == 0 && tid == 0)
+        ABT_timer_start(timer);
+
+    /* measure eventual create/set/wait/free time */
+    for (i = 0; i < iter; i++) {
+        ABT_eventual eventual;
+        int *p_value;
+        ABT_eventual_create(sizeof(int), &eventual);
+        ABT_eventual_set(eventual, &i, sizeof(int));
+        ABT_eventual_wait(eventual, (void **)&p_value);
+        if (*p_value != i) {
+            fprintf(stderr, "Wrong eventual value: %d (expected %d)\n",
+                    *p_value, i);
+            exit(EXIT_FAILURE);
+        }
+        ABT_eventual_free(&eventual);
+    }
+
+    /* barrier */
+    ABT_barrier_wait(g_barrier);
+
+    /* stop timer */
+    if (eid == 0 && tid == 0) {
+        ABT_timer_stop_and_read(timer, &t_time);
+        t_timers[T_EVENTUAL_CREATE_FREE] = (t_time - t_overhead) / iter;
+        ABT_timer_free(&timer);
+    }
+}
+
 void launch_test(void *arg)
 {
     launch_t *my_arg = (launch_t *)arg;
@@ -106,6 +334,21 @@ void launch_test(void *arg)
         case T_MUTEX_LOCK_UNLOCK:
             test_fn = mutex_lock_unlock;
             break;
+        case T_MUTEX_CONTENDED:
+            test_fn = mutex_contended;
+            break;
+        case T_RWLOCK_RDLOCK_UNLOCK:
+            test_fn = rwlock_rdlock_unlock;
+            break;
+        case T_BARRIER_WAIT:
+            test_fn = barrier_wait;
+            break;
+        case T_FUTURE_SET:
+            test_fn = future_set;
+            break;
+        case T_EVENTUAL_CREATE_FREE:
+            test_fn = eventual_create_free;
+            break;
         default:
             fprintf(stderr, "Unknown test kind!\n");
             exit(EXIT_FAILURE);
@@ -132,6 +375,27 @@ void launch_test(void *arg)
     free(args);
 }
 
+/* Run test_kind on all ESs and wait for its completion. */
+static void run_test(int test_kind, ABT_xstream *xstreams, ABT_pool *pools,
+                     ABT_thread *threads, launch_t *largs)
+{
+    int i;
+    for (i = 1; i < num_xstreams; i++) {
+        largs[i].eid = i;
+        largs[i].test_kind = test_kind;
+        ABT_thread_create(pools[i], launch_test, (void *)&largs[i],
+                          ABT_THREAD_ATTR_NULL, &threads[i]);
+    }
+
+    largs[0].eid = 0;
+    largs[0].test_kind = test_kind;
+    launch_test((void *)&largs[0]);
+
+    for (i = 1; i < num_xstreams; i++) {
+        ABT_thread_free(&threads[i]);
+    }
+}
+
 int main(int argc, char *argv[])
 {
     ABT_xstream *xstreams;
@@ -205,28 +469,71 @@ int main(int argc, char *argv[])
     t_timers[T_MUTEX_CREATE_FREE] =
         t_timers[T_MUTEX_CREATE] + t_timers[T_MUTEX_FREE];
 
-    /* mutex lock/unlock time */
-    ABT_timer_start(timer);
-
     largs = (launch_t *)malloc(num_xstreams * sizeof(launch_t));
     ABT_barrier_create(num_xstreams * num_threads, &g_barrier);
     ABT_mutex_create(&g_mutex);
+    ABT_rwlock_create(&g_rwlock);
 
     ABT_xstream_self(&xstreams[0]);
     for (i = 1; i < num_xstreams; i++) {
         ABT_xstream_create(ABT_SCHED_NULL, &xstreams[i]);
-    }
-    for (i = 1; i < num_xstreams; i++) {
         ABT_xstream_get_main_pools(xstreams[i], 1, &pools[i]);
-        largs[i].eid = i;
-        largs[i].test_kind = T_MUTEX_LOCK_UNLOCK;
-        ABT_thread_create(pools[i], launch_test, (void *)&largs[i],
-                          ABT_THREAD_ATTR_NULL, NULL);
     }
 
-    largs[0].eid = 0;
-    largs[0].test_kind = T_MUTEX_LOCK_UNLOCK;
-    launch_test((void *)&largs[0]);
+    /* mutex lock/unlock time */
+    ABT_timer_start(timer);
+    run_test(T_MUTEX_LOCK_UNLOCK, xstreams, pools, threads, largs);
+    ABT_timer_stop_and_read(timer, &t_time);
+    t_timers[T_MUTEX_LOCK_UNLOCK_ALL] = (t_time - t_overhead) / iter;
+
+    /* contended mutex lock/unlock time */
+    ABT_timer_start(timer);
+    run_test(T_MUTEX_CONTENDED, xstreams, pools, threads, largs);
+    ABT_timer_stop_and_read(timer, &t_time);
+    t_timers[T_MUTEX_CONTENDED_ALL] = (t_time - t_overhead) / iter;
+    if (g_counter != iter * num_xstreams * num_threads) {
+        fprintf(stderr, "Wrong counter: %d (expected %d)\n", g_counter,
+                iter * num_xstreams * num_threads);
+        exit(EXIT_FAILURE);
+    }
+
+    /* rwlock rdlock/unlock time */
+    ABT_timer_start(timer);
+    run_test(T_RWLOCK_RDLOCK_UNLOCK, xstreams, pools, threads, largs);
+    ABT_timer_stop_and_read(timer, &t_time);
+    t_timers[T_RWLOCK_RDLOCK_UNLOCK_ALL] = (t_time - t_overhead) / iter;
+
+    /* barrier wait time */
+    ABT_timer_start(timer);
+    run_test(T_BARRIER_WAIT, xstreams, pools, threads, largs);
+    ABT_timer_stop_and_read(timer, &t_time);
+    t_timers[T_BARRIER_WAIT_ALL] = (t_time - t_overhead) / iter;
+
+    /* future set time */
+    g_futures = (ABT_future *)malloc(iter * sizeof(ABT_future));
+    for (i = 0; i < iter; i++) {
+        ABT_future_create(num_xstreams * num_threads, NULL, &g_futures[i]);
+    }
+    ABT_timer_start(timer);
+    run_test(T_FUTURE_SET, xstreams, pools, threads, largs);
+    ABT_timer_stop_and_read(timer, &t_time);
+    t_timers[T_FUTURE_SET_ALL] = (t_time - t_overhead) / iter;
+    for (i = 0; i < iter; i++) {
+        ABT_bool is_ready;
+        ABT_future_test(g_futures[i], &is_ready);
+        if (is_ready != ABT_TRUE) {
+            fprintf(stderr, "Future %d is not ready\n", i);
+            exit(EXIT_FAILURE);
+        }
+        ABT_future_free(&g_futures[i]);
+    }
+    free(g_futures);
+
+    /* eventual create/free time */
+    ABT_timer_start(timer);
+    run_test(T_EVENTUAL_CREATE_FREE, xstreams, pools, threads, largs);
+    ABT_timer_stop_and_read(timer, &t_time);
+    t_timers[T_EVENTUAL_CREATE_FREE_ALL] = (t_time - t_overhead) / iter;
 
     for (i = 1; i < num_xstreams; i++) {
         ABT_xstream_join(xstreams[i]);
@@ -234,17 +541,15 @@ int main(int argc, char *argv[])
     }
     ABT_barrier_free(&g_barrier);
     ABT_mutex_free(&g_mutex);
+    ABT_rwlock_free(&g_rwlock);
     free(largs);
 
-    ABT_timer_stop_and_read(timer, &t_time);
-    t_timers[T_MUTEX_LOCK_UNLOCK_ALL] = (t_time - t_overhead) / iter;
-
     /* finalize */
     ABT_timer_free(&timer);
     ATS_finalize(0);
 
     /* output */
-    int line_size = 45;
+    int line_size = 47;
     ATS_print_line(stdout, '-', line_size);
     printf("# of ESs        : %d\n", num_xstreams);
     printf("# of ULTs per ES: %d\n", num_threads);
@@ -252,7 +557,7 @@ int main(int argc, char *argv[])
     printf("Avg. execution time (in seconds, %d times)\n", iter);
     ATS_print_line(stdout, '-', line_size);
     for (i = 0; i < T_LAST; i++) {
-        printf("%-25s  %.9f\n", t_names[i], t_timers[i]);
+        printf("%-27s  %.9f\n", t_names[i], t_timers[i]);
     }
     ATS_print_line(stdout, '-', line_size);
 
@@ -0,0 +1,164 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil ; -*- */
+/*
+ * See COPYRIGHT in top-level directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "abt.h"
+#include "abttest.h"
+#include "bench_util.h"
+
+/* This benchmark measures ABT_thread_create_many(), ABT_thread_join_many(),
+ * and ABT_thread_free_many() for bulk sizes from 1 to the given number of
+ * ULTs.  For comparison, it also measures ABT_thread_create() called as many
+ * times as the bulk size. */
+
+/* The number of ULTs created per size is kept around this number. */
+#define NULTS_PER_ITER 64
+
+#define ABTX_prof_summary(my_es, nults, iter, label, time, timestd)            \
+    do {                                                                       \
+        time /= iter;                                                          \
+        timestd = sqrt(timestd / iter - time * time);                          \
+        printf("%-3d %8d %8d %-20s %12.2f [%.2f]\n", my_es, nults, iter,       \
+               label, time, timestd);                                          \
+        fflush(stdout);                                                        \
+    } while (0)
+
+static ABT_xstream *xstreams;
+static ABT_pool *pools;
+static int niter, max_ults, ness;
+static ABT_xstream_barrier g_xbarrier = ABT_XSTREAM_BARRIER_NULL;
+
+static void thread_func(void *arg)
+{
+    ATS_UNUSED(arg);
+}
+
+static void main_thread_func(void *arg)
+{
+    int my_es = (int)(size_t)arg;
+    int t, nults;
+
+    ABT_thread *my_ults = (ABT_thread *)malloc(max_ults * sizeof(ABT_thread));
+    ABT_pool *my_pools = (ABT_pool *)malloc(max_ults * sizeof(ABT_pool));
+    void (**my_funcs)(void *) =
+        (void (**)(void *))malloc(max_ults * sizeof(void (*)(void *)));
+    for (t = 0; t < max_ults; t++) {
+        my_pools[t] = pools[my_es];
+        my_funcs[t] = thread_func;
+    }
+
+    /* warm-up */
+    ABT_thread_create_many(max_ults, my_pools, my_funcs, NULL,
+                           ABT_THREAD_ATTR_NULL, my_ults);
+    ABT_thread_free_many(max_ults, my_ults);
+
+    for (nults = 1; nults <= max_ults; nults *= 2) {
+        ABT_xstream_barrier_wait(g_xbarrier);
+        float loop_time = 0.0, loop_timestd = 0.0;
+        float crea_time = 0.0, crea_timestd = 0.0;
+        float join_time = 0.0, join_timestd = 0.0;
+        float free_time = 0.0, free_timestd = 0.0;
+        int i;
+
+        /* Keep the total number of ULTs constant */
+        int iter = niter * NULTS_PER_ITER / nults;
+        if (iter == 0)
+            iter = 1;
+        for (i = 0; i < iter; i++) {
+            unsigned long long start_time;
+
+            /* ABT_thread_create() one by one */
+            ABTX_start_prof(start_time, event_set);
+            for (t = 0; t < nults; t++)
+                ABT_thread_create(my_pools[t], thread_func, NULL,
+                                  ABT_THREAD_ATTR_NULL, &my_ults[t]);
+            ABTX_stop_prof(start_time, nults, loop_time, loop_timestd,
+                           event_set, values, 0, 0, 0, 0);
+            ABT_thread_free_many(nults, my_ults);
+
+            /* ABT_thread_create_many() */
+            ABTX_start_prof(start_time, event_set);
+            ABT_thread_create_many(nults, my_pools, my_funcs, NULL,
+                                   ABT_THREAD_ATTR_NULL, my_ults);
+            ABTX_stop_prof(start_time, nults, crea_time, crea_timestd,
+                           event_set, values, 0, 0, 0, 0);
+
+            ABTX_start_prof(start_time, event_set);
+            ABT_thread_join_many(nults, my_ults);
+            ABTX_stop_prof(start_time, nults, join_time, join_timestd,
+                           event_set, values, 0, 0, 0, 0);
+
+            ABTX_start_prof(start_time, event_set);
+            ABT_thread_free_many(nults, my_ults);
+            ABTX_stop_prof(start_time, nults, free_time, free_timestd,
+                           event_set, values, 0, 0, 0, 0);
+        }
+        ABT_xstream_barrier_wait(g_xbarrier);
+        ABTX_prof_summary(my_es, nults, iter, "create", loop_time,
+                          loop_timestd);
+        ABTX_prof_summary(my_es, nults, iter, "create_many", crea_time,
+                          crea_timestd);
+        ABTX_prof_summary(my_es, nults, iter, "join_many", join_time,
+                          join_timestd);
+        ABTX_prof_summary(my_es, nults, iter, "free_many", free_time,
+                          free_timestd);
+    }
+
+    free(my_ults);
+    free(my_pools);
+    free(my_funcs);
+}
+
+int main(int argc, char *argv[])
+{
+    int i;
+    ATS_read_args(argc, argv);
+    niter = ATS_get_arg_val(ATS_ARG_N_ITER);
+    ness = ATS_get_arg_val(ATS_ARG_N_ES);
+    max_ults = ATS_get_arg_val(ATS_ARG_N_ULT);
+
+    xstreams = (ABT_xstream *)malloc(ness * sizeof(ABT_xstream));
+    pools = (ABT_pool *)malloc(ness * sizeof(ABT_pool));
+
+    ATS_init(argc, argv, ness);
+
+    /* output beginning */
+    ATS_print_line(stdout, '-', 58);
+    printf("%-3s %8s %8s %-20s %16s\n", "ES#", "#ULTs", "#Iter", "Operation",
+           "cycles [std]");
+
+    /* create a global barrier */
+    ABT_xstream_barrier_create(ness, &g_xbarrier);
+
+    /* Create ESs */
+    ABT_xstream_self(&xstreams[0]);
+    ABT_xstream_get_main_pools(xstreams[0], 1, &pools[0]);
+    for (i = 1; i < ness; i++) {
+        ABT_xstream_create(ABT_SCHED_NULL, &xstreams[i]);
+        ABT_xstream_get_main_pools(xstreams[i], 1, &pools[i]);
+    }
+
+    for (i = 1; i < ness; i++) {
+        ABT_thread_create(pools[i], main_thread_func, (void *)(size_t)i,
+                          ABT_THREAD_ATTR_NULL, NULL);
+    }
+
+    main_thread_func((void *)(size_t)0);
+
+    for (i = 1; i < ness; i++) {
+        ABT_xstream_join(xstreams[i]);
+        ABT_xstream_free(&xstreams[i]);
+    }
+    ABT_xstream_barrier_free(&g_xbarrier);
+
+    ATS_finalize(0);
+
+    free(pools);
+    free(xstreams);
+
+    return EXIT_SUCCESS;
+}